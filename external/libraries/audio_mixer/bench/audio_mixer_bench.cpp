@@ -0,0 +1,168 @@
+/**
+ * Renders an acceleration from standstill to full speed and back with the
+ * RPM clips of sound.xml. The speed is updated at 100 Hz as by the control
+ * modules, the audio is rendered in blocks as the audio thread does. Reports
+ * the render time per block against the block duration, the allocations
+ * inside render() and the time decoding a clip takes, which the old player
+ * spent when it switched clips.
+ *
+ * Usage: audio_mixer_bench [--configs DIR] [--block FRAMES] [--out FILE.wav]
+ *
+ * --configs  directory of the WAV files, default configs
+ * --block    frames per render() call, default 256
+ * --out      write the rendered sweep, to listen to the crossfades
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "audio_mixer/engine_sound.h"
+
+using namespace audio_mixer;
+
+namespace {
+
+std::atomic<bool> counting(false);
+std::atomic<uint64_t> allocations(0);
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void writeWav(const std::string &path, const std::vector<int16_t> &samples, int rate) {
+    std::ofstream file(path.c_str(), std::ios::binary);
+    auto put32 = [&file](uint32_t value) {
+        file.write(reinterpret_cast<const char*>(&value), 4);
+    };
+    auto put16 = [&file](uint16_t value) {
+        file.write(reinterpret_cast<const char*>(&value), 2);
+    };
+    uint32_t bytes = static_cast<uint32_t>(samples.size() * 2);
+    file.write("RIFF", 4);
+    put32(36 + bytes);
+    file.write("WAVEfmt ", 8);
+    put32(16);
+    put16(1);
+    put16(2);
+    put32(rate);
+    put32(rate * 4);
+    put16(4);
+    put16(16);
+    file.write("data", 4);
+    put32(bytes);
+    file.write(reinterpret_cast<const char*>(samples.data()), bytes);
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    if(counting.load(std::memory_order_relaxed)) {
+        allocations++;
+    }
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if(p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char *argv[]) {
+    std::string directory = "configs";
+    size_t block = 256;
+    std::string out;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if(arg == "--configs") {
+            directory = argv[i + 1];
+        } else if(arg == "--block") {
+            block = std::atoi(argv[i + 1]);
+        } else if(arg == "--out") {
+            out = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    const int rate = 44100;
+    Mixer mixer(rate, 8, block);
+    std::vector<int> clips;
+    const char *NAMES[] = {"RPM_Low.wav", "RPM_Med.wav", "RPM_High.wav"};
+    int64_t decode = 0;
+    for(const char *name : NAMES) {
+        Clip clip;
+        std::string error;
+        int64_t start = nowNanos();
+        if(! loadWav(directory + "/" + name, rate, &clip, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        decode = std::max(decode, nowNanos() - start);
+        std::printf("%-13s %6zu frames, %.1f s\n", name, clip.frames(),
+                    clip.frames() / static_cast<double>(rate));
+        clips.push_back(mixer.addClip(std::move(clip)));
+    }
+
+    EngineOptions options;
+    options.thresholds = {0.3f, 0.6f, 1};
+    EngineSound engine(mixer, clips, options);
+    engine.start();
+
+    // 0 -> 1 in 4 s, hold 1 s, back to 0 in 3 s
+    const double seconds = 8;
+    const size_t updateFrames = rate / 100;
+    std::vector<int16_t> rendered;
+    rendered.reserve(static_cast<size_t>(seconds * rate * 2) + block * 2);
+    std::vector<int16_t> buffer(block * 2);
+    std::vector<int64_t> times;
+    size_t frame = 0;
+    size_t nextUpdate = 0;
+    while(frame < seconds * rate) {
+        if(frame >= nextUpdate) {
+            double t = frame / static_cast<double>(rate);
+            float speed = t < 4 ? t / 4 : t < 5 ? 1 : std::max(0.0, 1 - (t - 5) / 3);
+            engine.update(speed);
+            nextUpdate += updateFrames;
+        }
+        counting = true;
+        int64_t start = nowNanos();
+        mixer.render(buffer.data(), block);
+        int64_t time = nowNanos() - start;
+        counting = false;
+        times.push_back(time);
+        rendered.insert(rendered.end(), buffer.begin(), buffer.end());
+        frame += block;
+    }
+
+    std::sort(times.begin(), times.end());
+    double blockMicros = block * 1e6 / rate;
+    std::printf("block %zu frames = %.0f us: render p50 %.1f p99 %.1f max %.1f us, %.2f %% CPU\n",
+                block, blockMicros, times[times.size() / 2] / 1000.0,
+                times[times.size() * 99 / 100] / 1000.0, times.back() / 1000.0,
+                times[times.size() / 2] / 10.0 / blockMicros);
+    std::printf("allocations in render: %llu, clipped samples: %llu\n",
+                static_cast<unsigned long long>(allocations.load()),
+                static_cast<unsigned long long>(mixer.clipped()));
+    std::printf("decoding a clip: %.1f ms, %.0f blocks\n", decode / 1e6, decode / 1e3 / blockMicros);
+
+    if(! out.empty()) {
+        writeWav(out, rendered, rate);
+        std::printf("written to %s\n", out.c_str());
+    }
+    return allocations.load() == 0 ? 0 : 1;
+}
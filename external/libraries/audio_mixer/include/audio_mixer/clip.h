@@ -0,0 +1,32 @@
+#ifndef AUDIO_MIXER_CLIP_H
+#define AUDIO_MIXER_CLIP_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace audio_mixer {
+
+/**
+ * @brief Decoded sound, stereo float frames at the rate of the mixer
+ */
+struct Clip {
+    std::string name;
+    std::vector<float> samples; //!< left, right, left, ... in [-1, 1]
+
+    size_t frames() const {
+        return samples.size() / 2;
+    }
+};
+
+/**
+ * @brief loadWav decodes an uncompressed 8 or 16 bit PCM WAV file with one
+ * or two channels and resamples it to sampleRate
+ * @return false with error set if the file cannot be read or has another
+ * format
+ */
+bool loadWav(const std::string &path, int sampleRate, Clip *clip, std::string *error);
+
+}  // namespace audio_mixer
+
+#endif // AUDIO_MIXER_CLIP_H
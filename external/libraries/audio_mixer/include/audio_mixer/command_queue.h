@@ -0,0 +1,71 @@
+#ifndef AUDIO_MIXER_COMMAND_QUEUE_H
+#define AUDIO_MIXER_COMMAND_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace audio_mixer {
+
+/**
+ * @brief Lock-free queue between one producing and one consuming thread
+ *
+ * Neither side blocks or allocates after construction, so the audio thread
+ * can consume without risking a priority inversion with the control thread.
+ */
+template<typename T>
+class CommandQueue {
+public:
+    /**
+     * @param capacity entries, rounded up to a power of two
+     */
+    explicit CommandQueue(size_t capacity) : head(0), tail(0) {
+        size_t size = 1;
+        while(size < capacity) {
+            size *= 2;
+        }
+        entries.reset(new T[size]);
+        mask = size - 1;
+    }
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    /**
+     * @brief push appends an entry, producer only
+     * @return false if the queue is full
+     */
+    bool push(const T &entry) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if(t - head.load(std::memory_order_acquire) > mask) {
+            return false;
+        }
+        entries[t & mask] = entry;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief pop takes the oldest entry, consumer only
+     * @return false if the queue is empty
+     */
+    bool pop(T *entry) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if(h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *entry = entries[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::unique_ptr<T[]> entries;
+    size_t mask;
+    std::atomic<size_t> head; //!< next entry to pop
+    std::atomic<size_t> tail; //!< next entry to push
+};
+
+}  // namespace audio_mixer
+
+#endif // AUDIO_MIXER_COMMAND_QUEUE_H
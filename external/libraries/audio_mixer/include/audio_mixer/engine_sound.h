@@ -0,0 +1,70 @@
+#ifndef AUDIO_MIXER_ENGINE_SOUND_H
+#define AUDIO_MIXER_ENGINE_SOUND_H
+
+#include <vector>
+
+#include "audio_mixer/mixer.h"
+
+namespace audio_mixer {
+
+struct EngineOptions {
+    EngineOptions() : crossfade(0.1f), minPitch(0.85f), maxPitch(1.15f), ramp(0.05f),
+        volume(1) {
+    }
+
+    /**
+     * @brief Upper speed of each layer as part of the maximum speed,
+     * ascending, e.g. 0.3, 0.6, 1 for low, medium and high RPM
+     */
+    std::vector<float> thresholds;
+    float crossfade; //!< width of the fade between two layers, part of the maximum speed
+    float minPitch; //!< pitch at the lower speed of a layer
+    float maxPitch; //!< pitch at the upper speed of a layer
+    float ramp; //!< time gain and pitch take to follow a speed change [s]
+    float volume;
+};
+
+/**
+ * @brief Engine sound from looped RPM layers, driven by the speed
+ *
+ * All layers loop from start() on, silent ones with gain 0, so changing the
+ * layer never restarts a clip. Around a threshold the neighbouring layers
+ * crossfade with equal power, within a layer the pitch rises with the speed.
+ */
+class EngineSound {
+public:
+    /**
+     * @param clips clip of each layer in the mixer, one per threshold
+     * @param firstVoice layers use the voices from here on
+     */
+    EngineSound(Mixer &mixer, const std::vector<int> &clips, const EngineOptions &options,
+                unsigned int firstVoice = 0);
+
+    void start();
+    void stop();
+
+    /**
+     * @brief update sends new targets if they changed noticeably, call it
+     * from one control thread
+     * @param speed part of the maximum speed, the sign is ignored
+     */
+    void update(float speed);
+
+    /**
+     * @brief targets gain and pitch of every layer at a speed
+     */
+    void targets(float speed, std::vector<float> *gains, std::vector<float> *pitches) const;
+
+private:
+    Mixer &mixer;
+    std::vector<int> clips;
+    EngineOptions options;
+    unsigned int firstVoice;
+
+    std::vector<float> gains, pitches; //!< last sent
+    std::vector<float> nextGains, nextPitches; //!< reused by update()
+};
+
+}  // namespace audio_mixer
+
+#endif // AUDIO_MIXER_ENGINE_SOUND_H
@@ -0,0 +1,122 @@
+#ifndef AUDIO_MIXER_MIXER_H
+#define AUDIO_MIXER_MIXER_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "audio_mixer/clip.h"
+#include "audio_mixer/command_queue.h"
+
+namespace audio_mixer {
+
+/**
+ * @brief Mixes preloaded clips on voices with smooth gain and pitch changes
+ *
+ * Clips are added before the audio starts. Control threads change the
+ * voices through commands, the audio thread applies them at the start of
+ * its next render() call. Gain and pitch move linearly to their target over
+ * the requested time, per frame, so a change never clicks. A voice plays
+ * its clip with variable speed, linearly interpolated, which shifts the
+ * pitch.
+ *
+ * render() neither locks nor allocates.
+ */
+class Mixer {
+public:
+    /**
+     * @param maxFrames largest block render() is called with
+     */
+    Mixer(int sampleRate, unsigned int voices = 8, size_t maxFrames = 4096);
+
+    Mixer(const Mixer&) = delete;
+    Mixer& operator=(const Mixer&) = delete;
+
+    /**
+     * @brief addClip adds a clip, only before the audio thread started
+     * @return clip index
+     */
+    int addClip(Clip clip);
+
+    int sampleRate() const {
+        return rate;
+    }
+
+    unsigned int voices() const {
+        return static_cast<unsigned int>(voiceStates.size());
+    }
+
+    /**
+     * Commands of one control thread, false if the queue is full or an
+     * index is invalid
+     * @{
+     */
+    bool play(unsigned int voice, int clip, bool loop, float gain = 1, float pitch = 1);
+    bool stop(unsigned int voice, float fadeSeconds = 0.01f);
+    bool setGain(unsigned int voice, float gain, float seconds);
+    bool setPitch(unsigned int voice, float pitch, float seconds);
+    /** @} */
+
+    /**
+     * @brief render mixes the next frames, audio thread only
+     * @param out frames stereo 16 bit frames, left first
+     * @param frames at most maxFrames
+     */
+    void render(int16_t *out, size_t frames);
+
+    /**
+     * @brief clipped samples that exceeded full scale since the start
+     */
+    uint64_t clipped() const {
+        return clippedCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Command {
+        enum Type : uint8_t {
+            PLAY, STOP, GAIN, PITCH
+        } type;
+        uint8_t voice;
+        bool loop;
+        int clip;
+        float value;
+        float pitch; //!< PLAY
+        float seconds; //!< ramp
+    };
+
+    /**
+     * @brief A value moving linearly to its target
+     */
+    struct Ramp {
+        float value;
+        float target;
+        float step; //!< per frame
+        uint32_t frames; //!< until the target is reached
+
+        void set(float target, float seconds, int rate);
+        void advance();
+    };
+
+    struct Voice {
+        const Clip *clip; //!< nullptr when silent
+        bool loop;
+        bool stopping; //!< stops when the gain reached 0
+        double position; //!< in frames of the clip
+        Ramp gain;
+        Ramp pitch;
+    };
+
+    bool send(const Command &command);
+    void apply(const Command &command);
+
+    int rate;
+    std::vector<Clip> clips;
+    std::vector<Voice> voiceStates;
+    std::vector<float> mix; //!< maxFrames * 2, preallocated
+    CommandQueue<Command> commands;
+    std::atomic<uint64_t> clippedCount;
+};
+
+}  // namespace audio_mixer
+
+#endif // AUDIO_MIXER_MIXER_H
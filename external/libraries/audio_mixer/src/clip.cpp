@@ -0,0 +1,90 @@
+#include "audio_mixer/clip.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace audio_mixer {
+
+namespace {
+
+uint32_t read32(const uint8_t *data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+uint16_t read16(const uint8_t *data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+}  // namespace
+
+bool loadWav(const std::string &path, int sampleRate, Clip *clip, std::string *error) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if(! file) {
+        *error = "Could not open " + path;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if(data.size() < 12 || std::memcmp(data.data(), "RIFF", 4) != 0
+            || std::memcmp(data.data() + 8, "WAVE", 4) != 0) {
+        *error = path + " is no WAV file";
+        return false;
+    }
+
+    uint16_t format = 0;
+    uint16_t channels = 0;
+    uint32_t rate = 0;
+    uint16_t bits = 0;
+    const uint8_t *pcm = nullptr;
+    size_t pcmBytes = 0;
+    for(size_t offset = 12; offset + 8 <= data.size();) {
+        uint32_t size = read32(&data[offset + 4]);
+        const uint8_t *body = &data[offset + 8];
+        size_t available = data.size() - offset - 8;
+        if(std::memcmp(&data[offset], "fmt ", 4) == 0 && size >= 16 && available >= 16) {
+            format = read16(body);
+            channels = read16(body + 2);
+            rate = read32(body + 4);
+            bits = read16(body + 14);
+        } else if(std::memcmp(&data[offset], "data", 4) == 0) {
+            pcm = body;
+            pcmBytes = std::min<size_t>(size, available);
+        }
+        // chunks are padded to an even size
+        offset += 8 + static_cast<size_t>(size) + (size & 1);
+    }
+    if(format != 1 || (channels != 1 && channels != 2) || (bits != 8 && bits != 16)
+            || rate == 0 || pcm == nullptr) {
+        *error = path + ": only 8 or 16 bit PCM with 1 or 2 channels";
+        return false;
+    }
+
+    size_t bytesPerFrame = channels * bits / 8;
+    size_t frames = pcmBytes / bytesPerFrame;
+    auto sample = [&](size_t frame, int channel) {
+        const uint8_t *p = pcm + frame * bytesPerFrame + (channels == 2 ? channel : 0) * bits / 8;
+        return bits == 8 ? (p[0] - 128) / 128.0f : static_cast<int16_t>(read16(p)) / 32768.0f;
+    };
+
+    // linear resampling, once at load time
+    double ratio = static_cast<double>(rate) / sampleRate;
+    size_t outFrames = frames == 0 ? 0 : static_cast<size_t>((frames - 1) / ratio) + 1;
+    clip->name = path;
+    clip->samples.resize(outFrames * 2);
+    for(size_t i = 0; i < outFrames; i++) {
+        double position = i * ratio;
+        size_t index = static_cast<size_t>(position);
+        size_t next = std::min(index + 1, frames - 1);
+        float fraction = static_cast<float>(position - index);
+        for(int c = 0; c < 2; c++) {
+            float a = sample(index, c);
+            float b = sample(next, c);
+            clip->samples[i * 2 + c] = a + (b - a) * fraction;
+        }
+    }
+    return true;
+}
+
+}  // namespace audio_mixer
@@ -0,0 +1,89 @@
+#include "audio_mixer/engine_sound.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_mixer {
+
+namespace {
+
+/**
+ * @brief Target changes below this are not sent, the ramps smooth them anyway
+ */
+const float EPSILON = 0.005f;
+
+const float HALF_PI = 1.5707963f;
+
+float clamp(float value, float low, float high) {
+    return std::max(low, std::min(value, high));
+}
+
+}  // namespace
+
+EngineSound::EngineSound(Mixer &mixer, const std::vector<int> &clips, const EngineOptions &options,
+                         unsigned int firstVoice)
+    : mixer(mixer), clips(clips), options(options), firstVoice(firstVoice) {
+    this->options.thresholds.resize(clips.size(), 1);
+    this->options.crossfade = std::max(1e-3f, options.crossfade);
+}
+
+void EngineSound::start() {
+    targets(0, &gains, &pitches);
+    for(size_t i = 0; i < clips.size(); i++) {
+        mixer.play(firstVoice + i, clips[i], true, gains[i], pitches[i]);
+    }
+}
+
+void EngineSound::stop() {
+    for(size_t i = 0; i < clips.size(); i++) {
+        mixer.stop(firstVoice + i, options.ramp);
+    }
+}
+
+void EngineSound::update(float speed) {
+    targets(speed, &nextGains, &nextPitches);
+    for(size_t i = 0; i < clips.size(); i++) {
+        // a full queue leaves the old value, the next update retries
+        if(std::fabs(nextGains[i] - gains[i]) > EPSILON
+                && mixer.setGain(firstVoice + i, nextGains[i], options.ramp)) {
+            gains[i] = nextGains[i];
+        }
+        if(std::fabs(nextPitches[i] - pitches[i]) > EPSILON
+                && mixer.setPitch(firstVoice + i, nextPitches[i], options.ramp)) {
+            pitches[i] = nextPitches[i];
+        }
+    }
+}
+
+void EngineSound::targets(float speed, std::vector<float> *gains,
+                          std::vector<float> *pitches) const {
+    const std::vector<float> &thresholds = options.thresholds;
+    const float half = options.crossfade / 2;
+    speed = clamp(std::fabs(speed), 0, 1);
+    gains->assign(clips.size(), 0);
+    pitches->assign(clips.size(), options.minPitch);
+
+    for(size_t i = 0; i < clips.size(); i++) {
+        float low = i == 0 ? 0 : thresholds[i - 1];
+        float high = thresholds[i];
+        bool first = i == 0;
+        bool last = i + 1 == clips.size();
+
+        float gain;
+        if((first || speed >= low + half) && (last || speed <= high - half)) {
+            gain = 1;
+        } else if(! last && speed > high - half && speed < high + half) {
+            gain = std::cos((speed - (high - half)) / options.crossfade * HALF_PI);
+        } else if(! first && speed > low - half && speed < low + half) {
+            gain = std::sin((speed - (low - half)) / options.crossfade * HALF_PI);
+        } else {
+            gain = 0;
+        }
+        (*gains)[i] = gain * options.volume;
+
+        float t = high > low ? clamp((speed - low) / (high - low), 0, 1) : 0;
+        (*pitches)[i] = options.minPitch + (options.maxPitch - options.minPitch) * t;
+    }
+}
+
+}  // namespace audio_mixer
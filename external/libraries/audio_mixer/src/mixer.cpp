@@ -0,0 +1,148 @@
+#include "audio_mixer/mixer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_mixer {
+
+void Mixer::Ramp::set(float target, float seconds, int rate) {
+    this->target = target;
+    frames = static_cast<uint32_t>(std::max(0.0f, seconds) * rate);
+    if(frames == 0) {
+        value = target;
+        step = 0;
+    } else {
+        step = (target - value) / frames;
+    }
+}
+
+void Mixer::Ramp::advance() {
+    if(frames > 0) {
+        value += step;
+        if(--frames == 0) {
+            value = target;
+        }
+    }
+}
+
+Mixer::Mixer(int sampleRate, unsigned int voices, size_t maxFrames)
+    : rate(sampleRate), voiceStates(voices), mix(maxFrames * 2), commands(256), clippedCount(0) {
+    for(Voice &voice : voiceStates) {
+        voice.clip = nullptr;
+        voice.loop = false;
+        voice.stopping = false;
+        voice.position = 0;
+        voice.gain = Ramp{0, 0, 0, 0};
+        voice.pitch = Ramp{1, 1, 0, 0};
+    }
+}
+
+int Mixer::addClip(Clip clip) {
+    clips.push_back(std::move(clip));
+    return static_cast<int>(clips.size() - 1);
+}
+
+bool Mixer::play(unsigned int voice, int clip, bool loop, float gain, float pitch) {
+    if(clip < 0 || clip >= static_cast<int>(clips.size()) || clips[clip].frames() < 2) {
+        return false;
+    }
+    return send(Command{Command::PLAY, static_cast<uint8_t>(voice), loop, clip, gain, pitch, 0});
+}
+
+bool Mixer::stop(unsigned int voice, float fadeSeconds) {
+    return send(Command{Command::STOP, static_cast<uint8_t>(voice), false, 0, 0, 0, fadeSeconds});
+}
+
+bool Mixer::setGain(unsigned int voice, float gain, float seconds) {
+    return send(Command{Command::GAIN, static_cast<uint8_t>(voice), false, 0, gain, 0, seconds});
+}
+
+bool Mixer::setPitch(unsigned int voice, float pitch, float seconds) {
+    return send(Command{Command::PITCH, static_cast<uint8_t>(voice), false, 0, pitch, 0, seconds});
+}
+
+bool Mixer::send(const Command &command) {
+    if(command.voice >= voiceStates.size()) {
+        return false;
+    }
+    return commands.push(command);
+}
+
+void Mixer::apply(const Command &command) {
+    Voice &voice = voiceStates[command.voice];
+    switch(command.type) {
+    case Command::PLAY:
+        voice.clip = &clips[command.clip];
+        voice.loop = command.loop;
+        voice.stopping = false;
+        voice.position = 0;
+        voice.gain.set(command.value, 0, rate);
+        voice.pitch.set(command.pitch, 0, rate);
+        break;
+    case Command::STOP:
+        voice.stopping = true;
+        voice.gain.set(0, command.seconds, rate);
+        break;
+    case Command::GAIN:
+        voice.gain.set(command.value, command.seconds, rate);
+        break;
+    case Command::PITCH:
+        voice.pitch.set(std::max(0.01f, command.value), command.seconds, rate);
+        break;
+    }
+}
+
+void Mixer::render(int16_t *out, size_t frames) {
+    frames = std::min(frames, mix.size() / 2);
+    Command command;
+    while(commands.pop(&command)) {
+        apply(command);
+    }
+
+    std::fill(mix.begin(), mix.begin() + frames * 2, 0.0f);
+    for(Voice &voice : voiceStates) {
+        if(voice.clip == nullptr) {
+            continue;
+        }
+        const float *samples = voice.clip->samples.data();
+        // the last frame is only read for interpolation
+        const double end = static_cast<double>(voice.clip->frames() - 1);
+        for(size_t i = 0; i < frames; i++) {
+            size_t index = static_cast<size_t>(voice.position);
+            float fraction = static_cast<float>(voice.position - index);
+            const float *a = samples + index * 2;
+            float gain = voice.gain.value;
+            mix[i * 2] += gain * (a[0] + (a[2] - a[0]) * fraction);
+            mix[i * 2 + 1] += gain * (a[1] + (a[3] - a[1]) * fraction);
+
+            voice.gain.advance();
+            voice.position += voice.pitch.value;
+            voice.pitch.advance();
+            if(voice.position >= end) {
+                if(! voice.loop) {
+                    voice.clip = nullptr;
+                    break;
+                }
+                voice.position = std::fmod(voice.position - end, end);
+            }
+        }
+        if(voice.stopping && voice.gain.frames == 0) {
+            voice.clip = nullptr;
+        }
+    }
+
+    uint64_t clippedSamples = 0;
+    for(size_t i = 0; i < frames * 2; i++) {
+        float value = mix[i] * 32767.0f;
+        if(std::fabs(value) > 32767.0f) {
+            clippedSamples++;
+            value = value > 0 ? 32767.0f : -32767.0f;
+        }
+        out[i] = static_cast<int16_t>(value);
+    }
+    if(clippedSamples > 0) {
+        clippedCount.fetch_add(clippedSamples, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace audio_mixer
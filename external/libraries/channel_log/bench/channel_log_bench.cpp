@@ -0,0 +1,176 @@
+/**
+ * Records the channels of car.xml at an accelerated rate, reports the time
+ * append() takes in the recording cycle and the write throughput, replays
+ * the log and checks every record. Finally a copy cut in the middle of a
+ * chunk, as left by a crash, must still read up to its last complete chunk.
+ *
+ * Usage: channel_log_bench [--path FILE] [--cycles N] [--chunk BYTES]
+ *
+ * --path    log file, default /tmp/channel_log_bench.clog
+ * --cycles  recorded cycles, default 20000 (200 s at 100 Hz)
+ * --chunk   chunk size, default 4 MiB
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "channel_log/reader.h"
+#include "channel_log/writer.h"
+
+using namespace channel_log;
+
+namespace {
+
+struct Channel {
+    const char *name;
+    uint32_t size; //!< serialized bytes per cycle
+};
+
+/**
+ * @brief Rough serialized sizes of the car.xml channels
+ */
+const Channel CHANNELS[] = {
+    {"CAR", 64}, {"CONTROL_DATA", 96}, {"SENSOR_DATA", 256}, {"IMAGE", 188 * 87 + 16}
+};
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Content derived from channel and cycle, checked after replay
+ */
+void fill(std::vector<uint8_t> &data, int channel, int cycle) {
+    uint32_t state = channel * 2654435761u ^ cycle;
+    for(uint8_t &byte : data) {
+        state = state * 1664525u + 1013904223u;
+        byte = static_cast<uint8_t>(state >> 24);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    std::string path = "/tmp/channel_log_bench.clog";
+    int cycles = 20000;
+    WriterOptions options;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if(arg == "--path") {
+            path = argv[i + 1];
+        } else if(arg == "--cycles") {
+            cycles = std::atoi(argv[i + 1]);
+        } else if(arg == "--chunk") {
+            options.chunkSize = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    const int channelCount = sizeof(CHANNELS) / sizeof(CHANNELS[0]);
+
+    // payloads are prepared up front, the timing is append() alone
+    std::vector<std::vector<std::vector<uint8_t>>> payloads(16);
+    for(size_t k = 0; k < payloads.size(); k++) {
+        for(int c = 0; c < channelCount; c++) {
+            payloads[k].push_back(std::vector<uint8_t>(CHANNELS[c].size));
+            fill(payloads[k][c], c, static_cast<int>(k));
+        }
+    }
+
+    Writer writer;
+    std::string error;
+    if(! writer.open(path, options, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::vector<uint16_t> ids;
+    for(const Channel &channel : CHANNELS) {
+        ids.push_back(writer.channel(channel.name));
+    }
+
+    std::vector<int64_t> cycleTimes;
+    uint64_t bytes = 0;
+    int64_t start = nowNanos();
+    int64_t recordStart = start;
+    for(int cycle = 0; cycle < cycles; cycle++) {
+        int64_t cycleStart = nowNanos();
+        int64_t timestamp = 1000000 + cycle * 10000LL;
+        for(int c = 0; c < channelCount; c++) {
+            const std::vector<uint8_t> &data = payloads[cycle % payloads.size()][c];
+            writer.append(ids[c], timestamp, data.data(), data.size());
+            bytes += data.size();
+        }
+        cycleTimes.push_back(nowNanos() - cycleStart);
+    }
+    int64_t appendDone = nowNanos();
+    writer.close();
+    int64_t closed = nowNanos();
+
+    std::sort(cycleTimes.begin(), cycleTimes.end());
+    std::printf("record: %d cycles, %.1f MB offered at %.0f MB/s, append per cycle p50 %.1f "
+                "p99 %.1f max %.1f us, %llu records dropped\n", cycles, bytes / 1e6,
+                bytes / ((appendDone - start) / 1e3), cycleTimes[cycleTimes.size() / 2] / 1000.0,
+                cycleTimes[cycleTimes.size() * 99 / 100] / 1000.0, cycleTimes.back() / 1000.0,
+                static_cast<unsigned long long>(writer.dropped()));
+
+    Reader reader;
+    if(! reader.open(path, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    start = nowNanos();
+    Record record;
+    uint64_t records = 0;
+    uint64_t mismatches = 0;
+    uint64_t readBytes = 0;
+    std::vector<int> nextCycle(channelCount, 0);
+    while(reader.next(&record)) {
+        // dropped records leave gaps, the content must match its cycle
+        int c = record.channel;
+        int cycle = static_cast<int>((record.timestamp - 1000000) / 10000);
+        const std::vector<uint8_t> &expected = payloads[cycle % payloads.size()][c];
+        if(record.size != expected.size()
+                || ! std::equal(expected.begin(), expected.end(), record.data) || cycle < nextCycle[c]) {
+            mismatches++;
+        }
+        nextCycle[c] = cycle + 1;
+        readBytes += record.size;
+        records++;
+    }
+    int64_t readTime = nowNanos() - start;
+    std::printf("written: %.1f MB at %.0f MB/s until close\n", readBytes / 1e6,
+                readBytes / ((closed - recordStart) / 1e3));
+    std::printf("replay: %llu records, %.0f MB/s, %.1f M records/s, %llu mismatches, indexed %s\n",
+                static_cast<unsigned long long>(records), readBytes / (readTime / 1e3),
+                records / (readTime / 1e3), static_cast<unsigned long long>(mismatches),
+                reader.indexed() ? "yes" : "no");
+    size_t chunks = reader.chunkCount();
+    reader.close();
+
+    // a recorder that died leaves no index and maybe half a chunk
+    std::ifstream in(path.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::string cutPath = path + ".cut";
+    std::ofstream(cutPath.c_str(), std::ios::binary).write(content.data(), content.size() * 2 / 3);
+    if(! reader.open(cutPath, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    uint64_t recovered = 0;
+    while(reader.next(&record)) {
+        recovered++;
+    }
+    std::printf("cut at 2/3: %zu of %zu chunks, %llu records recovered, indexed %s\n",
+                reader.chunkCount(), chunks, static_cast<unsigned long long>(recovered),
+                reader.indexed() ? "yes" : "no");
+    reader.close();
+    std::remove(cutPath.c_str());
+    return mismatches == 0 && records == writer.records() && recovered > 0 ? 0 : 1;
+}
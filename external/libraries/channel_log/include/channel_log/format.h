@@ -0,0 +1,81 @@
+#ifndef CHANNEL_LOG_FORMAT_H
+#define CHANNEL_LOG_FORMAT_H
+
+#include <cstdint>
+
+namespace channel_log {
+
+/*
+ * Layout of a channel log, all numbers little endian:
+ *
+ *   FileHeader
+ *   chunks: ChunkHeader, records of ChunkHeader::bytes
+ *     record: RecordHeader, payload padded to 8 bytes
+ *   footer (missing if the recorder did not close the log):
+ *     "CIDX", channel count, per channel: id (u16), name length (u16), name
+ *     chunk count, per chunk: ChunkEntry
+ *   Trailer
+ *
+ * Channel names are defined by records of DEFINITION_CHANNEL before the
+ * first record of the channel, so a log without footer can be read by
+ * scanning the chunks.
+ */
+
+const char FILE_MAGIC[4] = {'C', 'L', 'O', 'G'};
+const char CHUNK_MAGIC[4] = {'C', 'H', 'N', 'K'};
+const char INDEX_MAGIC[4] = {'C', 'I', 'D', 'X'};
+const char END_MAGIC[4] = {'C', 'E', 'N', 'D'};
+const uint32_t VERSION = 1;
+
+/**
+ * @brief Channel id of the records that name a channel, payload: u16 id,
+ * name bytes
+ */
+const uint16_t DEFINITION_CHANNEL = 0xFFFF;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    int64_t created; //!< wall clock [us since epoch]
+};
+
+struct ChunkHeader {
+    char magic[4];
+    uint32_t bytes; //!< records after this header
+    uint32_t records;
+    uint32_t reserved;
+    int64_t first; //!< timestamp of the first record [us]
+    int64_t last; //!< timestamp of the last record [us]
+};
+
+struct RecordHeader {
+    int64_t timestamp; //!< [us]
+    uint16_t channel;
+    uint16_t reserved;
+    uint32_t size; //!< payload bytes without padding
+};
+
+struct ChunkEntry {
+    uint64_t offset; //!< of the ChunkHeader in the file
+    int64_t first;
+    int64_t last;
+    uint32_t records;
+    uint32_t reserved;
+};
+
+struct Trailer {
+    uint64_t footer; //!< offset of "CIDX"
+    char magic[4];
+    uint32_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 16 && sizeof(ChunkHeader) == 32 && sizeof(RecordHeader) == 16
+              && sizeof(ChunkEntry) == 32 && sizeof(Trailer) == 16, "the structs are the file layout");
+
+inline uint32_t padded(uint32_t size) {
+    return (size + 7) & ~7u;
+}
+
+}  // namespace channel_log
+
+#endif // CHANNEL_LOG_FORMAT_H
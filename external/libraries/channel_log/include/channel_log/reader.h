@@ -0,0 +1,103 @@
+#ifndef CHANNEL_LOG_READER_H
+#define CHANNEL_LOG_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "channel_log/format.h"
+
+namespace channel_log {
+
+struct Record {
+    int64_t timestamp; //!< [us]
+    uint16_t channel;
+    const uint8_t *data; //!< in the mapped file, valid until close()
+    uint32_t size;
+};
+
+/**
+ * @brief Reads a channel log mapped into memory, records are not copied
+ *
+ * Uses the index of a closed log. A log whose recorder died is scanned
+ * chunk by chunk instead, up to the last complete chunk.
+ */
+class Reader {
+public:
+    Reader();
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    bool open(const std::string &path, std::string *error);
+    void close();
+
+    /**
+     * @brief channels names by channel id
+     */
+    const std::vector<std::string>& channels() const {
+        return channelNames;
+    }
+
+    /**
+     * @return channel id, -1 if the log has no such channel
+     */
+    int channel(const std::string &name) const;
+
+    /**
+     * @brief next record in the order they were written
+     * @return false at the end of the log
+     */
+    bool next(Record *record);
+
+    /**
+     * @brief peek like next() without advancing
+     */
+    bool peek(Record *record);
+
+    void rewind();
+
+    /**
+     * @brief seek to the first chunk that has records at or after timestamp
+     */
+    void seek(int64_t timestamp);
+
+    int64_t begin() const; //!< timestamp of the first record [us]
+    int64_t end() const; //!< timestamp of the last record [us]
+
+    size_t chunkCount() const {
+        return chunks.size();
+    }
+
+    /**
+     * @brief indexed false if the log was not closed and had to be scanned
+     */
+    bool indexed() const {
+        return hasIndex;
+    }
+
+    int64_t created() const {
+        return createdAt;
+    }
+
+private:
+    bool readIndex();
+    void scan();
+    void define(const uint8_t *payload, uint32_t size);
+
+    const uint8_t *memory;
+    size_t size;
+    std::vector<std::string> channelNames;
+    std::vector<ChunkEntry> chunks;
+    bool hasIndex;
+    int64_t createdAt;
+
+    size_t chunk; //!< cursor: chunk index
+    size_t position; //!< cursor: offset in the file, 0 at the start of a chunk
+};
+
+}  // namespace channel_log
+
+#endif // CHANNEL_LOG_READER_H
@@ -0,0 +1,57 @@
+#ifndef CHANNEL_LOG_STREAM_BUFFERS_H
+#define CHANNEL_LOG_STREAM_BUFFERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <streambuf>
+#include <vector>
+
+namespace channel_log {
+
+/**
+ * @brief Output std::streambuf appending to a vector that is kept across
+ * records, the LMS channel serialization writes into it without allocating
+ * once it reached the largest record
+ */
+class VectorBuffer : public std::streambuf {
+public:
+    void clear() {
+        bytes.clear();
+    }
+
+    const std::vector<uint8_t>& data() const {
+        return bytes;
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if(c != traits_type::eof()) {
+            bytes.push_back(static_cast<uint8_t>(c));
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+        bytes.insert(bytes.end(), s, s + n);
+        return n;
+    }
+
+private:
+    std::vector<uint8_t> bytes;
+};
+
+/**
+ * @brief Input std::streambuf over a record in the mapped log
+ */
+class MemoryBuffer : public std::streambuf {
+public:
+    MemoryBuffer(const uint8_t *data, size_t size) {
+        // only read, the get area needs non-const pointers
+        char *begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+        setg(begin, begin, begin + size);
+    }
+};
+
+}  // namespace channel_log
+
+#endif // CHANNEL_LOG_STREAM_BUFFERS_H
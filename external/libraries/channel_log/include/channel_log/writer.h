@@ -0,0 +1,113 @@
+#ifndef CHANNEL_LOG_WRITER_H
+#define CHANNEL_LOG_WRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "channel_log/format.h"
+
+namespace channel_log {
+
+struct WriterOptions {
+    WriterOptions() : chunkSize(4 << 20), buffers(8) {
+    }
+
+    uint32_t chunkSize; //!< bytes per chunk, the largest record must fit
+    unsigned int buffers; //!< chunks in memory, all allocated by open()
+};
+
+/**
+ * @brief Appends records to a channel log
+ *
+ * append() copies the record into the current chunk buffer. Full chunks are
+ * written by a background thread, so a slow disk never blocks the caller.
+ * If all buffers are waiting for the disk, records are dropped and counted.
+ */
+class Writer {
+public:
+    Writer();
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    bool open(const std::string &path, const WriterOptions &options, std::string *error);
+
+    /**
+     * @brief close writes the last chunk and the index
+     */
+    bool close();
+
+    bool isOpen() const {
+        return fd >= 0;
+    }
+
+    /**
+     * @brief channel id for a name, defines the channel on first use
+     */
+    uint16_t channel(const std::string &name);
+
+    /**
+     * @return false if the record was dropped: too large for a chunk or no
+     * free buffer
+     */
+    bool append(uint16_t channel, int64_t timestamp, const void *data, uint32_t size);
+
+    uint64_t records() const {
+        return recordCount;
+    }
+
+    uint64_t dropped() const {
+        return droppedCount;
+    }
+
+    /**
+     * @brief failed true once a write to the disk failed, the log ends there
+     */
+    bool failed() const {
+        return writeFailed.load();
+    }
+
+private:
+    struct Buffer {
+        std::unique_ptr<uint8_t[]> data;
+        uint32_t used; //!< bytes after the ChunkHeader
+        bool timed; //!< has a channel record, header.first is set
+        ChunkHeader header;
+    };
+
+    bool put(uint16_t channel, int64_t timestamp, const void *data, uint32_t size);
+    bool takeBuffer();
+    void submit();
+    void writerLoop();
+    bool writeAll(const void *data, size_t size);
+
+    int fd;
+    uint32_t chunkSize;
+    std::vector<Buffer> buffers;
+    Buffer *current;
+    std::vector<std::string> channels;
+    std::vector<ChunkEntry> chunks; //!< written so far, used by the writer thread
+    uint64_t offset; //!< file offset of the next chunk
+    uint64_t recordCount;
+    uint64_t droppedCount;
+    std::atomic<bool> writeFailed;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Buffer*> freeBuffers;
+    std::deque<Buffer*> fullBuffers;
+    bool stopping;
+    std::thread thread;
+};
+
+}  // namespace channel_log
+
+#endif // CHANNEL_LOG_WRITER_H
@@ -0,0 +1,260 @@
+#include "channel_log/reader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace channel_log {
+
+namespace {
+
+template<typename T>
+bool load(const uint8_t *memory, size_t size, size_t offset, T *value) {
+    if(offset > size || size - offset < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(value, memory + offset, sizeof(T));
+    return true;
+}
+
+}  // namespace
+
+Reader::Reader() : memory(nullptr), size(0), hasIndex(false), createdAt(0), chunk(0), position(0) {
+}
+
+Reader::~Reader() {
+    close();
+}
+
+bool Reader::open(const std::string &path, std::string *error) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        *error = "open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(FileHeader)) {
+        *error = path + " is no channel log";
+        ::close(fd);
+        return false;
+    }
+    size = static_cast<size_t>(info.st_size);
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED) {
+        *error = "mmap " + path + ": " + std::strerror(errno);
+        size = 0;
+        return false;
+    }
+    memory = static_cast<const uint8_t*>(mapped);
+    // replay reads front to back
+    madvise(mapped, size, MADV_SEQUENTIAL);
+
+    FileHeader header;
+    load(memory, size, 0, &header);
+    if(std::memcmp(header.magic, FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION) {
+        *error = path + " is no channel log of version " + std::to_string(VERSION);
+        close();
+        return false;
+    }
+    createdAt = header.created;
+
+    hasIndex = readIndex();
+    if(! hasIndex) {
+        scan();
+    }
+    rewind();
+    return true;
+}
+
+void Reader::close() {
+    if(memory != nullptr) {
+        munmap(const_cast<uint8_t*>(memory), size);
+    }
+    memory = nullptr;
+    size = 0;
+    channelNames.clear();
+    chunks.clear();
+}
+
+bool Reader::readIndex() {
+    Trailer trailer;
+    if(size < sizeof(FileHeader) + sizeof(Trailer)
+            || ! load(memory, size, size - sizeof(Trailer), &trailer)
+            || std::memcmp(trailer.magic, END_MAGIC, sizeof(trailer.magic)) != 0
+            || trailer.footer + sizeof(INDEX_MAGIC) > size - sizeof(Trailer)
+            || std::memcmp(memory + trailer.footer, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        return false;
+    }
+
+    size_t offset = trailer.footer + sizeof(INDEX_MAGIC);
+    uint32_t count;
+    if(! load(memory, size, offset, &count)) {
+        return false;
+    }
+    offset += sizeof(count);
+    std::vector<std::string> names;
+    for(uint32_t i = 0; i < count; i++) {
+        uint16_t id, length;
+        if(! load(memory, size, offset, &id) || ! load(memory, size, offset + 2, &length)
+                || offset + 4 + length > size) {
+            return false;
+        }
+        if(id >= names.size()) {
+            names.resize(id + 1);
+        }
+        names[id].assign(reinterpret_cast<const char*>(memory + offset + 4), length);
+        offset += 4 + length;
+    }
+
+    if(! load(memory, size, offset, &count) || (size - offset - 4) / sizeof(ChunkEntry) < count) {
+        return false;
+    }
+    offset += sizeof(count);
+    std::vector<ChunkEntry> entries(count);
+    std::memcpy(entries.data(), memory + offset, count * sizeof(ChunkEntry));
+    for(const ChunkEntry &entry : entries) {
+        ChunkHeader header;
+        if(! load(memory, size, entry.offset, &header) || header.bytes > size - entry.offset - sizeof(header)) {
+            return false;
+        }
+    }
+
+    channelNames.swap(names);
+    chunks.swap(entries);
+    return true;
+}
+
+void Reader::scan() {
+    size_t offset = sizeof(FileHeader);
+    ChunkHeader header;
+    while(load(memory, size, offset, &header)
+          && std::memcmp(header.magic, CHUNK_MAGIC, sizeof(header.magic)) == 0
+          && header.bytes <= size - offset - sizeof(header)) {
+        ChunkEntry entry;
+        entry.offset = offset;
+        entry.first = header.first;
+        entry.last = header.last;
+        entry.records = header.records;
+        entry.reserved = 0;
+        chunks.push_back(entry);
+
+        // the names are only in the definition records
+        size_t position = offset + sizeof(header);
+        size_t end = position + header.bytes;
+        RecordHeader record;
+        while(load(memory, end, position, &record)) {
+            size_t payload = position + sizeof(record);
+            if(padded(record.size) > end - payload) {
+                break;
+            }
+            if(record.channel == DEFINITION_CHANNEL) {
+                define(memory + payload, record.size);
+            }
+            position = payload + padded(record.size);
+        }
+        offset = end;
+    }
+}
+
+void Reader::define(const uint8_t *payload, uint32_t length) {
+    uint16_t id;
+    if(length < sizeof(id)) {
+        return;
+    }
+    std::memcpy(&id, payload, sizeof(id));
+    if(id >= channelNames.size()) {
+        channelNames.resize(id + 1);
+    }
+    channelNames[id].assign(reinterpret_cast<const char*>(payload + sizeof(id)), length - sizeof(id));
+}
+
+int Reader::channel(const std::string &name) const {
+    for(size_t i = 0; i < channelNames.size(); i++) {
+        if(channelNames[i] == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool Reader::peek(Record *record) {
+    while(chunk < chunks.size()) {
+        const ChunkEntry &entry = chunks[chunk];
+        ChunkHeader header;
+        load(memory, size, entry.offset, &header);
+        size_t end = entry.offset + sizeof(header) + header.bytes;
+        if(position == 0) {
+            position = entry.offset + sizeof(header);
+        }
+
+        RecordHeader recordHeader;
+        if(! load(memory, end, position, &recordHeader)
+                || padded(recordHeader.size) > end - position - sizeof(recordHeader)) {
+            chunk++;
+            position = 0;
+            continue;
+        }
+        if(recordHeader.channel == DEFINITION_CHANNEL) {
+            position += sizeof(recordHeader) + padded(recordHeader.size);
+            continue;
+        }
+        record->timestamp = recordHeader.timestamp;
+        record->channel = recordHeader.channel;
+        record->data = memory + position + sizeof(recordHeader);
+        record->size = recordHeader.size;
+        return true;
+    }
+    return false;
+}
+
+bool Reader::next(Record *record) {
+    if(! peek(record)) {
+        return false;
+    }
+    position += sizeof(RecordHeader) + padded(record->size);
+    return true;
+}
+
+void Reader::rewind() {
+    chunk = 0;
+    position = 0;
+}
+
+void Reader::seek(int64_t timestamp) {
+    auto found = std::find_if(chunks.begin(), chunks.end(), [timestamp](const ChunkEntry &entry) {
+        return entry.records > 0 && entry.last >= timestamp;
+    });
+    chunk = static_cast<size_t>(found - chunks.begin());
+    position = 0;
+    // to the first record at or after timestamp within the chunk
+    Record record;
+    while(peek(&record) && record.timestamp < timestamp) {
+        next(&record);
+    }
+}
+
+int64_t Reader::begin() const {
+    for(const ChunkEntry &entry : chunks) {
+        if(entry.records > 0 && (entry.first != 0 || entry.last != 0)) {
+            return entry.first;
+        }
+    }
+    return 0;
+}
+
+int64_t Reader::end() const {
+    for(auto it = chunks.rbegin(); it != chunks.rend(); ++it) {
+        if(it->records > 0 && (it->first != 0 || it->last != 0)) {
+            return it->last;
+        }
+    }
+    return 0;
+}
+
+}  // namespace channel_log
@@ -0,0 +1,247 @@
+#include "channel_log/writer.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace channel_log {
+
+Writer::Writer() : fd(-1), chunkSize(0), current(nullptr), offset(0), recordCount(0),
+    droppedCount(0), writeFailed(false), stopping(false) {
+}
+
+Writer::~Writer() {
+    close();
+}
+
+bool Writer::open(const std::string &path, const WriterOptions &options, std::string *error) {
+    close();
+    if(options.buffers < 2 || options.chunkSize < 1024) {
+        *error = "at least 2 buffers of 1024 bytes";
+        return false;
+    }
+
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0) {
+        *error = "open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    FileHeader header;
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.created = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+    writeFailed = false;
+    if(! writeAll(&header, sizeof(header))) {
+        *error = "write " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    offset = sizeof(header);
+
+    chunkSize = options.chunkSize;
+    buffers.clear();
+    buffers.resize(options.buffers);
+    freeBuffers.clear();
+    fullBuffers.clear();
+    for(Buffer &buffer : buffers) {
+        buffer.data.reset(new uint8_t[sizeof(ChunkHeader) + chunkSize]);
+        // touch the pages now instead of while recording
+        std::memset(buffer.data.get(), 0, sizeof(ChunkHeader) + chunkSize);
+        freeBuffers.push_back(&buffer);
+    }
+    current = nullptr;
+    channels.clear();
+    chunks.clear();
+    recordCount = 0;
+    droppedCount = 0;
+    stopping = false;
+    thread = std::thread(&Writer::writerLoop, this);
+    return true;
+}
+
+bool Writer::close() {
+    if(fd < 0) {
+        return false;
+    }
+    if(current != nullptr) {
+        submit();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+
+    // index: the channel names and where each chunk is
+    std::string footer(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    auto put32 = [&footer](uint32_t value) {
+        footer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    put32(static_cast<uint32_t>(channels.size()));
+    for(size_t i = 0; i < channels.size(); i++) {
+        uint16_t id = static_cast<uint16_t>(i);
+        uint16_t length = static_cast<uint16_t>(channels[i].size());
+        footer.append(reinterpret_cast<const char*>(&id), sizeof(id));
+        footer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        footer.append(channels[i], 0, length);
+    }
+    put32(static_cast<uint32_t>(chunks.size()));
+    footer.append(reinterpret_cast<const char*>(chunks.data()), chunks.size() * sizeof(ChunkEntry));
+
+    Trailer trailer;
+    trailer.footer = offset;
+    std::memcpy(trailer.magic, END_MAGIC, sizeof(trailer.magic));
+    trailer.reserved = 0;
+    footer.append(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+
+    bool ok = ! writeFailed && writeAll(footer.data(), footer.size());
+    ::close(fd);
+    fd = -1;
+    return ok;
+}
+
+uint16_t Writer::channel(const std::string &name) {
+    for(size_t i = 0; i < channels.size(); i++) {
+        if(channels[i] == name) {
+            return static_cast<uint16_t>(i);
+        }
+    }
+    uint16_t id = static_cast<uint16_t>(channels.size());
+    channels.push_back(name);
+
+    std::string definition(reinterpret_cast<const char*>(&id), sizeof(id));
+    definition.append(name);
+    put(DEFINITION_CHANNEL, 0, definition.data(), static_cast<uint32_t>(definition.size()));
+    return id;
+}
+
+bool Writer::append(uint16_t channel, int64_t timestamp, const void *data, uint32_t size) {
+    if(fd < 0 || channel >= channels.size()) {
+        return false;
+    }
+    if(! put(channel, timestamp, data, size)) {
+        droppedCount++;
+        return false;
+    }
+    recordCount++;
+    return true;
+}
+
+bool Writer::put(uint16_t channel, int64_t timestamp, const void *data, uint32_t size) {
+    uint32_t needed = sizeof(RecordHeader) + padded(size);
+    if(needed > chunkSize) {
+        return false;
+    }
+    if(current != nullptr && current->used + needed > chunkSize) {
+        submit();
+    }
+    if(current == nullptr && ! takeBuffer()) {
+        return false;
+    }
+
+    uint8_t *out = current->data.get() + sizeof(ChunkHeader) + current->used;
+    RecordHeader header;
+    header.timestamp = timestamp;
+    header.channel = channel;
+    header.reserved = 0;
+    header.size = size;
+    std::memcpy(out, &header, sizeof(header));
+    std::memcpy(out + sizeof(header), data, size);
+    std::memset(out + sizeof(header) + size, 0, padded(size) - size);
+    current->used += needed;
+    current->header.records++;
+
+    if(channel != DEFINITION_CHANNEL) {
+        if(! current->timed) {
+            current->header.first = timestamp;
+            current->timed = true;
+        }
+        current->header.last = timestamp;
+    }
+    return true;
+}
+
+bool Writer::takeBuffer() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(freeBuffers.empty()) {
+        return false;
+    }
+    current = freeBuffers.back();
+    freeBuffers.pop_back();
+    current->used = 0;
+    current->timed = false;
+    std::memcpy(current->header.magic, CHUNK_MAGIC, sizeof(current->header.magic));
+    current->header.bytes = 0;
+    current->header.records = 0;
+    current->header.reserved = 0;
+    current->header.first = 0;
+    current->header.last = 0;
+    return true;
+}
+
+void Writer::submit() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fullBuffers.push_back(current);
+    }
+    current = nullptr;
+    wake.notify_one();
+}
+
+void Writer::writerLoop() {
+    while(true) {
+        Buffer *buffer;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() {
+                return stopping || ! fullBuffers.empty();
+            });
+            if(fullBuffers.empty()) {
+                return;
+            }
+            buffer = fullBuffers.front();
+            fullBuffers.pop_front();
+        }
+
+        buffer->header.bytes = buffer->used;
+        std::memcpy(buffer->data.get(), &buffer->header, sizeof(ChunkHeader));
+        size_t bytes = sizeof(ChunkHeader) + buffer->used;
+        if(! writeFailed && writeAll(buffer->data.get(), bytes)) {
+            ChunkEntry entry;
+            entry.offset = offset;
+            entry.first = buffer->header.first;
+            entry.last = buffer->header.last;
+            entry.records = buffer->header.records;
+            entry.reserved = 0;
+            chunks.push_back(entry);
+            offset += bytes;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        freeBuffers.push_back(buffer);
+    }
+}
+
+bool Writer::writeAll(const void *data, size_t size) {
+    const uint8_t *bytes = static_cast<const uint8_t*>(data);
+    while(size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if(written < 0 && errno == EINTR) {
+            continue;
+        }
+        if(written <= 0) {
+            writeFailed = true;
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+}  // namespace channel_log
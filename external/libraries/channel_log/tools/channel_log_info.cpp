@@ -0,0 +1,49 @@
+/**
+ * Prints the channels, record counts, sizes and duration of channel logs.
+ *
+ * Usage: channel_log_info <log.clog>...
+ */
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "channel_log/reader.h"
+
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        std::fprintf(stderr, "Usage: %s <log.clog>...\n", argv[0]);
+        return 1;
+    }
+
+    int result = 0;
+    for(int i = 1; i < argc; i++) {
+        channel_log::Reader reader;
+        std::string error;
+        if(! reader.open(argv[i], &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            result = 1;
+            continue;
+        }
+
+        std::vector<uint64_t> records(reader.channels().size());
+        std::vector<uint64_t> bytes(reader.channels().size());
+        channel_log::Record record;
+        while(reader.next(&record)) {
+            if(record.channel < records.size()) {
+                records[record.channel]++;
+                bytes[record.channel] += record.size;
+            }
+        }
+
+        double seconds = (reader.end() - reader.begin()) / 1e6;
+        std::printf("%s: %.1f s, %zu chunks%s\n", argv[i], seconds, reader.chunkCount(),
+                    reader.indexed() ? "" : ", not closed, scanned");
+        for(size_t c = 0; c < records.size(); c++) {
+            std::printf("  %-20s %8llu records %10.1f kB  %7.1f Hz  %8.0f bytes/record\n",
+                        reader.channels()[c].c_str(), static_cast<unsigned long long>(records[c]),
+                        bytes[c] / 1000.0, seconds > 0 ? records[c] / seconds : 0.0,
+                        records[c] > 0 ? static_cast<double>(bytes[c]) / records[c] : 0.0);
+        }
+    }
+    return result;
+}
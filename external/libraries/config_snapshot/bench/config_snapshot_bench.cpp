@@ -0,0 +1,158 @@
+/**
+ * Startup cost of a framework config read from XML, with its includes and
+ * .lconf files, against opening its snapshot and checking that it is
+ * fresh, and the cost of reading a number by string key against a
+ * pre-hashed key. The snapshot is written to a temporary file, not next to
+ * the XML.
+ *
+ * Usage: config_snapshot_bench [--config FILE] [--runs N] [--lookups N]
+ *
+ * --config   framework XML, default configs/car.xml
+ * --runs     loads per variant, default 200
+ * --lookups  lookups per variant, default 1000000
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "config_snapshot/snapshot.h"
+
+using namespace config_snapshot;
+
+namespace {
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Temporary file removed at the end of the bench
+ */
+struct TemporaryFile {
+    std::string path;
+
+    TemporaryFile() {
+        const char *directory = std::getenv("TMPDIR");
+        std::string pattern = std::string(directory != nullptr ? directory : "/tmp")
+                + "/config_snapshot_bench_XXXXXX";
+        std::vector<char> name(pattern.begin(), pattern.end());
+        name.push_back('\0');
+        int fd = mkstemp(name.data());
+        if(fd != -1) {
+            close(fd);
+            path = name.data();
+        }
+    }
+
+    ~TemporaryFile() {
+        if(! path.empty()) {
+            unlink(path.c_str());
+        }
+    }
+};
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    std::string xml = "configs/car.xml";
+    int runs = 200;
+    int lookups = 1000000;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if(arg == "--config") {
+            xml = argv[i + 1];
+        } else if(arg == "--runs") {
+            runs = std::atoi(argv[i + 1]);
+        } else if(arg == "--lookups") {
+            lookups = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::string error;
+    FrameworkConfig config;
+    int64_t start = nowNanos();
+    for(int i = 0; i < runs; i++) {
+        if(! loadFrameworkConfig(xml, &config, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    }
+    int64_t xmlTime = (nowNanos() - start) / runs;
+
+    std::vector<uint8_t> bytes;
+    compile(config, &bytes);
+    TemporaryFile file;
+    if(file.path.empty()) {
+        std::perror("mkstemp");
+        return 1;
+    }
+    const std::string &path = file.path;
+    if(! save(bytes, path, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    std::shared_ptr<const Snapshot> snapshot;
+    start = nowNanos();
+    for(int i = 0; i < runs; i++) {
+        snapshot = Snapshot::open(path, &error);
+        if(! snapshot) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    }
+    int64_t openTime = (nowNanos() - start) / runs;
+
+    start = nowNanos();
+    for(int i = 0; i < runs; i++) {
+        if(! snapshot->fresh()) {
+            std::fprintf(stderr, "%s is stale right after writing it\n", path.c_str());
+            return 1;
+        }
+    }
+    int64_t freshTime = (nowNanos() - start) / runs;
+
+    std::printf("%s: %zu sources, %zu modules, snapshot %zu bytes\n", xml.c_str(),
+                config.sources.size(), config.modules.size(), bytes.size());
+    std::printf("load XML %.1f us, open snapshot %.1f us (%.0fx), freshness check %.1f us\n",
+                xmlTime / 1e3, openTime / 1e3, static_cast<double>(xmlTime) / openTime, freshTime / 1e3);
+
+    // a module reading a number from its config each cycle: the string key
+    // and the value are converted on every call, like config().get<T>()
+    const ModuleConfig &module = config.modules.back();
+    if(module.configs.empty() || module.configs.begin()->second.empty()) {
+        return 0;
+    }
+    std::string sectionName = module.configs.begin()->first;
+    std::string keyName = module.configs.begin()->second.rbegin()->first;
+    const char *literal = keyName.c_str();
+    const Section &section = module.configs.begin()->second;
+    double sum = 0;
+    start = nowNanos();
+    for(int i = 0; i < lookups; i++) {
+        double value = 0;
+        std::istringstream(section.find(literal)->second) >> value;
+        sum += value;
+    }
+    int64_t mapTime = nowNanos() - start;
+
+    Key key(keyName);
+    SectionView view = snapshot->module(Key(module.name)).section(Key(sectionName));
+    start = nowNanos();
+    for(int i = 0; i < lookups; i++) {
+        sum -= view.getFloat(key, 0);
+    }
+    int64_t keyTime = nowNanos() - start;
+    std::printf("get %s.%s: string key %.1f ns, hashed key %.1f ns%s\n", module.name.c_str(),
+                keyName.c_str(), static_cast<double>(mapTime) / lookups,
+                static_cast<double>(keyTime) / lookups, sum == 0 ? "" : " (values differ!)");
+    return sum == 0 ? 0 : 1;
+}
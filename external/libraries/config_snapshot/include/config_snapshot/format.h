@@ -0,0 +1,120 @@
+#ifndef CONFIG_SNAPSHOT_FORMAT_H
+#define CONFIG_SNAPSHOT_FORMAT_H
+
+#include <cstdint>
+
+namespace config_snapshot {
+
+/*
+ * Layout of a config snapshot, all numbers little endian, tables 8 byte
+ * aligned so that the mapped file is read in place:
+ *
+ *   SnapshotHeader
+ *   SourceEntry[sourceCount]      files the snapshot was compiled from
+ *   EnabledEntry[enabledCount]    <modulesToEnable> in file order
+ *   ModuleEntry[moduleCount]      sorted by nameHash
+ *   per module: MappingEntry[], TriggerEntry[], SectionEntry[] sorted by
+ *   nameHash, per section ValueEntry[] sorted by keyHash
+ *   strings, NUL terminated, the file ends with a NUL
+ *
+ * Offsets are from the start of the file, the string table starts with
+ * "" for unset names.
+ */
+
+const char SNAPSHOT_MAGIC[4] = {'L', 'C', 'F', 'S'};
+const uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t bytes; //!< file size
+    uint64_t checksum; //!< hashBytes() of the bytes after the header
+    uint32_t sources; //!< offset of the SourceEntry table
+    uint32_t sourceCount;
+    uint32_t enabled;
+    uint32_t enabledCount;
+    uint32_t modules;
+    uint32_t moduleCount;
+    uint32_t execution; //!< offset of the SectionEntry of <execution>
+    uint32_t reserved;
+};
+
+struct SourceEntry {
+    uint32_t path;
+    uint32_t reserved;
+    uint64_t size;
+    int64_t modified; //!< mtime [ns since epoch]
+};
+
+struct EnabledEntry {
+    uint32_t name;
+    uint32_t logLevel;
+    int32_t module; //!< index in the ModuleEntry table, -1 if not defined
+    uint32_t reserved;
+};
+
+struct ModuleEntry {
+    uint64_t nameHash;
+    uint32_t name;
+    uint32_t realName;
+    uint32_t executionType;
+    uint32_t mappings;
+    uint32_t mappingCount;
+    uint32_t triggers;
+    uint32_t triggerCount;
+    uint32_t sections;
+    uint32_t sectionCount;
+    uint32_t reserved;
+};
+
+struct MappingEntry {
+    uint32_t from;
+    uint32_t to;
+    int32_t priority;
+    uint32_t reserved;
+};
+
+struct TriggerEntry {
+    uint32_t channel;
+    uint32_t maxRate;
+};
+
+struct SectionEntry {
+    uint64_t nameHash;
+    uint32_t name; //!< "" for <config> without name
+    uint32_t values;
+    uint32_t valueCount;
+    uint32_t reserved;
+};
+
+struct ValueEntry {
+    uint64_t keyHash;
+    uint32_t key;
+    uint32_t value;
+};
+
+static_assert(sizeof(SnapshotHeader) == 56 && sizeof(SourceEntry) == 24 && sizeof(EnabledEntry) == 16
+              && sizeof(ModuleEntry) == 48 && sizeof(MappingEntry) == 16 && sizeof(TriggerEntry) == 8
+              && sizeof(SectionEntry) == 24 && sizeof(ValueEntry) == 16,
+              "the structs are the file layout");
+
+/**
+ * @brief hashKey is the FNV-1a hash of module, section and key names,
+ * constexpr so that modules hash their keys at compile time
+ */
+constexpr uint64_t hashKey(const char *text, uint64_t hash = 14695981039346656037ull) {
+    return *text == '\0' ? hash
+                         : hashKey(text + 1, (hash ^ static_cast<uint8_t>(*text)) * 1099511628211ull);
+}
+
+inline uint64_t hashBytes(const uint8_t *data, uint64_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for(uint64_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+}  // namespace config_snapshot
+
+#endif // CONFIG_SNAPSHOT_FORMAT_H
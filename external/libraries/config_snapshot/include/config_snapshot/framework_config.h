@@ -0,0 +1,91 @@
+#ifndef CONFIG_SNAPSHOT_FRAMEWORK_CONFIG_H
+#define CONFIG_SNAPSHOT_FRAMEWORK_CONFIG_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace config_snapshot {
+
+/**
+ * @brief key = value pairs, nested XML elements joined with '.', e.g.
+ * key.down.Up.command
+ */
+typedef std::map<std::string, std::string> Section;
+
+struct ChannelMapping {
+    std::string from;
+    std::string to;
+    int priority;
+};
+
+struct Trigger {
+    std::string channel;
+    std::string maxRate; //!< as written, empty if not set
+};
+
+struct ModuleConfig {
+    std::string name;
+    std::string realName; //!< library, empty if equal to name
+    std::string executionType;
+    std::vector<ChannelMapping> mappings;
+    std::vector<Trigger> triggers;
+
+    /**
+     * @brief config sections by their name attribute, "" for <config>
+     * without name
+     */
+    std::map<std::string, Section> configs;
+};
+
+struct EnabledModule {
+    std::string name;
+    std::string logLevel; //!< of the module or its <modulesToEnable>
+};
+
+/**
+ * @brief File a config was built from, changed sources make a snapshot stale
+ */
+struct Source {
+    std::string path;
+    uint64_t size;
+    int64_t modified; //!< mtime [ns since epoch]
+};
+
+/**
+ * @brief A framework XML with all includes and config files resolved
+ */
+struct FrameworkConfig {
+    Section execution; //!< <execution>, e.g. clock.value, threads
+    std::vector<EnabledModule> enabled; //!< in the order of the files
+    std::vector<ModuleConfig> modules; //!< sorted by name
+    std::vector<Source> sources; //!< the XML, its includes and config files
+
+    /**
+     * @return nullptr if the module is not defined
+     */
+    const ModuleConfig* module(const std::string &name) const;
+};
+
+/**
+ * @brief loadFrameworkConfig reads a framework XML like the LMS loader:
+ * - <include src> is read in place, paths relative to the including file
+ * - <module> elements of the same name are merged, later values win,
+ *   mappings and triggers are appended
+ * - <config src> loads an .lconf, <config> elements are flattened, a
+ *   name attribute selects the section
+ * @return false with error set if a file is missing, malformed or includes
+ * itself
+ */
+bool loadFrameworkConfig(const std::string &path, FrameworkConfig *config, std::string *error);
+
+/**
+ * @brief statSource reads size and mtime of a file
+ * @return false if it does not exist
+ */
+bool statSource(const std::string &path, Source *source);
+
+}  // namespace config_snapshot
+
+#endif // CONFIG_SNAPSHOT_FRAMEWORK_CONFIG_H
@@ -0,0 +1,276 @@
+#ifndef CONFIG_SNAPSHOT_SNAPSHOT_H
+#define CONFIG_SNAPSHOT_SNAPSHOT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "config_snapshot/format.h"
+#include "config_snapshot/framework_config.h"
+
+namespace config_snapshot {
+
+/**
+ * @brief Name with its precomputed hash, constexpr from a literal:
+ * static constexpr Key SCALE_DOWN("scaleDown");
+ */
+struct Key {
+    constexpr Key(const char *name) : name(name), hash(hashKey(name)) {
+    }
+    Key(const std::string &name) : name(name.c_str()), hash(hashKey(name.c_str())) {
+    }
+
+    const char *name;
+    uint64_t hash;
+};
+
+/**
+ * @brief Values of one <config> of a module, points into its Snapshot
+ */
+class SectionView {
+public:
+    SectionView() : base(nullptr), entry(nullptr) {
+    }
+    SectionView(const uint8_t *base, const SectionEntry *entry) : base(base), entry(entry) {
+    }
+
+    bool valid() const {
+        return entry != nullptr;
+    }
+
+    const char* name() const {
+        return reinterpret_cast<const char*>(base + entry->name);
+    }
+
+    /**
+     * @return nullptr if the key is not set
+     */
+    const char* get(Key key) const;
+    std::string get(Key key, const std::string &fallback) const;
+    int64_t getInt(Key key, int64_t fallback) const;
+    double getFloat(Key key, double fallback) const;
+    bool getBool(Key key, bool fallback) const;
+
+    size_t size() const {
+        return entry == nullptr ? 0 : entry->valueCount;
+    }
+    const char* key(size_t index) const;
+    const char* value(size_t index) const;
+
+private:
+    const ValueEntry* values() const;
+
+    const uint8_t *base;
+    const SectionEntry *entry;
+};
+
+/**
+ * @brief Definition of a module, points into its Snapshot
+ */
+class ModuleView {
+public:
+    ModuleView() : base(nullptr), entry(nullptr) {
+    }
+    ModuleView(const uint8_t *base, const ModuleEntry *entry) : base(base), entry(entry) {
+    }
+
+    bool valid() const {
+        return entry != nullptr;
+    }
+
+    const char* name() const;
+    const char* realName() const; //!< library, the name if not set
+    const char* executionType() const;
+
+    size_t mappingCount() const {
+        return entry->mappingCount;
+    }
+    const MappingEntry& mapping(size_t index) const;
+    size_t triggerCount() const {
+        return entry->triggerCount;
+    }
+    const TriggerEntry& trigger(size_t index) const;
+
+    /**
+     * @brief section of <config name="...">, "" for <config> without name
+     */
+    SectionView section(Key name = Key("")) const;
+
+    size_t sectionCount() const {
+        return entry->sectionCount;
+    }
+    SectionView sectionAt(size_t index) const;
+
+    /**
+     * @brief config is the section without name
+     */
+    SectionView config() const {
+        return section();
+    }
+
+    const char* string(uint32_t offset) const {
+        return reinterpret_cast<const char*>(base + offset);
+    }
+
+private:
+    const uint8_t *base;
+    const ModuleEntry *entry;
+};
+
+/**
+ * @brief A compiled framework config, mapped read only or held in memory
+ *
+ * Opening checks header, version and checksum and the bounds of the
+ * tables, there is no parsing; lookups binary search the pre-hashed
+ * names. Views and strings are valid as long as the Snapshot lives.
+ */
+class Snapshot {
+public:
+    ~Snapshot();
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    /**
+     * @brief open maps a snapshot file
+     * @return nullptr with error set if the file is missing or not a valid
+     * snapshot of this version
+     */
+    static std::shared_ptr<const Snapshot> open(const std::string &path, std::string *error);
+
+    /**
+     * @brief fromBytes takes a snapshot built by compile()
+     */
+    static std::shared_ptr<const Snapshot> fromBytes(std::vector<uint8_t> bytes, std::string *error);
+
+    /**
+     * @brief fresh checks size and mtime of the source files, one stat per
+     * file
+     */
+    bool fresh() const;
+
+    SectionView execution() const;
+
+    size_t enabledCount() const {
+        return header().enabledCount;
+    }
+    const EnabledEntry& enabled(size_t index) const;
+
+    size_t moduleCount() const {
+        return header().moduleCount;
+    }
+    ModuleView module(size_t index) const;
+
+    /**
+     * @return invalid view if the module is not defined
+     */
+    ModuleView module(Key name) const;
+
+    size_t sourceCount() const {
+        return header().sourceCount;
+    }
+    const SourceEntry& source(size_t index) const;
+
+    const char* string(uint32_t offset) const {
+        return reinterpret_cast<const char*>(memory + offset);
+    }
+
+    const uint8_t* data() const {
+        return memory;
+    }
+    size_t size() const {
+        return bytes;
+    }
+
+    /**
+     * @brief mapped false if the snapshot was compiled in memory
+     */
+    bool mapped() const {
+        return owned.empty();
+    }
+
+private:
+    Snapshot();
+    bool validate(std::string *error) const;
+
+    const SnapshotHeader& header() const {
+        return *reinterpret_cast<const SnapshotHeader*>(memory);
+    }
+
+    const uint8_t *memory;
+    size_t bytes;
+    std::vector<uint8_t> owned; //!< set by fromBytes(), empty if mapped
+};
+
+/**
+ * @brief compile serializes a loaded config into the snapshot format
+ */
+void compile(const FrameworkConfig &config, std::vector<uint8_t> *bytes);
+
+/**
+ * @brief save writes a snapshot next to its final path and renames it, a
+ * running framework mapping the old file keeps reading the old one
+ */
+bool save(const std::vector<uint8_t> &bytes, const std::string &path, std::string *error);
+
+/**
+ * @brief snapshotPath is where the snapshot of a framework XML lives:
+ * configs/car.xml -> configs/car.lcfs
+ */
+std::string snapshotPath(const std::string &xmlPath);
+
+/**
+ * @brief load returns the snapshot of xmlPath if it exists and is fresh,
+ * otherwise compiles the XML and, with writeBack, saves the new snapshot
+ * @param compiled set to true if the XML had to be read
+ * @return nullptr with error set if the XML could not be loaded
+ */
+std::shared_ptr<const Snapshot> load(const std::string &xmlPath, bool writeBack,
+                                     std::string *error, bool *compiled = nullptr);
+
+/**
+ * @brief Current snapshot for hot reload
+ *
+ * current() hands out the snapshot of this moment; reload() builds the new
+ * one first and swaps it in atomically, so readers see either the old or
+ * the new config, never a mix. The old snapshot is unmapped when its last
+ * reader drops it.
+ */
+class SnapshotHolder {
+public:
+    SnapshotHolder(const std::string &xmlPath, bool writeBack);
+
+    std::shared_ptr<const Snapshot> current() const {
+        return std::atomic_load(&snapshot);
+    }
+
+    /**
+     * @brief reload loads the config if no snapshot is held yet or a source
+     * changed
+     * @param changed set to true if a new snapshot was swapped in
+     * @return false with error set if loading failed, the old snapshot stays
+     */
+    bool reload(std::string *error, bool *changed = nullptr);
+
+    /**
+     * @brief generation counts the swaps
+     */
+    uint64_t generation() const {
+        return swaps.load();
+    }
+
+private:
+    std::string xmlPath;
+    bool writeBack;
+    std::shared_ptr<const Snapshot> snapshot;
+    std::mutex reloadMutex; //!< one reload at a time
+    std::atomic<uint64_t> swaps;
+};
+
+}  // namespace config_snapshot
+
+#endif // CONFIG_SNAPSHOT_SNAPSHOT_H
@@ -0,0 +1,37 @@
+#ifndef CONFIG_SNAPSHOT_XML_H
+#define CONFIG_SNAPSHOT_XML_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace config_snapshot {
+
+/**
+ * @brief Element of a framework XML config
+ */
+struct XmlElement {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> attributes;
+    std::string text; //!< character data, trimmed, entities resolved
+    std::vector<XmlElement> children;
+
+    /**
+     * @return nullptr if the attribute is not set
+     */
+    const std::string* attribute(const std::string &key) const;
+    std::string attribute(const std::string &key, const std::string &fallback) const;
+};
+
+/**
+ * @brief parseXml reads the subset of XML used by the framework configs:
+ * elements, attributes, text, comments, CDATA, the predefined entities and
+ * an optional declaration. Mixed text and child elements are not kept
+ * apart, the text is joined.
+ * @return false with error set to the line of the first problem
+ */
+bool parseXml(const std::string &text, XmlElement *root, std::string *error);
+
+}  // namespace config_snapshot
+
+#endif // CONFIG_SNAPSHOT_XML_H
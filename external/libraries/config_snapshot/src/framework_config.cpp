@@ -0,0 +1,217 @@
+#include "config_snapshot/framework_config.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+#include "config_snapshot/xml.h"
+#include "sensor_conversion/conversion.h"
+
+namespace config_snapshot {
+
+namespace {
+
+std::string directoryOf(const std::string &path) {
+    size_t slash = path.rfind('/');
+    return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+}
+
+std::string resolve(const std::string &file, const std::string &src) {
+    if(! src.empty() && src[0] == '/') {
+        return src;
+    }
+    return directoryOf(file) + "/" + src;
+}
+
+/**
+ * @brief flatten stores the attributes and leaf elements below element
+ */
+void flatten(const XmlElement &element, const std::string &prefix, Section *section) {
+    for(const auto &attribute : element.attributes) {
+        (*section)[prefix + attribute.first] = attribute.second;
+    }
+    for(const XmlElement &child : element.children) {
+        if(child.children.empty() && child.attributes.empty()) {
+            (*section)[prefix + child.name] = child.text;
+        } else {
+            flatten(child, prefix + child.name + ".", section);
+        }
+    }
+}
+
+class Loader {
+public:
+    explicit Loader(FrameworkConfig *config) : config(config) {
+    }
+
+    bool file(const std::string &path, std::string *error) {
+        if(std::find(stack.begin(), stack.end(), path) != stack.end()) {
+            *error = path + " includes itself";
+            return false;
+        }
+        if(! addSource(path, error)) {
+            return false;
+        }
+        std::ifstream stream(path.c_str());
+        std::stringstream text;
+        text << stream.rdbuf();
+        XmlElement root;
+        if(! parseXml(text.str(), &root, error)) {
+            *error = path + " " + *error;
+            return false;
+        }
+        if(root.name != "framework") {
+            *error = path + " has no <framework> root";
+            return false;
+        }
+
+        stack.push_back(path);
+        for(const XmlElement &element : root.children) {
+            bool ok = true;
+            if(element.name == "include") {
+                ok = file(resolve(path, element.attribute("src", "")), error);
+            } else if(element.name == "execution") {
+                flatten(element, "", &config->execution);
+            } else if(element.name == "modulesToEnable") {
+                enable(element);
+            } else if(element.name == "module") {
+                ok = module(path, element, error);
+            }
+            if(! ok) {
+                return false;
+            }
+        }
+        stack.pop_back();
+        return true;
+    }
+
+    void finish() {
+        for(auto &entry : modules) {
+            config->modules.push_back(entry.second);
+        }
+    }
+
+private:
+    bool addSource(const std::string &path, std::string *error) {
+        Source source;
+        if(! statSource(path, &source)) {
+            *error = "Could not open " + path;
+            return false;
+        }
+        for(const Source &known : config->sources) {
+            if(known.path == path) {
+                return true;
+            }
+        }
+        config->sources.push_back(source);
+        return true;
+    }
+
+    void enable(const XmlElement &element) {
+        std::string logLevel = element.attribute("logLevel", "");
+        for(const XmlElement &child : element.children) {
+            if(child.name != "module") {
+                continue;
+            }
+            EnabledModule entry;
+            entry.name = child.text;
+            entry.logLevel = child.attribute("logLevel", logLevel);
+            auto found = std::find_if(config->enabled.begin(), config->enabled.end(),
+                                      [&entry](const EnabledModule &e) { return e.name == entry.name; });
+            if(found == config->enabled.end()) {
+                config->enabled.push_back(entry);
+            } else {
+                found->logLevel = entry.logLevel;
+            }
+        }
+    }
+
+    bool module(const std::string &path, const XmlElement &element, std::string *error) {
+        std::string name;
+        for(const XmlElement &child : element.children) {
+            if(child.name == "name") {
+                name = child.text;
+            }
+        }
+        if(name.empty()) {
+            *error = path + ": <module> without <name>";
+            return false;
+        }
+
+        ModuleConfig &module = modules[name];
+        module.name = name;
+        for(const XmlElement &child : element.children) {
+            if(child.name == "realName") {
+                module.realName = child.text;
+            } else if(child.name == "executionType") {
+                module.executionType = child.text;
+            } else if(child.name == "channelMapping") {
+                ChannelMapping mapping;
+                mapping.from = child.attribute("from", "");
+                mapping.to = child.attribute("to", "");
+                mapping.priority = std::atoi(child.attribute("priority", "0").c_str());
+                module.mappings.push_back(mapping);
+            } else if(child.name == "trigger") {
+                Trigger trigger;
+                trigger.channel = child.text;
+                trigger.maxRate = child.attribute("maxRate", "");
+                module.triggers.push_back(trigger);
+            } else if(child.name == "config") {
+                Section &section = module.configs[child.attribute("name", "")];
+                const std::string *src = child.attribute("src");
+                if(src != nullptr) {
+                    std::string lconf = resolve(path, *src);
+                    if(! addSource(lconf, error)
+                            || ! sensor_conversion::loadLconf(lconf, &section, error)) {
+                        return false;
+                    }
+                }
+                for(const XmlElement &entry : child.children) {
+                    if(entry.children.empty() && entry.attributes.empty()) {
+                        section[entry.name] = entry.text;
+                    } else {
+                        flatten(entry, entry.name + ".", &section);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    FrameworkConfig *config;
+    std::map<std::string, ModuleConfig> modules; //!< sorted by name
+    std::vector<std::string> stack; //!< files being read, detects include loops
+};
+
+}  // namespace
+
+const ModuleConfig* FrameworkConfig::module(const std::string &name) const {
+    auto found = std::lower_bound(modules.begin(), modules.end(), name,
+                                  [](const ModuleConfig &m, const std::string &n) { return m.name < n; });
+    return found != modules.end() && found->name == name ? &*found : nullptr;
+}
+
+bool loadFrameworkConfig(const std::string &path, FrameworkConfig *config, std::string *error) {
+    *config = FrameworkConfig();
+    Loader loader(config);
+    if(! loader.file(path, error)) {
+        return false;
+    }
+    loader.finish();
+    return true;
+}
+
+bool statSource(const std::string &path, Source *source) {
+    struct stat info;
+    if(stat(path.c_str(), &info) != 0 || ! S_ISREG(info.st_mode)) {
+        return false;
+    }
+    source->path = path;
+    source->size = static_cast<uint64_t>(info.st_size);
+    source->modified = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+    return true;
+}
+
+}  // namespace config_snapshot
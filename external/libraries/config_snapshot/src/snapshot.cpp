@@ -0,0 +1,537 @@
+#include "config_snapshot/snapshot.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace config_snapshot {
+
+namespace {
+
+/**
+ * @brief Lays out the tables first and appends the strings behind them
+ */
+class Builder {
+public:
+    /**
+     * @param tables bytes of all tables, they do not move until finish()
+     */
+    Builder(std::vector<uint8_t> *bytes, size_t tables) : bytes(bytes), tables(tables) {
+        bytes->assign(tables, 0);
+        strings.push_back('\0');
+    }
+
+    template<typename T>
+    T* at(size_t offset) {
+        return reinterpret_cast<T*>(bytes->data() + offset);
+    }
+
+    uint32_t string(const std::string &text) {
+        if(text.empty()) {
+            return static_cast<uint32_t>(tables);
+        }
+        auto found = known.find(text);
+        if(found != known.end()) {
+            return found->second;
+        }
+        uint32_t offset = static_cast<uint32_t>(tables + strings.size());
+        strings.insert(strings.end(), text.begin(), text.end());
+        strings.push_back('\0');
+        known[text] = offset;
+        return offset;
+    }
+
+    void finish() {
+        bytes->insert(bytes->end(), strings.begin(), strings.end());
+    }
+
+private:
+    std::vector<uint8_t> *bytes;
+    size_t tables;
+    std::vector<uint8_t> strings;
+    std::map<std::string, uint32_t> known;
+};
+
+template<typename Entry>
+bool hashLess(const Entry &a, const Entry &b) {
+    return a.first < b.first || (a.first == b.first && a.second < b.second);
+}
+
+/**
+ * @brief find searches a table sorted by hash for the entry named key
+ */
+template<typename Entry, typename Name>
+const Entry* find(const Entry *begin, const Entry *end, Key key, Name name) {
+    const Entry *found = std::lower_bound(begin, end, key.hash, [&name](const Entry &e, uint64_t h) {
+        return name(e).first < h;
+    });
+    for(; found != end && name(*found).first == key.hash; ++found) {
+        if(std::strcmp(name(*found).second, key.name) == 0) {
+            return found;
+        }
+    }
+    return nullptr;
+}
+
+bool inside(size_t bytes, uint64_t offset, uint64_t count, size_t size) {
+    return offset % 8 == 0 && offset <= bytes && count <= (bytes - offset) / size;
+}
+
+}  // namespace
+
+const ValueEntry* SectionView::values() const {
+    return reinterpret_cast<const ValueEntry*>(base + entry->values);
+}
+
+const char* SectionView::get(Key key) const {
+    if(entry == nullptr) {
+        return nullptr;
+    }
+    const uint8_t *strings = base;
+    const ValueEntry *found = find(values(), values() + entry->valueCount, key,
+                                   [strings](const ValueEntry &e) {
+        return std::make_pair(e.keyHash, reinterpret_cast<const char*>(strings + e.key));
+    });
+    return found == nullptr ? nullptr : reinterpret_cast<const char*>(base + found->value);
+}
+
+std::string SectionView::get(Key key, const std::string &fallback) const {
+    const char *value = get(key);
+    return value == nullptr ? fallback : std::string(value);
+}
+
+int64_t SectionView::getInt(Key key, int64_t fallback) const {
+    const char *value = get(key);
+    if(value == nullptr) {
+        return fallback;
+    }
+    char *end;
+    long long result = std::strtoll(value, &end, 10);
+    return end == value ? fallback : result;
+}
+
+double SectionView::getFloat(Key key, double fallback) const {
+    const char *value = get(key);
+    if(value == nullptr) {
+        return fallback;
+    }
+    char *end;
+    double result = std::strtod(value, &end);
+    return end == value ? fallback : result;
+}
+
+bool SectionView::getBool(Key key, bool fallback) const {
+    const char *value = get(key);
+    if(value == nullptr) {
+        return fallback;
+    }
+    if(std::strcmp(value, "true") == 0 || std::strcmp(value, "1") == 0) {
+        return true;
+    }
+    if(std::strcmp(value, "false") == 0 || std::strcmp(value, "0") == 0) {
+        return false;
+    }
+    return fallback;
+}
+
+const char* SectionView::key(size_t index) const {
+    return reinterpret_cast<const char*>(base + values()[index].key);
+}
+
+const char* SectionView::value(size_t index) const {
+    return reinterpret_cast<const char*>(base + values()[index].value);
+}
+
+const char* ModuleView::name() const {
+    return string(entry->name);
+}
+
+const char* ModuleView::realName() const {
+    const char *real = string(entry->realName);
+    return *real == '\0' ? name() : real;
+}
+
+const char* ModuleView::executionType() const {
+    return string(entry->executionType);
+}
+
+const MappingEntry& ModuleView::mapping(size_t index) const {
+    return reinterpret_cast<const MappingEntry*>(base + entry->mappings)[index];
+}
+
+const TriggerEntry& ModuleView::trigger(size_t index) const {
+    return reinterpret_cast<const TriggerEntry*>(base + entry->triggers)[index];
+}
+
+SectionView ModuleView::section(Key name) const {
+    const SectionEntry *sections = reinterpret_cast<const SectionEntry*>(base + entry->sections);
+    const uint8_t *strings = base;
+    const SectionEntry *found = find(sections, sections + entry->sectionCount, name,
+                                     [strings](const SectionEntry &e) {
+        return std::make_pair(e.nameHash, reinterpret_cast<const char*>(strings + e.name));
+    });
+    return found == nullptr ? SectionView() : SectionView(base, found);
+}
+
+SectionView ModuleView::sectionAt(size_t index) const {
+    return SectionView(base, reinterpret_cast<const SectionEntry*>(base + entry->sections) + index);
+}
+
+Snapshot::Snapshot() : memory(nullptr), bytes(0) {
+}
+
+Snapshot::~Snapshot() {
+    if(memory != nullptr && owned.empty()) {
+        munmap(const_cast<uint8_t*>(memory), bytes);
+    }
+}
+
+std::shared_ptr<const Snapshot> Snapshot::open(const std::string &path, std::string *error) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        *error = "open " + path + ": " + std::strerror(errno);
+        return nullptr;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SnapshotHeader)) {
+        *error = path + " is no config snapshot";
+        ::close(fd);
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED) {
+        *error = "mmap " + path + ": " + std::strerror(errno);
+        return nullptr;
+    }
+
+    std::shared_ptr<Snapshot> snapshot(new Snapshot);
+    snapshot->memory = static_cast<const uint8_t*>(mapped);
+    snapshot->bytes = size;
+    if(! snapshot->validate(error)) {
+        *error = path + ": " + *error;
+        return nullptr;
+    }
+    return snapshot;
+}
+
+std::shared_ptr<const Snapshot> Snapshot::fromBytes(std::vector<uint8_t> bytes, std::string *error) {
+    if(bytes.size() < sizeof(SnapshotHeader)) {
+        *error = "no config snapshot";
+        return nullptr;
+    }
+    std::shared_ptr<Snapshot> snapshot(new Snapshot);
+    snapshot->owned.swap(bytes);
+    snapshot->memory = snapshot->owned.data();
+    snapshot->bytes = snapshot->owned.size();
+    if(! snapshot->validate(error)) {
+        return nullptr;
+    }
+    return snapshot;
+}
+
+bool Snapshot::validate(std::string *error) const {
+    const SnapshotHeader &h = header();
+    if(std::memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0 || h.version != SNAPSHOT_VERSION) {
+        *error = "no config snapshot of version " + std::to_string(SNAPSHOT_VERSION);
+        return false;
+    }
+    if(h.bytes != bytes || memory[bytes - 1] != '\0'
+            || hashBytes(memory + sizeof(h), bytes - sizeof(h)) != h.checksum) {
+        *error = "snapshot is truncated or damaged";
+        return false;
+    }
+
+    // a file ending with NUL keeps every string in bounds, the tables are
+    // checked once here so that lookups need no checks
+    bool ok = inside(bytes, h.sources, h.sourceCount, sizeof(SourceEntry))
+            && inside(bytes, h.enabled, h.enabledCount, sizeof(EnabledEntry))
+            && inside(bytes, h.modules, h.moduleCount, sizeof(ModuleEntry))
+            && inside(bytes, h.execution, 1, sizeof(SectionEntry));
+    std::vector<const SectionEntry*> sections;
+    if(ok) {
+        sections.push_back(reinterpret_cast<const SectionEntry*>(memory + h.execution));
+        for(size_t i = 0; i < h.enabledCount; i++) {
+            ok = ok && enabled(i).module < static_cast<int32_t>(h.moduleCount);
+        }
+    }
+    for(size_t i = 0; ok && i < h.moduleCount; i++) {
+        const ModuleEntry &m = reinterpret_cast<const ModuleEntry*>(memory + h.modules)[i];
+        ok = inside(bytes, m.mappings, m.mappingCount, sizeof(MappingEntry))
+                && inside(bytes, m.triggers, m.triggerCount, sizeof(TriggerEntry))
+                && inside(bytes, m.sections, m.sectionCount, sizeof(SectionEntry));
+        for(size_t s = 0; ok && s < m.sectionCount; s++) {
+            sections.push_back(reinterpret_cast<const SectionEntry*>(memory + m.sections) + s);
+        }
+    }
+    for(size_t i = 0; ok && i < sections.size(); i++) {
+        ok = inside(bytes, sections[i]->values, sections[i]->valueCount, sizeof(ValueEntry));
+    }
+    if(! ok) {
+        *error = "snapshot table out of bounds";
+    }
+    return ok;
+}
+
+bool Snapshot::fresh() const {
+    for(size_t i = 0; i < sourceCount(); i++) {
+        const SourceEntry &entry = source(i);
+        Source current;
+        if(! statSource(string(entry.path), &current) || current.size != entry.size
+                || current.modified != entry.modified) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SectionView Snapshot::execution() const {
+    return SectionView(memory, reinterpret_cast<const SectionEntry*>(memory + header().execution));
+}
+
+const EnabledEntry& Snapshot::enabled(size_t index) const {
+    return reinterpret_cast<const EnabledEntry*>(memory + header().enabled)[index];
+}
+
+ModuleView Snapshot::module(size_t index) const {
+    return ModuleView(memory, reinterpret_cast<const ModuleEntry*>(memory + header().modules) + index);
+}
+
+ModuleView Snapshot::module(Key name) const {
+    const ModuleEntry *modules = reinterpret_cast<const ModuleEntry*>(memory + header().modules);
+    const uint8_t *strings = memory;
+    const ModuleEntry *found = find(modules, modules + moduleCount(), name,
+                                    [strings](const ModuleEntry &e) {
+        return std::make_pair(e.nameHash, reinterpret_cast<const char*>(strings + e.name));
+    });
+    return found == nullptr ? ModuleView() : ModuleView(memory, found);
+}
+
+const SourceEntry& Snapshot::source(size_t index) const {
+    return reinterpret_cast<const SourceEntry*>(memory + header().sources)[index];
+}
+
+void compile(const FrameworkConfig &config, std::vector<uint8_t> *bytes) {
+    // tables sorted by (hash, name) for Snapshot lookups
+    typedef std::pair<uint64_t, std::string> Name;
+    std::vector<std::pair<Name, const ModuleConfig*>> modules;
+    for(const ModuleConfig &module : config.modules) {
+        modules.emplace_back(Name(hashKey(module.name.c_str()), module.name), &module);
+    }
+    std::sort(modules.begin(), modules.end(), [](const std::pair<Name, const ModuleConfig*> &a,
+                                                 const std::pair<Name, const ModuleConfig*> &b) {
+        return hashLess(a.first, b.first);
+    });
+
+    size_t tables = sizeof(SnapshotHeader) + config.sources.size() * sizeof(SourceEntry)
+            + config.enabled.size() * sizeof(EnabledEntry) + modules.size() * sizeof(ModuleEntry)
+            + sizeof(SectionEntry) + config.execution.size() * sizeof(ValueEntry);
+    for(const auto &module : modules) {
+        tables += module.second->mappings.size() * sizeof(MappingEntry)
+                + module.second->triggers.size() * sizeof(TriggerEntry)
+                + module.second->configs.size() * sizeof(SectionEntry);
+        for(const auto &section : module.second->configs) {
+            tables += section.second.size() * sizeof(ValueEntry);
+        }
+    }
+    Builder builder(bytes, tables);
+    size_t offset = sizeof(SnapshotHeader);
+    auto reserve = [&offset](size_t count, size_t size) {
+        size_t begin = offset;
+        offset += count * size;
+        return static_cast<uint32_t>(begin);
+    };
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+
+    header.sourceCount = static_cast<uint32_t>(config.sources.size());
+    header.sources = reserve(config.sources.size(), sizeof(SourceEntry));
+    for(size_t i = 0; i < config.sources.size(); i++) {
+        SourceEntry *entry = builder.at<SourceEntry>(header.sources) + i;
+        entry->path = builder.string(config.sources[i].path);
+        entry->size = config.sources[i].size;
+        entry->modified = config.sources[i].modified;
+    }
+
+    header.enabledCount = static_cast<uint32_t>(config.enabled.size());
+    header.enabled = reserve(config.enabled.size(), sizeof(EnabledEntry));
+    header.moduleCount = static_cast<uint32_t>(modules.size());
+    header.modules = reserve(modules.size(), sizeof(ModuleEntry));
+    for(size_t i = 0; i < config.enabled.size(); i++) {
+        EnabledEntry *entry = builder.at<EnabledEntry>(header.enabled) + i;
+        entry->name = builder.string(config.enabled[i].name);
+        entry->logLevel = builder.string(config.enabled[i].logLevel);
+        entry->module = -1;
+        for(size_t m = 0; m < modules.size(); m++) {
+            if(modules[m].first.second == config.enabled[i].name) {
+                entry->module = static_cast<int32_t>(m);
+            }
+        }
+    }
+
+    auto writeSection = [&](const Section &section, const std::string &name, SectionEntry *entry) {
+        std::vector<std::pair<Name, const std::string*>> values;
+        for(const auto &value : section) {
+            values.emplace_back(Name(hashKey(value.first.c_str()), value.first), &value.second);
+        }
+        std::sort(values.begin(), values.end(), [](const std::pair<Name, const std::string*> &a,
+                                                   const std::pair<Name, const std::string*> &b) {
+            return hashLess(a.first, b.first);
+        });
+        entry->nameHash = hashKey(name.c_str());
+        entry->name = builder.string(name);
+        entry->valueCount = static_cast<uint32_t>(values.size());
+        entry->values = reserve(values.size(), sizeof(ValueEntry));
+        for(size_t v = 0; v < values.size(); v++) {
+            ValueEntry *value = builder.at<ValueEntry>(entry->values) + v;
+            value->keyHash = values[v].first.first;
+            value->key = builder.string(values[v].first.second);
+            value->value = builder.string(*values[v].second);
+        }
+    };
+
+    header.execution = reserve(1, sizeof(SectionEntry));
+    writeSection(config.execution, "execution", builder.at<SectionEntry>(header.execution));
+
+    for(size_t m = 0; m < modules.size(); m++) {
+        const ModuleConfig &module = *modules[m].second;
+        ModuleEntry *entry = builder.at<ModuleEntry>(header.modules) + m;
+        entry->nameHash = modules[m].first.first;
+        entry->name = builder.string(module.name);
+        entry->realName = builder.string(module.realName);
+        entry->executionType = builder.string(module.executionType);
+
+        entry->mappingCount = static_cast<uint32_t>(module.mappings.size());
+        entry->mappings = reserve(module.mappings.size(), sizeof(MappingEntry));
+        for(size_t i = 0; i < module.mappings.size(); i++) {
+            MappingEntry *mapping = builder.at<MappingEntry>(entry->mappings) + i;
+            mapping->from = builder.string(module.mappings[i].from);
+            mapping->to = builder.string(module.mappings[i].to);
+            mapping->priority = module.mappings[i].priority;
+        }
+
+        entry->triggerCount = static_cast<uint32_t>(module.triggers.size());
+        entry->triggers = reserve(module.triggers.size(), sizeof(TriggerEntry));
+        for(size_t i = 0; i < module.triggers.size(); i++) {
+            TriggerEntry *trigger = builder.at<TriggerEntry>(entry->triggers) + i;
+            trigger->channel = builder.string(module.triggers[i].channel);
+            trigger->maxRate = builder.string(module.triggers[i].maxRate);
+        }
+
+        std::vector<std::pair<Name, const Section*>> sections;
+        for(const auto &section : module.configs) {
+            sections.emplace_back(Name(hashKey(section.first.c_str()), section.first), &section.second);
+        }
+        std::sort(sections.begin(), sections.end(), [](const std::pair<Name, const Section*> &a,
+                                                       const std::pair<Name, const Section*> &b) {
+            return hashLess(a.first, b.first);
+        });
+        entry->sectionCount = static_cast<uint32_t>(sections.size());
+        entry->sections = reserve(sections.size(), sizeof(SectionEntry));
+        for(size_t i = 0; i < sections.size(); i++) {
+            writeSection(*sections[i].second, sections[i].first.second,
+                         builder.at<SectionEntry>(entry->sections) + i);
+        }
+    }
+
+    builder.finish();
+    header.bytes = bytes->size();
+    header.checksum = hashBytes(bytes->data() + sizeof(header), bytes->size() - sizeof(header));
+    std::memcpy(bytes->data(), &header, sizeof(header));
+}
+
+bool save(const std::vector<uint8_t> &bytes, const std::string &path, std::string *error) {
+    std::string temporary = path + ".tmp";
+    FILE *file = std::fopen(temporary.c_str(), "wb");
+    if(file == nullptr) {
+        *error = "open " + temporary + ": " + std::strerror(errno);
+        return false;
+    }
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    ok = std::fflush(file) == 0 && ok;
+    ok = fsync(fileno(file)) == 0 && ok;
+    ok = std::fclose(file) == 0 && ok;
+    if(! ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        *error = "write " + path + ": " + std::strerror(errno);
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string snapshotPath(const std::string &xmlPath) {
+    size_t dot = xmlPath.rfind('.');
+    size_t slash = xmlPath.rfind('/');
+    if(dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return xmlPath + ".lcfs";
+    }
+    return xmlPath.substr(0, dot) + ".lcfs";
+}
+
+std::shared_ptr<const Snapshot> load(const std::string &xmlPath, bool writeBack,
+                                     std::string *error, bool *compiled) {
+    if(compiled != nullptr) {
+        *compiled = false;
+    }
+    std::string path = snapshotPath(xmlPath);
+    std::string ignored;
+    std::shared_ptr<const Snapshot> snapshot = Snapshot::open(path, &ignored);
+    // the first source is the XML, a snapshot of another file is stale too
+    if(snapshot && snapshot->sourceCount() > 0
+            && xmlPath == snapshot->string(snapshot->source(0).path) && snapshot->fresh()) {
+        return snapshot;
+    }
+
+    FrameworkConfig config;
+    if(! loadFrameworkConfig(xmlPath, &config, error)) {
+        return nullptr;
+    }
+    if(compiled != nullptr) {
+        *compiled = true;
+    }
+    std::vector<uint8_t> bytes;
+    compile(config, &bytes);
+    // a read only config directory only costs the next start the XML parse
+    if(writeBack) {
+        save(bytes, path, &ignored);
+    }
+    return Snapshot::fromBytes(std::move(bytes), error);
+}
+
+SnapshotHolder::SnapshotHolder(const std::string &xmlPath, bool writeBack)
+    : xmlPath(xmlPath), writeBack(writeBack), swaps(0) {
+}
+
+bool SnapshotHolder::reload(std::string *error, bool *changed) {
+    std::lock_guard<std::mutex> lock(reloadMutex);
+    if(changed != nullptr) {
+        *changed = false;
+    }
+    std::shared_ptr<const Snapshot> old = current();
+    if(old && old->fresh()) {
+        return true;
+    }
+    std::shared_ptr<const Snapshot> next = load(xmlPath, writeBack, error);
+    if(! next) {
+        return false;
+    }
+    std::atomic_store(&snapshot, next);
+    swaps++;
+    if(changed != nullptr) {
+        *changed = true;
+    }
+    return true;
+}
+
+}  // namespace config_snapshot
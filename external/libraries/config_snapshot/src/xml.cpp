@@ -0,0 +1,259 @@
+#include "config_snapshot/xml.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace config_snapshot {
+
+namespace {
+
+class Parser {
+public:
+    explicit Parser(const std::string &text) : text(text), position(0) {
+    }
+
+    bool document(XmlElement *root, std::string *error) {
+        skipMisc();
+        if(! element(root)) {
+            *error = message();
+            return false;
+        }
+        skipMisc();
+        if(position != text.size()) {
+            problem = "content after the root element";
+            *error = message();
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool startsWith(const char *prefix) const {
+        return text.compare(position, std::strlen(prefix), prefix) == 0;
+    }
+
+    bool skipPast(const char *end) {
+        size_t found = text.find(end, position);
+        if(found == std::string::npos) {
+            problem = std::string("missing ") + end;
+            return false;
+        }
+        position = found + std::strlen(end);
+        return true;
+    }
+
+    void skipSpace() {
+        while(position < text.size() && std::strchr(" \t\r\n", text[position]) != nullptr) {
+            position++;
+        }
+    }
+
+    // declaration, comments and whitespace around the root element
+    void skipMisc() {
+        while(true) {
+            skipSpace();
+            if(startsWith("<?")) {
+                skipPast("?>");
+            } else if(startsWith("<!--")) {
+                skipPast("-->");
+            } else {
+                return;
+            }
+        }
+    }
+
+    bool name(std::string *result) {
+        size_t begin = position;
+        while(position < text.size() && (std::isalnum(static_cast<unsigned char>(text[position]))
+                                        || std::strchr("_-.:", text[position]) != nullptr)) {
+            position++;
+        }
+        if(position == begin) {
+            problem = "expected a name";
+            return false;
+        }
+        result->assign(text, begin, position - begin);
+        return true;
+    }
+
+    bool decode(const std::string &raw, std::string *result) {
+        result->clear();
+        for(size_t i = 0; i < raw.size(); i++) {
+            if(raw[i] != '&') {
+                *result += raw[i];
+                continue;
+            }
+            size_t end = raw.find(';', i);
+            if(end == std::string::npos) {
+                problem = "unterminated entity";
+                return false;
+            }
+            std::string entity = raw.substr(i + 1, end - i - 1);
+            if(entity == "lt") {
+                *result += '<';
+            } else if(entity == "gt") {
+                *result += '>';
+            } else if(entity == "amp") {
+                *result += '&';
+            } else if(entity == "quot") {
+                *result += '"';
+            } else if(entity == "apos") {
+                *result += '\'';
+            } else if(entity.size() > 1 && entity[0] == '#') {
+                long code = entity[1] == 'x' ? std::strtol(entity.c_str() + 2, nullptr, 16)
+                                             : std::strtol(entity.c_str() + 1, nullptr, 10);
+                if(code <= 0 || code > 0x7F) {
+                    problem = "only ASCII character references are supported: &" + entity + ";";
+                    return false;
+                }
+                *result += static_cast<char>(code);
+            } else {
+                problem = "unknown entity &" + entity + ";";
+                return false;
+            }
+            i = end;
+        }
+        return true;
+    }
+
+    bool element(XmlElement *element) {
+        if(! startsWith("<")) {
+            problem = "expected an element";
+            return false;
+        }
+        position++;
+        if(! name(&element->name)) {
+            return false;
+        }
+
+        while(true) {
+            skipSpace();
+            if(startsWith("/>")) {
+                position += 2;
+                return true;
+            }
+            if(startsWith(">")) {
+                position++;
+                break;
+            }
+            std::string key;
+            if(! name(&key)) {
+                return false;
+            }
+            skipSpace();
+            if(! startsWith("=")) {
+                problem = "expected = after " + key;
+                return false;
+            }
+            position++;
+            skipSpace();
+            if(position >= text.size() || (text[position] != '"' && text[position] != '\'')) {
+                problem = "expected a quoted value for " + key;
+                return false;
+            }
+            char quote = text[position++];
+            size_t end = text.find(quote, position);
+            if(end == std::string::npos) {
+                problem = "unterminated value of " + key;
+                return false;
+            }
+            std::string value;
+            if(! decode(text.substr(position, end - position), &value)) {
+                return false;
+            }
+            element->attributes.emplace_back(key, value);
+            position = end + 1;
+        }
+
+        std::string raw;
+        while(true) {
+            if(position >= text.size()) {
+                problem = "missing </" + element->name + ">";
+                return false;
+            }
+            if(startsWith("<!--")) {
+                if(! skipPast("-->")) {
+                    return false;
+                }
+            } else if(startsWith("<![CDATA[")) {
+                size_t begin = position + 9;
+                if(! skipPast("]]>")) {
+                    return false;
+                }
+                // kept as is, escaped so that decode() leaves it alone
+                for(size_t i = begin; i < position - 3; i++) {
+                    raw += text[i] == '&' ? std::string("&amp;") : std::string(1, text[i]);
+                }
+            } else if(startsWith("</")) {
+                position += 2;
+                std::string closing;
+                if(! name(&closing)) {
+                    return false;
+                }
+                if(closing != element->name) {
+                    problem = "</" + closing + "> closes <" + element->name + ">";
+                    return false;
+                }
+                skipSpace();
+                if(! startsWith(">")) {
+                    problem = "expected >";
+                    return false;
+                }
+                position++;
+                break;
+            } else if(startsWith("<")) {
+                element->children.emplace_back();
+                if(! this->element(&element->children.back())) {
+                    return false;
+                }
+            } else {
+                raw += text[position++];
+            }
+        }
+
+        size_t begin = raw.find_first_not_of(" \t\r\n");
+        if(begin != std::string::npos) {
+            size_t end = raw.find_last_not_of(" \t\r\n");
+            return decode(raw.substr(begin, end - begin + 1), &element->text);
+        }
+        return true;
+    }
+
+    std::string message() const {
+        size_t line = 1;
+        for(size_t i = 0; i < position && i < text.size(); i++) {
+            if(text[i] == '\n') {
+                line++;
+            }
+        }
+        return "line " + std::to_string(line) + ": " + problem;
+    }
+
+    const std::string &text;
+    size_t position;
+    std::string problem;
+};
+
+}  // namespace
+
+const std::string* XmlElement::attribute(const std::string &key) const {
+    for(const auto &attribute : attributes) {
+        if(attribute.first == key) {
+            return &attribute.second;
+        }
+    }
+    return nullptr;
+}
+
+std::string XmlElement::attribute(const std::string &key, const std::string &fallback) const {
+    const std::string *value = attribute(key);
+    return value != nullptr ? *value : fallback;
+}
+
+bool parseXml(const std::string &text, XmlElement *root, std::string *error) {
+    *root = XmlElement();
+    return Parser(text).document(root, error);
+}
+
+}  // namespace config_snapshot
@@ -0,0 +1,109 @@
+/**
+ * Compiles framework XML configs into snapshots next to them, e.g.
+ * configs/car.xml -> configs/car.lcfs, and optionally prints what the
+ * snapshot holds.
+ *
+ * Usage: config_snapshot_compile [--dump] <config.xml>...
+ */
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "config_snapshot/snapshot.h"
+
+using namespace config_snapshot;
+
+namespace {
+
+void printSection(const SectionView &section, const char *indent) {
+    for(size_t i = 0; i < section.size(); i++) {
+        std::printf("%s%s = %s\n", indent, section.key(i), section.value(i));
+    }
+}
+
+void dump(const Snapshot &snapshot) {
+    std::printf("sources:\n");
+    for(size_t i = 0; i < snapshot.sourceCount(); i++) {
+        std::printf("  %s\n", snapshot.string(snapshot.source(i).path));
+    }
+    std::printf("execution:\n");
+    printSection(snapshot.execution(), "  ");
+    std::printf("enabled:\n");
+    for(size_t i = 0; i < snapshot.enabledCount(); i++) {
+        const EnabledEntry &entry = snapshot.enabled(i);
+        std::printf("  %s %s%s\n", snapshot.string(entry.name), snapshot.string(entry.logLevel),
+                    entry.module < 0 ? " (no definition)" : "");
+    }
+    for(size_t m = 0; m < snapshot.moduleCount(); m++) {
+        ModuleView module = snapshot.module(m);
+        std::printf("module %s (%s) %s\n", module.name(), module.realName(), module.executionType());
+        for(size_t i = 0; i < module.mappingCount(); i++) {
+            const MappingEntry &mapping = module.mapping(i);
+            std::printf("  channel %s -> %s priority %d\n", module.string(mapping.from),
+                        module.string(mapping.to), mapping.priority);
+        }
+        for(size_t i = 0; i < module.triggerCount(); i++) {
+            const TriggerEntry &trigger = module.trigger(i);
+            std::printf("  trigger %s %s\n", module.string(trigger.channel), module.string(trigger.maxRate));
+        }
+        for(size_t i = 0; i < module.sectionCount(); i++) {
+            SectionView section = module.sectionAt(i);
+            std::printf("  config %s\n", *section.name() == '\0' ? "(default)" : section.name());
+            printSection(section, "    ");
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    bool print = false;
+    std::vector<std::string> paths;
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "--dump") {
+            print = true;
+        } else if(arg.compare(0, 2, "--") == 0) {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if(paths.empty()) {
+        std::fprintf(stderr, "Usage: %s [--dump] <config.xml>...\n", argv[0]);
+        return 1;
+    }
+
+    int result = 0;
+    for(const std::string &path : paths) {
+        FrameworkConfig config;
+        std::string error;
+        std::vector<uint8_t> bytes;
+        if(! loadFrameworkConfig(path, &config, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            result = 1;
+            continue;
+        }
+        compile(config, &bytes);
+        std::string output = snapshotPath(path);
+        if(! save(bytes, output, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            result = 1;
+            continue;
+        }
+        std::printf("%s: %zu modules, %zu sources, %zu bytes\n", output.c_str(),
+                    config.modules.size(), config.sources.size(), bytes.size());
+
+        if(print) {
+            std::shared_ptr<const Snapshot> snapshot = Snapshot::open(output, &error);
+            if(! snapshot) {
+                std::fprintf(stderr, "%s\n", error.c_str());
+                result = 1;
+                continue;
+            }
+            dump(*snapshot);
+        }
+    }
+    return result;
+}
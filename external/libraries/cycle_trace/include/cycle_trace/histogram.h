@@ -0,0 +1,71 @@
+#ifndef CYCLE_TRACE_HISTOGRAM_H
+#define CYCLE_TRACE_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace cycle_trace {
+
+/**
+ * @brief Log-linear histogram of durations [us]
+ *
+ * Every power of two is split into SUB_BUCKETS buckets, so any recorded value
+ * is known to about 3 % without storing the values. Values below SUB_BUCKETS
+ * are exact.
+ *
+ * record() only does relaxed atomic increments, any number of threads may
+ * record while another one reads percentiles.
+ */
+class Histogram {
+public:
+    static const int SUB_BUCKET_BITS = 5;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAX_EXPONENT = 40;
+    static const int BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+    Histogram();
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    /**
+     * @brief record adds one value, negative values count as 0
+     */
+    void record(int64_t value);
+
+    void reset();
+
+    uint64_t count() const;
+    int64_t max() const;
+    double mean() const;
+
+    /**
+     * @brief percentile upper bound of the bucket holding the given fraction
+     * of all values
+     * @param fraction 0 to 1, e.g. 0.99
+     */
+    int64_t percentile(double fraction) const;
+
+    /**
+     * @brief countAbove number of values larger than the given limit, exact
+     * to the bucket resolution
+     */
+    uint64_t countAbove(int64_t limit) const;
+
+    static int bucketIndex(int64_t value);
+
+    /**
+     * @brief bucketUpperBound largest value that falls into a bucket
+     */
+    static int64_t bucketUpperBound(int index);
+
+private:
+    std::atomic<uint32_t> buckets[BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<int64_t> maximum;
+};
+
+}  // namespace cycle_trace
+
+#endif // CYCLE_TRACE_HISTOGRAM_H
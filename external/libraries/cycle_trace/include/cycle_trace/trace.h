@@ -0,0 +1,150 @@
+#ifndef CYCLE_TRACE_TRACE_H
+#define CYCLE_TRACE_TRACE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cycle_trace/histogram.h"
+
+namespace cycle_trace {
+
+typedef uint16_t ScopeId;
+
+/**
+ * @brief Most scopes that can be registered, further names share the last id
+ */
+const ScopeId MAX_SCOPES = 256;
+
+/**
+ * @brief Events kept per thread, older events are overwritten
+ */
+const unsigned int THREAD_BUFFER_EVENTS = 1 << 16;
+
+/**
+ * @brief Name of the scope that collects camera frame to actuator latencies
+ */
+const char* const FRAME_SCOPE = "frame_to_actuator";
+
+/**
+ * @brief now monotonic clock used for all events [ns]
+ */
+int64_t now();
+
+enum class EventKind : uint8_t {
+    CYCLE = 0, //!< Execution of a scope, e.g. one module cycle
+    FRAME = 1  //!< Camera frame key from capture to actuator command
+};
+
+/**
+ * @brief One recorded interval
+ */
+struct Event {
+    int64_t start; //!< [ns], see now()
+    uint32_t duration; //!< [ns], saturates after about 4 s
+    ScopeId scope;
+    EventKind kind;
+    uint8_t reserved;
+    uint64_t key; //!< Frame id of FRAME events, 0 otherwise
+};
+
+struct ThreadTrace {
+    uint32_t threadId; //!< Kernel thread id
+    std::string name;
+    std::vector<Event> events; //!< Oldest first
+};
+
+/**
+ * @brief Copy of everything recorded, see snapshot()
+ */
+struct Trace {
+    std::vector<std::string> scopes; //!< Names indexed by ScopeId
+    std::vector<ThreadTrace> threads;
+};
+
+struct ScopeSummary {
+    std::string name;
+    uint64_t count;
+    double mean; //!< [us]
+    int64_t p50; //!< [us]
+    int64_t p99; //!< [us]
+    int64_t max; //!< [us]
+    uint64_t overBudget; //!< Intervals longer than the given budget
+};
+
+/**
+ * @brief scope registers a name or looks it up, call it once in
+ * initialize(), not per cycle
+ */
+ScopeId scope(const std::string &name);
+
+/**
+ * @brief record adds an interval to the histogram of its scope and to the
+ * event buffer of the calling thread, lock-free
+ * @param start [ns], see now()
+ * @param end [ns], see now()
+ */
+void record(ScopeId id, int64_t start, int64_t end, EventKind kind = EventKind::CYCLE,
+            uint64_t key = 0);
+
+/**
+ * @brief Records the lifetime of the object as one CYCLE event
+ *
+ * Put it at the top of a module's cycle():
+ *   cycle_trace::Scope trace(traceScope);
+ */
+class Scope {
+public:
+    explicit Scope(ScopeId id) : id(id), start(now()) {
+    }
+
+    ~Scope() {
+        record(id, start, now());
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    ScopeId id;
+    int64_t start;
+};
+
+/**
+ * @brief frameCaptured notes the capture time of a camera frame
+ */
+void frameCaptured(uint64_t frameId);
+
+/**
+ * @brief frameActuated records the latency from the capture of the frame to
+ * now in FRAME_SCOPE, only the first call per frame counts
+ * @return false if the frame is unknown or already actuated
+ */
+bool frameActuated(uint64_t frameId);
+
+/**
+ * @brief histogram durations of a scope [us]
+ */
+Histogram& histogram(ScopeId id);
+
+/**
+ * @brief summary statistics of all scopes that recorded something
+ * @param budget intervals longer than this count as over budget [us]
+ */
+std::vector<ScopeSummary> summary(int64_t budget);
+
+/**
+ * @brief snapshot copies the event buffers of all threads, recording
+ * continues meanwhile
+ */
+Trace snapshot();
+
+/**
+ * @brief setEnabled turns recording on or off, on by default
+ */
+void setEnabled(bool enabled);
+bool enabled();
+
+}  // namespace cycle_trace
+
+#endif // CYCLE_TRACE_TRACE_H
@@ -0,0 +1,42 @@
+#ifndef CYCLE_TRACE_TRACE_FILE_H
+#define CYCLE_TRACE_TRACE_FILE_H
+
+#include <string>
+
+#include "cycle_trace/trace.h"
+
+namespace cycle_trace {
+
+/**
+ * @brief writeBinary stores a trace in the compact binary format
+ *
+ * Layout, all numbers unsigned LEB128 varints:
+ *   "CTRC", version byte (1)
+ *   scope count, per scope: name length, name bytes
+ *   thread count, per thread: thread id, name length, name bytes, event count,
+ *   per event: zig-zag start delta to the previous event of the thread [ns],
+ *   duration [ns], scope id, kind byte, key
+ *
+ * A 100 Hz module cycle takes about 7 bytes per event.
+ */
+bool writeBinary(const Trace &trace, const std::string &path);
+
+/**
+ * @brief readBinary loads a trace written by writeBinary()
+ * @return false if the file cannot be read or is malformed
+ */
+bool readBinary(const std::string &path, Trace *trace);
+
+/**
+ * @brief writeChromeTrace exports a trace as Chrome trace event JSON, opened
+ * by chrome://tracing and ui.perfetto.dev
+ *
+ * CYCLE events become complete events on the thread that recorded them,
+ * FRAME events async events from capture to actuator command. Timestamps
+ * start at the oldest event.
+ */
+bool writeChromeTrace(const Trace &trace, const std::string &path);
+
+}  // namespace cycle_trace
+
+#endif // CYCLE_TRACE_TRACE_FILE_H
@@ -0,0 +1,102 @@
+#include "cycle_trace/histogram.h"
+
+namespace cycle_trace {
+
+Histogram::Histogram() {
+    reset();
+}
+
+void Histogram::record(int64_t value) {
+    if(value < 0) {
+        value = 0;
+    }
+    buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+
+    int64_t current = maximum.load(std::memory_order_relaxed);
+    while(value > current && ! maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::reset() {
+    for(std::atomic<uint32_t> &bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+uint64_t Histogram::count() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+int64_t Histogram::max() const {
+    return maximum.load(std::memory_order_relaxed);
+}
+
+double Histogram::mean() const {
+    uint64_t n = count();
+    return n == 0 ? 0 : static_cast<double>(sum.load(std::memory_order_relaxed)) / n;
+}
+
+int64_t Histogram::percentile(double fraction) const {
+    // the bucket counts may run ahead of total while recording, count them
+    // first so the walk below always ends in a bucket
+    uint64_t counted = 0;
+    for(const std::atomic<uint32_t> &bucket : buckets) {
+        counted += bucket.load(std::memory_order_relaxed);
+    }
+    if(counted == 0) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(fraction * counted);
+    if(rank >= counted) {
+        rank = counted - 1;
+    }
+    uint64_t seen = 0;
+    for(int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if(seen > rank) {
+            int64_t bound = bucketUpperBound(i);
+            int64_t largest = max();
+            return bound < largest ? bound : largest;
+        }
+    }
+    return max();
+}
+
+uint64_t Histogram::countAbove(int64_t limit) const {
+    uint64_t above = 0;
+    for(int i = bucketIndex(limit) + 1; i < BUCKETS; i++) {
+        above += buckets[i].load(std::memory_order_relaxed);
+    }
+    return above;
+}
+
+int Histogram::bucketIndex(int64_t value) {
+    if(value < SUB_BUCKETS) {
+        return static_cast<int>(value);
+    }
+
+    int exponent = 63 - __builtin_clzll(static_cast<uint64_t>(value));
+    if(exponent > MAX_EXPONENT) {
+        return BUCKETS - 1;
+    }
+    // the SUB_BUCKET_BITS bits below the leading one select the bucket
+    int shift = exponent - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + static_cast<int>((value >> shift) - SUB_BUCKETS);
+}
+
+int64_t Histogram::bucketUpperBound(int index) {
+    if(index < SUB_BUCKETS) {
+        return index;
+    }
+    int shift = index / SUB_BUCKETS - 1;
+    int64_t lower = static_cast<int64_t>(index % SUB_BUCKETS + SUB_BUCKETS) << shift;
+    return lower + (int64_t(1) << shift) - 1;
+}
+
+}  // namespace cycle_trace
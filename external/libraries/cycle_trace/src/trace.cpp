@@ -0,0 +1,246 @@
+#include "cycle_trace/trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace cycle_trace {
+
+namespace {
+
+/**
+ * @brief Camera frames that can wait for their actuator command at the same
+ * time, a frame is forgotten when a frame FRAME_SLOTS ids later is captured
+ */
+const unsigned int FRAME_SLOTS = 64;
+
+/**
+ * @brief Event ring of one thread, written only by that thread
+ *
+ * Same scheme as sense_link::SampleRing: readers copy without locks and drop
+ * what the writer may have overwritten meanwhile.
+ */
+class ThreadBuffer {
+public:
+    ThreadBuffer() : events(new Event[THREAD_BUFFER_EVENTS]), head(0) {
+        threadId = static_cast<uint32_t>(syscall(SYS_gettid));
+        char threadName[16] = {0};
+        if(pthread_getname_np(pthread_self(), threadName, sizeof(threadName)) == 0) {
+            name = threadName;
+        }
+    }
+
+    void push(const Event &event) {
+        uint64_t index = head.load(std::memory_order_relaxed);
+        // the new head of the last push must be visible before the oldest
+        // event is overwritten, readers compare against it after copying
+        std::atomic_thread_fence(std::memory_order_release);
+        events[index & (THREAD_BUFFER_EVENTS - 1)] = event;
+        head.store(index + 1, std::memory_order_release);
+    }
+
+    void copy(ThreadTrace *trace) const {
+        trace->threadId = threadId;
+        trace->name = name;
+
+        uint64_t end = head.load(std::memory_order_acquire);
+        uint64_t begin = end > THREAD_BUFFER_EVENTS ? end - THREAD_BUFFER_EVENTS : 0;
+        std::vector<Event> copied;
+        copied.reserve(end - begin);
+        for(uint64_t i = begin; i < end; i++) {
+            copied.push_back(events[i & (THREAD_BUFFER_EVENTS - 1)]);
+        }
+
+        // events up to the current head may have been overwritten while
+        // copying, the one at the head itself may be half written
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t written = head.load(std::memory_order_relaxed);
+        uint64_t firstIntact = written >= THREAD_BUFFER_EVENTS ? written - THREAD_BUFFER_EVENTS + 1 : 0;
+        uint64_t skip = firstIntact > begin ? std::min(firstIntact - begin, end - begin) : 0;
+        trace->events.assign(copied.begin() + skip, copied.end());
+    }
+
+private:
+    uint32_t threadId;
+    std::string name;
+    std::unique_ptr<Event[]> events;
+    std::atomic<uint64_t> head;
+};
+
+struct FrameSlot {
+    std::atomic<uint64_t> key; //!< frame id + 1, 0 if free
+    std::atomic<int64_t> captured;
+};
+
+struct Registry {
+    Registry() : recording(true) {
+        for(FrameSlot &slot : frames) {
+            slot.key = 0;
+            slot.captured = 0;
+        }
+        frameScope = add(FRAME_SCOPE);
+    }
+
+    ScopeId add(const std::string &name) {
+        for(size_t i = 0; i < names.size(); i++) {
+            if(names[i] == name) {
+                return static_cast<ScopeId>(i);
+            }
+        }
+        if(names.size() == MAX_SCOPES) {
+            return MAX_SCOPES - 1;
+        }
+        histograms[names.size()].reset(new Histogram);
+        names.push_back(name);
+        return static_cast<ScopeId>(names.size() - 1);
+    }
+
+    std::mutex mutex; //!< guards names and threads, never taken while recording
+    std::vector<std::string> names;
+    std::unique_ptr<Histogram> histograms[MAX_SCOPES];
+    std::vector<std::shared_ptr<ThreadBuffer>> threads;
+
+    std::atomic<bool> recording;
+    ScopeId frameScope;
+    FrameSlot frames[FRAME_SLOTS];
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+/**
+ * @brief threadBuffer returns the buffer of the calling thread, only the first
+ * call of a thread locks the registry
+ */
+ThreadBuffer& threadBuffer() {
+    // the registry keeps the buffer after the thread ended, its events stay
+    // in the trace
+    static thread_local ThreadBuffer *buffer = nullptr;
+    if(buffer == nullptr) {
+        std::shared_ptr<ThreadBuffer> created = std::make_shared<ThreadBuffer>();
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.threads.push_back(created);
+        buffer = created.get();
+    }
+    return *buffer;
+}
+
+}  // namespace
+
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ScopeId scope(const std::string &name) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.add(name);
+}
+
+void record(ScopeId id, int64_t start, int64_t end, EventKind kind, uint64_t key) {
+    Registry &r = registry();
+    if(! r.recording.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    int64_t duration = end > start ? end - start : 0;
+    histogram(id).record(duration / 1000);
+
+    Event event;
+    event.start = start;
+    event.duration = duration > 0xFFFFFFFF ? 0xFFFFFFFF : static_cast<uint32_t>(duration);
+    event.scope = id;
+    event.kind = kind;
+    event.reserved = 0;
+    event.key = key;
+    threadBuffer().push(event);
+}
+
+void frameCaptured(uint64_t frameId) {
+    Registry &r = registry();
+    FrameSlot &slot = r.frames[frameId % FRAME_SLOTS];
+    slot.captured.store(now(), std::memory_order_relaxed);
+    slot.key.store(frameId + 1, std::memory_order_release);
+}
+
+bool frameActuated(uint64_t frameId) {
+    Registry &r = registry();
+    FrameSlot &slot = r.frames[frameId % FRAME_SLOTS];
+    uint64_t key = frameId + 1;
+    if(slot.key.load(std::memory_order_acquire) != key) {
+        return false;
+    }
+    int64_t captured = slot.captured.load(std::memory_order_relaxed);
+    // only the first actuator command after the frame counts
+    if(! slot.key.compare_exchange_strong(key, 0)) {
+        return false;
+    }
+    record(r.frameScope, captured, now(), EventKind::FRAME, frameId);
+    return true;
+}
+
+Histogram& histogram(ScopeId id) {
+    if(id >= MAX_SCOPES) {
+        id = MAX_SCOPES - 1;
+    }
+    return *registry().histograms[id];
+}
+
+std::vector<ScopeSummary> summary(int64_t budget) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    std::vector<ScopeSummary> result;
+    for(size_t i = 0; i < r.names.size(); i++) {
+        const Histogram &h = *r.histograms[i];
+        if(h.count() == 0) {
+            continue;
+        }
+        ScopeSummary s;
+        s.name = r.names[i];
+        s.count = h.count();
+        s.mean = h.mean();
+        s.p50 = h.percentile(0.5);
+        s.p99 = h.percentile(0.99);
+        s.max = h.max();
+        s.overBudget = h.countAbove(budget);
+        result.push_back(s);
+    }
+    return result;
+}
+
+Trace snapshot() {
+    Registry &r = registry();
+    Trace trace;
+    std::vector<std::shared_ptr<ThreadBuffer>> threads;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        trace.scopes = r.names;
+        threads = r.threads;
+    }
+
+    trace.threads.resize(threads.size());
+    for(size_t i = 0; i < threads.size(); i++) {
+        threads[i]->copy(&trace.threads[i]);
+    }
+    return trace;
+}
+
+void setEnabled(bool enabled) {
+    registry().recording.store(enabled, std::memory_order_relaxed);
+}
+
+bool enabled() {
+    return registry().recording.load(std::memory_order_relaxed);
+}
+
+}  // namespace cycle_trace
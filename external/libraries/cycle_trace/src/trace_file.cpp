@@ -0,0 +1,267 @@
+#include "cycle_trace/trace_file.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+namespace cycle_trace {
+
+namespace {
+
+const char MAGIC[4] = {'C', 'T', 'R', 'C'};
+const uint8_t VERSION = 1;
+
+void writeVarint(std::string &out, uint64_t value) {
+    while(value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void writeString(std::string &out, const std::string &value) {
+    writeVarint(out, value.size());
+    out.append(value);
+}
+
+/**
+ * @brief Reads the binary format, every read fails once the data ended
+ */
+class Reader {
+public:
+    explicit Reader(const std::string &data) : data(data), position(0), failed(false) {
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for(int shift = 0; shift < 64; shift += 7) {
+            if(position >= data.size()) {
+                failed = true;
+                return 0;
+            }
+            uint8_t byte = static_cast<uint8_t>(data[position++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        failed = true;
+        return 0;
+    }
+
+    uint8_t byte() {
+        if(position >= data.size()) {
+            failed = true;
+            return 0;
+        }
+        return static_cast<uint8_t>(data[position++]);
+    }
+
+    std::string string() {
+        uint64_t length = varint();
+        if(failed || length > data.size() - position) {
+            failed = true;
+            return std::string();
+        }
+        std::string value = data.substr(position, length);
+        position += length;
+        return value;
+    }
+
+    /**
+     * @brief count reads an element count, each element takes at least one byte
+     */
+    uint64_t count() {
+        uint64_t value = varint();
+        if(value > data.size() - position) {
+            failed = true;
+            return 0;
+        }
+        return value;
+    }
+
+    const std::string &data;
+    size_t position;
+    bool failed;
+};
+
+/**
+ * @brief jsonString quotes a string, escaping what JSON requires
+ */
+std::string jsonString(const std::string &value) {
+    std::string out = "\"";
+    for(char c : value) {
+        if(c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if(static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out.append(escaped);
+        } else {
+            out.push_back(c);
+        }
+    }
+    out.push_back('"');
+    return out;
+}
+
+/**
+ * @brief micros formats a nanosecond time as microseconds with 3 decimals
+ */
+std::string micros(int64_t nanoseconds) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.3f", nanoseconds / 1000.0);
+    return text;
+}
+
+}  // namespace
+
+bool writeBinary(const Trace &trace, const std::string &path) {
+    std::string out(MAGIC, sizeof(MAGIC));
+    out.push_back(static_cast<char>(VERSION));
+
+    writeVarint(out, trace.scopes.size());
+    for(const std::string &name : trace.scopes) {
+        writeString(out, name);
+    }
+
+    writeVarint(out, trace.threads.size());
+    for(const ThreadTrace &thread : trace.threads) {
+        writeVarint(out, thread.threadId);
+        writeString(out, thread.name);
+        writeVarint(out, thread.events.size());
+
+        int64_t previous = 0;
+        for(const Event &event : thread.events) {
+            int64_t delta = event.start - previous;
+            previous = event.start;
+            // FRAME events start at the capture time, before the events
+            // recorded just ahead of them
+            writeVarint(out, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+            writeVarint(out, event.duration);
+            writeVarint(out, event.scope);
+            out.push_back(static_cast<char>(event.kind));
+            writeVarint(out, event.key);
+        }
+    }
+
+    std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+    file.write(out.data(), out.size());
+    return file.good();
+}
+
+bool readBinary(const std::string &path, Trace *trace) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if(! file) {
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if(data.size() < sizeof(MAGIC) + 1 || data.compare(0, sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0
+            || static_cast<uint8_t>(data[sizeof(MAGIC)]) != VERSION) {
+        return false;
+    }
+
+    Reader reader(data);
+    reader.position = sizeof(MAGIC) + 1;
+    Trace result;
+
+    uint64_t scopes = reader.count();
+    for(uint64_t i = 0; i < scopes && ! reader.failed; i++) {
+        result.scopes.push_back(reader.string());
+    }
+
+    uint64_t threads = reader.count();
+    for(uint64_t i = 0; i < threads && ! reader.failed; i++) {
+        ThreadTrace thread;
+        thread.threadId = static_cast<uint32_t>(reader.varint());
+        thread.name = reader.string();
+        uint64_t events = reader.count();
+        thread.events.reserve(events);
+
+        int64_t previous = 0;
+        for(uint64_t j = 0; j < events && ! reader.failed; j++) {
+            uint64_t zigzag = reader.varint();
+            Event event;
+            event.start = previous + static_cast<int64_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+            previous = event.start;
+            uint64_t duration = reader.varint();
+            event.duration = duration > std::numeric_limits<uint32_t>::max()
+                    ? std::numeric_limits<uint32_t>::max() : static_cast<uint32_t>(duration);
+            uint64_t scope = reader.varint();
+            if(scope >= result.scopes.size()) {
+                reader.failed = true;
+            }
+            event.scope = static_cast<ScopeId>(scope);
+            event.kind = static_cast<EventKind>(reader.byte());
+            event.reserved = 0;
+            event.key = reader.varint();
+            thread.events.push_back(event);
+        }
+        result.threads.push_back(thread);
+    }
+
+    if(reader.failed) {
+        return false;
+    }
+    *trace = result;
+    return true;
+}
+
+bool writeChromeTrace(const Trace &trace, const std::string &path) {
+    int64_t origin = std::numeric_limits<int64_t>::max();
+    for(const ThreadTrace &thread : trace.threads) {
+        for(const Event &event : thread.events) {
+            origin = std::min(origin, event.start);
+        }
+    }
+
+    std::ofstream file(path.c_str(), std::ios::trunc);
+    if(! file) {
+        return false;
+    }
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    auto separate = [&file, &first]() {
+        if(! first) {
+            file << ",\n";
+        }
+        first = false;
+    };
+
+    for(const ThreadTrace &thread : trace.threads) {
+        if(! thread.name.empty()) {
+            separate();
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.threadId
+                 << ",\"args\":{\"name\":" << jsonString(thread.name) << "}}";
+        }
+
+        for(const Event &event : thread.events) {
+            std::string name = event.scope < trace.scopes.size()
+                    ? jsonString(trace.scopes[event.scope]) : "\"?\"";
+            if(event.kind == EventKind::FRAME) {
+                // async begin/end pair, matched by category and id
+                separate();
+                file << "{\"name\":" << name << ",\"cat\":\"frame\",\"ph\":\"b\",\"id\":" << event.key
+                     << ",\"pid\":1,\"tid\":" << thread.threadId
+                     << ",\"ts\":" << micros(event.start - origin) << "},\n"
+                     << "{\"name\":" << name << ",\"cat\":\"frame\",\"ph\":\"e\",\"id\":" << event.key
+                     << ",\"pid\":1,\"tid\":" << thread.threadId
+                     << ",\"ts\":" << micros(event.start - origin + event.duration) << "}";
+            } else {
+                separate();
+                file << "{\"name\":" << name << ",\"cat\":\"cycle\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                     << thread.threadId << ",\"ts\":" << micros(event.start - origin)
+                     << ",\"dur\":" << micros(event.duration) << "}";
+            }
+        }
+    }
+
+    file << "\n]}\n";
+    return file.good();
+}
+
+}  // namespace cycle_trace
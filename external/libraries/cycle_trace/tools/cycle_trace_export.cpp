@@ -0,0 +1,58 @@
+/**
+ * Converts a binary cycle trace to Chrome trace JSON and prints the duration
+ * statistics of every scope.
+ *
+ * Usage: cycle_trace_export <trace.ctrace> [trace.json] [budget us]
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cycle_trace/trace_file.h"
+
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        std::fprintf(stderr, "Usage: %s <trace.ctrace> [trace.json] [budget us]\n", argv[0]);
+        return 1;
+    }
+
+    cycle_trace::Trace trace;
+    if(! cycle_trace::readBinary(argv[1], &trace)) {
+        std::fprintf(stderr, "Could not read %s\n", argv[1]);
+        return 1;
+    }
+
+    std::string json = argc > 2 ? argv[2] : std::string(argv[1]) + ".json";
+    if(! cycle_trace::writeChromeTrace(trace, json)) {
+        std::fprintf(stderr, "Could not write %s\n", json.c_str());
+        return 1;
+    }
+    int64_t budget = argc > 3 ? std::atoll(argv[3]) : 10000;
+
+    std::vector<std::unique_ptr<cycle_trace::Histogram>> histograms;
+    for(size_t i = 0; i < trace.scopes.size(); i++) {
+        histograms.emplace_back(new cycle_trace::Histogram);
+    }
+    for(const cycle_trace::ThreadTrace &thread : trace.threads) {
+        for(const cycle_trace::Event &event : thread.events) {
+            histograms[event.scope]->record(event.duration / 1000);
+        }
+    }
+
+    std::printf("%-32s %8s %8s %8s %8s %8s\n", "scope [us]", "count", "p50", "p99", "max", ">budget");
+    for(size_t i = 0; i < trace.scopes.size(); i++) {
+        const cycle_trace::Histogram &h = *histograms[i];
+        if(h.count() > 0) {
+            std::printf("%-32s %8llu %8lld %8lld %8lld %8llu\n", trace.scopes[i].c_str(),
+                        static_cast<unsigned long long>(h.count()),
+                        static_cast<long long>(h.percentile(0.5)),
+                        static_cast<long long>(h.percentile(0.99)),
+                        static_cast<long long>(h.max()),
+                        static_cast<unsigned long long>(h.countAbove(budget)));
+        }
+    }
+    std::printf("Chrome trace written to %s\n", json.c_str());
+    return 0;
+}
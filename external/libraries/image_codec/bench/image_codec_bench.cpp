@@ -0,0 +1,296 @@
+/**
+ * Round trip checks, size and speed of every level of the quality ladder,
+ * and the rate controller on a simulated WiFi link whose throughput
+ * changes. The images are synthetic: a road with lane markings and sensor
+ * noise, moving from frame to frame.
+ *
+ * Usage: image_codec_bench [--width N] [--height N] [--frames N] [--noise N]
+ *
+ * --width, --height  image size, default 188x87 (IMAGE of car.xml)
+ * --frames           frames per level, default 500
+ * --noise            sensor noise amplitude, default 3
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "image_codec/codec.h"
+#include "image_codec/rate_controller.h"
+
+using namespace image_codec;
+
+namespace {
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class RoadScene {
+public:
+    RoadScene(int width, int height, int noise) : width(width), height(height), noise(noise),
+        random(7), pixels(width * height) {
+    }
+
+    const std::vector<uint8_t>& frame(int index) {
+        std::uniform_int_distribution<int> jitter(-noise, noise);
+        double curve = 0.3 * std::sin(index * 0.01);
+        for(int y = 0; y < height; y++) {
+            double depth = (y + 1.0) / height;
+            double center = width / 2.0 + curve * width * (1 - depth) * (1 - depth);
+            double half = width * (0.1 + 0.35 * depth);
+            for(int x = 0; x < width; x++) {
+                int value = 60 + 40 * y / height;
+                double dx = x - center;
+                if(std::abs(std::abs(dx) - half) < 1 + 2 * depth) {
+                    value = 220;
+                } else if(std::abs(dx) < 1 + depth
+                          && static_cast<int>(y * (1 + depth) + index) % 20 < 10) {
+                    value = 200;
+                }
+                value += jitter(random);
+                pixels[y * width + x] = static_cast<uint8_t>(std::max(0, std::min(255, value)));
+            }
+        }
+        return pixels;
+    }
+
+    int width;
+    int height;
+    int noise;
+
+private:
+    std::mt19937 random;
+    std::vector<uint8_t> pixels;
+};
+
+bool check(bool condition, const char *what) {
+    if(! condition) {
+        std::printf("FAILED: %s\n", what);
+    }
+    return condition;
+}
+
+bool roundTrips(RoadScene &scene) {
+    bool ok = true;
+    Encoder encoder;
+    Decoder decoder;
+    EncodedFrame frame;
+    const std::vector<uint8_t> &image = scene.frame(0);
+
+    for(int shift = 0; shift <= 7; shift++) {
+        EncodeParams params;
+        params.shift = shift;
+        encoder.encode(image.data(), scene.width, scene.height, scene.width, 1, params, &frame);
+
+        // through the serialization like over socket_data
+        std::stringstream stream;
+        frame.serialize(stream);
+        EncodedFrame received;
+        ok &= check(received.deserialize(stream), "deserialize");
+        ok &= check(decoder.decode(received), "decode");
+
+        int maxError = 0;
+        for(size_t i = 0; i < image.size(); i++) {
+            maxError = std::max(maxError, std::abs(decoder.data()[i] - image[i]));
+        }
+        int allowed = shift > 0 ? 1 << (shift - 1) : 0;
+        ok &= check(maxError <= allowed, shift == 0 ? "lossless is exact" : "lossy error bound");
+    }
+
+    // a frame with only some rows leaves the others alone
+    std::vector<uint8_t> before(decoder.data(), decoder.data() + image.size());
+    const std::vector<uint8_t> &next = scene.frame(50);
+    EncodeParams roi;
+    roi.top = scene.height / 2;
+    encoder.encode(next.data(), scene.width, scene.height, scene.width, 1, roi, &frame);
+    ok &= check(decoder.decode(frame), "decode roi");
+    size_t split = static_cast<size_t>(roi.top) * scene.width;
+    ok &= check(std::equal(before.begin(), before.begin() + split, decoder.data()), "rows above roi");
+    ok &= check(std::equal(next.begin() + split, next.end(), decoder.data() + split), "roi rows");
+
+    // corrupted frames must be rejected or decode to something, never crash
+    std::mt19937 random(1);
+    EncodeParams lossless;
+    encoder.encode(image.data(), scene.width, scene.height, scene.width, 1, lossless, &frame);
+    int rejected = 0;
+    for(int i = 0; i < 2000; i++) {
+        EncodedFrame corrupted = frame;
+        for(int j = 0; j < 1 + i % 8; j++) {
+            corrupted.payload[random() % corrupted.payload.size()] = static_cast<uint8_t>(random());
+        }
+        if(i % 3 == 0) {
+            corrupted.payload.resize(random() % corrupted.payload.size());
+        }
+        rejected += decoder.decode(corrupted) ? 0 : 1;
+    }
+    std::printf("round trips %s, %d of 2000 corrupted frames rejected\n", ok ? "ok" : "FAILED",
+                rejected);
+    return ok;
+}
+
+void levels(RoadScene &scene, int frames) {
+    std::printf("\n%dx%d, %d frames per level, raw %d bytes\n", scene.width, scene.height, frames,
+                scene.width * scene.height);
+    std::printf("level shift skip roi  bytes/frame  ratio  encode us  decode us\n");
+    for(int l = 0; l < RateController::LEVEL_COUNT; l++) {
+        const Level &level = RateController::LEVELS[l];
+        Encoder encoder;
+        Decoder decoder;
+        EncodedFrame frame;
+        int64_t encodeTime = 0;
+        int64_t decodeTime = 0;
+        size_t bytes = 0;
+        int encoded = 0;
+        for(int i = 0; i < frames; i++) {
+            const std::vector<uint8_t> &image = scene.frame(i);
+            EncodeParams params;
+            params.shift = level.shift;
+            params.skip = encoder.nextSequence() % level.skip != 0;
+            if(level.roi) {
+                params.top = scene.height / 3;
+            }
+            int64_t start = nowNanos();
+            encoder.encode(image.data(), scene.width, scene.height, scene.width, 1, params, &frame);
+            int64_t middle = nowNanos();
+            decoder.decode(frame);
+            int64_t end = nowNanos();
+            bytes += frame.size();
+            if(! frame.skipped()) {
+                encodeTime += middle - start;
+                decodeTime += end - middle;
+                encoded++;
+            }
+        }
+        double perFrame = static_cast<double>(bytes) / frames;
+        std::printf("%5d %5d %4d %3s %12.0f %6.1f %10.1f %10.1f\n", l, level.shift, level.skip,
+                    level.roi ? "yes" : "no", perFrame, scene.width * scene.height / perFrame,
+                    encodeTime / 1000.0 / encoded, decodeTime / 1000.0 / encoded);
+    }
+}
+
+/**
+ * @brief A link that delivers bytes at a given rate after a fixed delay,
+ * frames queue behind each other
+ */
+void simulateLink(RoadScene &scene) {
+    struct Phase {
+        double seconds;
+        double bytesPerSecond;
+    };
+    const Phase phases[] = {{3, 3e6}, {5, 60e3}, {5, 400e3}, {3, 0}, {5, 3e6}};
+    const int64_t frameMicros = 10000; // 100 Hz
+    const int64_t delayMicros = 3000;
+
+    RateOptions options;
+    RateController controller(options);
+    Encoder encoder;
+    Decoder decoder;
+    EncodedFrame frame;
+
+    struct InFlight {
+        uint32_t sequence;
+        size_t bytes;
+        int64_t sent;
+        int64_t arrives;
+    };
+    std::deque<InFlight> queue;
+    int64_t linkFree = 0; //!< when the link finished the queued bytes
+    LinkReport report;
+    std::deque<std::pair<int64_t, LinkReport>> reports; //!< on their way back
+
+    std::printf("\nsimulated link, 100 Hz frames, %lld ms delay each way\n",
+                static_cast<long long>(delayMicros / 1000));
+    std::printf("time  link kB/s  level  frames/s  kB/s  latency ms  in flight\n");
+
+    int64_t now = 0;
+    int frameIndex = 0;
+    for(const Phase &phase : phases) {
+        int64_t phaseEnd = now + static_cast<int64_t>(phase.seconds * 1e6);
+        while(now < phaseEnd) {
+            int64_t secondEnd = now + 1000000;
+            int delivered = 0;
+            size_t deliveredBytes = 0;
+            int64_t latency = 0;
+            int levelSum = 0;
+            int steps = 0;
+            for(; now < secondEnd; now += frameMicros) {
+                while(! reports.empty() && reports.front().first <= now) {
+                    controller.report(reports.front().second, now);
+                    reports.pop_front();
+                }
+
+                const std::vector<uint8_t> &image = scene.frame(frameIndex++);
+                EncodeParams params = controller.params(encoder.nextSequence(), scene.height / 3,
+                                                        scene.height, now);
+                encoder.encode(image.data(), scene.width, scene.height, scene.width, 1, params,
+                               &frame);
+                controller.sent(frame.sequence, frame.size(), now);
+                levelSum += controller.level();
+                steps++;
+
+                if(phase.bytesPerSecond > 0) {
+                    linkFree = std::max(linkFree, now)
+                            + static_cast<int64_t>(frame.size() * 1e6 / phase.bytesPerSecond);
+                    queue.push_back({frame.sequence, frame.size(), now, linkFree + delayMicros});
+                }
+
+                while(! queue.empty() && queue.front().arrives <= now) {
+                    const InFlight &arrived = queue.front();
+                    report.lastSequence = arrived.sequence;
+                    report.frames++;
+                    report.bytes += arrived.bytes;
+                    report.timestamp = now;
+                    reports.push_back(std::make_pair(now + delayMicros, report));
+                    delivered++;
+                    deliveredBytes += arrived.bytes;
+                    latency += now - arrived.sent;
+                    queue.pop_front();
+                }
+            }
+            std::printf("%4lld %10.0f %6.1f %9d %5.0f %11.1f %10d\n",
+                        static_cast<long long>(now / 1000000), phase.bytesPerSecond / 1000,
+                        static_cast<double>(levelSum) / steps, delivered, deliveredBytes / 1000.0,
+                        delivered > 0 ? latency / 1000.0 / delivered : 0.0, controller.inFlight());
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    int width = 188;
+    int height = 87;
+    int frames = 500;
+    int noise = 3;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if(arg == "--width") {
+            width = std::atoi(argv[i + 1]);
+        } else if(arg == "--height") {
+            height = std::atoi(argv[i + 1]);
+        } else if(arg == "--frames") {
+            frames = std::atoi(argv[i + 1]);
+        } else if(arg == "--noise") {
+            noise = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    RoadScene scene(width, height, noise);
+    if(! roundTrips(scene)) {
+        return 1;
+    }
+    levels(scene, frames);
+    simulateLink(scene);
+    return 0;
+}
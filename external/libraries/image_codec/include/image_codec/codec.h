@@ -0,0 +1,138 @@
+#ifndef IMAGE_CODEC_CODEC_H
+#define IMAGE_CODEC_CODEC_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "image_codec/lz.h"
+
+namespace image_codec {
+
+/**
+ * @brief Compressed image as it goes over the link, the value of the
+ * IMAGE_ENCODED channel
+ */
+struct EncodedFrame {
+    EncodedFrame() : sequence(0), width(0), height(0), bytesPerPixel(0), format(0), shift(0),
+        top(0), bottom(0), rawSize(0) {
+    }
+
+    uint32_t sequence; //!< frame number of the encoder
+    uint16_t width; //!< [px]
+    uint16_t height; //!< [px]
+    uint8_t bytesPerPixel;
+    uint8_t format; //!< pixel format of the sender, passed through
+    uint8_t shift; //!< low bits dropped per byte, 0 for lossless
+    uint16_t top; //!< first row in the payload
+    uint16_t bottom; //!< row after the last one in the payload
+    uint32_t rawSize; //!< residual bytes before LZ compression
+    std::vector<uint8_t> payload; //!< empty if the frame was skipped
+
+    bool skipped() const {
+        return payload.empty();
+    }
+
+    size_t size() const;
+
+    /**
+     * @brief serialize writes the frame little endian for the channel
+     * serialization of socket_data
+     */
+    bool serialize(std::ostream &os) const;
+
+    /**
+     * @brief deserialize reads a frame, rejecting sizes the header does not
+     * allow
+     */
+    bool deserialize(std::istream &is);
+};
+
+/**
+ * @brief What to encode of a frame
+ */
+struct EncodeParams {
+    EncodeParams() : shift(0), top(0), bottom(0), skip(false) {
+    }
+
+    int shift; //!< low bits to drop, 0 to 7
+    int top; //!< first row to send
+    int bottom; //!< row after the last one to send, 0 for the image height
+    bool skip; //!< send an empty frame, the receiver keeps the last image
+};
+
+/**
+ * @brief Predicts every byte from its left, upper and upper left neighbour
+ * (the median predictor of LOCO-I), stores the differences and compresses
+ * them with LzCompressor
+ *
+ * Lossless with shift 0. Otherwise the bytes are quantized first, which
+ * turns most differences into runs of zeros. The buffers are kept across
+ * frames, nothing is allocated once the size is stable.
+ */
+class Encoder {
+public:
+    Encoder();
+
+    /**
+     * @param stride bytes from one row to the next
+     */
+    bool encode(const uint8_t *pixels, int width, int height, int stride, int bytesPerPixel,
+                const EncodeParams &params, EncodedFrame *frame, uint8_t format = 0);
+
+    /**
+     * @brief nextSequence sequence number the next frame gets
+     */
+    uint32_t nextSequence() const {
+        return sequence + 1;
+    }
+
+private:
+    LzCompressor compressor;
+    std::vector<uint8_t> residuals;
+    uint32_t sequence;
+};
+
+/**
+ * @brief Decodes EncodedFrames into a persistent image
+ *
+ * Rows outside the frame's row range and skipped frames keep the content of
+ * earlier frames.
+ */
+class Decoder {
+public:
+    Decoder();
+
+    /**
+     * @return false for malformed frames, the image is unchanged then
+     */
+    bool decode(const EncodedFrame &frame);
+
+    const uint8_t* data() const {
+        return image.data();
+    }
+
+    int width() const {
+        return imageWidth;
+    }
+
+    int height() const {
+        return imageHeight;
+    }
+
+    int bytesPerPixel() const {
+        return imageBytesPerPixel;
+    }
+
+private:
+    std::vector<uint8_t> image;
+    std::vector<uint8_t> residuals;
+    int imageWidth;
+    int imageHeight;
+    int imageBytesPerPixel;
+};
+
+}  // namespace image_codec
+
+#endif // IMAGE_CODEC_CODEC_H
@@ -0,0 +1,44 @@
+#ifndef IMAGE_CODEC_LZ_H
+#define IMAGE_CODEC_LZ_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace image_codec {
+
+/**
+ * @brief LZ77 compressor in the LZ4 block format: a token with 4 bit
+ * literal and match lengths, the literals, a 16 bit offset, length bytes
+ * of 255 for longer runs
+ *
+ * Greedy matching with one hash table entry per 4 byte prefix, tuned for
+ * speed over ratio: the residual images of the codec are mostly runs.
+ */
+class LzCompressor {
+public:
+    /**
+     * @brief bound largest compressed size of size input bytes
+     */
+    static size_t bound(size_t size);
+
+    /**
+     * @param out at least bound(size) bytes
+     * @return compressed size
+     */
+    size_t compress(const uint8_t *in, size_t size, uint8_t *out);
+
+private:
+    static const int HASH_BITS = 12;
+    uint32_t table[1 << HASH_BITS]; //!< last input position per hash
+};
+
+/**
+ * @brief lzDecompress decodes exactly outSize bytes, checking every length
+ * and offset against both buffers
+ * @return false if the input is malformed or does not fill out
+ */
+bool lzDecompress(const uint8_t *in, size_t size, uint8_t *out, size_t outSize);
+
+}  // namespace image_codec
+
+#endif // IMAGE_CODEC_LZ_H
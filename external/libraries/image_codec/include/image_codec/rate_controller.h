@@ -0,0 +1,126 @@
+#ifndef IMAGE_CODEC_RATE_CONTROLLER_H
+#define IMAGE_CODEC_RATE_CONTROLLER_H
+
+#include <cstdint>
+
+#include "image_codec/codec.h"
+
+namespace image_codec {
+
+/**
+ * @brief What the receiving side got so far, sent back with the control
+ * traffic as the IMAGE_LINK channel
+ */
+struct LinkReport {
+    LinkReport() : lastSequence(0), frames(0), bytes(0), timestamp(0) {
+    }
+
+    uint32_t lastSequence; //!< newest frame received
+    uint32_t frames; //!< frames received
+    uint64_t bytes; //!< bytes received, header included
+    int64_t timestamp; //!< receiver clock [us], only differences are used
+
+    bool serialize(std::ostream &os) const;
+    bool deserialize(std::istream &is);
+};
+
+/**
+ * @brief One step of the quality ladder
+ */
+struct Level {
+    int shift; //!< low bits dropped
+    int skip; //!< send every skip-th frame
+    bool roi; //!< only the rows of the region of interest
+};
+
+struct RateOptions {
+    RateOptions() : maxBytesPerSecond(0), maxInFlight(4), holdFrames(10), probeFrames(100),
+        staleMicros(1000000), minLevel(0), maxLevel(-1) {
+    }
+
+    double maxBytesPerSecond; //!< cap for the images, leaves the rest to control traffic, 0 for none
+    int maxInFlight; //!< frames sent but not reported received before degrading
+    int holdFrames; //!< frames between two degradations
+    int probeFrames; //!< calm frames before trying a better level
+    int64_t staleMicros; //!< without reports for this long the worst level is used
+    int minLevel; //!< best level to use
+    int maxLevel; //!< worst level to use, -1 for the end of the ladder
+};
+
+/**
+ * @brief Picks the quality level from the receiver's reports
+ *
+ * The link queues when frames in flight (sent but not reported received yet)
+ * pile up, or the images exceed maxBytesPerSecond. Then the level gets worse, one step
+ * per holdFrames so a step shows its effect first. After probeFrames without
+ * queueing the next better level is tried. Without reports the link is
+ * considered down and the worst level keeps the control traffic going.
+ * While more than maxInFlight frames are in flight, every frame is skipped.
+ */
+class RateController {
+public:
+    static const Level LEVELS[];
+    static const int LEVEL_COUNT;
+
+    explicit RateController(const RateOptions &options = RateOptions());
+
+    /**
+     * @brief report feeds a LinkReport, repeated ones are ignored
+     * @param now sender clock [us]
+     */
+    void report(const LinkReport &report, int64_t now);
+
+    /**
+     * @brief next parameters for the frame with the given sequence number
+     */
+    EncodeParams params(uint32_t sequence, int roiTop, int roiBottom, int64_t now);
+
+    /**
+     * @brief sent tells the bytes of an encoded frame that went out
+     */
+    void sent(uint32_t sequence, size_t bytes, int64_t now);
+
+    int level() const {
+        return current;
+    }
+
+    int inFlight() const;
+
+    /**
+     * @brief throughput bytes per second the receiver reported, 0 if unknown
+     */
+    double throughput() const {
+        return receiveRate;
+    }
+
+    /**
+     * @brief sendRate bytes per second sent, 0 if unknown
+     */
+    double sendRate() const {
+        return sentRate;
+    }
+
+private:
+    void change(int level);
+
+    RateOptions options;
+    int current;
+    int maxLevel;
+    int sinceChange;
+    int calmFrames;
+
+    LinkReport last;
+    LinkReport window; //!< report the receive rate is measured from
+    int64_t lastReportTime; //!< sender clock
+    double receiveRate;
+
+    uint32_t lastSent;
+    uint64_t sentBytes;
+    uint64_t windowBytes; //!< sentBytes at windowStart
+    int64_t windowStart;
+    double sentRate;
+};
+
+}  // namespace image_codec
+
+#endif // IMAGE_CODEC_RATE_CONTROLLER_H
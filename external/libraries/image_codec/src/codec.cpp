@@ -0,0 +1,225 @@
+#include "image_codec/codec.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace image_codec {
+
+namespace {
+
+const char MAGIC[2] = {'I', 'C'};
+const uint8_t VERSION = 1;
+
+/**
+ * @brief Median edge detector: the median of left, up and the gradient
+ * left + up - upLeft, written without branches since camera noise makes
+ * them unpredictable
+ */
+inline int predict(int left, int up, int upLeft) {
+    int low = std::min(left, up);
+    int high = std::max(left, up);
+    return std::max(low, std::min(high, left + up - upLeft));
+}
+
+/*
+ * The first row of a frame's range is predicted from the left only, the
+ * first pixel of every other row from above. Predictions use the quantized
+ * values, the decoder gets them back from its pixels by the same shift.
+ */
+
+void encodeRow(const uint8_t *row, const uint8_t *up, int rowBytes, int bytesPerPixel, int shift,
+               uint8_t *out) {
+    if(up == nullptr) {
+        for(int x = 0; x < bytesPerPixel; x++) {
+            out[x] = static_cast<uint8_t>(row[x] >> shift);
+        }
+        for(int x = bytesPerPixel; x < rowBytes; x++) {
+            out[x] = static_cast<uint8_t>((row[x] >> shift) - (row[x - bytesPerPixel] >> shift));
+        }
+        return;
+    }
+    for(int x = 0; x < bytesPerPixel; x++) {
+        out[x] = static_cast<uint8_t>((row[x] >> shift) - (up[x] >> shift));
+    }
+    for(int x = bytesPerPixel; x < rowBytes; x++) {
+        int prediction = predict(row[x - bytesPerPixel] >> shift, up[x] >> shift,
+                                 up[x - bytesPerPixel] >> shift);
+        out[x] = static_cast<uint8_t>((row[x] >> shift) - prediction);
+    }
+}
+
+/**
+ * @brief decodeRow stores the midpoint of each quantization step
+ */
+void decodeRow(uint8_t *row, const uint8_t *up, int rowBytes, int bytesPerPixel, int shift,
+               const uint8_t *in) {
+    const int half = shift > 0 ? 1 << (shift - 1) : 0;
+    for(int x = 0; x < bytesPerPixel; x++) {
+        int prediction = up != nullptr ? up[x] >> shift : 0;
+        row[x] = static_cast<uint8_t>(static_cast<uint8_t>(prediction + in[x]) << shift | half);
+    }
+
+    if(bytesPerPixel == 1) {
+        // grey: the left value stays in a register instead of being read
+        // back from the byte just stored
+        int left = row[0] >> shift;
+        for(int x = 1; x < rowBytes; x++) {
+            int prediction = up != nullptr ? predict(left, up[x] >> shift, up[x - 1] >> shift) : left;
+            left = static_cast<uint8_t>(prediction + in[x]);
+            row[x] = static_cast<uint8_t>(left << shift | half);
+        }
+        return;
+    }
+
+    for(int x = bytesPerPixel; x < rowBytes; x++) {
+        int left = row[x - bytesPerPixel] >> shift;
+        int prediction = up != nullptr
+                ? predict(left, up[x] >> shift, up[x - bytesPerPixel] >> shift) : left;
+        row[x] = static_cast<uint8_t>(static_cast<uint8_t>(prediction + in[x]) << shift | half);
+    }
+}
+
+template<typename T>
+void writeValue(std::ostream &os, T value) {
+    uint8_t bytes[sizeof(T)];
+    for(size_t i = 0; i < sizeof(T); i++) {
+        bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    os.write(reinterpret_cast<const char*>(bytes), sizeof(T));
+}
+
+template<typename T>
+bool readValue(std::istream &is, T &value) {
+    uint8_t bytes[sizeof(T)];
+    if(! is.read(reinterpret_cast<char*>(bytes), sizeof(T))) {
+        return false;
+    }
+    value = 0;
+    for(size_t i = 0; i < sizeof(T); i++) {
+        value = static_cast<T>(value | static_cast<T>(bytes[i]) << (8 * i));
+    }
+    return true;
+}
+
+}  // namespace
+
+size_t EncodedFrame::size() const {
+    // header and payload on the wire
+    return 2 + 1 + 4 + 2 + 2 + 1 + 1 + 1 + 2 + 2 + 4 + 4 + payload.size();
+}
+
+bool EncodedFrame::serialize(std::ostream &os) const {
+    os.write(MAGIC, sizeof(MAGIC));
+    writeValue(os, VERSION);
+    writeValue(os, sequence);
+    writeValue(os, width);
+    writeValue(os, height);
+    writeValue(os, bytesPerPixel);
+    writeValue(os, format);
+    writeValue(os, shift);
+    writeValue(os, top);
+    writeValue(os, bottom);
+    writeValue(os, rawSize);
+    writeValue(os, static_cast<uint32_t>(payload.size()));
+    os.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+    return os.good();
+}
+
+bool EncodedFrame::deserialize(std::istream &is) {
+    char magic[2];
+    uint8_t version;
+    uint32_t payloadSize;
+    if(! is.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+            || ! readValue(is, version) || version != VERSION
+            || ! readValue(is, sequence) || ! readValue(is, width) || ! readValue(is, height)
+            || ! readValue(is, bytesPerPixel) || ! readValue(is, format) || ! readValue(is, shift)
+            || ! readValue(is, top) || ! readValue(is, bottom)
+            || ! readValue(is, rawSize) || ! readValue(is, payloadSize)) {
+        return false;
+    }
+    size_t maxRaw = static_cast<size_t>(width) * height * bytesPerPixel;
+    if(shift > 7 || bytesPerPixel == 0 || bytesPerPixel > 4 || top > bottom || bottom > height
+            || rawSize > maxRaw || payloadSize > LzCompressor::bound(rawSize)) {
+        return false;
+    }
+    payload.resize(payloadSize);
+    return payloadSize == 0 || is.read(reinterpret_cast<char*>(payload.data()), payloadSize);
+}
+
+Encoder::Encoder() : sequence(0) {
+}
+
+bool Encoder::encode(const uint8_t *pixels, int width, int height, int stride, int bytesPerPixel,
+                     const EncodeParams &params, EncodedFrame *frame, uint8_t format) {
+    int bottom = params.bottom > 0 ? std::min(params.bottom, height) : height;
+    int top = std::max(0, std::min(params.top, bottom));
+    if(width <= 0 || height <= 0 || width > 65535 || height > 65535 || bytesPerPixel < 1
+            || bytesPerPixel > 4 || params.shift < 0 || params.shift > 7) {
+        return false;
+    }
+
+    frame->sequence = ++sequence;
+    frame->width = static_cast<uint16_t>(width);
+    frame->height = static_cast<uint16_t>(height);
+    frame->bytesPerPixel = static_cast<uint8_t>(bytesPerPixel);
+    frame->format = format;
+    frame->shift = static_cast<uint8_t>(params.shift);
+    frame->top = static_cast<uint16_t>(top);
+    frame->bottom = static_cast<uint16_t>(bottom);
+    frame->payload.clear();
+    frame->rawSize = 0;
+    if(params.skip || top == bottom) {
+        return true;
+    }
+
+    const int rowBytes = width * bytesPerPixel;
+    residuals.resize(static_cast<size_t>(rowBytes) * (bottom - top));
+    for(int y = top; y < bottom; y++) {
+        const uint8_t *row = pixels + static_cast<size_t>(y) * stride;
+        encodeRow(row, y > top ? row - stride : nullptr, rowBytes, bytesPerPixel, params.shift,
+                  residuals.data() + static_cast<size_t>(y - top) * rowBytes);
+    }
+
+    frame->rawSize = static_cast<uint32_t>(residuals.size());
+    frame->payload.resize(LzCompressor::bound(residuals.size()));
+    frame->payload.resize(compressor.compress(residuals.data(), residuals.size(),
+                                              frame->payload.data()));
+    return true;
+}
+
+Decoder::Decoder() : imageWidth(0), imageHeight(0), imageBytesPerPixel(0) {
+}
+
+bool Decoder::decode(const EncodedFrame &frame) {
+    if(frame.width != imageWidth || frame.height != imageHeight
+            || frame.bytesPerPixel != imageBytesPerPixel) {
+        imageWidth = frame.width;
+        imageHeight = frame.height;
+        imageBytesPerPixel = frame.bytesPerPixel;
+        image.assign(static_cast<size_t>(imageWidth) * imageHeight * imageBytesPerPixel, 0);
+    }
+    if(frame.skipped()) {
+        return true;
+    }
+
+    const size_t rowBytes = static_cast<size_t>(imageWidth) * imageBytesPerPixel;
+    if(frame.shift > 7 || frame.top > frame.bottom || frame.bottom > imageHeight
+            || frame.rawSize != rowBytes * (frame.bottom - frame.top)) {
+        return false;
+    }
+    residuals.resize(frame.rawSize);
+    if(! lzDecompress(frame.payload.data(), frame.payload.size(), residuals.data(),
+                      residuals.size())) {
+        return false;
+    }
+
+    // the prediction reads the rows decoded so far, so it runs on image itself
+    for(int y = frame.top; y < frame.bottom; y++) {
+        uint8_t *row = image.data() + y * rowBytes;
+        decodeRow(row, y > frame.top ? row - rowBytes : nullptr, static_cast<int>(rowBytes),
+                  imageBytesPerPixel, frame.shift, residuals.data() + (y - frame.top) * rowBytes);
+    }
+    return true;
+}
+
+}  // namespace image_codec
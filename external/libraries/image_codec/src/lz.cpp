@@ -0,0 +1,165 @@
+#include "image_codec/lz.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace image_codec {
+
+namespace {
+
+const size_t MIN_MATCH = 4;
+const size_t LAST_LITERALS = 5; //!< the last bytes are always literals
+const size_t MATCH_LIMIT = 12; //!< no match starts this close to the end
+const size_t MAX_OFFSET = 65535;
+
+inline uint32_t read32(const uint8_t *p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint8_t* writeLength(uint8_t *out, size_t length) {
+    while(length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = static_cast<uint8_t>(length);
+    return out;
+}
+
+inline bool readLength(const uint8_t *&in, const uint8_t *end, size_t &length) {
+    uint8_t byte;
+    do {
+        if(in >= end) {
+            return false;
+        }
+        byte = *in++;
+        length += byte;
+    } while(byte == 255);
+    return true;
+}
+
+uint8_t* writeSequence(uint8_t *out, const uint8_t *literals, size_t literalLength) {
+    uint8_t *token = out++;
+    *token = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+    if(literalLength >= 15) {
+        out = writeLength(out, literalLength - 15);
+    }
+    std::memcpy(out, literals, literalLength);
+    return out + literalLength;
+}
+
+}  // namespace
+
+size_t LzCompressor::bound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t LzCompressor::compress(const uint8_t *in, size_t size, uint8_t *out) {
+    uint8_t *op = out;
+    const uint8_t *anchor = in;
+    const uint8_t *end = in + size;
+
+    if(size > MATCH_LIMIT) {
+        std::memset(table, 0, sizeof(table));
+        const uint8_t *ip = in;
+        const uint8_t *limit = end - MATCH_LIMIT;
+        const uint8_t *matchLimit = end - LAST_LITERALS;
+        unsigned int misses = 0;
+
+        while(ip < limit) {
+            uint32_t sequence = read32(ip);
+            uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+            const uint8_t *candidate = in + table[hash];
+            table[hash] = static_cast<uint32_t>(ip - in);
+
+            if(candidate >= ip || static_cast<size_t>(ip - candidate) > MAX_OFFSET
+                    || read32(candidate) != sequence) {
+                // skip faster through data that does not compress
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            const uint8_t *matchEnd = ip + MIN_MATCH;
+            const uint8_t *reference = candidate + MIN_MATCH;
+            while(matchEnd < matchLimit && *matchEnd == *reference) {
+                matchEnd++;
+                reference++;
+            }
+
+            size_t literalLength = static_cast<size_t>(ip - anchor);
+            size_t matchLength = static_cast<size_t>(matchEnd - ip) - MIN_MATCH;
+            uint8_t *token = op;
+            op = writeSequence(op, anchor, literalLength);
+            *token |= static_cast<uint8_t>(std::min<size_t>(matchLength, 15));
+
+            size_t offset = static_cast<size_t>(ip - candidate);
+            *op++ = static_cast<uint8_t>(offset);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+            if(matchLength >= 15) {
+                op = writeLength(op, matchLength - 15);
+            }
+            ip = matchEnd;
+            anchor = ip;
+        }
+    }
+
+    op = writeSequence(op, anchor, static_cast<size_t>(end - anchor));
+    return static_cast<size_t>(op - out);
+}
+
+bool lzDecompress(const uint8_t *in, size_t size, uint8_t *out, size_t outSize) {
+    const uint8_t *ip = in;
+    const uint8_t *inEnd = in + size;
+    uint8_t *op = out;
+    uint8_t *outEnd = out + outSize;
+
+    while(ip < inEnd) {
+        uint8_t token = *ip++;
+        size_t literalLength = token >> 4;
+        if(literalLength == 15 && ! readLength(ip, inEnd, literalLength)) {
+            return false;
+        }
+        if(literalLength > static_cast<size_t>(inEnd - ip)
+                || literalLength > static_cast<size_t>(outEnd - op)) {
+            return false;
+        }
+        std::memcpy(op, ip, literalLength);
+        op += literalLength;
+        ip += literalLength;
+        if(ip == inEnd) {
+            // the last sequence has no match
+            break;
+        }
+
+        if(inEnd - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | static_cast<size_t>(ip[1]) << 8;
+        ip += 2;
+        size_t matchLength = token & 15;
+        if(matchLength == 15 && ! readLength(ip, inEnd, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        if(offset == 0 || offset > static_cast<size_t>(op - out)
+                || matchLength > static_cast<size_t>(outEnd - op)) {
+            return false;
+        }
+
+        const uint8_t *reference = op - offset;
+        if(offset >= matchLength) {
+            std::memcpy(op, reference, matchLength);
+        } else {
+            // overlapping: repeats the last offset bytes
+            for(size_t i = 0; i < matchLength; i++) {
+                op[i] = reference[i];
+            }
+        }
+        op += matchLength;
+    }
+    return op == outEnd;
+}
+
+}  // namespace image_codec
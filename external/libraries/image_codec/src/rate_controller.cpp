@@ -0,0 +1,138 @@
+#include "image_codec/rate_controller.h"
+
+#include <algorithm>
+
+namespace image_codec {
+
+namespace {
+
+/**
+ * @brief Rates are measured over windows of this length [us], single
+ * frames arrive in bursts
+ */
+const int64_t RATE_WINDOW = 200000;
+
+template<typename T>
+void writeValue(std::ostream &os, T value) {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+bool readValue(std::istream &is, T &value) {
+    return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+}  // namespace
+
+const Level RateController::LEVELS[] = {
+    {0, 1, false}, // lossless
+    {2, 1, false},
+    {3, 1, false},
+    {4, 1, false},
+    {4, 2, false},
+    {4, 2, true},
+    {5, 3, true},
+    {5, 5, true},
+    {6, 10, true}
+};
+
+const int RateController::LEVEL_COUNT = sizeof(LEVELS) / sizeof(LEVELS[0]);
+
+bool LinkReport::serialize(std::ostream &os) const {
+    writeValue(os, lastSequence);
+    writeValue(os, frames);
+    writeValue(os, bytes);
+    writeValue(os, timestamp);
+    return os.good();
+}
+
+bool LinkReport::deserialize(std::istream &is) {
+    return readValue(is, lastSequence) && readValue(is, frames) && readValue(is, bytes)
+            && readValue(is, timestamp);
+}
+
+RateController::RateController(const RateOptions &options)
+    : options(options), sinceChange(0), calmFrames(0), lastReportTime(0), receiveRate(0),
+      lastSent(0), sentBytes(0), windowBytes(0), windowStart(0), sentRate(0) {
+    maxLevel = options.maxLevel < 0 ? LEVEL_COUNT - 1 : std::min(options.maxLevel, LEVEL_COUNT - 1);
+    this->options.minLevel = std::max(0, std::min(options.minLevel, maxLevel));
+    current = this->options.minLevel;
+}
+
+void RateController::report(const LinkReport &report, int64_t now) {
+    if(report.timestamp == last.timestamp) {
+        return;
+    }
+    if(window.timestamp == 0 || report.timestamp < window.timestamp || report.bytes < window.bytes) {
+        // first report or the receiver restarted
+        window = report;
+    } else if(report.timestamp - window.timestamp >= RATE_WINDOW) {
+        receiveRate = (report.bytes - window.bytes) * 1e6 / (report.timestamp - window.timestamp);
+        window = report;
+    }
+    last = report;
+    lastReportTime = now;
+}
+
+int RateController::inFlight() const {
+    return static_cast<int>(lastSent - std::min(lastSent, last.lastSequence));
+}
+
+EncodeParams RateController::params(uint32_t sequence, int roiTop, int roiBottom, int64_t now) {
+    sinceChange++;
+
+    if(lastReportTime != 0 && now - lastReportTime > options.staleMicros) {
+        change(maxLevel);
+    } else if(lastReportTime != 0) {
+        bool capped = options.maxBytesPerSecond > 0;
+        bool queueing = inFlight() > options.maxInFlight
+                || (capped && sentRate > options.maxBytesPerSecond);
+        // room for the next level, which may need about twice the bytes
+        bool calm = inFlight() <= options.maxInFlight / 2
+                && (! capped || sentRate < options.maxBytesPerSecond / 2);
+        if(queueing) {
+            calmFrames = 0;
+            if(sinceChange >= options.holdFrames) {
+                change(current + 1);
+            }
+        } else if(calm && ++calmFrames >= options.probeFrames) {
+            change(current - 1);
+        }
+    }
+
+    const Level &level = LEVELS[current];
+    EncodeParams params;
+    params.shift = level.shift;
+    // nothing but headers while a backlog drains, a frame queued behind it
+    // would be outdated when it arrives
+    params.skip = sequence % level.skip != 0 || inFlight() > options.maxInFlight;
+    if(level.roi) {
+        params.top = roiTop;
+        params.bottom = roiBottom;
+    }
+    return params;
+}
+
+void RateController::sent(uint32_t sequence, size_t bytes, int64_t now) {
+    sentBytes += bytes;
+    if(windowStart == 0) {
+        windowStart = now;
+        windowBytes = sentBytes;
+    } else if(now - windowStart >= RATE_WINDOW) {
+        sentRate = (sentBytes - windowBytes) * 1e6 / (now - windowStart);
+        windowStart = now;
+        windowBytes = sentBytes;
+    }
+    lastSent = sequence;
+}
+
+void RateController::change(int level) {
+    level = std::max(options.minLevel, std::min(level, maxLevel));
+    if(level != current) {
+        current = level;
+        sinceChange = 0;
+    }
+    calmFrames = 0;
+}
+
+}  // namespace image_codec
@@ -0,0 +1,173 @@
+/**
+ * Work per 100 Hz cycle of the operator station image path. The current
+ * path copies each new camera frame into IMAGE, scales it up into IMAGE_HQ
+ * every cycle and uploads all of IMAGE_HQ every cycle. The on-change path
+ * copies only changed tiles into IMAGE and scales only the damaged regions
+ * straight into the texture buffer, and only when the version changed.
+ * Frames are 188x87 grey like IMAGE after image_converter_scaledown.
+ *
+ * Usage: image_damage_bench [--cycles N] [--every N] [--factor N]
+ *
+ * --cycles   cycles per measurement, default 20000
+ * --every    cycles between camera frames, default 3 (33 Hz)
+ * --factor   scale up factor, default 4
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "image_stage/damage.h"
+
+using namespace image_stage;
+
+namespace {
+
+const int WIDTH = 188;
+const int HEIGHT = 87;
+const int TILE = 16;
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Decoded camera frames where a share of the tiles changes from one
+ * frame to the next, the rest stays byte identical like a quantized static
+ * scene does after image_decoder
+ */
+class Camera {
+public:
+    Camera(double changed, unsigned int seed) : pixels(WIDTH * HEIGHT), changed(changed), random(seed) {
+        for(uint8_t &pixel : pixels) {
+            pixel = static_cast<uint8_t>(random());
+        }
+    }
+
+    void next() {
+        std::uniform_real_distribution<double> share(0, 1);
+        for(int y = 0; y < HEIGHT; y += TILE) {
+            for(int x = 0; x < WIDTH; x += TILE) {
+                if(share(random) >= changed) {
+                    continue;
+                }
+                for(int row = y; row < std::min(y + TILE, HEIGHT); row++) {
+                    for(int column = x; column < std::min(x + TILE, WIDTH); column++) {
+                        pixels[row * WIDTH + column] = static_cast<uint8_t>(random());
+                    }
+                }
+            }
+        }
+    }
+
+    ImageView view() const {
+        return ImageView(pixels.data(), WIDTH, HEIGHT, WIDTH, PixelFormat::GREY);
+    }
+
+private:
+    std::vector<uint8_t> pixels;
+    double changed;
+    std::mt19937 random;
+};
+
+struct Result {
+    int64_t nanos;
+    uint64_t uploaded; //!< bytes written to the texture
+};
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    int cycles = 20000;
+    int every = 3;
+    int factor = 4;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if(arg == "--cycles") {
+            cycles = std::atoi(argv[i + 1]);
+        } else if(arg == "--every") {
+            every = std::atoi(argv[i + 1]);
+        } else if(arg == "--factor") {
+            factor = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    int scaledStride = WIDTH * factor;
+    size_t scaledBytes = static_cast<size_t>(scaledStride) * HEIGHT * factor;
+    const double SHARES[] = {0, 0.1, 0.5, 1};
+    std::printf("%-8s %26s %26s\n", "changed", "current", "on change");
+    for(double share : SHARES) {
+        // current: IMAGE, IMAGE_HQ and the texture
+        std::vector<uint8_t> image(WIDTH * HEIGHT);
+        std::vector<uint8_t> imageHq(scaledBytes);
+        std::vector<uint8_t> texture(scaledBytes);
+        ImageView imageView(image.data(), WIDTH, HEIGHT, WIDTH, PixelFormat::GREY);
+        Result current = {0, 0};
+        Camera camera(share, 1);
+        for(int cycle = 0; cycle < cycles; cycle++) {
+            bool frame = cycle % every == 0;
+            if(frame) {
+                camera.next();
+            }
+            int64_t start = nowNanos();
+            if(frame) {
+                std::memcpy(image.data(), camera.view().data, image.size());
+            }
+            scaleUp(imageView, Rect(0, 0, WIDTH, HEIGHT), factor, imageHq.data(), scaledStride);
+            std::memcpy(texture.data(), imageHq.data(), texture.size());
+            current.nanos += nowNanos() - start;
+            current.uploaded += texture.size();
+        }
+
+        // on change: IMAGE with its damage and the texture
+        std::vector<uint8_t> kept(WIDTH * HEIGHT);
+        std::vector<uint8_t> uploaded(scaledBytes);
+        ImageView keptView(kept.data(), WIDTH, HEIGHT, WIDTH, PixelFormat::GREY);
+        Damage damage;
+        DamageTracker tracker;
+        Result onChange = {0, 0};
+        Camera changes(share, 1);
+        for(int cycle = 0; cycle < cycles; cycle++) {
+            bool frame = cycle % every == 0;
+            if(frame) {
+                changes.next();
+            }
+            int64_t start = nowNanos();
+            if(frame) {
+                copyChanged(changes.view(), kept.data(), WIDTH, 0, HEIGHT, &damage);
+            }
+            switch(tracker.update(damage)) {
+            case Update::NONE:
+                break;
+            case Update::REGIONS:
+                for(const Rect &rect : damage.rects()) {
+                    scaleUp(keptView, rect, factor, uploaded.data(), scaledStride);
+                    onChange.uploaded += static_cast<uint64_t>(rect.width) * rect.height * factor * factor;
+                }
+                break;
+            case Update::FULL:
+                scaleUp(keptView, Rect(0, 0, WIDTH, HEIGHT), factor, uploaded.data(), scaledStride);
+                onChange.uploaded += uploaded.size();
+                break;
+            }
+            onChange.nanos += nowNanos() - start;
+        }
+
+        if(texture != uploaded) {
+            std::fprintf(stderr, "textures differ at %.0f%% changed tiles\n", share * 100);
+            return 1;
+        }
+        std::printf("%6.0f%% %9.2f us %9.1f kB/cycle %9.2f us %9.1f kB/cycle\n", share * 100,
+                    current.nanos / 1000.0 / cycles, current.uploaded / 1000.0 / cycles,
+                    onChange.nanos / 1000.0 / cycles, onChange.uploaded / 1000.0 / cycles);
+    }
+    return 0;
+}
@@ -0,0 +1,211 @@
+/**
+ * Checks that all kernels of this CPU match the scalar code and compares the
+ * fused stage with the copy + convert + downscale passes of the current
+ * camera path, on 752x350 frames like ueye.lconf captures.
+ *
+ * Usage: image_stage_bench [--frames N] [--factor 1|2|4]
+ *
+ * --frames   frames per measurement, default 2000
+ * --factor   downscale factor, default 4 like image_converter_scaledown
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "image_stage/frame_pool.h"
+#include "image_stage/fused_stage.h"
+
+using namespace image_stage;
+
+namespace {
+
+const int WIDTH = 752;
+const int HEIGHT = 350;
+const int DRIVER_BUFFERS = 8; //!< num_buffers of ueye.lconf
+
+const Isa ISAS[] = {Isa::SSE2, Isa::AVX2, Isa::NEON};
+const PixelFormat FORMATS[] = {PixelFormat::GREY, PixelFormat::YUYV, PixelFormat::BGR,
+                               PixelFormat::BGRA};
+const char *FORMAT_NAMES[] = {"GREY", "YUYV", "BGR", "BGRA"};
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool supportedIsa(Isa isa) {
+    return isa == Isa::SCALAR || isa == bestIsa()
+            || (isa == Isa::SSE2 && bestIsa() == Isa::AVX2);
+}
+
+/**
+ * @brief Ring of capture buffers filled with noise, stands in for the
+ * driver's image memory
+ */
+struct Capture {
+    Capture(PixelFormat format, unsigned int seed) : format(format) {
+        stride = (WIDTH * bytesPerPixel(format) + 63) / 64 * 64;
+        std::mt19937 random(seed);
+        for(std::vector<uint8_t> &buffer : buffers) {
+            buffer.resize(static_cast<size_t>(stride) * HEIGHT);
+            for(uint8_t &byte : buffer) {
+                byte = static_cast<uint8_t>(random());
+            }
+        }
+    }
+
+    ImageView view(int frame) const {
+        return ImageView(buffers[frame % DRIVER_BUFFERS].data(), WIDTH, HEIGHT, stride, format);
+    }
+
+    PixelFormat format;
+    int stride;
+    std::vector<uint8_t> buffers[DRIVER_BUFFERS];
+};
+
+int verify() {
+    std::mt19937 random(42);
+    int failures = 0;
+    int checks = 0;
+    for(int f = 0; f < 4; f++) {
+        Capture capture(FORMATS[f], f + 1);
+        for(int factor : {1, 2, 4}) {
+            for(int round = 0; round < 50; round++) {
+                StageConfig config;
+                config.factor = factor;
+                config.x = random() % 64;
+                config.y = random() % 32;
+                config.width = round == 0 ? 0 : 1 + random() % (WIDTH - config.x);
+                config.height = round == 0 ? 0 : 1 + random() % (HEIGHT - config.y);
+                int width, height;
+                if(! outputSize(capture.view(0), config, &width, &height)) {
+                    continue;
+                }
+                std::vector<uint8_t> expected(width * height);
+                process(capture.view(round), config, expected.data(), width, Isa::SCALAR);
+                for(Isa isa : ISAS) {
+                    if(! supportedIsa(isa)) {
+                        continue;
+                    }
+                    std::vector<uint8_t> actual(width * height);
+                    process(capture.view(round), config, actual.data(), width, isa);
+                    checks++;
+                    if(actual != expected) {
+                        failures++;
+                        std::printf("MISMATCH %s %s factor %d roi %d,%d %dx%d\n", isaName(isa),
+                                    FORMAT_NAMES[f], factor, config.x, config.y,
+                                    config.width, config.height);
+                    }
+                }
+            }
+        }
+    }
+    std::printf("verify: %d comparisons against scalar, %d mismatches\n", checks, failures);
+    return failures;
+}
+
+/**
+ * @brief The passes of the current path: the frame is copied out of the
+ * driver buffer into CAMERA_IMAGE, converted to grey into a second image
+ * and downscaled into IMAGE
+ */
+struct SeparatePasses {
+    explicit SeparatePasses(const Capture &capture)
+        : camera(static_cast<size_t>(capture.stride) * HEIGHT), grey(WIDTH * HEIGHT) {
+    }
+
+    void run(const ImageView &view, int factor) {
+        std::memcpy(camera.data(), view.data, camera.size());
+        ImageView copy(camera.data(), WIDTH, HEIGHT, view.stride, view.format);
+        const uint8_t *source = camera.data();
+        if(view.format != PixelFormat::GREY) {
+            StageConfig convert;
+            process(copy, convert, grey.data(), WIDTH, Isa::SCALAR);
+            source = grey.data();
+        }
+        // the downscale is its own pass over the grey image
+        int width = WIDTH / factor;
+        int height = HEIGHT / factor;
+        image.resize(width * height);
+        int area = factor * factor;
+        int stride = view.format == PixelFormat::GREY ? view.stride : WIDTH;
+        for(int y = 0; y < height; y++) {
+            for(int x = 0; x < width; x++) {
+                int sum = 0;
+                for(int i = 0; i < factor; i++) {
+                    for(int j = 0; j < factor; j++) {
+                        sum += source[(y * factor + i) * stride + x * factor + j];
+                    }
+                }
+                image[y * width + x] = static_cast<uint8_t>((sum + area / 2) / area);
+            }
+        }
+    }
+
+    std::vector<uint8_t> camera;
+    std::vector<uint8_t> grey;
+    std::vector<uint8_t> image;
+};
+
+double perFrame(int64_t nanos, int frames) {
+    return nanos / 1000.0 / frames;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    int frames = 2000;
+    int factor = 4;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if(arg == "--frames") {
+            frames = std::atoi(argv[i + 1]);
+        } else if(arg == "--factor") {
+            factor = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if(verify() != 0) {
+        return 1;
+    }
+
+    std::printf("%dx%d -> factor %d, best kernels %s, us per frame:\n", WIDTH, HEIGHT, factor,
+                isaName(bestIsa()));
+    std::printf("%-6s %10s %10s %10s\n", "format", "separate", "scalar", isaName(bestIsa()));
+    for(int f = 0; f < 4; f++) {
+        Capture capture(FORMATS[f], f + 1);
+        SeparatePasses separate(capture);
+        int64_t start = nowNanos();
+        for(int i = 0; i < frames; i++) {
+            separate.run(capture.view(i), factor);
+        }
+        double separateMicros = perFrame(nowNanos() - start, frames);
+
+        StageConfig config;
+        config.factor = factor;
+        FramePool pool(WIDTH / factor, HEIGHT / factor, 4);
+        double fusedMicros[2];
+        for(int k = 0; k < 2; k++) {
+            Isa isa = k == 0 ? Isa::SCALAR : bestIsa();
+            start = nowNanos();
+            for(int i = 0; i < frames; i++) {
+                Frame *frame = pool.acquire();
+                process(capture.view(i), config, frame->data, frame->stride, isa);
+                frame->id = i;
+                pool.release(frame);
+            }
+            fusedMicros[k] = perFrame(nowNanos() - start, frames);
+        }
+        std::printf("%-6s %10.1f %10.1f %10.1f\n", FORMAT_NAMES[f], separateMicros, fusedMicros[0],
+                    fusedMicros[1]);
+    }
+    return 0;
+}
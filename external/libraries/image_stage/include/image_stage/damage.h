@@ -0,0 +1,142 @@
+#ifndef IMAGE_STAGE_DAMAGE_H
+#define IMAGE_STAGE_DAMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "image_stage/image_view.h"
+
+namespace image_stage {
+
+/**
+ * @brief Pixel rectangle, x and y are the top left corner
+ */
+struct Rect {
+    Rect() : x(0), y(0), width(0), height(0) {
+    }
+
+    Rect(int x, int y, int width, int height) : x(x), y(y), width(width), height(height) {
+    }
+
+    bool empty() const {
+        return width <= 0 || height <= 0;
+    }
+
+    int x; //!< [px]
+    int y; //!< [px]
+    int width; //!< [px]
+    int height; //!< [px]
+};
+
+/**
+ * @brief Version stamp and changed regions of an image channel, written
+ * next to the image, e.g. IMAGE_DAMAGE for IMAGE
+ *
+ * The producer calls begin() for every image that changed and add()s the
+ * changed regions. An image that did not change keeps its version, so
+ * consumers can skip it. Adjacent rectangles are merged; beyond MAX_RECTS
+ * they collapse into their bounding box. The vector is reserved once,
+ * nothing is allocated per frame.
+ */
+class Damage {
+public:
+    static const size_t MAX_RECTS = 32;
+
+    Damage();
+
+    /**
+     * @brief begin starts the next version with no changed regions
+     */
+    void begin();
+
+    void add(const Rect &rect);
+
+    /**
+     * @brief addAll marks the whole image, e.g. after a size or format change
+     */
+    void addAll(int width, int height);
+
+    uint64_t version() const {
+        return stamp;
+    }
+
+    /**
+     * @brief rects changed since the previous version
+     */
+    const std::vector<Rect>& rects() const {
+        return regions;
+    }
+
+    Rect bounds() const;
+
+private:
+    uint64_t stamp;
+    std::vector<Rect> regions;
+};
+
+/**
+ * @brief What a consumer has to redo for the current version
+ */
+enum class Update : uint8_t {
+    NONE,    //!< same version as drawn last
+    REGIONS, //!< the rects of the current version
+    FULL     //!< everything, versions were missed or never drawn
+};
+
+/**
+ * @brief Version a consumer drew last
+ *
+ * The rects only describe the step from the previous version, so if a
+ * consumer missed one the whole image has to be redone.
+ */
+class DamageTracker {
+public:
+    DamageTracker() : drawn(0) {
+    }
+
+    /**
+     * @brief update returns what changed since the last call and marks the
+     * current version as drawn
+     */
+    Update update(const Damage &damage);
+
+    /**
+     * @brief invalidate makes the next update() FULL, e.g. after the
+     * window was resized
+     */
+    void invalidate() {
+        drawn = 0;
+    }
+
+private:
+    uint64_t drawn;
+};
+
+/**
+ * @brief copyChanged copies rows [top, bottom) of source into target tile
+ * by tile and add()s the tiles that differed to damage
+ *
+ * target holds the previous image of the same size and format. Both are
+ * read once and only changed rows of a tile are written, so it costs about
+ * as much as the plain copy it replaces. The next version of damage begins
+ * at the first tile that differs, an identical frame keeps the version.
+ *
+ * @return true if anything differed
+ */
+bool copyChanged(const ImageView &source, uint8_t *target, int targetStride, int top, int bottom,
+                 Damage *damage, int tileSize = 16);
+
+/**
+ * @brief scaleUp writes region of source, factor times larger by pixel
+ * repetition, to (region.x * factor, region.y * factor) of target
+ *
+ * Meant for the locked pixel buffer of a texture: the renderer scales while
+ * it uploads instead of reading a full size copy like IMAGE_HQ.
+ */
+void scaleUp(const ImageView &source, const Rect &region, int factor, uint8_t *target,
+             int targetStride);
+
+}  // namespace image_stage
+
+#endif // IMAGE_STAGE_DAMAGE_H
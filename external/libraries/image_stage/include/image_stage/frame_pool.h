@@ -0,0 +1,68 @@
+#ifndef IMAGE_STAGE_FRAME_POOL_H
+#define IMAGE_STAGE_FRAME_POOL_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace image_stage {
+
+/**
+ * @brief Grey output image handed out by a FramePool
+ */
+struct Frame {
+    uint8_t *data; //!< 32 byte aligned rows
+    int width; //!< [px]
+    int height; //!< [px]
+    int stride; //!< bytes from one row to the next, multiple of 32
+    uint64_t id; //!< capture sequence number, set by the producer
+    int64_t timestamp; //!< capture time, set by the producer
+};
+
+/**
+ * @brief Fixed set of frames allocated once and reused for every capture
+ *
+ * The producer acquire()s a frame, fills it and publishes the pointer; the
+ * last consumer release()s it. Nothing is allocated after construction, so
+ * the frames stay in place and warm in the cache.
+ */
+class FramePool {
+public:
+    /**
+     * @param count frames in the pool, at least the frames in flight:
+     * the one being filled plus the ones consumers still hold
+     */
+    FramePool(int width, int height, unsigned int count);
+    ~FramePool();
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /**
+     * @brief acquire takes a free frame
+     * @return nullptr if all frames are in use, the producer should drop the
+     * capture instead of waiting
+     */
+    Frame* acquire();
+
+    /**
+     * @brief release returns a frame of this pool
+     */
+    void release(Frame *frame);
+
+    unsigned int available() const;
+
+    unsigned int size() const {
+        return static_cast<unsigned int>(frames.size());
+    }
+
+private:
+    uint8_t *memory;
+    std::vector<Frame> frames;
+    std::vector<Frame*> free;
+    mutable std::mutex mutex;
+};
+
+}  // namespace image_stage
+
+#endif // IMAGE_STAGE_FRAME_POOL_H
@@ -0,0 +1,63 @@
+#ifndef IMAGE_STAGE_FUSED_STAGE_H
+#define IMAGE_STAGE_FUSED_STAGE_H
+
+#include <cstdint>
+
+#include "image_stage/image_view.h"
+
+namespace image_stage {
+
+/**
+ * @brief Region of interest and downscale factor of the fused stage
+ */
+struct StageConfig {
+    StageConfig() : x(0), y(0), width(0), height(0), factor(1) {
+    }
+
+    int x; //!< ROI left edge [px]
+    int y; //!< ROI top edge [px]
+    int width; //!< ROI width [px], 0 for the rest of the image
+    int height; //!< ROI height [px], 0 for the rest of the image
+    int factor; //!< box downscale factor: 1, 2 or 4
+};
+
+enum class Isa : uint8_t {
+    SCALAR = 0,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+const char* isaName(Isa isa);
+
+/**
+ * @brief bestIsa fastest instruction set of this CPU that has kernels
+ */
+Isa bestIsa();
+
+/**
+ * @brief outputSize size of the stage result, the ROI is cut to a multiple
+ * of the factor
+ * @return false if the config does not fit the image
+ */
+bool outputSize(const ImageView &input, const StageConfig &config, int *width, int *height);
+
+/**
+ * @brief process crops, downscales and converts to grey in one pass
+ *
+ * Reads every input byte of the ROI once and writes every output byte once,
+ * nothing in between. Each output pixel is the rounded mean of the luma of
+ * a factor x factor block; BGR luma is (29 B + 150 G + 77 R + 128) >> 8.
+ * All instruction sets give bit-identical results.
+ *
+ * @param output grey image of outputSize(), rows stride bytes apart
+ * @param isa kernels to use, falls back to SCALAR where the CPU or format
+ * has none
+ * @return false if the config does not fit the image
+ */
+bool process(const ImageView &input, const StageConfig &config, uint8_t *output, int stride,
+             Isa isa = bestIsa());
+
+}  // namespace image_stage
+
+#endif // IMAGE_STAGE_FUSED_STAGE_H
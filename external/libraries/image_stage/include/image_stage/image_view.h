@@ -0,0 +1,51 @@
+#ifndef IMAGE_STAGE_IMAGE_VIEW_H
+#define IMAGE_STAGE_IMAGE_VIEW_H
+
+#include <cstdint>
+
+namespace image_stage {
+
+enum class PixelFormat : uint8_t {
+    GREY = 0, //!< 8 bit mono
+    YUYV,     //!< 4:2:2, luma in the even bytes
+    BGR,      //!< 8 bit per channel, packed
+    BGRA,     //!< 8 bit per channel, packed, alpha ignored
+    __END__ // PixelFormat counter, must be LAST
+};
+
+inline int bytesPerPixel(PixelFormat format) {
+    switch(format) {
+    case PixelFormat::GREY:
+        return 1;
+    case PixelFormat::YUYV:
+        return 2;
+    case PixelFormat::BGR:
+        return 3;
+    case PixelFormat::BGRA:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Pixels owned by someone else, e.g. a locked uEye capture buffer
+ */
+struct ImageView {
+    ImageView() : data(nullptr), width(0), height(0), stride(0), format(PixelFormat::GREY) {
+    }
+
+    ImageView(const uint8_t *data, int width, int height, int stride, PixelFormat format)
+        : data(data), width(width), height(height), stride(stride), format(format) {
+    }
+
+    const uint8_t *data;
+    int width; //!< [px]
+    int height; //!< [px]
+    int stride; //!< bytes from one row to the next
+    PixelFormat format;
+};
+
+}  // namespace image_stage
+
+#endif // IMAGE_STAGE_IMAGE_VIEW_H
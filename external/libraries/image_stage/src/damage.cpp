@@ -0,0 +1,158 @@
+#include "image_stage/damage.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace image_stage {
+
+Damage::Damage() : stamp(0) {
+    regions.reserve(MAX_RECTS);
+}
+
+void Damage::begin() {
+    stamp++;
+    regions.clear();
+}
+
+void Damage::add(const Rect &rect) {
+    if(rect.empty()) {
+        return;
+    }
+    // copyChanged adds runs of tiles row by row, so the previous rect is
+    // usually the left neighbour and a rect further up the one above
+    if(! regions.empty()) {
+        Rect &last = regions.back();
+        if(last.y == rect.y && last.height == rect.height && last.x + last.width == rect.x) {
+            last.width += rect.width;
+            return;
+        }
+    }
+    for(Rect &region : regions) {
+        if(region.x == rect.x && region.width == rect.width && region.y + region.height == rect.y) {
+            region.height += rect.height;
+            return;
+        }
+    }
+    if(regions.size() == MAX_RECTS) {
+        Rect all = bounds();
+        int right = std::max(all.x + all.width, rect.x + rect.width);
+        int bottom = std::max(all.y + all.height, rect.y + rect.height);
+        all.x = std::min(all.x, rect.x);
+        all.y = std::min(all.y, rect.y);
+        all.width = right - all.x;
+        all.height = bottom - all.y;
+        regions.clear();
+        regions.push_back(all);
+        return;
+    }
+    regions.push_back(rect);
+}
+
+void Damage::addAll(int width, int height) {
+    regions.clear();
+    add(Rect(0, 0, width, height));
+}
+
+Rect Damage::bounds() const {
+    if(regions.empty()) {
+        return Rect();
+    }
+    int left = regions[0].x;
+    int top = regions[0].y;
+    int right = left + regions[0].width;
+    int bottom = top + regions[0].height;
+    for(const Rect &region : regions) {
+        left = std::min(left, region.x);
+        top = std::min(top, region.y);
+        right = std::max(right, region.x + region.width);
+        bottom = std::max(bottom, region.y + region.height);
+    }
+    return Rect(left, top, right - left, bottom - top);
+}
+
+Update DamageTracker::update(const Damage &damage) {
+    if(damage.version() == drawn) {
+        return Update::NONE;
+    }
+    Update update = drawn != 0 && damage.version() == drawn + 1 ? Update::REGIONS : Update::FULL;
+    drawn = damage.version();
+    return update;
+}
+
+bool copyChanged(const ImageView &source, uint8_t *target, int targetStride, int top, int bottom,
+                 Damage *damage, int tileSize) {
+    int pixelBytes = bytesPerPixel(source.format);
+    top = std::max(top, 0);
+    bottom = std::min(bottom, source.height);
+    int tiles = (source.width + tileSize - 1) / tileSize;
+    bool any = false;
+
+    for(int y = top; y < bottom; y += tileSize) {
+        int rows = std::min(tileSize, bottom - y);
+        int run = -1; // first tile of the current run of changed tiles
+        for(int tile = 0; tile <= tiles; tile++) {
+            int x = tile * tileSize;
+            bool changed = false;
+            if(tile < tiles) {
+                size_t bytes = static_cast<size_t>(std::min(tileSize, source.width - x)) * pixelBytes;
+                const uint8_t *from = source.data + static_cast<size_t>(y) * source.stride
+                        + static_cast<size_t>(x) * pixelBytes;
+                uint8_t *to = target + static_cast<size_t>(y) * targetStride
+                        + static_cast<size_t>(x) * pixelBytes;
+                for(int row = 0; row < rows; row++) {
+                    if(std::memcmp(from, to, bytes) != 0) {
+                        std::memcpy(to, from, bytes);
+                        changed = true;
+                    }
+                    from += source.stride;
+                    to += targetStride;
+                }
+            }
+            if(changed && ! any) {
+                damage->begin();
+                any = true;
+            }
+            if(changed && run < 0) {
+                run = tile;
+            } else if(! changed && run >= 0) {
+                int left = run * tileSize;
+                damage->add(Rect(left, y, std::min(x, source.width) - left, rows));
+                run = -1;
+            }
+        }
+    }
+    return any;
+}
+
+void scaleUp(const ImageView &source, const Rect &region, int factor, uint8_t *target,
+             int targetStride) {
+    int pixelBytes = bytesPerPixel(source.format);
+    size_t rowBytes = static_cast<size_t>(region.width) * factor * pixelBytes;
+    for(int y = region.y; y < region.y + region.height; y++) {
+        const uint8_t *from = source.data + static_cast<size_t>(y) * source.stride
+                + static_cast<size_t>(region.x) * pixelBytes;
+        uint8_t *first = target + static_cast<size_t>(y) * factor * targetStride
+                + static_cast<size_t>(region.x) * factor * pixelBytes;
+        uint8_t *to = first;
+        if(pixelBytes == 1) {
+            for(int x = 0; x < region.width; x++) {
+                std::memset(to, from[x], factor);
+                to += factor;
+            }
+        } else {
+            for(int x = 0; x < region.width; x++) {
+                for(int repeat = 0; repeat < factor; repeat++) {
+                    std::memcpy(to, from, pixelBytes);
+                    to += pixelBytes;
+                }
+                from += pixelBytes;
+            }
+        }
+        // the other rows of the block are copies of the first
+        for(int repeat = 1; repeat < factor; repeat++) {
+            std::memcpy(first + static_cast<size_t>(repeat) * targetStride, first, rowBytes);
+        }
+    }
+}
+
+}  // namespace image_stage
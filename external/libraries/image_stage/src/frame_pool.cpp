@@ -0,0 +1,68 @@
+#include "image_stage/frame_pool.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace image_stage {
+
+namespace {
+
+const int ALIGNMENT = 32;
+
+}  // namespace
+
+FramePool::FramePool(int width, int height, unsigned int count) : memory(nullptr) {
+    int stride = (width + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    size_t frameBytes = static_cast<size_t>(stride) * height;
+    void *allocation = nullptr;
+    if(posix_memalign(&allocation, ALIGNMENT, frameBytes * count) != 0) {
+        throw std::bad_alloc();
+    }
+    memory = static_cast<uint8_t*>(allocation);
+    // touch every page now instead of in the first cycles
+    std::memset(memory, 0, frameBytes * count);
+
+    frames.resize(count);
+    free.reserve(count);
+    for(unsigned int i = 0; i < count; i++) {
+        Frame &frame = frames[i];
+        frame.data = memory + frameBytes * i;
+        frame.width = width;
+        frame.height = height;
+        frame.stride = stride;
+        frame.id = 0;
+        frame.timestamp = 0;
+        free.push_back(&frame);
+    }
+}
+
+FramePool::~FramePool() {
+    std::free(memory);
+}
+
+Frame* FramePool::acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(free.empty()) {
+        return nullptr;
+    }
+    Frame *frame = free.back();
+    free.pop_back();
+    return frame;
+}
+
+void FramePool::release(Frame *frame) {
+    if(frame == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    // push_back cannot allocate, free was reserved for all frames
+    free.push_back(frame);
+}
+
+unsigned int FramePool::available() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<unsigned int>(free.size());
+}
+
+}  // namespace image_stage
@@ -0,0 +1,165 @@
+#include "image_stage/fused_stage.h"
+
+#include <cstring>
+
+#include "kernels.h"
+
+namespace image_stage {
+
+namespace {
+
+inline int factorIndex(int factor) {
+    return factor == 1 ? 0 : factor == 2 ? 1 : factor == 4 ? 2 : -1;
+}
+
+/**
+ * @brief luma of the pixel at byte offset x of a row
+ */
+inline int luma(const uint8_t *row, int x, PixelFormat format) {
+    switch(format) {
+    case PixelFormat::BGR:
+    case PixelFormat::BGRA:
+        return (29 * row[x] + 150 * row[x + 1] + 77 * row[x + 2] + 128) >> 8;
+    default:
+        // GREY and the Y byte of YUYV
+        return row[x];
+    }
+}
+
+void scalarRow(const uint8_t *const *rows, int factor, PixelFormat format, int from, int width,
+               uint8_t *out) {
+    const int bytes = bytesPerPixel(format);
+    const int area = factor * factor;
+    for(int x = from; x < width; x++) {
+        int sum = 0;
+        for(int i = 0; i < factor; i++) {
+            for(int j = 0; j < factor; j++) {
+                sum += luma(rows[i], (x * factor + j) * bytes, format);
+            }
+        }
+        out[x] = static_cast<uint8_t>((sum + area / 2) / area);
+    }
+}
+
+detail::Kernels makeKernels(Isa isa) {
+    detail::Kernels kernels;
+    std::memset(&kernels, 0, sizeof(kernels));
+    switch(isa) {
+    case Isa::AVX2:
+        detail::sse2Kernels(&kernels);
+        detail::avx2Kernels(&kernels);
+        break;
+    case Isa::SSE2:
+        detail::sse2Kernels(&kernels);
+        break;
+    case Isa::NEON:
+        detail::neonKernels(&kernels);
+        break;
+    default:
+        break;
+    }
+    return kernels;
+}
+
+bool supported(Isa isa) {
+    switch(isa) {
+    case Isa::SCALAR:
+        return true;
+#if defined(__SSE2__)
+    case Isa::SSE2:
+        return true;
+    case Isa::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    case Isa::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+}  // namespace
+
+const char* isaName(Isa isa) {
+    switch(isa) {
+    case Isa::SCALAR:
+        return "scalar";
+    case Isa::SSE2:
+        return "SSE2";
+    case Isa::AVX2:
+        return "AVX2";
+    case Isa::NEON:
+        return "NEON";
+    default:
+        return "?";
+    }
+}
+
+Isa bestIsa() {
+    static const Isa best = supported(Isa::AVX2) ? Isa::AVX2
+            : supported(Isa::SSE2) ? Isa::SSE2
+            : supported(Isa::NEON) ? Isa::NEON : Isa::SCALAR;
+    return best;
+}
+
+bool outputSize(const ImageView &input, const StageConfig &config, int *width, int *height) {
+    if(input.data == nullptr || factorIndex(config.factor) < 0
+            || bytesPerPixel(input.format) == 0 || config.x < 0 || config.y < 0) {
+        return false;
+    }
+    int roiWidth = config.width > 0 ? config.width : input.width - config.x;
+    int roiHeight = config.height > 0 ? config.height : input.height - config.y;
+    if(roiWidth <= 0 || roiHeight <= 0 || config.x + roiWidth > input.width
+            || config.y + roiHeight > input.height) {
+        return false;
+    }
+    *width = roiWidth / config.factor;
+    *height = roiHeight / config.factor;
+    return *width > 0 && *height > 0;
+}
+
+bool process(const ImageView &input, const StageConfig &config, uint8_t *output, int stride,
+             Isa isa) {
+    int width, height;
+    if(output == nullptr || ! outputSize(input, config, &width, &height) || stride < width) {
+        return false;
+    }
+
+    static const detail::Kernels TABLES[] = {
+        makeKernels(Isa::SCALAR), makeKernels(Isa::SSE2), makeKernels(Isa::AVX2),
+        makeKernels(Isa::NEON)
+    };
+    if(! supported(isa)) {
+        isa = Isa::SCALAR;
+    }
+    const detail::Kernels &kernels = TABLES[static_cast<int>(isa)];
+    const int index = factorIndex(config.factor);
+    detail::RowKernel kernel = nullptr;
+    if(input.format == PixelFormat::GREY) {
+        kernel = kernels.grey[index];
+    } else if(input.format == PixelFormat::YUYV) {
+        kernel = kernels.yuyv[index];
+    }
+
+    const int bytes = bytesPerPixel(input.format);
+    const uint8_t *rows[4];
+    for(int y = 0; y < height; y++) {
+        for(int i = 0; i < config.factor; i++) {
+            rows[i] = input.data + static_cast<size_t>(config.y + y * config.factor + i) * input.stride
+                    + config.x * bytes;
+        }
+        uint8_t *out = output + static_cast<size_t>(y) * stride;
+
+        if(input.format == PixelFormat::GREY && config.factor == 1) {
+            std::memcpy(out, rows[0], width);
+            continue;
+        }
+        int done = kernel != nullptr ? kernel(rows, width, out) : 0;
+        scalarRow(rows, config.factor, input.format, done, width, out);
+    }
+    return true;
+}
+
+}  // namespace image_stage
@@ -0,0 +1,37 @@
+#ifndef IMAGE_STAGE_KERNELS_H
+#define IMAGE_STAGE_KERNELS_H
+
+#include <cstdint>
+
+namespace image_stage {
+namespace detail {
+
+/**
+ * @brief Converts one output row
+ * @param rows factor input rows, each pointing at the left ROI edge
+ * @param count output pixels of the row
+ * @return output pixels written from the left, a multiple of the kernel's
+ * block width; the scalar code converts the rest
+ */
+typedef int (*RowKernel)(const uint8_t *const *rows, int count, uint8_t *out);
+
+/**
+ * @brief Kernels of one instruction set, nullptr where it has none
+ */
+struct Kernels {
+    RowKernel grey[3]; //!< factor 1, 2, 4
+    RowKernel yuyv[3]; //!< factor 1, 2, 4
+};
+
+/**
+ * @brief Fill in the kernels of an instruction set on top of the ones
+ * already in kernels, false if it was not compiled in
+ */
+bool sse2Kernels(Kernels *kernels);
+bool avx2Kernels(Kernels *kernels);
+bool neonKernels(Kernels *kernels);
+
+}  // namespace detail
+}  // namespace image_stage
+
+#endif // IMAGE_STAGE_KERNELS_H
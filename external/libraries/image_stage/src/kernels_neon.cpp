@@ -0,0 +1,107 @@
+#include "kernels.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace image_stage {
+namespace detail {
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+namespace {
+
+/*
+ * vpaddl adds neighbouring lanes into lanes twice as wide, vrshrn divides by
+ * the block size with rounding and narrows. vld2 splits YUYV into luma and
+ * chroma, after that it is the grey case.
+ */
+
+inline uint8x8_t mean2(uint8x16_t row0, uint8x16_t row1) {
+    uint16x8_t sum = vaddq_u16(vpaddlq_u8(row0), vpaddlq_u8(row1));
+    return vrshrn_n_u16(sum, 2);
+}
+
+inline uint8x8_t mean4(uint8x16_t row0, uint8x16_t row1, uint8x16_t row2, uint8x16_t row3) {
+    uint16x8_t pairs = vaddq_u16(vpaddlq_u8(row0), vpaddlq_u8(row1));
+    pairs = vaddq_u16(pairs, vaddq_u16(vpaddlq_u8(row2), vpaddlq_u8(row3)));
+    // 16 input pixels per row give 4 outputs, the caller combines two
+    uint16x4_t quads = vrshrn_n_u32(vpaddlq_u16(pairs), 4);
+    return vmovn_u16(vcombine_u16(quads, quads));
+}
+
+int greyFactor2(const uint8_t *const *rows, int count, uint8_t *out) {
+    int x = 0;
+    for(; x + 8 <= count; x += 8) {
+        vst1_u8(out + x, mean2(vld1q_u8(rows[0] + 2 * x), vld1q_u8(rows[1] + 2 * x)));
+    }
+    return x;
+}
+
+int greyFactor4(const uint8_t *const *rows, int count, uint8_t *out) {
+    int x = 0;
+    for(; x + 8 <= count; x += 8) {
+        int offset = 4 * x;
+        uint8x8_t left = mean4(vld1q_u8(rows[0] + offset), vld1q_u8(rows[1] + offset),
+                vld1q_u8(rows[2] + offset), vld1q_u8(rows[3] + offset));
+        offset += 16;
+        uint8x8_t right = mean4(vld1q_u8(rows[0] + offset), vld1q_u8(rows[1] + offset),
+                vld1q_u8(rows[2] + offset), vld1q_u8(rows[3] + offset));
+        uint32x2_t packed = vzip_u32(vreinterpret_u32_u8(left), vreinterpret_u32_u8(right)).val[0];
+        vst1_u8(out + x, vreinterpret_u8_u32(packed));
+    }
+    return x;
+}
+
+int yuyvFactor1(const uint8_t *const *rows, int count, uint8_t *out) {
+    int x = 0;
+    for(; x + 16 <= count; x += 16) {
+        vst1q_u8(out + x, vld2q_u8(rows[0] + 2 * x).val[0]);
+    }
+    return x;
+}
+
+int yuyvFactor2(const uint8_t *const *rows, int count, uint8_t *out) {
+    int x = 0;
+    for(; x + 8 <= count; x += 8) {
+        vst1_u8(out + x, mean2(vld2q_u8(rows[0] + 4 * x).val[0], vld2q_u8(rows[1] + 4 * x).val[0]));
+    }
+    return x;
+}
+
+int yuyvFactor4(const uint8_t *const *rows, int count, uint8_t *out) {
+    int x = 0;
+    for(; x + 8 <= count; x += 8) {
+        int offset = 8 * x;
+        uint8x8_t left = mean4(vld2q_u8(rows[0] + offset).val[0], vld2q_u8(rows[1] + offset).val[0],
+                vld2q_u8(rows[2] + offset).val[0], vld2q_u8(rows[3] + offset).val[0]);
+        offset += 32;
+        uint8x8_t right = mean4(vld2q_u8(rows[0] + offset).val[0], vld2q_u8(rows[1] + offset).val[0],
+                vld2q_u8(rows[2] + offset).val[0], vld2q_u8(rows[3] + offset).val[0]);
+        uint32x2_t packed = vzip_u32(vreinterpret_u32_u8(left), vreinterpret_u32_u8(right)).val[0];
+        vst1_u8(out + x, vreinterpret_u8_u32(packed));
+    }
+    return x;
+}
+
+}  // namespace
+
+bool neonKernels(Kernels *kernels) {
+    kernels->grey[1] = greyFactor2;
+    kernels->grey[2] = greyFactor4;
+    kernels->yuyv[0] = yuyvFactor1;
+    kernels->yuyv[1] = yuyvFactor2;
+    kernels->yuyv[2] = yuyvFactor4;
+    return true;
+}
+
+#else
+
+bool neonKernels(Kernels*) {
+    return false;
+}
+
+#endif
+
+}  // namespace detail
+}  // namespace image_stage
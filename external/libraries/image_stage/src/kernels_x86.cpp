@@ -0,0 +1,219 @@
+#include "kernels.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace image_stage {
+namespace detail {
+
+#if defined(__SSE2__)
+
+namespace {
+
+/*
+ * A block mean is the sum of the luma bytes plus half the block size, shifted
+ * right. The bytes are added as 16 bit lanes: the low byte of a lane is
+ * masked out, the high byte shifted down, so two neighbouring pixels need no
+ * shuffle. madd with ones adds neighbouring 16 bit lanes into 32 bit.
+ */
+
+// grey 2x2: 16 input bytes per row -> 8 output pixels
+inline __m128i greyPairs2(const uint8_t *row0, const uint8_t *row1, int x) {
+    const __m128i low = _mm_set1_epi16(0x00FF);
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x));
+    __m128i sum = _mm_add_epi16(_mm_and_si128(a, low), _mm_srli_epi16(a, 8));
+    sum = _mm_add_epi16(sum, _mm_and_si128(b, low));
+    sum = _mm_add_epi16(sum, _mm_srli_epi16(b, 8));
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+}
+
+int greyFactor2(const uint8_t *const *rows, int count, uint8_t *out) {
+    int x = 0;
+    for(; x + 16 <= count; x += 16) {
+        __m128i left = greyPairs2(rows[0], rows[1], 2 * x);
+        __m128i right = greyPairs2(rows[0], rows[1], 2 * x + 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(left, right));
+    }
+    return x;
+}
+
+// grey 4x4: 16 input bytes per row -> 4 output pixels as 32 bit lanes
+inline __m128i greyQuads4(const uint8_t *const *rows, int x) {
+    const __m128i low = _mm_set1_epi16(0x00FF);
+    __m128i pairs = _mm_setzero_si128();
+    for(int i = 0; i < 4; i++) {
+        __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[i] + x));
+        pairs = _mm_add_epi16(pairs, _mm_and_si128(row, low));
+        pairs = _mm_add_epi16(pairs, _mm_srli_epi16(row, 8));
+    }
+    __m128i quads = _mm_madd_epi16(pairs, _mm_set1_epi16(1));
+    return _mm_srli_epi32(_mm_add_epi32(quads, _mm_set1_epi32(8)), 4);
+}
+
+int greyFactor4(const uint8_t *const *rows, int count, uint8_t *out) {
+    int x = 0;
+    for(; x + 16 <= count; x += 16) {
+        __m128i a = greyQuads4(rows, 4 * x);
+        __m128i b = greyQuads4(rows, 4 * x + 16);
+        __m128i c = greyQuads4(rows, 4 * x + 32);
+        __m128i d = greyQuads4(rows, 4 * x + 48);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), packed);
+    }
+    return x;
+}
+
+// YUYV: 16 input bytes -> 8 luma values as 16 bit lanes
+inline __m128i luma(const uint8_t *row, int x) {
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+    return _mm_and_si128(pixels, _mm_set1_epi16(0x00FF));
+}
+
+int yuyvFactor1(const uint8_t *const *rows, int count, uint8_t *out) {
+    int x = 0;
+    for(; x + 16 <= count; x += 16) {
+        __m128i packed = _mm_packus_epi16(luma(rows[0], 2 * x), luma(rows[0], 2 * x + 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), packed);
+    }
+    return x;
+}
+
+// YUYV 2x2: 16 input bytes per row -> 4 output pixels as 32 bit lanes
+inline __m128i yuyvPairs2(const uint8_t *const *rows, int x) {
+    __m128i sum = _mm_add_epi16(luma(rows[0], x), luma(rows[1], x));
+    __m128i pairs = _mm_madd_epi16(sum, _mm_set1_epi16(1));
+    return _mm_srli_epi32(_mm_add_epi32(pairs, _mm_set1_epi32(2)), 2);
+}
+
+int yuyvFactor2(const uint8_t *const *rows, int count, uint8_t *out) {
+    int x = 0;
+    for(; x + 16 <= count; x += 16) {
+        __m128i a = yuyvPairs2(rows, 4 * x);
+        __m128i b = yuyvPairs2(rows, 4 * x + 16);
+        __m128i c = yuyvPairs2(rows, 4 * x + 32);
+        __m128i d = yuyvPairs2(rows, 4 * x + 48);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), packed);
+    }
+    return x;
+}
+
+// YUYV 4x4: 32 input bytes per row -> 4 output pixels as 32 bit lanes
+inline __m128i yuyvQuads4(const uint8_t *const *rows, int x) {
+    __m128i left = _mm_setzero_si128();
+    __m128i right = _mm_setzero_si128();
+    for(int i = 0; i < 4; i++) {
+        left = _mm_add_epi16(left, luma(rows[i], x));
+        right = _mm_add_epi16(right, luma(rows[i], x + 16));
+    }
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i pairs = _mm_packs_epi32(_mm_madd_epi16(left, ones), _mm_madd_epi16(right, ones));
+    __m128i quads = _mm_madd_epi16(pairs, ones);
+    return _mm_srli_epi32(_mm_add_epi32(quads, _mm_set1_epi32(8)), 4);
+}
+
+int yuyvFactor4(const uint8_t *const *rows, int count, uint8_t *out) {
+    int x = 0;
+    for(; x + 16 <= count; x += 16) {
+        __m128i a = yuyvQuads4(rows, 8 * x);
+        __m128i b = yuyvQuads4(rows, 8 * x + 32);
+        __m128i c = yuyvQuads4(rows, 8 * x + 64);
+        __m128i d = yuyvQuads4(rows, 8 * x + 96);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), packed);
+    }
+    return x;
+}
+
+/*
+ * AVX2 packs work within each 128 bit half, the results are put back in
+ * order with a cross-lane permute.
+ */
+
+__attribute__((target("avx2")))
+inline __m256i greyPairs2Avx2(const uint8_t *row0, const uint8_t *row1, int x) {
+    const __m256i low = _mm256_set1_epi16(0x00FF);
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x));
+    __m256i sum = _mm256_add_epi16(_mm256_and_si256(a, low), _mm256_srli_epi16(a, 8));
+    sum = _mm256_add_epi16(sum, _mm256_and_si256(b, low));
+    sum = _mm256_add_epi16(sum, _mm256_srli_epi16(b, 8));
+    return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(2)), 2);
+}
+
+__attribute__((target("avx2")))
+int greyFactor2Avx2(const uint8_t *const *rows, int count, uint8_t *out) {
+    int x = 0;
+    for(; x + 32 <= count; x += 32) {
+        __m256i left = greyPairs2Avx2(rows[0], rows[1], 2 * x);
+        __m256i right = greyPairs2Avx2(rows[0], rows[1], 2 * x + 32);
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(left, right), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), packed);
+    }
+    return x;
+}
+
+__attribute__((target("avx2")))
+inline __m256i greyQuads4Avx2(const uint8_t *const *rows, int x) {
+    const __m256i low = _mm256_set1_epi16(0x00FF);
+    __m256i pairs = _mm256_setzero_si256();
+    for(int i = 0; i < 4; i++) {
+        __m256i row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[i] + x));
+        pairs = _mm256_add_epi16(pairs, _mm256_and_si256(row, low));
+        pairs = _mm256_add_epi16(pairs, _mm256_srli_epi16(row, 8));
+    }
+    __m256i quads = _mm256_madd_epi16(pairs, _mm256_set1_epi16(1));
+    return _mm256_srli_epi32(_mm256_add_epi32(quads, _mm256_set1_epi32(8)), 4);
+}
+
+__attribute__((target("avx2")))
+int greyFactor4Avx2(const uint8_t *const *rows, int count, uint8_t *out) {
+    // after both packs each half holds 4 pixels of a, b, c and d in turn
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int x = 0;
+    for(; x + 32 <= count; x += 32) {
+        __m256i a = greyQuads4Avx2(rows, 4 * x);
+        __m256i b = greyQuads4Avx2(rows, 4 * x + 32);
+        __m256i c = greyQuads4Avx2(rows, 4 * x + 64);
+        __m256i d = greyQuads4Avx2(rows, 4 * x + 96);
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        packed = _mm256_permutevar8x32_epi32(packed, order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), packed);
+    }
+    return x;
+}
+
+}  // namespace
+
+bool sse2Kernels(Kernels *kernels) {
+    kernels->grey[1] = greyFactor2;
+    kernels->grey[2] = greyFactor4;
+    kernels->yuyv[0] = yuyvFactor1;
+    kernels->yuyv[1] = yuyvFactor2;
+    kernels->yuyv[2] = yuyvFactor4;
+    return true;
+}
+
+bool avx2Kernels(Kernels *kernels) {
+    // YUYV keeps the SSE2 kernels
+    kernels->grey[1] = greyFactor2Avx2;
+    kernels->grey[2] = greyFactor4Avx2;
+    return true;
+}
+
+#else
+
+bool sse2Kernels(Kernels*) {
+    return false;
+}
+
+bool avx2Kernels(Kernels*) {
+    return false;
+}
+
+#endif
+
+}  // namespace detail
+}  // namespace image_stage
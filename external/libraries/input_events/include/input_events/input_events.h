@@ -0,0 +1,126 @@
+#ifndef INPUT_EVENTS_INPUT_EVENTS_H
+#define INPUT_EVENTS_INPUT_EVENTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace input_events {
+
+/**
+ * @brief Driver inputs, the contents of the key/gamepad commands in the
+ * configs (e.g. `<content>acc_down</content>`)
+ */
+enum class Action : uint8_t {
+    NONE = 0,
+    LEFT,
+    RIGHT,
+    LEFT_UP,
+    RIGHT_UP,
+    ACC_DOWN,
+    ACC_UP,
+    BREAK_DOWN,
+    BREAK_UP,
+    __END__ // Action counter, must be LAST
+};
+
+/**
+ * @brief actionName config name of an action, e.g. "acc_down"
+ */
+const char* actionName(Action action);
+
+const uint8_t SOURCE_KEYBOARD = 0;
+const uint8_t SOURCE_GAMEPAD = 1;
+
+struct InputEvent {
+    Action action;
+    uint8_t source; //!< SOURCE_KEYBOARD or SOURCE_GAMEPAD
+    int16_t value; //!< Analog value of gamepad axes, 0 for keys
+};
+
+/**
+ * @brief Input events of one cycle, fixed size so it is filled and read
+ * without allocations
+ */
+struct InputEvents {
+    static const uint8_t CAPACITY = 64;
+
+    InputEvents() : count(0), dropped(0) {
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    /**
+     * @return false if the list is full, the event is counted as dropped
+     */
+    bool push(const InputEvent &event) {
+        if(count == CAPACITY) {
+            dropped++;
+            return false;
+        }
+        events[count++] = event;
+        return true;
+    }
+
+    const InputEvent* begin() const {
+        return events;
+    }
+
+    const InputEvent* end() const {
+        return events + count;
+    }
+
+    uint8_t size() const {
+        return count;
+    }
+
+    uint8_t count;
+    uint32_t dropped; //!< Events lost since the start because the list was full
+    InputEvent events[CAPACITY];
+};
+
+/**
+ * @brief Maps command contents to actions
+ *
+ * Built once at startup, afterwards each string is looked up once where it
+ * enters the system instead of being compared by every consumer. The names
+ * are kept sorted, a lookup is a binary search without allocations.
+ */
+class ActionTable {
+public:
+    /**
+     * @brief ActionTable knows the names of all actions
+     */
+    ActionTable();
+
+    /**
+     * @brief alias maps an additional name to an action
+     */
+    void alias(const std::string &name, Action action);
+
+    /**
+     * @param name first character of the name, need not be terminated
+     * @param length characters of the name
+     * @return Action::NONE for unknown names
+     */
+    Action find(const char *name, size_t length) const;
+
+    Action find(const std::string &name) const {
+        return find(name.data(), name.size());
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        Action action;
+    };
+
+    std::vector<Entry> actions; //!< sorted by name
+};
+
+}  // namespace input_events
+
+#endif // INPUT_EVENTS_INPUT_EVENTS_H
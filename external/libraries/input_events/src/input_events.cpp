@@ -0,0 +1,62 @@
+#include "input_events/input_events.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace input_events {
+
+namespace {
+
+const char* const NAMES[] = {
+    "none",
+    "left",
+    "right",
+    "left_up",
+    "right_up",
+    "acc_down",
+    "acc_up",
+    "break_down",
+    "break_up"
+};
+
+static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == static_cast<size_t>(Action::__END__),
+              "every action needs a name");
+
+}  // namespace
+
+const char* actionName(Action action) {
+    return action < Action::__END__ ? NAMES[static_cast<uint8_t>(action)] : NAMES[0];
+}
+
+ActionTable::ActionTable() {
+    for(uint8_t i = 1; i < static_cast<uint8_t>(Action::__END__); i++) {
+        alias(NAMES[i], static_cast<Action>(i));
+    }
+}
+
+void ActionTable::alias(const std::string &name, Action action) {
+    auto it = std::lower_bound(actions.begin(), actions.end(), name,
+                               [](const Entry &entry, const std::string &name) {
+        return entry.name < name;
+    });
+    if(it != actions.end() && it->name == name) {
+        it->action = action;
+    } else {
+        actions.insert(it, Entry{name, action});
+    }
+}
+
+Action ActionTable::find(const char *name, size_t length) const {
+    auto it = std::lower_bound(actions.begin(), actions.end(), length,
+                               [name](const Entry &entry, size_t length) {
+        int order = std::memcmp(entry.name.data(), name, std::min(entry.name.size(), length));
+        return order < 0 || (order == 0 && entry.name.size() < length);
+    });
+    if(it == actions.end() || it->name.size() != length
+            || std::memcmp(it->name.data(), name, length) != 0) {
+        return Action::NONE;
+    }
+    return it->action;
+}
+
+}  // namespace input_events
@@ -0,0 +1,9 @@
+#include "bench_module.h"
+
+namespace BENCH_NAMESPACE {
+
+int libraryStep(int value) {
+    return value * 1103515245 + 12345;
+}
+
+}  // namespace BENCH_NAMESPACE
@@ -0,0 +1,29 @@
+#include "bench_module.h"
+
+namespace {
+
+class BenchModule : public BenchModuleBase {
+public:
+    BenchModule() : state(1) {
+    }
+
+    int cycle(int steps) override {
+        int value = state;
+        for(int i = 0; i < steps; i++) {
+            value = BENCH_NAMESPACE::libraryStep(value);
+        }
+        state = value;
+        return value;
+    }
+
+private:
+    int state;
+};
+
+}  // namespace
+
+extern "C" {
+void* getInstance() {
+    return static_cast<BenchModuleBase*>(new BenchModule);
+}
+}
@@ -0,0 +1,24 @@
+#ifndef MODULE_REGISTRY_BENCH_MODULE_H
+#define MODULE_REGISTRY_BENCH_MODULE_H
+
+/**
+ * @brief Stand-in for lms::Module
+ */
+class BenchModuleBase {
+public:
+    virtual ~BenchModuleBase() {}
+
+    /**
+     * @brief cycle calls a function of a library steps times, like a module
+     * calling into lmscore or a shared library each cycle
+     */
+    virtual int cycle(int steps) = 0;
+};
+
+namespace BENCH_NAMESPACE {
+
+int libraryStep(int value);
+
+}  // namespace BENCH_NAMESPACE
+
+#endif // MODULE_REGISTRY_BENCH_MODULE_H
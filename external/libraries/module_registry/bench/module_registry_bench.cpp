@@ -0,0 +1,150 @@
+/**
+ * Startup and call cost of a module loaded as shared library against one
+ * linked into the binary. The shared module is copied to --modules files,
+ * each is opened with dlopen, getInstance resolved and called, as the
+ * framework does per module. The linked module is found with the find() of
+ * a registry generated from src/registry.cpp.in with 64 entries, as many
+ * lookups as modules. Then each module calls a library function per step, the
+ * shared one through the PLT into a shared library, the linked one with
+ * LTO across the module boundary.
+ *
+ * Usage: module_registry_bench <shared module> [--modules N] [--steps N]
+ *
+ * --modules  modules to load, default 16, at most 64
+ * --steps    library calls measured, default 100000000
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "bench_module.h"
+#include "module_registry/registry.h"
+
+extern "C" void* linked_getInstance();
+
+namespace {
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool copyFile(const std::string &from, const std::string &to) {
+    std::ifstream in(from.c_str(), std::ios::binary);
+    std::ofstream out(to.c_str(), std::ios::binary);
+    out << in.rdbuf();
+    return in && out;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        std::fprintf(stderr, "Usage: %s <shared module> [--modules N] [--steps N]\n", argv[0]);
+        return 1;
+    }
+    std::string shared = argv[1];
+    int modules = 16;
+    int steps = 100000000;
+    for(int i = 2; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if(arg == "--modules") {
+            modules = std::atoi(argv[i + 1]);
+        } else if(arg == "--steps") {
+            steps = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if(modules < 1 || static_cast<size_t>(modules) > module_registry::count()) {
+        std::fprintf(stderr, "--modules must be 1 to %zu\n", module_registry::count());
+        return 1;
+    }
+
+    // every copy is a new library for the dynamic loader
+    std::vector<std::string> paths;
+    char directory[] = "/tmp/module_registry_benchXXXXXX";
+    if(mkdtemp(directory) == nullptr) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    for(int i = 0; i < modules; i++) {
+        paths.push_back(std::string(directory) + "/libmodule" + std::to_string(i) + ".so");
+        if(! copyFile(shared, paths.back())) {
+            std::fprintf(stderr, "Could not copy %s\n", shared.c_str());
+            return 1;
+        }
+    }
+
+    std::vector<void*> handles;
+    std::vector<BenchModuleBase*> loaded;
+    int64_t start = nowNanos();
+    for(const std::string &path : paths) {
+        void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if(handle == nullptr) {
+            std::fprintf(stderr, "%s\n", dlerror());
+            return 1;
+        }
+        module_registry::Factory factory =
+                reinterpret_cast<module_registry::Factory>(dlsym(handle, "getInstance"));
+        if(factory == nullptr) {
+            std::fprintf(stderr, "%s\n", dlerror());
+            return 1;
+        }
+        handles.push_back(handle);
+        loaded.push_back(static_cast<BenchModuleBase*>(factory()));
+    }
+    int64_t dlopenTime = nowNanos() - start;
+
+    // the names the framework would ask the generated registry for
+    std::vector<std::string> names;
+    for(int i = 0; i < modules; i++) {
+        names.push_back("module_" + std::to_string(i));
+    }
+    std::vector<BenchModuleBase*> linked;
+    start = nowNanos();
+    for(const std::string &name : names) {
+        module_registry::Factory factory = module_registry::find(name.c_str());
+        if(factory == nullptr) {
+            std::fprintf(stderr, "%s is not in the registry\n", name.c_str());
+            return 1;
+        }
+        linked.push_back(static_cast<BenchModuleBase*>(factory()));
+    }
+    int64_t linkedTime = nowNanos() - start;
+
+    std::printf("startup of %d modules: dlopen %.0f us, linked %.1f us\n", modules,
+                dlopenTime / 1e3, linkedTime / 1e3);
+
+    start = nowNanos();
+    int a = loaded[0]->cycle(steps);
+    int64_t sharedCalls = nowNanos() - start;
+    start = nowNanos();
+    int b = linked[0]->cycle(steps);
+    int64_t linkedCalls = nowNanos() - start;
+    std::printf("library call from a module: shared %.2f ns, linked %.2f ns%s\n",
+                static_cast<double>(sharedCalls) / steps, static_cast<double>(linkedCalls) / steps,
+                a == b ? "" : " (results differ!)");
+
+    for(BenchModuleBase *module : loaded) {
+        delete module;
+    }
+    for(BenchModuleBase *module : linked) {
+        delete module;
+    }
+    for(void *handle : handles) {
+        dlclose(handle);
+    }
+    for(const std::string &path : paths) {
+        unlink(path.c_str());
+    }
+    rmdir(directory);
+    return a == b ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+#ifndef MODULE_REGISTRY_REGISTRY_H
+#define MODULE_REGISTRY_REGISTRY_H
+
+#include <cstddef>
+
+namespace module_registry {
+
+/**
+ * @brief getInstance of a module, returns a new lms::Module
+ */
+typedef void* (*Factory)();
+
+struct Entry {
+    const char *name; //!< library name of the module, e.g. image_converter
+    Factory factory;
+};
+
+/**
+ * @brief Modules linked into the binary, sorted by name
+ *
+ * Generated at configure time when the modules are built with
+ * LMS_STATIC_MODULES (see external/modules/CMakeLists.txt), the framework
+ * then creates these modules through their factory instead of loading a
+ * shared library. Targets linking lms_static_modules get LMS_STATIC_MODULES
+ * defined.
+ */
+const Entry* entries();
+size_t count();
+
+/**
+ * @brief find looks a module up in O(log n)
+ * @return nullptr if the module is not linked in, load it with dlopen then
+ */
+Factory find(const char *name);
+
+}  // namespace module_registry
+
+#endif // MODULE_REGISTRY_REGISTRY_H
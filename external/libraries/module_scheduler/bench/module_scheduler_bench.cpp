@@ -0,0 +1,199 @@
+/**
+ * Cycle time of the car.xml module chain, run in topological order on one
+ * thread and on the parallel executor. The modules are simulated by busy
+ * work and blocking waits of typical length.
+ *
+ * Usage: module_scheduler_bench [--cycles N] [--threads N] [--cores 1,2,3]
+ *                               [--scale F]
+ *
+ * --cycles   cycles per run, default 500
+ * --threads  largest thread count to try, default 4
+ * --cores    pin the threads to these CPUs
+ * --scale    multiply all module durations, default 1
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "module_scheduler/dependency_graph.h"
+#include "module_scheduler/parallel_executor.h"
+
+using namespace module_scheduler;
+
+namespace {
+
+struct SimulatedModule {
+    const char *name;
+    double computeMillis; //!< busy CPU time
+    double waitMillis; //!< blocking I/O, the core is free meanwhile
+    std::vector<const char*> reads;
+    std::vector<const char*> writes;
+    int priority; //!< channelMapping priority of the reads
+};
+
+/**
+ * @brief Modules of car.xml with their channels, rough durations for a
+ * 752x480 uEye image, --scale adjusts them to the machine
+ */
+const std::vector<SimulatedModule> CAR_MODULES = {
+    {"ueye_importer", 1.5, 1.0, {}, {"CAMERA_IMAGE"}, 0},
+    {"image_converter_scaledown", 2.5, 0, {"CAMERA_IMAGE"}, {"IMAGE"}, 0},
+    {"socket_data_sender", 0.6, 0.2, {"IMAGE"}, {}, 0},
+    {"socket_data_receiver", 0.2, 0.1, {}, {"CAR"}, 0},
+    {"car_to_senseboard2015", 0.05, 0, {"CAR"}, {"CONTROL_DATA", "SENSOR_DATA"}, 10},
+    {"importer_senseboard2015", 0.5, 1.5, {"CONTROL_DATA"}, {"SENSOR_DATA"}, 0},
+    {"cycle_trace_dump", 0.02, 0, {}, {}, 0}
+};
+
+int64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void busy(double millis) {
+    int64_t end = nowMicros() + static_cast<int64_t>(millis * 1000);
+    while(nowMicros() < end) {
+    }
+}
+
+struct Result {
+    std::vector<int64_t> cycles;
+    int violations;
+};
+
+void printResult(const char *name, Result &result, double reference) {
+    std::sort(result.cycles.begin(), result.cycles.end());
+    auto percentile = [&result](double p) {
+        return result.cycles[std::min(result.cycles.size() - 1,
+                                      static_cast<size_t>(p * result.cycles.size()))] / 1000.0;
+    };
+    double p50 = percentile(0.5);
+    std::printf("%-12s p50 %6.2f  p99 %6.2f  max %6.2f ms  speed-up %4.2f  order violations %d\n",
+                name, p50, percentile(0.99), result.cycles.back() / 1000.0,
+                reference > 0 ? reference / p50 : 1.0, result.violations);
+}
+
+std::vector<int> parseList(const std::string &text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while(std::getline(stream, item, ',')) {
+        values.push_back(std::atoi(item.c_str()));
+    }
+    return values;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    int cycles = 500;
+    unsigned int maxThreads = 4;
+    double scale = 1;
+    std::vector<int> cores;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if(arg == "--cycles") {
+            cycles = std::atoi(argv[i + 1]);
+        } else if(arg == "--threads") {
+            maxThreads = std::atoi(argv[i + 1]);
+        } else if(arg == "--cores") {
+            cores = parseList(argv[i + 1]);
+        } else if(arg == "--scale") {
+            scale = std::atof(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    DependencyGraph graph;
+    for(const SimulatedModule &module : CAR_MODULES) {
+        int index = graph.addModule(module.name);
+        for(const char *channel : module.reads) {
+            graph.readChannel(index, channel, module.priority);
+        }
+        for(const char *channel : module.writes) {
+            graph.writeChannel(index, channel);
+        }
+    }
+    std::string error;
+    if(! graph.build(&error)) {
+        std::fprintf(stderr, "Dependency cycle: %s\n", error.c_str());
+        return 1;
+    }
+
+    for(size_t i = 0; i < graph.size(); i++) {
+        std::printf("%-26s ->", graph.name(i).c_str());
+        for(int next : graph.successors(i)) {
+            std::printf(" %s", graph.name(next).c_str());
+        }
+        std::printf("\n");
+    }
+
+    // cycle in which each module ran last, checks the order of the executor
+    std::vector<std::atomic<int>> ranIn(graph.size());
+    std::vector<std::vector<int>> predecessors(graph.size());
+    for(size_t i = 0; i < graph.size(); i++) {
+        for(int next : graph.successors(i)) {
+            predecessors[next].push_back(i);
+        }
+    }
+    int currentCycle = 0;
+    std::atomic<int> violations(0);
+
+    auto runModule = [&](int index) {
+        for(int previous : predecessors[index]) {
+            if(ranIn[previous].load() != currentCycle) {
+                violations++;
+            }
+        }
+        const SimulatedModule &module = CAR_MODULES[index];
+        busy(module.computeMillis * scale);
+        if(module.waitMillis > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(
+                    static_cast<int64_t>(module.waitMillis * scale * 1000)));
+        }
+        ranIn[index] = currentCycle;
+        return true;
+    };
+
+    Result serial;
+    for(currentCycle = 1; currentCycle <= cycles; currentCycle++) {
+        int64_t start = nowMicros();
+        for(int index : graph.order()) {
+            runModule(index);
+        }
+        serial.cycles.push_back(nowMicros() - start);
+    }
+    serial.violations = violations.exchange(0);
+    printResult("serial", serial, 0);
+    std::sort(serial.cycles.begin(), serial.cycles.end());
+    double reference = serial.cycles[serial.cycles.size() / 2] / 1000.0;
+
+    for(unsigned int threads = 2; threads <= maxThreads; threads++) {
+        ExecutorOptions options;
+        options.threads = threads;
+        options.cores = cores;
+        ParallelExecutor executor(graph, runModule, options);
+
+        Result parallel;
+        for(int i = 1; i <= cycles; i++) {
+            currentCycle = cycles + (threads - 1) * cycles + i;
+            int64_t start = nowMicros();
+            executor.cycle();
+            parallel.cycles.push_back(nowMicros() - start);
+        }
+        parallel.violations = violations.exchange(0);
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%u threads", threads);
+        printResult(name, parallel, reference);
+    }
+    return 0;
+}
@@ -0,0 +1,182 @@
+/**
+ * Latency from a driver input to socket_data_sender in the pc.xml chain
+ * input_event_mapper -> ogre_input_to_car -> socket_data_sender, once only on
+ * the framework clock and once with the chain triggered by its inputs.
+ * A second input thread plays a gamepad axis that changes every
+ * millisecond, the rate cap coalesces it.
+ *
+ * Usage: trigger_bench [--seconds N] [--hz N] [--max-rate N]
+ *
+ * --seconds   duration per run, default 5
+ * --hz        framework clock, default 100
+ * --max-rate  rate cap of input_event_mapper [Hz], default 500
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "module_scheduler/trigger_queue.h"
+
+using namespace module_scheduler;
+
+namespace {
+
+const char *CHAIN[] = {"input_event_mapper", "ogre_input_to_car", "socket_data_sender"};
+const char *TRIGGERS[] = {"car", "INPUT_EVENTS", "CAR"};
+const char *WRITES[] = {"INPUT_EVENTS", "CAR", ""};
+const int CHAIN_LENGTH = 3;
+
+void busy(int64_t micros) {
+    int64_t end = TriggerQueue::now() + micros;
+    while(TriggerQueue::now() < end) {
+    }
+}
+
+struct Result {
+    std::vector<int64_t> latencies;
+    uint64_t runs; //!< module runs, clocked and triggered
+    uint64_t sends;
+    uint64_t coalesced;
+};
+
+/**
+ * @brief Earliest input not yet sent, 0 if none
+ */
+std::atomic<int64_t> unsent(0);
+
+void input(TriggerQueue *queue, int64_t end, bool keys) {
+    std::mt19937 random(keys ? 1 : 2);
+    // keys at random times, the axis every millisecond
+    std::uniform_int_distribution<int> pause(5000, 40000);
+    while(TriggerQueue::now() < end) {
+        std::this_thread::sleep_for(std::chrono::microseconds(keys ? pause(random) : 1000));
+        int64_t expected = 0;
+        unsent.compare_exchange_strong(expected, TriggerQueue::now());
+        queue->notify("car");
+    }
+}
+
+Result run(bool triggered, double seconds, int hz, int maxRate, bool axis) {
+    TriggerQueue queue;
+    // the cap at the start of the chain limits the modules after it too
+    TriggerOptions capped;
+    capped.minInterval = maxRate > 0 ? 1000000 / maxRate : 0;
+    for(int i = 0; i < CHAIN_LENGTH; i++) {
+        queue.addModule(CHAIN[i], i == 0 ? capped : TriggerOptions());
+        if(triggered) {
+            queue.triggerOn(i, TRIGGERS[i]);
+        }
+    }
+
+    Result result;
+    result.runs = 0;
+    result.sends = 0;
+    unsent = 0;
+    int64_t period = 1000000 / hz;
+    int64_t end = TriggerQueue::now() + static_cast<int64_t>(seconds * 1e6);
+    std::thread keys(input, &queue, end, true);
+    std::thread gamepad;
+    if(axis) {
+        gamepad = std::thread(input, &queue, end, false);
+    }
+
+    auto send = [&result]() {
+        int64_t since = unsent.exchange(0);
+        if(since != 0) {
+            result.latencies.push_back(TriggerQueue::now() - since);
+        }
+        result.sends++;
+    };
+
+    int64_t tick = TriggerQueue::now() + period;
+    std::vector<int> ready;
+    while(TriggerQueue::now() < end) {
+        if(queue.wait(tick, &ready)) {
+            for(int module : ready) {
+                busy(50);
+                result.runs++;
+                if(module == CHAIN_LENGTH - 1) {
+                    send();
+                } else {
+                    queue.notify(WRITES[module]);
+                }
+            }
+            continue;
+        }
+
+        // clock tick: the whole chain in order
+        for(int i = 0; i < CHAIN_LENGTH; i++) {
+            busy(50);
+            result.runs++;
+            if(i == CHAIN_LENGTH - 1) {
+                send();
+            }
+            queue.ran(i);
+        }
+        tick += period;
+        int64_t now = TriggerQueue::now();
+        if(tick < now) {
+            tick = now + period;
+        }
+    }
+    keys.join();
+    if(gamepad.joinable()) {
+        gamepad.join();
+    }
+    result.coalesced = 0;
+    for(size_t i = 0; i < queue.size(); i++) {
+        result.coalesced += queue.coalesced(i);
+    }
+    return result;
+}
+
+void print(const char *name, Result &result, double seconds) {
+    std::sort(result.latencies.begin(), result.latencies.end());
+    auto percentile = [&result](double p) {
+        if(result.latencies.empty()) {
+            return 0.0;
+        }
+        return result.latencies[std::min(result.latencies.size() - 1,
+                                         static_cast<size_t>(p * result.latencies.size()))] / 1000.0;
+    };
+    std::printf("%-22s input -> send p50 %5.2f  p99 %5.2f  max %5.2f ms  %6.0f module runs/s  "
+                "%6.0f sends/s  %llu coalesced\n", name, percentile(0.5), percentile(0.99),
+                result.latencies.empty() ? 0.0 : result.latencies.back() / 1000.0,
+                result.runs / seconds, result.sends / seconds,
+                static_cast<unsigned long long>(result.coalesced));
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    double seconds = 5;
+    int hz = 100;
+    int maxRate = 500;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if(arg == "--seconds") {
+            seconds = std::atof(argv[i + 1]);
+        } else if(arg == "--hz") {
+            hz = std::atoi(argv[i + 1]);
+        } else if(arg == "--max-rate") {
+            maxRate = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    Result clock = run(false, seconds, hz, maxRate, false);
+    print("clock", clock, seconds);
+    Result triggered = run(true, seconds, hz, maxRate, false);
+    print("triggered", triggered, seconds);
+    Result axis = run(true, seconds, hz, maxRate, true);
+    print("triggered + 1 kHz axis", axis, seconds);
+    return 0;
+}
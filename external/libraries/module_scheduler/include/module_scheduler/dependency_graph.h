@@ -0,0 +1,93 @@
+#ifndef MODULE_SCHEDULER_DEPENDENCY_GRAPH_H
+#define MODULE_SCHEDULER_DEPENDENCY_GRAPH_H
+
+#include <string>
+#include <vector>
+
+namespace module_scheduler {
+
+/**
+ * @brief Execution order of modules derived from their data channel accesses
+ *
+ * Every module registers the channels it reads and writes, as in
+ * readChannel()/writeChannel() of its initialize(). Per channel the accesses
+ * are ordered by priority (higher first, like channelMapping priority),
+ * writers before readers of the same priority. From that order:
+ * - a writer runs before every later access of the channel
+ * - a reader runs before the next writer of the channel
+ *
+ * Modules without a path between them may run concurrently.
+ */
+class DependencyGraph {
+public:
+    /**
+     * @brief addModule adds a module
+     * @param mainThread module must run on the thread calling
+     * ParallelExecutor::cycle(), e.g. for window handling
+     * @return module index
+     */
+    int addModule(const std::string &name, bool mainThread = false);
+
+    void readChannel(int module, const std::string &channel, int priority = 0);
+    void writeChannel(int module, const std::string &channel, int priority = 0);
+
+    /**
+     * @brief build derives the edges, call it after all accesses are added
+     * @param error set to the modules involved if the accesses form a cycle
+     * @return false on a cycle
+     */
+    bool build(std::string *error = nullptr);
+
+    size_t size() const {
+        return modules.size();
+    }
+
+    const std::string& name(int module) const {
+        return modules[module].name;
+    }
+
+    bool mainThread(int module) const {
+        return modules[module].mainThread;
+    }
+
+    const std::vector<int>& successors(int module) const {
+        return modules[module].successors;
+    }
+
+    int predecessorCount(int module) const {
+        return modules[module].predecessors;
+    }
+
+    /**
+     * @brief order all modules so that every module comes after its
+     * predecessors, valid after build()
+     */
+    const std::vector<int>& order() const {
+        return topologicalOrder;
+    }
+
+private:
+    struct Access {
+        int module;
+        bool write;
+        int priority;
+    };
+
+    struct Module {
+        std::string name;
+        bool mainThread;
+        std::vector<int> successors;
+        int predecessors;
+    };
+
+    void addEdge(int from, int to);
+    Access* findAccess(const std::string &channel, int module);
+
+    std::vector<Module> modules;
+    std::vector<std::pair<std::string, std::vector<Access>>> channels;
+    std::vector<int> topologicalOrder;
+};
+
+}  // namespace module_scheduler
+
+#endif // MODULE_SCHEDULER_DEPENDENCY_GRAPH_H
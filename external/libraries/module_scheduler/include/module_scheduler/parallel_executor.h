@@ -0,0 +1,120 @@
+#ifndef MODULE_SCHEDULER_PARALLEL_EXECUTOR_H
+#define MODULE_SCHEDULER_PARALLEL_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "module_scheduler/dependency_graph.h"
+
+namespace module_scheduler {
+
+struct ExecutorOptions {
+    ExecutorOptions() : threads(0) {
+    }
+
+    /**
+     * @brief Threads running modules including the caller of cycle(),
+     * 0 for one per core
+     */
+    unsigned int threads;
+
+    /**
+     * @brief CPU per thread, the caller of cycle() first, repeated if shorter
+     * than threads, empty for no pinning
+     */
+    std::vector<int> cores;
+};
+
+/**
+ * @brief Runs the modules of a DependencyGraph once per cycle() on a
+ * work-stealing thread pool
+ *
+ * A module becomes ready when all its predecessors finished in this cycle.
+ * The thread that finishes a module queues the successors that became ready
+ * on its own deque and continues with the newest one, so a chain of modules
+ * stays on one core while its data is in the cache. Idle threads steal the
+ * oldest entry of another deque.
+ *
+ * mainThread modules only run on the thread calling cycle(), which works on
+ * the other modules too while it waits.
+ */
+class ParallelExecutor {
+public:
+    /**
+     * @param graph built graph, must outlive the executor
+     * @param run called with the module index, false stops the cycle after
+     * the running modules finished
+     */
+    ParallelExecutor(const DependencyGraph &graph, std::function<bool(int)> run,
+                     const ExecutorOptions &options = ExecutorOptions());
+    ~ParallelExecutor();
+
+    ParallelExecutor(const ParallelExecutor&) = delete;
+    ParallelExecutor& operator=(const ParallelExecutor&) = delete;
+
+    /**
+     * @brief cycle runs every module once, returns when all finished
+     * @return false if a module returned false
+     */
+    bool cycle();
+
+    unsigned int threads() const {
+        return static_cast<unsigned int>(queues.size());
+    }
+
+    /**
+     * @brief steals number of modules a thread took from another thread's deque
+     */
+    uint64_t steals() const {
+        return stealCount.load();
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<int> modules;
+    };
+
+    void workerLoop(unsigned int index);
+
+    /**
+     * @brief next takes a ready module for the given thread
+     * @return -1 if nothing is ready
+     */
+    int next(unsigned int worker);
+    void push(unsigned int worker, int module);
+    void execute(unsigned int worker, int module);
+    void pin(unsigned int worker);
+
+    const DependencyGraph &graph;
+    std::function<bool(int)> run;
+    std::vector<int> cores;
+
+    std::vector<std::unique_ptr<Queue>> queues; //!< one per thread, 0 is the caller
+    Queue mainQueue;
+    std::unique_ptr<std::atomic<int>[]> remaining; //!< unfinished predecessors per module
+
+    std::atomic<int> outstanding; //!< modules of this cycle not finished yet
+    std::atomic<int> queued; //!< modules waiting in the thread deques
+    std::atomic<int> mainQueued; //!< modules waiting in mainQueue
+    std::atomic<bool> failed;
+    std::atomic<uint64_t> stealCount;
+    bool callerPinned;
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable cycleDone;
+    bool stopping;
+
+    std::vector<std::thread> workers;
+};
+
+}  // namespace module_scheduler
+
+#endif // MODULE_SCHEDULER_PARALLEL_EXECUTOR_H
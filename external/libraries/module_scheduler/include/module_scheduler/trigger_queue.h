@@ -0,0 +1,137 @@
+#ifndef MODULE_SCHEDULER_TRIGGER_QUEUE_H
+#define MODULE_SCHEDULER_TRIGGER_QUEUE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace module_scheduler {
+
+struct TriggerOptions {
+    TriggerOptions() : minInterval(0) {
+    }
+
+    /**
+     * @brief Rate cap: shortest time between two runs, notifications in
+     * between are coalesced into one run at the end of the interval [us]
+     */
+    int64_t minInterval;
+};
+
+/**
+ * @brief Runs modules as soon as their input changed instead of on the
+ * next clock tick
+ *
+ * A triggered module names the data channels or messaging commands it waits
+ * for. notify() marks every module waiting on the source pending and wakes
+ * the thread sleeping in wait(), which sleeps until the next clock tick or
+ * the first pending module. A module runs at most once per minInterval, any
+ * number of notifications until then result in one run.
+ *
+ * The thread calling wait() runs the modules it returns, a module that
+ * writes a channel notifies it and the next wait() returns its triggered
+ * readers, so a chain of modules runs within one wake-up. Triggered modules
+ * keep running on the clock too, ran() tells the queue about those runs.
+ */
+class TriggerQueue {
+public:
+    TriggerQueue();
+
+    TriggerQueue(const TriggerQueue&) = delete;
+    TriggerQueue& operator=(const TriggerQueue&) = delete;
+
+    /**
+     * @brief addModule adds a triggered module, wait() returns modules of a
+     * wake-up in the order they were added, add them in execution order
+     * @return module index
+     */
+    int addModule(const std::string &name, const TriggerOptions &options = TriggerOptions());
+
+    /**
+     * @brief triggerOn lets the module run when source is notified
+     * @param source data channel or messaging command
+     */
+    void triggerOn(int module, const std::string &source);
+
+    /**
+     * @brief source id for notify(int), avoids the name lookup per write
+     * @return -1 if no module triggers on it
+     */
+    int source(const std::string &name) const;
+
+    /**
+     * @brief notify marks the modules triggered by source pending, may be
+     * called from any thread
+     */
+    void notify(int source);
+    void notify(const std::string &source);
+
+    /**
+     * @brief wait sleeps until a triggered module may run or until deadline
+     * @param deadline [us] of now(), usually the next clock tick
+     * @param ready set to the modules to run now, in execution order
+     * @return false if the deadline passed or wakeUp() was called without a
+     * module to run
+     */
+    bool wait(int64_t deadline, std::vector<int> *ready);
+
+    /**
+     * @brief ran tells that the module ran in a clock cycle, clears its
+     * pending notifications
+     */
+    void ran(int module);
+
+    /**
+     * @brief wakeUp lets wait() return, e.g. to stop the framework
+     */
+    void wakeUp();
+
+    size_t size() const {
+        return modules.size();
+    }
+
+    const std::string& name(int module) const {
+        return modules[module].name;
+    }
+
+    /**
+     * @brief runs number of triggered runs returned by wait()
+     */
+    uint64_t runs(int module) const;
+
+    /**
+     * @brief coalesced number of notifications that did not cause a run of
+     * their own
+     */
+    uint64_t coalesced(int module) const;
+
+    /**
+     * @brief now monotonic clock of deadlines and intervals [us]
+     */
+    static int64_t now();
+
+private:
+    struct Module {
+        std::string name;
+        int64_t minInterval;
+        int64_t lastRun;
+        uint32_t notifications; //!< since the last run
+        uint64_t runs;
+        uint64_t coalesced;
+    };
+
+    std::vector<Module> modules;
+    std::map<std::string, int> sourceIds;
+    std::vector<std::vector<int>> triggered; //!< modules per source
+
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    bool woken;
+};
+
+}  // namespace module_scheduler
+
+#endif // MODULE_SCHEDULER_TRIGGER_QUEUE_H
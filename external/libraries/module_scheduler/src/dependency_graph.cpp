@@ -0,0 +1,109 @@
+#include "module_scheduler/dependency_graph.h"
+
+#include <algorithm>
+
+namespace module_scheduler {
+
+int DependencyGraph::addModule(const std::string &name, bool mainThread) {
+    Module module;
+    module.name = name;
+    module.mainThread = mainThread;
+    module.predecessors = 0;
+    modules.push_back(module);
+    return static_cast<int>(modules.size() - 1);
+}
+
+DependencyGraph::Access* DependencyGraph::findAccess(const std::string &channel, int module) {
+    for(auto &entry : channels) {
+        if(entry.first == channel) {
+            for(Access &access : entry.second) {
+                if(access.module == module) {
+                    return &access;
+                }
+            }
+            entry.second.push_back(Access{module, false, 0});
+            return &entry.second.back();
+        }
+    }
+    channels.push_back(std::make_pair(channel, std::vector<Access>{Access{module, false, 0}}));
+    return &channels.back().second.back();
+}
+
+void DependencyGraph::readChannel(int module, const std::string &channel, int priority) {
+    Access *access = findAccess(channel, module);
+    access->priority = std::max(access->priority, priority);
+}
+
+void DependencyGraph::writeChannel(int module, const std::string &channel, int priority) {
+    // a module reading and writing a channel counts as writer
+    Access *access = findAccess(channel, module);
+    access->write = true;
+    access->priority = std::max(access->priority, priority);
+}
+
+void DependencyGraph::addEdge(int from, int to) {
+    std::vector<int> &successors = modules[from].successors;
+    if(from != to && std::find(successors.begin(), successors.end(), to) == successors.end()) {
+        successors.push_back(to);
+        modules[to].predecessors++;
+    }
+}
+
+bool DependencyGraph::build(std::string *error) {
+    for(Module &module : modules) {
+        module.successors.clear();
+        module.predecessors = 0;
+    }
+
+    for(auto &entry : channels) {
+        std::vector<Access> accesses = entry.second;
+        std::stable_sort(accesses.begin(), accesses.end(), [](const Access &a, const Access &b) {
+            return a.priority != b.priority ? a.priority > b.priority : a.write && ! b.write;
+        });
+
+        for(size_t i = 0; i < accesses.size(); i++) {
+            for(size_t j = i + 1; j < accesses.size(); j++) {
+                if(accesses[i].write) {
+                    addEdge(accesses[i].module, accesses[j].module);
+                } else if(accesses[j].write) {
+                    // readers finish before the next writer, later
+                    // accesses depend on that writer already
+                    addEdge(accesses[i].module, accesses[j].module);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Kahn's algorithm, whatever is left belongs to a cycle
+    topologicalOrder.clear();
+    std::vector<int> remaining(modules.size());
+    for(size_t i = 0; i < modules.size(); i++) {
+        remaining[i] = modules[i].predecessors;
+        if(remaining[i] == 0) {
+            topologicalOrder.push_back(static_cast<int>(i));
+        }
+    }
+    for(size_t i = 0; i < topologicalOrder.size(); i++) {
+        for(int next : modules[topologicalOrder[i]].successors) {
+            if(--remaining[next] == 0) {
+                topologicalOrder.push_back(next);
+            }
+        }
+    }
+
+    if(topologicalOrder.size() != modules.size()) {
+        if(error) {
+            error->clear();
+            for(size_t i = 0; i < modules.size(); i++) {
+                if(remaining[i] > 0) {
+                    *error += (error->empty() ? "" : ", ") + modules[i].name;
+                }
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
+}  // namespace module_scheduler
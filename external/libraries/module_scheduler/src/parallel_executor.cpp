@@ -0,0 +1,204 @@
+#include "module_scheduler/parallel_executor.h"
+
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+
+namespace module_scheduler {
+
+namespace {
+
+/**
+ * @brief Times an idle thread yields before it sleeps, modules that become
+ * ready right after another one finished start without a wake-up
+ */
+const int SPIN_ROUNDS = 200;
+
+}  // namespace
+
+ParallelExecutor::ParallelExecutor(const DependencyGraph &graph, std::function<bool(int)> run,
+                                   const ExecutorOptions &options)
+    : graph(graph), run(run), cores(options.cores), remaining(new std::atomic<int>[graph.size()]),
+      outstanding(0), queued(0), mainQueued(0), failed(false), stealCount(0),
+      callerPinned(false), stopping(false) {
+    unsigned int count = options.threads;
+    if(count == 0) {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for(unsigned int i = 0; i < count; i++) {
+        queues.emplace_back(new Queue);
+    }
+    for(unsigned int i = 1; i < count; i++) {
+        workers.emplace_back(&ParallelExecutor::workerLoop, this, i);
+    }
+}
+
+ParallelExecutor::~ParallelExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for(std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+bool ParallelExecutor::cycle() {
+    if(! callerPinned) {
+        pin(0);
+        callerPinned = true;
+    }
+
+    int count = static_cast<int>(graph.size());
+    if(count == 0) {
+        return true;
+    }
+
+    failed = false;
+    for(int i = 0; i < count; i++) {
+        remaining[i].store(graph.predecessorCount(i), std::memory_order_relaxed);
+    }
+    outstanding.store(count, std::memory_order_release);
+
+    unsigned int worker = 0;
+    for(int i = 0; i < count; i++) {
+        if(graph.predecessorCount(i) == 0) {
+            push(worker++ % threads(), i);
+        }
+    }
+
+    while(outstanding.load(std::memory_order_acquire) > 0) {
+        int module = next(0);
+        if(module >= 0) {
+            execute(0, module);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        cycleDone.wait(lock, [this]() {
+            return outstanding.load() == 0 || mainQueued.load() > 0 || queued.load() > 0;
+        });
+    }
+    return ! failed.load();
+}
+
+void ParallelExecutor::workerLoop(unsigned int index) {
+    pin(index);
+    while(true) {
+        int module = next(index);
+        if(module >= 0) {
+            execute(index, module);
+            continue;
+        }
+
+        for(int i = 0; i < SPIN_ROUNDS && queued.load(std::memory_order_relaxed) == 0; i++) {
+            std::this_thread::yield();
+        }
+        if(queued.load() > 0) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeWorkers.wait(lock, [this]() {
+            return stopping || queued.load() > 0;
+        });
+        if(stopping) {
+            return;
+        }
+    }
+}
+
+int ParallelExecutor::next(unsigned int worker) {
+    if(worker == 0 && mainQueued.load() > 0) {
+        std::lock_guard<std::mutex> lock(mainQueue.mutex);
+        if(! mainQueue.modules.empty()) {
+            int module = mainQueue.modules.front();
+            mainQueue.modules.pop_front();
+            mainQueued--;
+            return module;
+        }
+    }
+
+    if(queued.load() == 0) {
+        return -1;
+    }
+
+    // newest of the own deque: its inputs were just written on this core
+    {
+        Queue &own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(! own.modules.empty()) {
+            int module = own.modules.back();
+            own.modules.pop_back();
+            queued--;
+            return module;
+        }
+    }
+
+    for(unsigned int i = 1; i < queues.size(); i++) {
+        Queue &victim = *queues[(worker + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(! victim.modules.empty()) {
+            int module = victim.modules.front();
+            victim.modules.pop_front();
+            queued--;
+            stealCount++;
+            return module;
+        }
+    }
+    return -1;
+}
+
+void ParallelExecutor::push(unsigned int worker, int module) {
+    bool main = graph.mainThread(module);
+    {
+        Queue &queue = main ? mainQueue : *queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.modules.push_back(module);
+    }
+    (main ? mainQueued : queued)++;
+
+    // a thread about to sleep checks the counters under this mutex
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    if(! main) {
+        wakeWorkers.notify_one();
+    }
+    cycleDone.notify_one();
+}
+
+void ParallelExecutor::execute(unsigned int worker, int module) {
+    // after a failure the remaining modules are skipped, the cycle still has
+    // to count them down to finish
+    if(! failed.load(std::memory_order_relaxed) && ! run(module)) {
+        failed = true;
+    }
+
+    for(int successor : graph.successors(module)) {
+        if(remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            push(worker, successor);
+        }
+    }
+
+    if(outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        cycleDone.notify_all();
+    }
+}
+
+void ParallelExecutor::pin(unsigned int worker) {
+    if(cores.empty()) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cores[worker % cores.size()], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+}  // namespace module_scheduler
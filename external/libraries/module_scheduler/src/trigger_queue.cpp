@@ -0,0 +1,131 @@
+#include "module_scheduler/trigger_queue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace module_scheduler {
+
+TriggerQueue::TriggerQueue() : woken(false) {
+}
+
+int TriggerQueue::addModule(const std::string &name, const TriggerOptions &options) {
+    Module module;
+    module.name = name;
+    module.minInterval = std::max<int64_t>(0, options.minInterval);
+    module.lastRun = std::numeric_limits<int64_t>::min() / 2;
+    module.notifications = 0;
+    module.runs = 0;
+    module.coalesced = 0;
+    modules.push_back(module);
+    return static_cast<int>(modules.size() - 1);
+}
+
+void TriggerQueue::triggerOn(int module, const std::string &source) {
+    auto it = sourceIds.find(source);
+    if(it == sourceIds.end()) {
+        it = sourceIds.insert(std::make_pair(source, static_cast<int>(triggered.size()))).first;
+        triggered.push_back(std::vector<int>());
+    }
+    std::vector<int> &list = triggered[it->second];
+    if(std::find(list.begin(), list.end(), module) == list.end()) {
+        list.push_back(module);
+    }
+}
+
+int TriggerQueue::source(const std::string &name) const {
+    auto it = sourceIds.find(name);
+    return it == sourceIds.end() ? -1 : it->second;
+}
+
+void TriggerQueue::notify(int source) {
+    if(source < 0 || source >= static_cast<int>(triggered.size())) {
+        return;
+    }
+    // a module that is pending already has its wake-up scheduled
+    bool first = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(int module : triggered[source]) {
+            first |= modules[module].notifications++ == 0;
+        }
+    }
+    if(first) {
+        changed.notify_one();
+    }
+}
+
+void TriggerQueue::notify(const std::string &source) {
+    notify(this->source(source));
+}
+
+bool TriggerQueue::wait(int64_t deadline, std::vector<int> *ready) {
+    ready->clear();
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true) {
+        int64_t time = now();
+        int64_t next = deadline;
+        for(size_t i = 0; i < modules.size(); i++) {
+            Module &module = modules[i];
+            if(module.notifications == 0) {
+                continue;
+            }
+            int64_t due = module.lastRun + module.minInterval;
+            if(due <= time) {
+                module.coalesced += module.notifications - 1;
+                module.notifications = 0;
+                module.lastRun = time;
+                module.runs++;
+                ready->push_back(static_cast<int>(i));
+            } else {
+                next = std::min(next, due);
+            }
+        }
+        if(! ready->empty()) {
+            return true;
+        }
+        if(woken) {
+            woken = false;
+            return false;
+        }
+        if(time >= deadline) {
+            return false;
+        }
+        changed.wait_until(lock, std::chrono::steady_clock::time_point(
+                               std::chrono::microseconds(next)));
+    }
+}
+
+void TriggerQueue::ran(int module) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Module &m = modules[module];
+    // the rate cap only limits the triggered runs, an input right after a
+    // clock tick must not wait for minInterval
+    m.coalesced += m.notifications;
+    m.notifications = 0;
+}
+
+void TriggerQueue::wakeUp() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        woken = true;
+    }
+    changed.notify_one();
+}
+
+uint64_t TriggerQueue::runs(int module) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return modules[module].runs;
+}
+
+uint64_t TriggerQueue::coalesced(int module) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return modules[module].coalesced;
+}
+
+int64_t TriggerQueue::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace module_scheduler
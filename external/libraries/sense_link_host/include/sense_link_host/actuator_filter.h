@@ -0,0 +1,96 @@
+#ifndef SENSE_LINK_HOST_ACTUATOR_FILTER_H
+#define SENSE_LINK_HOST_ACTUATOR_FILTER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "message.h"
+
+namespace sense_link {
+
+struct ActuatorFilterOptions {
+    ActuatorFilterOptions() : keepalive(200000) {
+        for(double &value : deadband) {
+            value = 0;
+        }
+    }
+
+    /**
+     * @brief Changes up to this much to the last sent value are not sent,
+     * per ActuatorType in its unit
+     */
+    double deadband[static_cast<int>(ActuatorType::__END__)];
+
+    /**
+     * @brief An unchanged value is sent again after this time, so the
+     * failsafe of the board does not stop the actuator [us], 0 for never
+     */
+    int64_t keepalive;
+};
+
+/**
+ * @brief Decides which actuator values are worth a frame on the serial link
+ *
+ * Remembers the last value sent per actuator (type and id). A value is sent
+ * if it is the first one, differs from the last sent one by more than the
+ * deadband of its type, or the keepalive time passed since the last send.
+ * Comparing to the last sent value instead of the previous one lets slow
+ * drifts through once they add up to the deadband.
+ */
+class ActuatorFilter {
+public:
+    struct Counters {
+        uint64_t sent; //!< changes and keepalives
+        uint64_t keepalives;
+        uint64_t suppressed;
+    };
+
+    struct Entry {
+        ActuatorType type;
+        uint8_t id;
+        double value; //!< last sent
+        int64_t time; //!< of the last send [us]
+        Counters counters;
+    };
+
+    explicit ActuatorFilter(const ActuatorFilterOptions &options = ActuatorFilterOptions());
+
+    /**
+     * @brief update decides whether to send a value
+     * @param now host time [us]
+     * @return true if the value has to be sent, it is remembered as sent then
+     */
+    bool update(ActuatorType type, uint8_t id, double value, int64_t now);
+
+    /**
+     * @brief reset forgets the sent values, e.g. after the board reconnected,
+     * all following values are sent. The counters are kept.
+     */
+    void reset();
+
+    void setOptions(const ActuatorFilterOptions &options) {
+        this->options = options;
+    }
+
+    /**
+     * @brief counters of one actuator, all 0 if it was never updated
+     */
+    Counters counters(ActuatorType type, uint8_t id) const;
+
+    /**
+     * @brief entries all actuators with their last sent value and counters
+     */
+    const std::vector<Entry>& entries() const {
+        return actuators;
+    }
+
+private:
+    Entry* find(ActuatorType type, uint8_t id);
+
+    ActuatorFilterOptions options;
+    std::vector<Entry> actuators; //!< few per board, searched linearly
+};
+
+}  // namespace sense_link
+
+#endif // SENSE_LINK_HOST_ACTUATOR_FILTER_H
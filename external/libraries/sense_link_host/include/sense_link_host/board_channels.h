@@ -0,0 +1,95 @@
+#ifndef SENSE_LINK_HOST_BOARD_CHANNELS_H
+#define SENSE_LINK_HOST_BOARD_CHANNELS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "message.h"
+#include "sense_link_host/sample_ring.h"
+#include "sense_link_host/serial_hub.h"
+
+namespace sense_link {
+
+/**
+ * @brief Messages of one board per cycle, routed by sensor type and id
+ *
+ * samples() holds everything received this cycle in order, latest() the
+ * newest SENSOR_DATA of a sensor, also from earlier cycles. The lookup is
+ * a table indexed by type and id, no search. history() gives the sensors
+ * recorded with SerialHub::keepHistory, e.g. to look up a gyro sample at
+ * the exposure time of a camera frame.
+ */
+class BoardSensors {
+public:
+    BoardSensors();
+
+    /**
+     * @brief clear forgets the samples of the cycle, latest() stays
+     */
+    void clear() {
+        cycleSamples.clear();
+    }
+
+    void add(const Sample &sample);
+
+    const std::vector<Sample>& samples() const {
+        return cycleSamples;
+    }
+
+    /**
+     * @return nullptr if the sensor never sent data
+     */
+    const Sample* latest(SensorType type, uint8_t id) const {
+        uint16_t slot = slots[static_cast<int>(type)][id];
+        return slot == 0 ? nullptr : &latestSamples[slot - 1];
+    }
+
+    /**
+     * @brief addHistory makes a ring recorded by the hub available to the
+     * readers of the channel
+     */
+    void addHistory(SensorType type, uint8_t id, const SampleRing *ring);
+
+    /**
+     * @return nullptr if the sensor is not recorded
+     */
+    const SampleRing* history(SensorType type, uint8_t id) const;
+
+private:
+    struct History {
+        SensorType type;
+        uint8_t id;
+        const SampleRing *ring;
+    };
+
+    std::vector<History> histories;
+    std::vector<Sample> cycleSamples;
+    std::vector<Sample> latestSamples;
+    uint16_t slots[static_cast<int>(SensorType::__END__)][256]; //!< index in latestSamples + 1
+};
+
+/**
+ * @brief Actuator values to send to one board this cycle
+ */
+class BoardActuators {
+public:
+    void clear() {
+        pending.clear();
+    }
+
+    /**
+     * @brief set replaces a value set for the same actuator this cycle
+     */
+    void set(ActuatorType type, uint8_t id, const ActuatorData &data);
+
+    const std::vector<Message>& messages() const {
+        return pending;
+    }
+
+private:
+    std::vector<Message> pending;
+};
+
+}  // namespace sense_link
+
+#endif // SENSE_LINK_HOST_BOARD_CHANNELS_H
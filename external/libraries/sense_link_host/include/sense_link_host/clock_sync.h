@@ -0,0 +1,112 @@
+#ifndef SENSE_LINK_HOST_CLOCK_SYNC_H
+#define SENSE_LINK_HOST_CLOCK_SYNC_H
+
+#include <cstdint>
+
+#include "message.h"
+
+namespace sense_link {
+
+/**
+ * @brief hostMicros returns the monotonic host clock used for all sample
+ * timestamps [us]
+ */
+int64_t hostMicros();
+
+/**
+ * @brief Estimates offset and drift between the board clock and the host clock
+ *
+ * NTP-style exchange: the host sends a TIME_SYNC_ID request and notes the send
+ * time t0, the board answers with its clock tb, the host notes the receive
+ * time t3. Assuming symmetric delays the board read its clock at (t0 + t3) / 2.
+ *
+ * The last WINDOW exchanges are kept. Exchanges with a round trip much longer
+ * than the best one were delayed on one way and are ignored. A straight line
+ * is fitted through the rest, its slope is the drift of the board clock.
+ */
+class ClockSync {
+public:
+    static const int WINDOW = 32;
+
+    ClockSync();
+
+    /**
+     * @brief request builds the next synchronization request, a request that
+     * is still unanswered is forgotten
+     * @param sendTime host time the request is sent at [us]
+     * @return TIME message to send to the board
+     */
+    Message request(int64_t sendTime);
+
+    /**
+     * @brief reply processes the answer of the board
+     * @param reply TIME message received from the board
+     * @param receiveTime host time the reply was received at [us]
+     * @return true if the reply answered the last request
+     */
+    bool reply(const Message &reply, int64_t receiveTime);
+
+    /**
+     * @brief synchronized is true once a single exchange succeeded
+     */
+    bool synchronized() const {
+        return count > 0;
+    }
+
+    /**
+     * @brief toHost converts a board timestamp to host time [us]
+     */
+    int64_t toHost(uint64_t boardTime) const;
+
+    /**
+     * @brief toBoard converts a host timestamp to board time [us]
+     */
+    uint64_t toBoard(int64_t hostTime) const;
+
+    /**
+     * @brief offset of the board clock at the given host time [us]
+     */
+    int64_t offset(int64_t hostTime) const;
+
+    /**
+     * @brief drift of the board clock relative to the host clock [ppm]
+     */
+    double drift() const {
+        return (slope - 1) * 1e6;
+    }
+
+    /**
+     * @brief roundTrip shortest round trip in the window [us], bounds the
+     * error of the offset to half of it
+     */
+    int64_t roundTrip() const {
+        return minRoundTrip;
+    }
+
+private:
+    struct Exchange {
+        int64_t hostTime; //!< midpoint of request and reply
+        int64_t boardTime;
+        int64_t roundTrip;
+    };
+
+    void fit();
+
+    Exchange exchanges[WINDOW];
+    int count;
+    int next;
+
+    uint8_t sequence;
+    bool pending;
+    int64_t pendingSendTime;
+
+    // board = boardRef + (host - hostRef) * slope
+    int64_t hostRef;
+    int64_t boardRef;
+    double slope;
+    int64_t minRoundTrip;
+};
+
+}  // namespace sense_link
+
+#endif // SENSE_LINK_HOST_CLOCK_SYNC_H
@@ -0,0 +1,81 @@
+#ifndef SENSE_LINK_HOST_SAMPLE_RING_H
+#define SENSE_LINK_HOST_SAMPLE_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "message.h"
+
+namespace sense_link {
+
+/**
+ * @brief Ring buffer of timestamped samples of one sensor
+ *
+ * One thread pushes samples (e.g. the thread reading the serial link), any
+ * number of threads look samples up without locks. Readers copy only the two
+ * samples around the requested time and retry if the writer overwrote one of
+ * them meanwhile.
+ *
+ * Timestamps must not decrease, a sample older than the newest one is stored
+ * with the newest timestamp.
+ */
+class SampleRing {
+public:
+    /**
+     * @param capacity number of samples kept, rounded up to a power of two
+     */
+    explicit SampleRing(unsigned int capacity);
+
+    SampleRing(const SampleRing&) = delete;
+    SampleRing& operator=(const SampleRing&) = delete;
+
+    /**
+     * @brief push appends a sample, only one thread may push
+     * @param sample SENSOR_DATA message
+     * @param hostTime host time of the sample [us]
+     */
+    void push(const Message &sample, int64_t hostTime);
+
+    /**
+     * @brief latest copies the newest sample
+     * @return false if the ring is empty
+     */
+    bool latest(Message *sample, int64_t *hostTime) const;
+
+    /**
+     * @brief at interpolates the sample at an arbitrary host time in O(log n).
+     * Fields of 2 and 4 bytes are interpolated linearly, single byte fields
+     * (flags, brightness) are taken from the nearer sample.
+     * @param hostTime requested time [us]
+     * @param sample interpolated SENSOR_DATA message (result)
+     * @return false if the time is older than the oldest or newer than the
+     * newest sample
+     */
+    bool at(int64_t hostTime, Message *sample) const;
+
+    /**
+     * @brief size number of samples pushed since construction
+     */
+    uint64_t size() const {
+        return head.load(std::memory_order_acquire);
+    }
+
+    unsigned int capacity() const {
+        return mask + 1;
+    }
+
+private:
+    struct Entry {
+        int64_t time;
+        Message sample;
+    };
+
+    std::unique_ptr<Entry[]> entries;
+    uint64_t mask;
+    std::atomic<uint64_t> head; //!< index of the next entry to write
+};
+
+}  // namespace sense_link
+
+#endif // SENSE_LINK_HOST_SAMPLE_RING_H
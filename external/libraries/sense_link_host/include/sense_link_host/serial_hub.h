@@ -0,0 +1,193 @@
+#ifndef SENSE_LINK_HOST_SERIAL_HUB_H
+#define SENSE_LINK_HOST_SERIAL_HUB_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "message.h"
+#include "sense_link_host/sample_ring.h"
+#include "sense_link_host/serial_link.h"
+
+namespace sense_link {
+
+struct BoardOptions {
+    BoardOptions() : baudRate(115200), checksum(ChecksumMode::CRC8), batch(true) {
+    }
+
+    std::string name;
+    std::string device; //!< e.g. /dev/ttyACM0, empty if attached
+    int baudRate; //!< 0 to keep the current setting
+    ChecksumMode checksum; //!< negotiated after opening
+    bool batch; //!< board understands BATCH frames
+};
+
+struct HubOptions {
+    HubOptions() : syncInterval(1000000), reconnectInterval(1000000) {
+    }
+
+    int64_t syncInterval; //!< clock synchronization per board [us], 0 for none
+    int64_t reconnectInterval; //!< retry of a lost device [us]
+};
+
+struct BoardStats {
+    bool connected;
+    uint64_t received; //!< decoded messages
+    uint64_t dropped; //!< received but not taken by receive() in time
+    uint64_t sent; //!< messages written
+    uint64_t frames; //!< frames written, sent / frames is the batching
+    uint64_t writeErrors;
+    uint64_t reconnects;
+};
+
+/**
+ * @brief Message of a board with the host time it was sampled or read at
+ */
+struct Sample {
+    Message message;
+    int64_t timestamp; //!< [us]
+};
+
+/**
+ * @brief Serves several Senseboards from one I/O thread
+ *
+ * The thread waits with epoll on all devices and an eventfd. Readable
+ * devices are drained with SerialLink::receive into a per-board inbox;
+ * messages queued with send() are written when the thread wakes up next,
+ * everything queued for a board since then in one BATCH frame. A device
+ * that fails is closed and reopened every reconnectInterval, the other
+ * boards keep running. Clock synchronization is sent by the thread too.
+ *
+ * receive() and send() may be called from any thread, they only take the
+ * mutex of their board.
+ */
+class SerialHub {
+public:
+    explicit SerialHub(const HubOptions &options = HubOptions());
+    ~SerialHub();
+
+    SerialHub(const SerialHub&) = delete;
+    SerialHub& operator=(const SerialHub&) = delete;
+
+    /**
+     * @brief addBoard registers a device to open in start()
+     * @return board index
+     */
+    int addBoard(const BoardOptions &options);
+
+    /**
+     * @brief attachBoard uses an open connection, e.g. to a SimulatedBoard
+     * @param fileDescriptor taken over, not reopened when it fails
+     * @return board index
+     */
+    int attachBoard(const BoardOptions &options, int fileDescriptor);
+
+    /**
+     * @brief start opens the devices and starts the I/O thread. A device
+     * that cannot be opened is retried like a lost one.
+     * @return false with error set if epoll could not be set up
+     */
+    bool start(std::string *error);
+    void stop();
+
+    size_t boardCount() const {
+        return boards.size();
+    }
+
+    /**
+     * @return -1 if there is no board with this name
+     */
+    int board(const std::string &name) const;
+    const BoardOptions& options(int board) const;
+
+    /**
+     * @brief receive takes all messages of a board received since the last
+     * call, in the order they arrived
+     * @param samples cleared and filled (result), keeps its capacity
+     */
+    void receive(int board, std::vector<Sample> *samples);
+
+    /**
+     * @brief send queues messages for a board and wakes the I/O thread
+     */
+    void send(int board, const Message *messages, size_t count);
+    void send(int board, const Message &message) {
+        send(board, &message, 1);
+    }
+
+    /**
+     * @brief keepHistory records the SENSOR_DATA of a sensor with its host
+     * time in a SampleRing, filled by the I/O thread. Call before start().
+     * @param capacity number of samples kept
+     * @return the ring, valid as long as the hub
+     */
+    const SampleRing& keepHistory(int board, SensorType type, uint8_t id, unsigned int capacity = 1024);
+
+    /**
+     * @return nullptr if keepHistory was not called for the sensor
+     */
+    const SampleRing* history(int board, SensorType type, uint8_t id) const;
+
+    BoardStats stats(int board) const;
+
+    /**
+     * @brief wakeups times the I/O thread returned from epoll_wait
+     */
+    uint64_t wakeups() const {
+        return wakeupCount.load();
+    }
+
+    /**
+     * @brief MAX_INBOX messages kept per board between two receive() calls,
+     * older ones are dropped and counted
+     */
+    static const size_t MAX_INBOX = 4096;
+
+private:
+    struct History {
+        SensorType type;
+        uint8_t id;
+        std::unique_ptr<SampleRing> ring; //!< pushed by the I/O thread only
+    };
+
+    struct Board {
+        BoardOptions options;
+        SerialLink link;
+        int attached; //!< file descriptor for attachBoard, -1 for a device
+
+        mutable std::mutex mutex; //!< inbox, outbox and stats
+        std::vector<Sample> inbox;
+        std::vector<Message> outbox;
+        BoardStats stats;
+
+        std::vector<History> histories; //!< fixed after start()
+        std::vector<Message> writing; //!< I/O thread only
+        int64_t nextSync; //!< I/O thread only [us]
+        int64_t nextReconnect; //!< I/O thread only [us]
+        uint8_t sequence; //!< of BATCH frames, I/O thread only
+    };
+
+    void run();
+    bool connect(int index);
+    void disconnect(int index);
+    void read(int index);
+    void write(int index);
+    void wake();
+
+    HubOptions hubOptions;
+    std::vector<std::unique_ptr<Board>> boards;
+    int epollFd;
+    int wakeFd; //!< eventfd, send() and stop() wake the I/O thread
+    std::atomic<bool> wakePending; //!< coalesces the eventfd writes
+    std::atomic<bool> running;
+    std::atomic<uint64_t> wakeupCount;
+    std::thread thread;
+};
+
+}  // namespace sense_link
+
+#endif // SENSE_LINK_HOST_SERIAL_HUB_H
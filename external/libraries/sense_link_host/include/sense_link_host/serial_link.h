@@ -0,0 +1,152 @@
+#ifndef SENSE_LINK_HOST_SERIAL_LINK_H
+#define SENSE_LINK_HOST_SERIAL_LINK_H
+
+#include <string>
+
+#include "clock_sync.h"
+#include "compact.h"
+#include "message.h"
+#include "parser.h"
+
+namespace sense_link {
+
+/**
+ * @brief Non-blocking serial connection to a Senseboard
+ *
+ * Incoming bytes are read in whatever chunks the device delivers and handed
+ * to a FrameParser, so a frame may be split across several receive() calls
+ * and a corrupted byte only costs the frames it touches.
+ */
+class SerialLink {
+public:
+    SerialLink();
+    ~SerialLink();
+
+    SerialLink(const SerialLink&) = delete;
+    SerialLink& operator=(const SerialLink&) = delete;
+
+    /**
+     * @brief open opens the device in raw, non-blocking mode
+     * @param device path of the device, e.g. /dev/ttyACM0
+     * @param baudRate baud rate, 0 to keep the current setting (e.g. for a pty)
+     * @return true if the device was opened and configured
+     */
+    bool open(const std::string &device, int baudRate = 115200);
+
+    /**
+     * @brief attach uses an already open connection, e.g. one end of a
+     * socketpair to a SimulatedBoard. The link takes ownership of it.
+     * @param fileDescriptor connection, switched to non-blocking
+     * @return false if fileDescriptor is -1
+     */
+    bool attach(int fileDescriptor);
+    void close();
+
+    bool isOpen() const {
+        return fd != -1;
+    }
+
+    /**
+     * @brief fileDescriptor can be used to wait for input with poll/epoll
+     */
+    int fileDescriptor() const {
+        return fd;
+    }
+
+    /**
+     * @brief receive decodes all messages that can be read without blocking.
+     * SENSOR_DATA_DELTA messages of the stream are returned as SENSOR_DATA
+     * with absolute values, deltas following a lost sample are dropped until
+     * the next keyframe. TIME messages of
+     * the clock synchronization and board timestamps are consumed.
+     * @param messages decoded messages (result)
+     * @param maxCount maximum number of messages to decode
+     * @param timestamps host time of every message [us] (result, optional).
+     * Samples that follow a board timestamp in the same BATCH frame get the
+     * board time converted by the clock synchronization, all other messages
+     * the time they were read.
+     * @return number of messages decoded, -1 on a device error
+     */
+    int receive(Message *messages, int maxCount, int64_t *timestamps = nullptr);
+
+    /**
+     * @brief send writes a message as one length-prefixed frame
+     * @param message message to send
+     * @return true if the whole frame was written
+     */
+    bool send(const Message &message);
+
+    /**
+     * @brief send packs several messages into as few BATCH frames as possible,
+     * requires firmware with BATCH support
+     * @param messages first message to send
+     * @param count number of messages
+     * @param sequence sequence number of the frames
+     * @return true if all frames were written
+     */
+    bool send(const Message *messages, unsigned int count, uint8_t sequence);
+
+    /**
+     * @brief syncClock sends a clock synchronization request, the reply is
+     * processed by receive(). Call it periodically (e.g. every second) to
+     * follow the drift of the board clock.
+     * @return true if the request was written
+     */
+    bool syncClock();
+
+    const ClockSync& clock() const {
+        return clockSync;
+    }
+
+    /**
+     * @brief negotiateChecksum asks the board to switch to another checksum
+     * mode and waits for the acknowledge. Call it right after open(), messages
+     * received meanwhile are discarded. Boards that do not know the
+     * CHECKSUM_MODE message keep the link on CRC8. Only if the board did
+     * not answer in time it is asked to switch back in the requested mode,
+     * in case just the acknowledge got lost.
+     * @param mode requested checksum mode
+     * @param timeout time to wait for the acknowledge [ms]
+     * @return true if the board switched to the requested mode
+     */
+    bool negotiateChecksum(ChecksumMode mode, int timeout = 100);
+
+    ChecksumMode checksumMode() const {
+        return parser.getChecksumMode();
+    }
+
+    const ParserStats& stats() const {
+        return parser.stats();
+    }
+
+    const CompactStats& compactStats() const {
+        return compact.stats();
+    }
+
+private:
+    enum class ChecksumReply : uint8_t {
+        ACKNOWLEDGED,
+        REFUSED, //!< ERROR or CHECKSUM_MODE with another mode
+        NONE //!< timeout or device error
+    };
+
+    void resetState();
+    bool sendFrame(const Message &message, ChecksumMode mode);
+    bool writeFrame(const char *data, size_t length);
+    ChecksumReply waitForChecksumMode(ChecksumMode mode, int timeout);
+
+    int fd;
+    FrameParser parser;
+    CompactDecoder compact;
+    ClockSync clockSync;
+    bool stamped; //!< boardStamp applies to the rest of the current BATCH frame
+    uint64_t boardStamp; //!< board time of the following samples
+    char rxBuffer[512];
+    const char *rxData;
+    unsigned int rxLength;
+    int64_t rxTime; //!< host time rxBuffer was read at [us]
+};
+
+}  // namespace sense_link
+
+#endif // SENSE_LINK_HOST_SERIAL_LINK_H
@@ -0,0 +1,93 @@
+#ifndef SENSE_LINK_HOST_SIMULATED_BOARD_H
+#define SENSE_LINK_HOST_SIMULATED_BOARD_H
+
+#include <cstdint>
+#include <memory>
+
+namespace sense_link {
+
+/**
+ * @brief The LinkConditions struct
+ *
+ * Impairments of the simulated serial line, applied by the board's UART to
+ * both directions.
+ */
+struct LinkConditions {
+    LinkConditions() : baudRate(0), lossRate(0), corruptionRate(0), seed(1) {
+    }
+
+    int baudRate; //!< 8N1 line speed, 0 for unlimited
+    double lossRate; //!< Probability that a byte is lost
+    double corruptionRate; //!< Probability that a byte has a flipped bit
+    unsigned int seed; //!< Seed of the random loss and corruption
+};
+
+/**
+ * @brief The SimulatedBoardStats struct
+ */
+struct SimulatedBoardStats {
+    uint32_t framesReceived; //!< Frames decoded by the firmware
+    uint32_t framesSent; //!< Frames queued by the firmware
+    uint32_t framesDropped; //!< Frames dropped by the firmware, TX buffer full
+    uint32_t bytesLost; //!< Bytes removed by LinkConditions::lossRate or not read by the host in time
+    uint32_t bytesCorrupted; //!< Bytes changed by LinkConditions::corruptionRate
+};
+
+/**
+ * @brief Senseboard firmware running on the host
+ *
+ * Runs the same senseboard::Firmware and Scheduler as the Arduino sketch in
+ * its own thread. Serial bytes go through a file descriptor, usually the
+ * master side of a pty that a SerialLink opens, actuator outputs are recorded
+ * instead of driving pins.
+ */
+class SimulatedBoard {
+public:
+    SimulatedBoard();
+    ~SimulatedBoard();
+
+    SimulatedBoard(const SimulatedBoard&) = delete;
+    SimulatedBoard& operator=(const SimulatedBoard&) = delete;
+
+    /**
+     * @brief start runs the firmware until stop() is called
+     * @param fd serial connection, e.g. pty master or one end of a
+     * socketpair, switched to non-blocking, not closed
+     * @param conditions impairments of the serial line
+     * @return false if the board is running already
+     */
+    bool start(int fd, const LinkConditions &conditions = LinkConditions());
+    void stop();
+
+    bool running() const;
+
+    /**
+     * @brief servo last angle written to a servo [deg]
+     * @param id 1: front servo, 2: rear servo
+     */
+    int16_t servo(uint8_t id) const;
+
+    /**
+     * @brief motor last PWM pulse written to the motor controller [us]
+     */
+    uint16_t motor() const;
+
+    bool led() const;
+
+    bool failsafeActive() const;
+
+    /**
+     * @brief actuatorWrites number of times the firmware refreshed the servos
+     */
+    uint32_t actuatorWrites() const;
+
+    SimulatedBoardStats stats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+}  // namespace sense_link
+
+#endif // SENSE_LINK_HOST_SIMULATED_BOARD_H
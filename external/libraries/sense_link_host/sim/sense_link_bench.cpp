@@ -0,0 +1,645 @@
+/**
+ * Latency and throughput benchmark of the sense_link protocol against the
+ * simulated Senseboard firmware.
+ *
+ * Usage: sense_link_bench [--pipe] [--baud N] [--loss P] [--corrupt P]
+ *                         [--count N] [--duration S] [--crc32c] [--codec]
+ *
+ * --pipe      connect through a socketpair instead of a pty
+ * --baud      throttle the line to N baud (8N1), default unlimited
+ * --loss      probability that a byte is lost
+ * --corrupt   probability that a byte has a flipped bit
+ * --count     round trips per latency test, default 1000
+ * --duration  seconds per throughput test, default 2
+ * --crc32c    negotiate the CRC-32C checksum
+ * --codec     only the CPU cost of the codec, no link: single messages
+ *             against encodeMessages/decodeMessages and the checksums
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <poll.h>
+#include <pty.h>
+#include <random>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "sense_link_host/serial_link.h"
+#include "sense_link_host/simulated_board.h"
+
+using namespace sense_link;
+
+namespace {
+
+/**
+ * @brief Round trips slower than this count as lost [us]
+ */
+const int64_t LOST_TIMEOUT = 200000;
+
+/**
+ * @brief SENSOR_GET requests in flight during the sensor throughput test
+ */
+const int SENSOR_WINDOW = 8;
+
+/**
+ * @brief Bytes the host may queue ahead of the board in throughput tests,
+ * keeps the line busy without a backlog that outlasts the test
+ */
+const int MAX_BACKLOG = 512;
+
+/**
+ * @brief Time without progress after which the board is considered idle [us]
+ */
+const int64_t SETTLE_TIME = 50000;
+
+struct Options {
+    bool pipe = false;
+    bool crc32c = false;
+    bool codec = false;
+    int count = 1000;
+    double duration = 2;
+    LinkConditions conditions;
+};
+
+void printPercentiles(const char *name, std::vector<int64_t> &samples, int lost) {
+    if(samples.empty()) {
+        std::printf("%-22s all %d lost\n", name, lost);
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))] / 1000.0;
+    };
+    std::printf("%-22s p50 %7.3f  p90 %7.3f  p99 %7.3f  max %7.3f ms  lost %d/%zu\n",
+                name, percentile(0.5), percentile(0.9), percentile(0.99),
+                samples.back() / 1000.0, lost, samples.size() + lost);
+}
+
+Message actuator(ActuatorType type, uint8_t id, int16_t value) {
+    Message message;
+    std::memset(&message, 0, sizeof(message));
+    message.message = MessageType::ACTUATOR;
+    message.actuator = type;
+    message.id = id;
+    message.actuatorData.Servo.angle = value;
+    return message;
+}
+
+Message sensorGet(SensorType type, uint8_t id, uint8_t sequence) {
+    Message message;
+    std::memset(&message, 0, sizeof(message));
+    message.message = MessageType::SENSOR_GET;
+    message.sensor = type;
+    message.id = id;
+    message.sequence = sequence;
+    return message;
+}
+
+/**
+ * @brief backlog bytes written by the host the board did not read yet
+ */
+int backlog(int boardFd) {
+    int bytes = 0;
+    ioctl(boardFd, FIONREAD, &bytes);
+    return bytes;
+}
+
+/**
+ * Waits until the board decoded everything still buffered on the line, so
+ * the backlog of one test does not slow down the next.
+ * @return time the last frame was decoded [us]
+ */
+int64_t settle(SerialLink &link, SimulatedBoard &board, int boardFd) {
+    Message replies[32];
+    uint32_t frames = board.stats().framesReceived;
+    int64_t lastProgress = hostMicros();
+    while(backlog(boardFd) > 0 || hostMicros() - lastProgress < SETTLE_TIME) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        link.receive(replies, 32);
+        if(board.stats().framesReceived != frames) {
+            frames = board.stats().framesReceived;
+            lastProgress = hostMicros();
+        }
+    }
+    return lastProgress;
+}
+
+/**
+ * Pure CPU cost of encoding and decoding, independent of the link.
+ */
+void benchmarkCodec(ChecksumMode mode) {
+    const int COUNT = 1000000;
+    Message messages[4] = {
+        actuator(ActuatorType::SERVO, 1, 90),
+        actuator(ActuatorType::MOTOR, 1, 3000),
+        sensorGet(SensorType::SERVO, 1, 0),
+        actuator(ActuatorType::LED, 1, ON)
+    };
+    messages[2].message = MessageType::SENSOR_DATA;
+
+    char buffer[64];
+    Message decoded;
+    int64_t start = hostMicros();
+    int checksum = 0;
+    for(int i = 0; i < COUNT; i++) {
+        int length = encodeMessage(&messages[i & 3], buffer, mode);
+        checksum += decodeMessage(&decoded, buffer, mode) == length;
+    }
+    int64_t elapsed = hostMicros() - start;
+    std::printf("%-22s %7.2f M msg/s (%d ok)\n", "codec encode+decode",
+                COUNT / static_cast<double>(elapsed), checksum);
+}
+
+/**
+ * Host side framing of a cycle worth of messages: one length-prefixed frame
+ * per message as SerialLink::send writes them and FrameParser reads them,
+ * against encodeMessages/decodeMessages on one contiguous buffer.
+ */
+void benchmarkFrames(ChecksumMode mode) {
+    const int COUNT = 200000;
+    const unsigned int MESSAGES = 16;
+    Message messages[MESSAGES];
+    for(unsigned int i = 0; i < MESSAGES; i++) {
+        messages[i] = actuator(i % 2 == 0 ? ActuatorType::SERVO : ActuatorType::MOTOR, 1 + i % 2, i * 100);
+    }
+
+    char buffer[MESSAGES * MAX_FRAME_SIZE];
+    Message decoded[MESSAGES];
+    FrameParser parser;
+    parser.setChecksumMode(mode);
+
+    int64_t start = hostMicros();
+    int checksum = 0;
+    for(int i = 0; i < COUNT; i++) {
+        char *frame = buffer;
+        for(unsigned int j = 0; j < MESSAGES; j++) {
+            frame[0] = encodeMessage(&messages[j], frame + 1, mode);
+            frame += 1 + static_cast<uint8_t>(frame[0]);
+        }
+        const char *data = buffer;
+        unsigned int length = frame - buffer;
+        unsigned int count = 0;
+        while(count < MESSAGES && parser.next(data, length, &decoded[count])) {
+            count++;
+        }
+        checksum += count == MESSAGES;
+    }
+    int64_t single = hostMicros() - start;
+
+    start = hostMicros();
+    int checksumMessages = 0;
+    for(int i = 0; i < COUNT; i++) {
+        int length = encodeMessages(messages, MESSAGES, buffer, sizeof(buffer), mode);
+        checksumMessages += decodeMessages(decoded, MESSAGES, buffer, length, mode) == static_cast<int>(MESSAGES);
+    }
+    int64_t contiguous = hostMicros() - start;
+
+    double total = static_cast<double>(COUNT) * MESSAGES;
+    std::printf("%-22s %7.2f M msg/s (%d ok)\n", "frames + parser", total / single, checksum);
+    std::printf("%-22s %7.2f M msg/s (%d ok)\n", "encode/decodeMessages", total / contiguous, checksumMessages);
+}
+
+/**
+ * @brief crc8Bytewise is the CRC-8 as it was before slicing, one dependent
+ * table lookup per byte. The table is built from the reflected Dallas/Maxim
+ * polynomial.
+ */
+uint8_t crc8Bytewise(const char *data, unsigned int length) {
+    static uint8_t table[256];
+    static bool built = false;
+    if(! built) {
+        for(int i = 0; i < 256; i++) {
+            uint8_t crc = i;
+            for(int bit = 0; bit < 8; bit++) {
+                crc = crc & 1 ? (crc >> 1) ^ 0x8C : crc >> 1;
+            }
+            table[i] = crc;
+        }
+        built = true;
+    }
+    uint8_t crc = 0xde;
+    for(; length > 0; length--, data++) {
+        crc = table[crc ^ static_cast<uint8_t>(*data)];
+    }
+    return crc;
+}
+
+/**
+ * Checksum throughput on a single message, a typical BATCH and the largest
+ * frame: the bytewise CRC-8 against the sliced crc8() and crc32c().
+ * @return false if crc8() and the bytewise CRC-8 differ
+ */
+bool benchmarkChecksums() {
+    const unsigned int SIZES[] = {8, 64, 255};
+    const int64_t BYTES = 200000000;
+    std::vector<char> data(255);
+    std::mt19937 random(1);
+    for(char &byte : data) {
+        byte = static_cast<char>(random());
+    }
+
+    for(unsigned int length = 0; length <= data.size(); length++) {
+        if(crc8Bytewise(data.data(), length) != crc8(data.data(), length)) {
+            std::fprintf(stderr, "crc8 differs from the bytewise CRC-8 at %u bytes\n", length);
+            return false;
+        }
+    }
+
+    for(unsigned int size : SIZES) {
+        int64_t rounds = BYTES / size;
+        uint32_t sink = 0;
+        int64_t start = hostMicros();
+        for(int64_t i = 0; i < rounds; i++) {
+            sink += crc8Bytewise(data.data(), size);
+            data[0] = static_cast<char>(sink);
+        }
+        int64_t bytewise = hostMicros() - start;
+
+        start = hostMicros();
+        for(int64_t i = 0; i < rounds; i++) {
+            sink += crc8(data.data(), size);
+            data[0] = static_cast<char>(sink);
+        }
+        int64_t sliced = hostMicros() - start;
+
+        start = hostMicros();
+        for(int64_t i = 0; i < rounds; i++) {
+            sink += crc32c(data.data(), size);
+            data[0] = static_cast<char>(sink);
+        }
+        int64_t castagnoli = hostMicros() - start;
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "checksum %u bytes", size);
+        std::printf("%-22s crc8 bytewise %7.0f  crc8 %7.0f  crc32c %7.0f MB/s\n", name,
+                    BYTES / static_cast<double>(bytewise), BYTES / static_cast<double>(sliced),
+                    BYTES / static_cast<double>(castagnoli));
+    }
+    return true;
+}
+
+/**
+ * Time from sending an ACTUATOR frame until the firmware writes the servo,
+ * includes the 100 Hz refresh of the firmware.
+ */
+void benchmarkActuatorLatency(SerialLink &link, SimulatedBoard &board, int count) {
+    std::vector<int64_t> samples;
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> pause(0, 10000);
+    int lost = 0;
+    Message replies[32];
+
+    for(int i = 0; i < count; i++) {
+        int16_t angle = board.servo(1) == 10 ? 20 : 10;
+        int64_t start = hostMicros();
+        link.send(actuator(ActuatorType::SERVO, 1, angle));
+
+        while(board.servo(1) != angle && hostMicros() - start < LOST_TIMEOUT) {
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+        if(board.servo(1) == angle) {
+            samples.push_back(hostMicros() - start);
+        } else {
+            lost++;
+        }
+
+        link.receive(replies, 32);
+        // sample all phases of the refresh cadence
+        std::this_thread::sleep_for(std::chrono::microseconds(pause(random)));
+    }
+    printPercentiles("actuator latency", samples, lost);
+}
+
+/**
+ * Time from sending SENSOR_GET until the SENSOR_DATA reply is decoded.
+ */
+void benchmarkSensorRoundTrip(SerialLink &link, int count) {
+    std::vector<int64_t> samples;
+    int lost = 0;
+    Message replies[32];
+
+    for(int i = 0; i < count; i++) {
+        uint8_t sequence = i;
+        int64_t start = hostMicros();
+        link.send(sensorGet(SensorType::SERVO, 1, sequence));
+
+        bool answered = false;
+        while(! answered && hostMicros() - start < LOST_TIMEOUT) {
+            pollfd pfd = {link.fileDescriptor(), POLLIN, 0};
+            poll(&pfd, 1, 1);
+            int received = link.receive(replies, 32);
+            for(int j = 0; j < received; j++) {
+                if(replies[j].message == MessageType::SENSOR_DATA && replies[j].sequence == sequence) {
+                    answered = true;
+                }
+            }
+        }
+        if(answered) {
+            samples.push_back(hostMicros() - start);
+        } else {
+            lost++;
+        }
+    }
+    printPercentiles("sensor round trip", samples, lost);
+}
+
+/**
+ * ACTUATOR frames the firmware decodes per second while the host sends as
+ * fast as the link accepts.
+ */
+void benchmarkActuatorThroughput(SerialLink &link, SimulatedBoard &board, int boardFd,
+                                 double duration, unsigned int batchSize) {
+    std::vector<Message> messages;
+    for(unsigned int i = 0; i < batchSize; i++) {
+        messages.push_back(actuator(ActuatorType::SERVO, 1 + i % 2, i));
+    }
+
+    Message replies[32];
+    uint32_t before = board.stats().framesReceived;
+    int64_t start = hostMicros();
+    int64_t end = start + static_cast<int64_t>(duration * 1e6);
+    uint8_t sequence = 0;
+    uint64_t sent = 0;
+    while(hostMicros() < end) {
+        if(backlog(boardFd) > MAX_BACKLOG) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+        bool written = batchSize == 1 ? link.send(messages[0])
+                                      : link.send(messages.data(), batchSize, sequence++);
+        if(written) {
+            sent += batchSize;
+        }
+        link.receive(replies, 32);
+    }
+    double elapsed = (settle(link, board, boardFd) - start) / 1e6;
+    uint64_t frames = board.stats().framesReceived - before;
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "actuator x%u", batchSize);
+    std::printf("%-22s %9.0f msg/s  (%llu sent, %llu decoded)\n", name,
+                frames / elapsed, static_cast<unsigned long long>(sent),
+                static_cast<unsigned long long>(frames));
+}
+
+/**
+ * SENSOR_DATA replies per second with SENSOR_WINDOW requests in flight.
+ */
+void benchmarkSensorThroughput(SerialLink &link, SimulatedBoard &board, int boardFd, double duration) {
+    Message replies[64];
+    // send time of the request with each sequence number, 0 if none in flight
+    std::vector<int64_t> sentAt(256, 0);
+    int64_t start = hostMicros();
+    int64_t end = start + static_cast<int64_t>(duration * 1e6);
+    uint8_t sequence = 0;
+    int inFlight = 0;
+    uint64_t answered = 0;
+
+    while(hostMicros() < end) {
+        while(inFlight < SENSOR_WINDOW && sentAt[sequence] == 0
+              && link.send(sensorGet(SensorType::SERVO, 1, sequence))) {
+            sentAt[sequence++] = hostMicros();
+            inFlight++;
+        }
+
+        pollfd pfd = {link.fileDescriptor(), POLLIN, 0};
+        poll(&pfd, 1, 1);
+        int received = link.receive(replies, 64);
+        for(int i = 0; i < received; i++) {
+            if(replies[i].message == MessageType::SENSOR_DATA && sentAt[replies[i].sequence] != 0) {
+                sentAt[replies[i].sequence] = 0;
+                answered++;
+                inFlight--;
+            }
+        }
+
+        // requests or replies got lost, free their place in the window
+        int64_t now = hostMicros();
+        for(int64_t &time : sentAt) {
+            if(time != 0 && now - time > LOST_TIMEOUT) {
+                time = 0;
+                inFlight--;
+            }
+        }
+    }
+
+    double elapsed = (hostMicros() - start) / 1e6;
+    std::printf("%-22s %9.0f msg/s\n", "sensor get", answered / elapsed);
+    settle(link, board, boardFd);
+}
+
+/**
+ * @brief stream holds the SERVO 1/2 and MOTOR 1 values of a streaming test
+ */
+struct StreamValues {
+    int16_t front;
+    int16_t rear;
+    int16_t speed;
+};
+
+/**
+ * Round trip of the compact encoded stream: the servos and the motor are
+ * ramped every 5 ms while the firmware streams them at 50 Hz as keyframes
+ * and deltas, SENSOR_GET replies are mixed in. Every decoded value must be
+ * one the host commanded, in order, and the last one the final command.
+ * @return false if a decoded value is wrong
+ */
+bool benchmarkStream(SerialLink &link, SimulatedBoard &board, int boardFd, double duration) {
+    const SensorType SENSORS[3] = {SensorType::SERVO, SensorType::SERVO, SensorType::MOTOR};
+    const uint8_t IDS[3] = {1, 2, 1};
+    Message control;
+    std::memset(&control, 0, sizeof(control));
+    control.message = MessageType::SENSOR_ENABLE;
+    for(int i = 0; i < 3; i++) {
+        control.sensor = SENSORS[i];
+        control.id = IDS[i];
+        link.send(control);
+    }
+
+    // servo 1 counts up, servo 2 down and the motor in steps of 7, so a
+    // delta applied to the wrong base shows up as a value never commanded
+    CompactStats before = link.compactStats();
+    Message replies[64];
+    StreamValues last = {0, 0, 0};
+    int16_t step = 0;
+    uint64_t samples = 0;
+    uint64_t wrong = 0;
+    auto check = [&](const Message &message) {
+        if(message.message != MessageType::SENSOR_DATA) {
+            return;
+        }
+        samples++;
+        if(message.sensor == SensorType::SERVO && message.id == 1) {
+            int16_t value = message.sensorData.Servo.angle;
+            wrong += value < last.front || value > step;
+            last.front = value;
+        } else if(message.sensor == SensorType::SERVO && message.id == 2) {
+            int16_t value = message.sensorData.Servo.angle;
+            wrong += value > last.rear || value < -step;
+            last.rear = value;
+        } else if(message.sensor == SensorType::MOTOR && message.id == 1) {
+            int16_t value = message.sensorData.Motor.speed;
+            wrong += value < last.speed || value > 7 * step || value % 7 != 0;
+            last.speed = value;
+        }
+    };
+
+    int64_t end = hostMicros() + static_cast<int64_t>(duration * 1e6);
+    while(hostMicros() < end) {
+        step++;
+        Message ramp[3] = {
+            actuator(ActuatorType::SERVO, 1, step),
+            actuator(ActuatorType::SERVO, 2, -step),
+            actuator(ActuatorType::MOTOR, 1, 7 * step)
+        };
+        link.send(ramp, 3, static_cast<uint8_t>(step));
+        if(step % 4 == 0) {
+            link.send(sensorGet(SensorType::SERVO, 1, static_cast<uint8_t>(step)));
+        }
+        int64_t wait = hostMicros() + 5000;
+        while(hostMicros() < wait) {
+            pollfd pfd = {link.fileDescriptor(), POLLIN, 0};
+            poll(&pfd, 1, 1);
+            int received = link.receive(replies, 64);
+            for(int i = 0; i < received; i++) {
+                check(replies[i]);
+            }
+        }
+    }
+
+    // wait for the stream to catch up with the last command
+    int64_t deadline = hostMicros() + LOST_TIMEOUT;
+    while(hostMicros() < deadline && (last.front != step || last.rear != -step || last.speed != 7 * step)) {
+        pollfd pfd = {link.fileDescriptor(), POLLIN, 0};
+        poll(&pfd, 1, 1);
+        int received = link.receive(replies, 64);
+        for(int i = 0; i < received; i++) {
+            check(replies[i]);
+        }
+    }
+    bool current = last.front == step && last.rear == -step && last.speed == 7 * step;
+
+    control.message = MessageType::SENSOR_DISABLE;
+    for(int i = 0; i < 3; i++) {
+        control.sensor = SENSORS[i];
+        control.id = IDS[i];
+        link.send(control);
+    }
+    settle(link, board, boardFd);
+
+    const CompactStats &stats = link.compactStats();
+    std::printf("%-22s %6llu samples, %u keyframes, %u deltas, %u gaps, %llu wrong%s\n", "stream round trip",
+                static_cast<unsigned long long>(samples), stats.keyframes - before.keyframes,
+                stats.deltas - before.deltas, stats.gaps - before.gaps,
+                static_cast<unsigned long long>(wrong), current ? "" : ", last value missing");
+    return wrong == 0 && current;
+}
+
+bool parseOptions(int argc, char *argv[], Options &options) {
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(arg == "--pipe") {
+            options.pipe = true;
+        } else if(arg == "--crc32c") {
+            options.crc32c = true;
+        } else if(arg == "--codec") {
+            options.codec = true;
+        } else if(arg == "--baud" && hasValue) {
+            options.conditions.baudRate = std::atoi(argv[++i]);
+        } else if(arg == "--loss" && hasValue) {
+            options.conditions.lossRate = std::atof(argv[++i]);
+        } else if(arg == "--corrupt" && hasValue) {
+            options.conditions.corruptionRate = std::atof(argv[++i]);
+        } else if(arg == "--count" && hasValue) {
+            options.count = std::atoi(argv[++i]);
+        } else if(arg == "--duration" && hasValue) {
+            options.duration = std::atof(argv[++i]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    if(! parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    if(options.codec) {
+        ChecksumMode mode = options.crc32c ? ChecksumMode::CRC32C : ChecksumMode::CRC8;
+        benchmarkCodec(mode);
+        benchmarkFrames(mode);
+        return benchmarkChecksums() ? 0 : 1;
+    }
+
+    SerialLink link;
+    int boardFd, slaveFd = -1;
+    if(options.pipe) {
+        int fds[2];
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+            perror("socketpair");
+            return 1;
+        }
+        boardFd = fds[0];
+        link.attach(fds[1]);
+    } else {
+        char name[64];
+        if(openpty(&boardFd, &slaveFd, name, nullptr, nullptr) == -1) {
+            perror("openpty");
+            return 1;
+        }
+        termios termOptions;
+        tcgetattr(boardFd, &termOptions);
+        cfmakeraw(&termOptions);
+        tcsetattr(boardFd, TCSANOW, &termOptions);
+        link.open(name, 0);
+    }
+
+    SimulatedBoard board;
+    board.start(boardFd, options.conditions);
+
+    std::printf("link %s, baud %d, loss %g, corrupt %g\n", options.pipe ? "pipe" : "pty",
+                options.conditions.baudRate, options.conditions.lossRate,
+                options.conditions.corruptionRate);
+
+    if(options.crc32c && ! link.negotiateChecksum(ChecksumMode::CRC32C)) {
+        std::fprintf(stderr, "CRC32C negotiation failed\n");
+    }
+
+    benchmarkCodec(link.checksumMode());
+    benchmarkActuatorLatency(link, board, options.count);
+    benchmarkSensorRoundTrip(link, options.count);
+    benchmarkActuatorThroughput(link, board, boardFd, options.duration, 1);
+    benchmarkActuatorThroughput(link, board, boardFd, options.duration, 16);
+    benchmarkSensorThroughput(link, board, boardFd, options.duration);
+    bool streamed = benchmarkStream(link, board, boardFd, options.duration);
+
+    SimulatedBoardStats stats = board.stats();
+    const ParserStats &parser = link.stats();
+    std::printf("board: %u frames received, %u sent, %u dropped, %u bytes lost, %u corrupted\n",
+                stats.framesReceived, stats.framesSent, stats.framesDropped,
+                stats.bytesLost, stats.bytesCorrupted);
+    std::printf("host: %u frames decoded, %u rejected, %u bytes dropped\n",
+                parser.framesDecoded, parser.framesRejected, parser.bytesDropped);
+
+    board.stop();
+    link.close();
+    close(boardFd);
+    if(slaveFd != -1) {
+        close(slaveFd);
+    }
+    return streamed ? 0 : 1;
+}
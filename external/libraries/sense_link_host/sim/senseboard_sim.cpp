@@ -0,0 +1,73 @@
+/**
+ * Runs the Senseboard firmware on the host behind a pty, so host software can
+ * connect to the printed device instead of a real board.
+ *
+ * Usage: senseboard_sim [--baud N] [--loss P] [--corrupt P]
+ */
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "sense_link_host/simulated_board.h"
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void onSignal(int) {
+    stopRequested = 1;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    sense_link::LinkConditions conditions;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        if(std::strcmp(argv[i], "--baud") == 0) {
+            conditions.baudRate = std::atoi(argv[i + 1]);
+        } else if(std::strcmp(argv[i], "--loss") == 0) {
+            conditions.lossRate = std::atof(argv[i + 1]);
+        } else if(std::strcmp(argv[i], "--corrupt") == 0) {
+            conditions.corruptionRate = std::atof(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    int master, slave;
+    char name[64];
+    if(openpty(&master, &slave, name, nullptr, nullptr) == -1) {
+        perror("openpty");
+        return 1;
+    }
+
+    termios options;
+    tcgetattr(master, &options);
+    cfmakeraw(&options);
+    tcsetattr(master, TCSANOW, &options);
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    sense_link::SimulatedBoard board;
+    board.start(master, conditions);
+    std::printf("Senseboard simulation on %s\n", name);
+
+    while(! stopRequested) {
+        sleep(1);
+        std::printf("servo %d/%d motor %u us led %d%s\n",
+                    board.servo(1), board.servo(2), board.motor(), board.led(),
+                    board.failsafeActive() ? " FAILSAFE" : "");
+        std::fflush(stdout);
+    }
+
+    board.stop();
+    close(slave);
+    close(master);
+    return 0;
+}
@@ -0,0 +1,271 @@
+/**
+ * Host cost of serving several streaming Senseboards: one polling thread
+ * per board, like one framework process per board today, against one
+ * SerialHub I/O thread. The simulated boards run in a child process, so
+ * CPU time and context switches of this process are the host side only.
+ *
+ * Every board streams its servos and the motor at 50 Hz, the host sends
+ * three actuator values per board at 100 Hz.
+ *
+ * Usage: serial_hub_bench [--boards N] [--duration S] [--poll MS]
+ *
+ * --boards    simulated boards, default 4
+ * --duration  seconds per variant, default 3
+ * --poll      period of the polling threads [ms], default 1
+ */
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "sense_link_host/board_channels.h"
+#include "sense_link_host/serial_hub.h"
+#include "sense_link_host/simulated_board.h"
+
+using namespace sense_link;
+
+namespace {
+
+/**
+ * @brief Host cycle sending the actuators [us]
+ */
+const int64_t CYCLE = 10000;
+
+struct Usage {
+    double cpu; //!< [s]
+    long switches;
+};
+
+Usage usage() {
+    rusage r;
+    getrusage(RUSAGE_SELF, &r);
+    Usage u;
+    u.cpu = r.ru_utime.tv_sec + r.ru_stime.tv_sec + (r.ru_utime.tv_usec + r.ru_stime.tv_usec) / 1e6;
+    u.switches = r.ru_nvcsw + r.ru_nivcsw;
+    return u;
+}
+
+Message command(MessageType type, uint8_t kind, uint8_t id, int16_t value) {
+    Message message;
+    std::memset(&message, 0, sizeof(message));
+    message.message = type;
+    message.sensor = static_cast<SensorType>(kind);
+    message.id = id;
+    message.actuatorData.Servo.angle = value;
+    return message;
+}
+
+std::vector<Message> enableStreams() {
+    return {command(MessageType::SENSOR_ENABLE, static_cast<uint8_t>(SensorType::SERVO), 1, 0),
+            command(MessageType::SENSOR_ENABLE, static_cast<uint8_t>(SensorType::SERVO), 2, 0),
+            command(MessageType::SENSOR_ENABLE, static_cast<uint8_t>(SensorType::MOTOR), 1, 0)};
+}
+
+std::vector<Message> actuators(int cycle) {
+    int16_t angle = static_cast<int16_t>(cycle % 40);
+    return {command(MessageType::ACTUATOR, static_cast<uint8_t>(ActuatorType::SERVO), 1, angle),
+            command(MessageType::ACTUATOR, static_cast<uint8_t>(ActuatorType::SERVO), 2, -angle),
+            command(MessageType::ACTUATOR, static_cast<uint8_t>(ActuatorType::MOTOR), 1, 100)};
+}
+
+/**
+ * @brief Boards in a child process, one end of a socketpair each
+ */
+class Boards {
+public:
+    explicit Boards(int count) : child(-1) {
+        std::vector<int> boardFds;
+        for(int i = 0; i < count; i++) {
+            int fds[2];
+            if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+                std::perror("socketpair");
+                std::exit(1);
+            }
+            boardFds.push_back(fds[0]);
+            hostFds.push_back(fds[1]);
+        }
+        child = fork();
+        if(child == 0) {
+            for(int fd : hostFds) {
+                close(fd);
+            }
+            std::vector<std::unique_ptr<SimulatedBoard>> boards;
+            for(int fd : boardFds) {
+                boards.emplace_back(new SimulatedBoard);
+                boards.back()->start(fd);
+            }
+            pause();
+            _exit(0);
+        }
+        for(int fd : boardFds) {
+            close(fd);
+        }
+    }
+
+    ~Boards() {
+        kill(child, SIGTERM);
+        waitpid(child, nullptr, 0);
+    }
+
+    std::vector<int> hostFds; //!< taken over by the variant
+    pid_t child;
+};
+
+struct Result {
+    uint64_t received;
+    uint64_t sent;
+    uint64_t frames;
+    uint64_t wakeups;
+    Usage usage;
+};
+
+void print(const char *name, const Result &r, double duration, int boards) {
+    std::printf("%-16s %6.1f%% CPU  %7.0f switches/s  %7.0f wakeups/s  %6.0f samples/s per board"
+                "  %4.1f msg/frame\n", name, 100 * r.usage.cpu / duration, r.usage.switches / duration,
+                r.wakeups / duration, r.received / duration / boards,
+                r.frames > 0 ? static_cast<double>(r.sent) / r.frames : 0.0);
+}
+
+Result runThreads(int boards, double duration, int pollMillis) {
+    Boards sim(boards);
+    std::vector<std::thread> threads;
+    std::vector<Result> results(boards);
+    Usage before = usage();
+    int64_t end = hostMicros() + static_cast<int64_t>(duration * 1e6);
+    for(int b = 0; b < boards; b++) {
+        threads.emplace_back([&, b]() {
+            SerialLink link;
+            link.attach(sim.hostFds[b]);
+            Result &result = results[b];
+            std::memset(&result, 0, sizeof(result));
+            for(const Message &message : enableStreams()) {
+                link.send(message);
+            }
+            Message messages[64];
+            int64_t nextCycle = hostMicros();
+            int cycle = 0;
+            while(hostMicros() < end) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(pollMillis));
+                result.wakeups++;
+                int count;
+                while((count = link.receive(messages, 64)) > 0) {
+                    for(int i = 0; i < count; i++) {
+                        result.received += messages[i].message == MessageType::SENSOR_DATA;
+                    }
+                }
+                if(hostMicros() >= nextCycle) {
+                    for(const Message &message : actuators(cycle++)) {
+                        result.sent += link.send(message);
+                        result.frames++;
+                    }
+                    nextCycle += CYCLE;
+                }
+            }
+        });
+    }
+    for(std::thread &thread : threads) {
+        thread.join();
+    }
+    Usage after = usage();
+
+    Result total;
+    std::memset(&total, 0, sizeof(total));
+    for(const Result &r : results) {
+        total.received += r.received;
+        total.sent += r.sent;
+        total.frames += r.frames;
+        total.wakeups += r.wakeups;
+    }
+    total.usage.cpu = after.cpu - before.cpu;
+    total.usage.switches = after.switches - before.switches;
+    return total;
+}
+
+Result runHub(int boards, double duration) {
+    Boards sim(boards);
+    Usage before = usage();
+    SerialHub hub;
+    for(int b = 0; b < boards; b++) {
+        BoardOptions options;
+        options.name = "board" + std::to_string(b);
+        hub.attachBoard(options, sim.hostFds[b]);
+    }
+    std::string error;
+    if(! hub.start(&error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        std::exit(1);
+    }
+
+    std::vector<Message> enable = enableStreams();
+    for(int b = 0; b < boards; b++) {
+        hub.send(b, enable.data(), enable.size());
+    }
+
+    // the framework cycle: routes the samples, sends the actuators
+    std::vector<BoardSensors> sensors(boards);
+    std::vector<Sample> samples;
+    Result result;
+    std::memset(&result, 0, sizeof(result));
+    int64_t end = hostMicros() + static_cast<int64_t>(duration * 1e6);
+    int64_t nextCycle = hostMicros();
+    for(int cycle = 0; hostMicros() < end; cycle++) {
+        std::vector<Message> values = actuators(cycle);
+        for(int b = 0; b < boards; b++) {
+            sensors[b].clear();
+            hub.receive(b, &samples);
+            for(const Sample &sample : samples) {
+                sensors[b].add(sample);
+                result.received += sample.message.message == MessageType::SENSOR_DATA;
+            }
+            hub.send(b, values.data(), values.size());
+        }
+        nextCycle += CYCLE;
+        std::this_thread::sleep_for(std::chrono::microseconds(std::max<int64_t>(0, nextCycle - hostMicros())));
+    }
+    for(int b = 0; b < boards; b++) {
+        BoardStats stats = hub.stats(b);
+        result.sent += stats.sent;
+        result.frames += stats.frames;
+    }
+    // the main loop only wakes once per cycle, the I/O thread on input
+    result.wakeups = hub.wakeups();
+    hub.stop();
+    Usage after = usage();
+    result.usage.cpu = after.cpu - before.cpu;
+    result.usage.switches = after.switches - before.switches;
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    int boards = 4;
+    double duration = 3;
+    int pollMillis = 1;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if(arg == "--boards") {
+            boards = std::atoi(argv[i + 1]);
+        } else if(arg == "--duration") {
+            duration = std::atof(argv[i + 1]);
+        } else if(arg == "--poll") {
+            pollMillis = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::printf("%d boards, %.0f s\n", boards, duration);
+    print("thread per board", runThreads(boards, duration, pollMillis), duration, boards);
+    print("serial hub", runHub(boards, duration), duration, boards);
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "sense_link_host/actuator_filter.h"
+
+#include <cmath>
+
+namespace sense_link {
+
+ActuatorFilter::ActuatorFilter(const ActuatorFilterOptions &options) : options(options) {
+}
+
+ActuatorFilter::Entry* ActuatorFilter::find(ActuatorType type, uint8_t id) {
+    for(Entry &entry : actuators) {
+        if(entry.type == type && entry.id == id) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool ActuatorFilter::update(ActuatorType type, uint8_t id, double value, int64_t now) {
+    Entry *entry = find(type, id);
+    if(entry == nullptr) {
+        Entry added;
+        added.type = type;
+        added.id = id;
+        added.counters = Counters{0, 0, 0};
+        actuators.push_back(added);
+        entry = &actuators.back();
+    } else if(entry->time != INT64_MIN) {
+        bool changed = std::fabs(value - entry->value) > options.deadband[static_cast<int>(type)];
+        bool due = options.keepalive > 0 && now - entry->time >= options.keepalive;
+        if(! changed && ! due) {
+            entry->counters.suppressed++;
+            return false;
+        }
+        if(! changed) {
+            entry->counters.keepalives++;
+        }
+    }
+
+    entry->value = value;
+    entry->time = now;
+    entry->counters.sent++;
+    return true;
+}
+
+void ActuatorFilter::reset() {
+    for(Entry &entry : actuators) {
+        entry.time = INT64_MIN;
+    }
+}
+
+ActuatorFilter::Counters ActuatorFilter::counters(ActuatorType type, uint8_t id) const {
+    for(const Entry &entry : actuators) {
+        if(entry.type == type && entry.id == id) {
+            return entry.counters;
+        }
+    }
+    return Counters{0, 0, 0};
+}
+
+}  // namespace sense_link
@@ -0,0 +1,55 @@
+#include "sense_link_host/board_channels.h"
+
+#include <cstring>
+
+namespace sense_link {
+
+BoardSensors::BoardSensors() {
+    std::memset(slots, 0, sizeof(slots));
+}
+
+void BoardSensors::add(const Sample &sample) {
+    cycleSamples.push_back(sample);
+    const Message &message = sample.message;
+    if(message.message != MessageType::SENSOR_DATA || message.sensor >= SensorType::__END__) {
+        return;
+    }
+    uint16_t &slot = slots[static_cast<int>(message.sensor)][message.id];
+    if(slot == 0) {
+        latestSamples.push_back(sample);
+        slot = static_cast<uint16_t>(latestSamples.size());
+    } else {
+        latestSamples[slot - 1] = sample;
+    }
+}
+
+void BoardSensors::addHistory(SensorType type, uint8_t id, const SampleRing *ring) {
+    histories.push_back(History{type, id, ring});
+}
+
+const SampleRing* BoardSensors::history(SensorType type, uint8_t id) const {
+    for(const History &history : histories) {
+        if(history.type == type && history.id == id) {
+            return history.ring;
+        }
+    }
+    return nullptr;
+}
+
+void BoardActuators::set(ActuatorType type, uint8_t id, const ActuatorData &data) {
+    for(Message &message : pending) {
+        if(message.actuator == type && message.id == id) {
+            message.actuatorData = data;
+            return;
+        }
+    }
+    Message message;
+    std::memset(&message, 0, sizeof(message));
+    message.message = MessageType::ACTUATOR;
+    message.actuator = type;
+    message.id = id;
+    message.actuatorData = data;
+    pending.push_back(message);
+}
+
+}  // namespace sense_link
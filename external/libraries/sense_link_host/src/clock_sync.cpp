@@ -0,0 +1,124 @@
+#include "sense_link_host/clock_sync.h"
+
+#include <chrono>
+
+namespace sense_link {
+
+namespace {
+
+/**
+ * @brief Exchanges within this margin of the best round trip are used [us]
+ */
+const int64_t ROUND_TRIP_MARGIN = 200;
+
+/**
+ * @brief Exchanges must span this time before a drift is estimated [us],
+ * on shorter spans the jitter dominates the slope
+ */
+const int64_t MIN_DRIFT_SPAN = 2000000;
+
+}  // namespace
+
+int64_t hostMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ClockSync::ClockSync() : count(0), next(0), sequence(0), pending(false), pendingSendTime(0),
+    hostRef(0), boardRef(0), slope(1), minRoundTrip(0) {
+}
+
+Message ClockSync::request(int64_t sendTime) {
+    Message message;
+    message.message = MessageType::TIME;
+    message.sensor = SensorType::UNKNOWN;
+    message.id = TIME_SYNC_ID;
+    message.sequence = ++sequence;
+    message.time.micros = static_cast<uint64_t>(sendTime);
+
+    pending = true;
+    pendingSendTime = sendTime;
+    return message;
+}
+
+bool ClockSync::reply(const Message &reply, int64_t receiveTime) {
+    if(! pending || reply.message != MessageType::TIME || reply.id != TIME_SYNC_ID
+            || reply.sequence != sequence || receiveTime < pendingSendTime) {
+        return false;
+    }
+    pending = false;
+
+    Exchange &exchange = exchanges[next];
+    exchange.roundTrip = receiveTime - pendingSendTime;
+    exchange.hostTime = pendingSendTime + exchange.roundTrip / 2;
+    exchange.boardTime = static_cast<int64_t>(reply.time.micros);
+
+    next = (next + 1) % WINDOW;
+    if(count < WINDOW) {
+        count++;
+    }
+
+    fit();
+    return true;
+}
+
+void ClockSync::fit() {
+    minRoundTrip = exchanges[0].roundTrip;
+    for(int i = 1; i < count; i++) {
+        if(exchanges[i].roundTrip < minRoundTrip) {
+            minRoundTrip = exchanges[i].roundTrip;
+        }
+    }
+    int64_t maxRoundTrip = 2 * minRoundTrip + ROUND_TRIP_MARGIN;
+
+    // center on the newest exchange to keep the sums small
+    const Exchange &newest = exchanges[(next + WINDOW - 1) % WINDOW];
+    double sumHost = 0, sumBoard = 0;
+    int64_t firstHost = newest.hostTime;
+    int used = 0;
+    for(int i = 0; i < count; i++) {
+        if(exchanges[i].roundTrip <= maxRoundTrip) {
+            sumHost += exchanges[i].hostTime - newest.hostTime;
+            sumBoard += exchanges[i].boardTime - newest.boardTime;
+            if(exchanges[i].hostTime < firstHost) {
+                firstHost = exchanges[i].hostTime;
+            }
+            used++;
+        }
+    }
+
+    double meanHost = sumHost / used;
+    double meanBoard = sumBoard / used;
+    hostRef = newest.hostTime + static_cast<int64_t>(meanHost);
+    boardRef = newest.boardTime + static_cast<int64_t>(meanBoard);
+
+    if(newest.hostTime - firstHost < MIN_DRIFT_SPAN) {
+        slope = 1;
+        return;
+    }
+
+    double sxy = 0, sxx = 0;
+    for(int i = 0; i < count; i++) {
+        if(exchanges[i].roundTrip <= maxRoundTrip) {
+            double dx = (exchanges[i].hostTime - newest.hostTime) - meanHost;
+            double dy = (exchanges[i].boardTime - newest.boardTime) - meanBoard;
+            sxy += dx * dy;
+            sxx += dx * dx;
+        }
+    }
+    slope = sxx > 0 ? sxy / sxx : 1;
+}
+
+int64_t ClockSync::toHost(uint64_t boardTime) const {
+    return hostRef + static_cast<int64_t>((static_cast<int64_t>(boardTime) - boardRef) / slope);
+}
+
+uint64_t ClockSync::toBoard(int64_t hostTime) const {
+    return static_cast<uint64_t>(boardRef + static_cast<int64_t>((hostTime - hostRef) * slope));
+}
+
+int64_t ClockSync::offset(int64_t hostTime) const {
+    return static_cast<int64_t>(toBoard(hostTime)) - hostTime;
+}
+
+}  // namespace sense_link
@@ -0,0 +1,147 @@
+#include "sense_link_host/sample_ring.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace sense_link {
+
+namespace {
+
+/**
+ * @brief interpolate blends the payload fields of two samples
+ * @param a older sample
+ * @param b newer sample
+ * @param f position between a (0) and b (1)
+ * @param out result, header taken from a
+ */
+void interpolate(const Message &a, const Message &b, double f, Message *out) {
+    *out = f < 0.5 ? a : b;
+
+    const PayloadLayout *layout = payloadLayout(MessageType::SENSOR_DATA,
+                                                static_cast<uint8_t>(a.sensor));
+    const char *from = reinterpret_cast<const char*>(&a);
+    const char *to = reinterpret_cast<const char*>(&b);
+    char *result = reinterpret_cast<char*>(out);
+
+    for(uint8_t i = 0; i < layout->count; i++) {
+        const FieldLayout &field = layout->fields[i];
+        // the difference is taken in the field width, so it works for signed
+        // and unsigned fields alike
+        if(field.width == 2) {
+            uint16_t x, y;
+            memcpy(&x, from + field.offset, sizeof(x));
+            memcpy(&y, to + field.offset, sizeof(y));
+            int16_t delta = static_cast<int16_t>(y - x);
+            uint16_t value = x + static_cast<int16_t>(std::lround(delta * f));
+            memcpy(result + field.offset, &value, sizeof(value));
+        } else if(field.width == 4) {
+            uint32_t x, y;
+            memcpy(&x, from + field.offset, sizeof(x));
+            memcpy(&y, to + field.offset, sizeof(y));
+            int32_t delta = static_cast<int32_t>(y - x);
+            uint32_t value = x + static_cast<uint32_t>(static_cast<int32_t>(std::lround(delta * f)));
+            memcpy(result + field.offset, &value, sizeof(value));
+        }
+    }
+}
+
+}  // namespace
+
+SampleRing::SampleRing(unsigned int capacity) : head(0) {
+    unsigned int size = 2;
+    while(size < capacity) {
+        size *= 2;
+    }
+    entries.reset(new Entry[size]);
+    mask = size - 1;
+}
+
+void SampleRing::push(const Message &sample, int64_t hostTime) {
+    uint64_t index = head.load(std::memory_order_relaxed);
+    if(index > 0 && hostTime < entries[(index - 1) & mask].time) {
+        hostTime = entries[(index - 1) & mask].time;
+    }
+
+    // the new head of the last push must be visible before the oldest entry
+    // is overwritten, readers compare against it after copying
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Entry &entry = entries[index & mask];
+    entry.time = hostTime;
+    entry.sample = sample;
+    head.store(index + 1, std::memory_order_release);
+}
+
+bool SampleRing::latest(Message *sample, int64_t *hostTime) const {
+    while(true) {
+        uint64_t end = head.load(std::memory_order_acquire);
+        if(end == 0) {
+            return false;
+        }
+
+        const Entry &entry = entries[(end - 1) & mask];
+        *hostTime = entry.time;
+        *sample = entry.sample;
+
+        // the entry is intact if the writer did not wrap around onto it
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(head.load(std::memory_order_relaxed) <= end - 1 + mask) {
+            return true;
+        }
+    }
+}
+
+bool SampleRing::at(int64_t hostTime, Message *sample) const {
+    while(true) {
+        uint64_t end = head.load(std::memory_order_acquire);
+        if(end == 0) {
+            return false;
+        }
+        // the slot of the oldest entry is the next one to be overwritten
+        uint64_t begin = end > mask ? end - mask : 0;
+
+        // first entry newer than hostTime
+        uint64_t low = begin;
+        uint64_t high = end;
+        while(low < high) {
+            uint64_t middle = low + (high - low) / 2;
+            if(entries[middle & mask].time <= hostTime) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        Entry before, after;
+        bool exact = false;
+        if(low == begin) {
+            return false;
+        } else if(low == end) {
+            before = entries[(end - 1) & mask];
+            if(before.time != hostTime) {
+                return false;
+            }
+            exact = true;
+        } else {
+            before = entries[(low - 1) & mask];
+            after = entries[low & mask];
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(head.load(std::memory_order_relaxed) > low - 1 + mask) {
+            // overwritten while reading, search again
+            continue;
+        }
+
+        if(exact || after.time == before.time) {
+            *sample = before.sample;
+        } else {
+            interpolate(before.sample, after.sample,
+                        static_cast<double>(hostTime - before.time) / (after.time - before.time),
+                        sample);
+        }
+        return true;
+    }
+}
+
+}  // namespace sense_link
@@ -0,0 +1,331 @@
+#include "sense_link_host/serial_hub.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace sense_link {
+
+namespace {
+
+/**
+ * @brief Messages decoded per SerialLink::receive call
+ */
+const int RECEIVE_CHUNK = 64;
+
+/**
+ * @brief epoll data of the eventfd, boards use their index
+ */
+const uint64_t WAKE_TOKEN = ~0ull;
+
+}  // namespace
+
+const size_t SerialHub::MAX_INBOX;
+
+SerialHub::SerialHub(const HubOptions &options) : hubOptions(options), epollFd(-1), wakeFd(-1),
+    wakePending(false), running(false), wakeupCount(0) {
+}
+
+SerialHub::~SerialHub() {
+    stop();
+}
+
+int SerialHub::addBoard(const BoardOptions &options) {
+    return attachBoard(options, -1);
+}
+
+int SerialHub::attachBoard(const BoardOptions &options, int fileDescriptor) {
+    std::unique_ptr<Board> board(new Board);
+    board->options = options;
+    board->attached = fileDescriptor;
+    std::memset(&board->stats, 0, sizeof(board->stats));
+    board->nextSync = 0;
+    board->nextReconnect = 0;
+    board->sequence = 0;
+    boards.push_back(std::move(board));
+    return static_cast<int>(boards.size() - 1);
+}
+
+const SampleRing& SerialHub::keepHistory(int board, SensorType type, uint8_t id, unsigned int capacity) {
+    const SampleRing *existing = history(board, type, id);
+    if(existing != nullptr) {
+        return *existing;
+    }
+    History history;
+    history.type = type;
+    history.id = id;
+    history.ring.reset(new SampleRing(capacity));
+    boards[board]->histories.push_back(std::move(history));
+    return *boards[board]->histories.back().ring;
+}
+
+const SampleRing* SerialHub::history(int board, SensorType type, uint8_t id) const {
+    for(const History &history : boards[board]->histories) {
+        if(history.type == type && history.id == id) {
+            return history.ring.get();
+        }
+    }
+    return nullptr;
+}
+
+bool SerialHub::start(std::string *error) {
+    if(running) {
+        return true;
+    }
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_TOKEN;
+    if(epollFd == -1 || wakeFd == -1 || epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) == -1) {
+        *error = std::string("epoll: ") + std::strerror(errno);
+        stop();
+        return false;
+    }
+
+    for(size_t i = 0; i < boards.size(); i++) {
+        connect(static_cast<int>(i));
+    }
+    running = true;
+    thread = std::thread(&SerialHub::run, this);
+    return true;
+}
+
+void SerialHub::stop() {
+    if(running.exchange(false)) {
+        wake();
+        thread.join();
+    }
+    for(size_t i = 0; i < boards.size(); i++) {
+        disconnect(static_cast<int>(i));
+    }
+    if(wakeFd != -1) {
+        close(wakeFd);
+        wakeFd = -1;
+    }
+    if(epollFd != -1) {
+        close(epollFd);
+        epollFd = -1;
+    }
+}
+
+int SerialHub::board(const std::string &name) const {
+    for(size_t i = 0; i < boards.size(); i++) {
+        if(boards[i]->options.name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+const BoardOptions& SerialHub::options(int board) const {
+    return boards[board]->options;
+}
+
+void SerialHub::receive(int board, std::vector<Sample> *samples) {
+    samples->clear();
+    Board &b = *boards[board];
+    std::lock_guard<std::mutex> lock(b.mutex);
+    // the empty vector keeps the capacity of the caller's one for the next round
+    samples->swap(b.inbox);
+}
+
+void SerialHub::send(int board, const Message *messages, size_t count) {
+    Board &b = *boards[board];
+    {
+        std::lock_guard<std::mutex> lock(b.mutex);
+        b.outbox.insert(b.outbox.end(), messages, messages + count);
+    }
+    wake();
+}
+
+BoardStats SerialHub::stats(int board) const {
+    Board &b = *boards[board];
+    std::lock_guard<std::mutex> lock(b.mutex);
+    return b.stats;
+}
+
+void SerialHub::wake() {
+    // one eventfd write per I/O round however many send() calls come in
+    if(! wakePending.exchange(true) && wakeFd != -1) {
+        uint64_t one = 1;
+        ssize_t written = ::write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+bool SerialHub::connect(int index) {
+    Board &board = *boards[index];
+    bool opened;
+    if(board.attached != -1) {
+        opened = board.link.attach(board.attached);
+        board.attached = -1;
+    } else {
+        opened = ! board.options.device.empty()
+                && board.link.open(board.options.device, board.options.baudRate);
+    }
+    if(opened && board.options.checksum != ChecksumMode::CRC8
+            && ! board.link.negotiateChecksum(board.options.checksum)) {
+        board.link.close();
+        opened = false;
+    }
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = static_cast<uint64_t>(index);
+    if(opened && epoll_ctl(epollFd, EPOLL_CTL_ADD, board.link.fileDescriptor(), &event) == -1) {
+        board.link.close();
+        opened = false;
+    }
+
+    int64_t now = hostMicros();
+    board.nextReconnect = now + hubOptions.reconnectInterval;
+    board.nextSync = now;
+    std::lock_guard<std::mutex> lock(board.mutex);
+    board.stats.connected = opened;
+    return opened;
+}
+
+void SerialHub::disconnect(int index) {
+    Board &board = *boards[index];
+    if(board.link.isOpen()) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, board.link.fileDescriptor(), nullptr);
+        board.link.close();
+    }
+    board.nextReconnect = hostMicros() + hubOptions.reconnectInterval;
+    std::lock_guard<std::mutex> lock(board.mutex);
+    board.stats.connected = false;
+}
+
+void SerialHub::read(int index) {
+    Board &board = *boards[index];
+    Message messages[RECEIVE_CHUNK];
+    int64_t timestamps[RECEIVE_CHUNK];
+    int count;
+    do {
+        count = board.link.receive(messages, RECEIVE_CHUNK, timestamps);
+        if(count == -1) {
+            disconnect(index);
+            return;
+        }
+        if(count == 0) {
+            return;
+        }
+
+        if(! board.histories.empty()) {
+            for(int i = 0; i < count; i++) {
+                if(messages[i].message != MessageType::SENSOR_DATA) {
+                    continue;
+                }
+                for(History &history : board.histories) {
+                    if(history.type == messages[i].sensor && history.id == messages[i].id) {
+                        history.ring->push(messages[i], timestamps[i]);
+                    }
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(board.mutex);
+        for(int i = 0; i < count; i++) {
+            board.inbox.push_back(Sample{messages[i], timestamps[i]});
+        }
+        board.stats.received += count;
+        if(board.inbox.size() > MAX_INBOX) {
+            size_t excess = board.inbox.size() - MAX_INBOX;
+            board.inbox.erase(board.inbox.begin(), board.inbox.begin() + excess);
+            board.stats.dropped += excess;
+        }
+    } while(count == RECEIVE_CHUNK);
+}
+
+void SerialHub::write(int index) {
+    Board &board = *boards[index];
+    board.writing.clear();
+    {
+        std::lock_guard<std::mutex> lock(board.mutex);
+        board.writing.swap(board.outbox);
+    }
+    if(board.writing.empty() || ! board.link.isOpen()) {
+        return;
+    }
+
+    size_t frames = 0;
+    bool ok = true;
+    if(board.options.batch && board.writing.size() > 1) {
+        ok = board.link.send(board.writing.data(), board.writing.size(), board.sequence++);
+        frames = (board.writing.size() + 254) / 255;
+    } else {
+        for(const Message &message : board.writing) {
+            ok = board.link.send(message) && ok;
+        }
+        frames = board.writing.size();
+    }
+
+    std::lock_guard<std::mutex> lock(board.mutex);
+    if(ok) {
+        board.stats.sent += board.writing.size();
+        board.stats.frames += frames;
+    } else {
+        board.stats.writeErrors++;
+    }
+}
+
+void SerialHub::run() {
+    std::vector<epoll_event> events(boards.size() + 1);
+    while(running) {
+        // sleep until input, a send() or the next clock sync or reconnect
+        int64_t now = hostMicros();
+        int64_t next = now + 1000000;
+        for(const std::unique_ptr<Board> &board : boards) {
+            if(! board->link.isOpen()) {
+                next = std::min(next, board->nextReconnect);
+            } else if(hubOptions.syncInterval > 0) {
+                next = std::min(next, board->nextSync);
+            }
+        }
+        int timeout = static_cast<int>(std::max<int64_t>(0, (next - now + 999) / 1000));
+        int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), timeout);
+        wakeupCount++;
+        if(ready == -1 && errno != EINTR) {
+            break;
+        }
+
+        bool woken = false;
+        for(int i = 0; i < ready; i++) {
+            if(events[i].data.u64 == WAKE_TOKEN) {
+                uint64_t value;
+                ssize_t bytes = ::read(wakeFd, &value, sizeof(value));
+                (void)bytes;
+                woken = true;
+            } else {
+                read(static_cast<int>(events[i].data.u64));
+            }
+        }
+        if(woken) {
+            // later send() calls write the eventfd again
+            wakePending = false;
+            for(size_t i = 0; i < boards.size(); i++) {
+                write(static_cast<int>(i));
+            }
+        }
+
+        now = hostMicros();
+        for(size_t i = 0; i < boards.size(); i++) {
+            Board &board = *boards[i];
+            if(! board.link.isOpen()) {
+                if(now >= board.nextReconnect && ! board.options.device.empty() && connect(i)) {
+                    std::lock_guard<std::mutex> lock(board.mutex);
+                    board.stats.reconnects++;
+                }
+            } else if(hubOptions.syncInterval > 0 && now >= board.nextSync) {
+                board.link.syncClock();
+                board.nextSync = now + hubOptions.syncInterval;
+            }
+        }
+    }
+}
+
+}  // namespace sense_link
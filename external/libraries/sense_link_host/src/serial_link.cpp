@@ -0,0 +1,284 @@
+#include "sense_link_host/serial_link.h"
+
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace sense_link {
+
+namespace {
+
+/**
+ * @brief Time to wait for the device to accept more bytes [ms]
+ */
+const int WRITE_TIMEOUT = 10;
+
+speed_t baudConstant(int baudRate) {
+    switch(baudRate) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default: return B0;
+    }
+}
+
+}  // namespace
+
+SerialLink::SerialLink() : fd(-1), stamped(false), boardStamp(0), rxData(rxBuffer), rxLength(0), rxTime(0) {
+}
+
+SerialLink::~SerialLink() {
+    close();
+}
+
+bool SerialLink::open(const std::string &device, int baudRate) {
+    close();
+
+    fd = ::open(device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if(fd == -1) {
+        return false;
+    }
+
+    termios options;
+    if(tcgetattr(fd, &options) == 0) {
+        cfmakeraw(&options);
+        if(baudRate != 0) {
+            speed_t speed = baudConstant(baudRate);
+            if(speed == B0) {
+                close();
+                return false;
+            }
+            cfsetispeed(&options, speed);
+            cfsetospeed(&options, speed);
+        }
+        options.c_cc[VMIN] = 0;
+        options.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &options);
+        tcflush(fd, TCIOFLUSH);
+    }
+
+    resetState();
+    return true;
+}
+
+bool SerialLink::attach(int fileDescriptor) {
+    close();
+    if(fileDescriptor == -1) {
+        return false;
+    }
+
+    fd = fileDescriptor;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    resetState();
+    return true;
+}
+
+void SerialLink::resetState() {
+    parser.reset();
+    compact = CompactDecoder();
+    clockSync = ClockSync();
+    stamped = false;
+    rxData = rxBuffer;
+    rxLength = 0;
+}
+
+void SerialLink::close() {
+    if(fd != -1) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+int SerialLink::receive(Message *messages, int maxCount, int64_t *timestamps) {
+    int count = 0;
+
+    while(count < maxCount) {
+        if(parser.next(rxData, rxLength, &messages[count])) {
+            Message &message = messages[count];
+            // a board timestamp applies to the rest of its BATCH frame only,
+            // not to e.g. a later SENSOR_GET reply
+            bool sampled = stamped;
+            if(! parser.batchEntry() || parser.lastBatchEntry()) {
+                stamped = false;
+            }
+
+            if(message.message == MessageType::TIME) {
+                if(message.id == TIME_STAMP_ID) {
+                    boardStamp = message.time.micros;
+                    stamped = parser.batchEntry() && ! parser.lastBatchEntry();
+                    continue;
+                } else if(clockSync.reply(message, rxTime)) {
+                    continue;
+                }
+            }
+
+            // only the stamped stream is compact encoded, a SENSOR_GET reply
+            // or other SENSOR_DATA must not touch its state
+            if((sampled || message.message == MessageType::SENSOR_DATA_DELTA)
+                    && ! compact.decode(&message)) {
+                continue;
+            }
+            if(timestamps != nullptr) {
+                timestamps[count] = sampled && clockSync.synchronized()
+                        && message.message == MessageType::SENSOR_DATA
+                        ? clockSync.toHost(boardStamp) : rxTime;
+            }
+            count++;
+            continue;
+        }
+
+        ssize_t bytesRead = ::read(fd, rxBuffer, sizeof(rxBuffer));
+        if(bytesRead > 0) {
+            rxData = rxBuffer;
+            rxLength = bytesRead;
+            rxTime = hostMicros();
+        } else if(bytesRead == -1 && errno != EAGAIN && errno != EWOULDBLOCK
+                  && errno != EINTR) {
+            return count > 0 ? count : -1;
+        } else {
+            break;
+        }
+    }
+
+    return count;
+}
+
+bool SerialLink::send(const Message &message) {
+    return sendFrame(message, parser.getChecksumMode());
+}
+
+bool SerialLink::send(const Message *messages, unsigned int count, uint8_t sequence) {
+    ChecksumMode mode = parser.getChecksumMode();
+    char buffer[MAX_FRAME_SIZE];
+
+    while(count > 0) {
+        // pack as many messages as fit into the frame length byte
+        unsigned int packed = count > 255 ? 255 : count;
+        int length;
+        while((length = encodeBatch(messages, packed, sequence, buffer + 1,
+                                    sizeof(buffer) - 1, mode)) == -1 && packed > 1) {
+            packed--;
+        }
+        if(length == -1) {
+            return false;
+        }
+
+        buffer[0] = length;
+        if(! writeFrame(buffer, 1 + length)) {
+            return false;
+        }
+        messages += packed;
+        count -= packed;
+    }
+
+    return true;
+}
+
+bool SerialLink::syncClock() {
+    // stamp the request as late as possible, the round trip bounds the error
+    return send(clockSync.request(hostMicros()));
+}
+
+bool SerialLink::negotiateChecksum(ChecksumMode mode, int timeout) {
+    ChecksumMode current = parser.getChecksumMode();
+    if(mode == current) {
+        return true;
+    }
+
+    Message request;
+    request.message = MessageType::CHECKSUM_MODE;
+    request.sensor = SensorType::UNKNOWN;
+    request.id = 0;
+    request.sequence = 0;
+    request.checksum.mode = mode;
+
+    if(! sendFrame(request, current)) {
+        return false;
+    }
+
+    switch(waitForChecksumMode(mode, timeout)) {
+    case ChecksumReply::ACKNOWLEDGED:
+        parser.setChecksumMode(mode);
+        return true;
+    case ChecksumReply::REFUSED:
+        // the board answered in the current mode, so it did not switch
+        return false;
+    case ChecksumReply::NONE:
+        break;
+    }
+
+    // The board may have switched and only the acknowledge got lost.
+    // Ask it to switch back using the new mode, an old board drops the frame.
+    request.checksum.mode = current;
+    sendFrame(request, mode);
+    return false;
+}
+
+SerialLink::ChecksumReply SerialLink::waitForChecksumMode(ChecksumMode mode, int timeout) {
+    std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+    while(true) {
+        // decode one message at a time, the bytes following the acknowledge
+        // already use the new mode
+        Message message;
+        int received;
+        while((received = receive(&message, 1)) == 1) {
+            if(message.message == MessageType::CHECKSUM_MODE) {
+                return message.checksum.mode == mode ? ChecksumReply::ACKNOWLEDGED
+                                                     : ChecksumReply::REFUSED;
+            } else if(message.message == MessageType::ERROR) {
+                // old firmware answers unknown messages with an error
+                return ChecksumReply::REFUSED;
+            }
+        }
+        if(received == -1) {
+            return ChecksumReply::NONE;
+        }
+
+        int remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+        pollfd pfd = {fd, POLLIN, 0};
+        if(remaining <= 0 || poll(&pfd, 1, remaining) <= 0) {
+            return ChecksumReply::NONE;
+        }
+    }
+}
+
+bool SerialLink::sendFrame(const Message &message, ChecksumMode mode) {
+    char buffer[MAX_FRAME_SIZE];
+    buffer[0] = encodeMessage(&message, buffer + 1, mode);
+
+    return writeFrame(buffer, 1 + static_cast<uint8_t>(buffer[0]));
+}
+
+bool SerialLink::writeFrame(const char *data, size_t length) {
+    while(length > 0) {
+        ssize_t written = ::write(fd, data, length);
+        if(written > 0) {
+            data += written;
+            length -= written;
+        } else if(written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd pfd = {fd, POLLOUT, 0};
+            if(poll(&pfd, 1, WRITE_TIMEOUT) <= 0) {
+                return false;
+            }
+        } else if(written == -1 && errno == EINTR) {
+            continue;
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}  // namespace sense_link
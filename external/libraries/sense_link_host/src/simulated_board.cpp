@@ -0,0 +1,329 @@
+#include "sense_link_host/simulated_board.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <fcntl.h>
+#include <poll.h>
+#include <random>
+#include <sys/ioctl.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "senseboard/firmware.h"
+
+namespace sense_link {
+
+namespace {
+
+/**
+ * @brief Longest time the board thread sleeps waiting for input [ms], bounds
+ * the jitter of the periodic tasks
+ */
+const int IDLE_TIMEOUT = 1;
+
+/**
+ * @brief Time to wait for the host to read before output is discarded [ms]
+ */
+const int WRITE_TIMEOUT = 10;
+
+/**
+ * @brief Size of the transmit buffer of a throttled UART, like the 64 byte
+ * buffer of the Arduino Serial
+ */
+const int TX_BUFFER_SIZE = 64;
+
+/**
+ * @brief Line time the board thread may fall behind without losing
+ * throughput [us], covers oversleeping
+ */
+const double LINE_SLACK = 200;
+
+}  // namespace
+
+class SimulatedBoard::Impl : public senseboard::Hardware {
+public:
+    explicit Impl(const LinkConditions &conditions) : firmware(*this), fd(-1),
+        conditions(conditions), random(conditions.seed),
+        rxBudget(1), txBudget(1), lastRefill(0),
+        stopRequested(false), isRunning(false),
+        motorPulse(1500), ledOn(false), failsafe(false), writes(0),
+        framesReceived(0), framesSent(0), framesDropped(0), bytesLost(0), bytesCorrupted(0) {
+        servoAngle[0] = 0;
+        servoAngle[1] = 0;
+        // 8N1: 10 bits per byte
+        bytesPerMicro = conditions.baudRate / 10 / 1e6;
+    }
+
+    void run() {
+        lastRefill = micros();
+        firmware.begin();
+        while(! stopRequested.load()) {
+            firmware.loop();
+
+            const senseboard::FirmwareStats &stats = firmware.stats();
+            failsafe = firmware.failsafeActive();
+            framesReceived = stats.framesReceived;
+            framesSent = stats.framesSent;
+            framesDropped = stats.framesDropped;
+
+            if(conditions.baudRate > 0) {
+                refill();
+                flush();
+            }
+            if(conditions.baudRate > 0 && (! txLine.empty() || pendingBytes() > 0)) {
+                // bytes are waiting for the line, sleep until the next one
+                double budget = std::min(rxBudget, txBudget);
+                std::this_thread::sleep_for(std::chrono::microseconds(
+                        static_cast<int64_t>(std::max(0.0, 1 - budget) / bytesPerMicro) + 1));
+            } else {
+                pollfd pfd = {fd, POLLIN, 0};
+                poll(&pfd, 1, IDLE_TIMEOUT);
+            }
+        }
+    }
+
+    uint32_t micros() override {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    int available() override {
+        int bytes = pendingBytes();
+        if(conditions.baudRate > 0) {
+            refill();
+            bytes = std::min(bytes, static_cast<int>(rxBudget));
+        }
+        return bytes;
+    }
+
+    int read(char *buffer, int length) override {
+        ssize_t bytesRead = ::read(fd, buffer, length);
+        if(bytesRead <= 0) {
+            return 0;
+        }
+        if(conditions.baudRate > 0) {
+            rxBudget -= bytesRead;
+        }
+        return impair(buffer, bytesRead);
+    }
+
+    int availableForWrite() override {
+        if(conditions.baudRate > 0) {
+            return TX_BUFFER_SIZE - static_cast<int>(txLine.size());
+        }
+        // the kernel buffers the rest, write() reports what it took
+        return 4096;
+    }
+
+    int write(const char *buffer, int length) override {
+        if(conditions.baudRate > 0) {
+            // flush() sends the buffer at line speed
+            length = std::min(length, availableForWrite());
+            txLine.insert(txLine.end(), buffer, buffer + length);
+            return length;
+        }
+        send(buffer, length);
+        return length;
+    }
+
+    /**
+     * @brief flush sends as many buffered bytes as the line carried since the
+     * last call
+     */
+    void flush() {
+        int count = std::min(static_cast<int>(txBudget), static_cast<int>(txLine.size()));
+        if(count > 0) {
+            std::vector<char> chunk(txLine.begin(), txLine.begin() + count);
+            txLine.erase(txLine.begin(), txLine.begin() + count);
+            txBudget -= count;
+            send(chunk.data(), count);
+        }
+    }
+
+    /**
+     * @brief send hands bytes to the host, the firmware never writes more than
+     * availableForWrite(), so they go out at once unless the host stopped reading
+     */
+    void send(const char *buffer, int length) {
+        char line[4096];
+        length = std::min(length, static_cast<int>(sizeof(line)));
+        std::copy(buffer, buffer + length, line);
+
+        int remaining = impair(line, length);
+        const char *data = line;
+        while(remaining > 0) {
+            ssize_t written = ::write(fd, data, remaining);
+            if(written > 0) {
+                data += written;
+                remaining -= written;
+                continue;
+            }
+            pollfd pfd = {fd, POLLOUT, 0};
+            if(poll(&pfd, 1, WRITE_TIMEOUT) <= 0) {
+                bytesLost += remaining;
+                break;
+            }
+        }
+    }
+
+    void writeServo(uint8_t id, int16_t angle) override {
+        if(id == 1 || id == 2) {
+            servoAngle[id - 1] = angle;
+        }
+        if(id == 1) {
+            writes++;
+        }
+    }
+
+    void writeMotor(uint16_t microseconds) override {
+        motorPulse = microseconds;
+    }
+
+    void writeLed(uint8_t id, bool on) override {
+        if(id == 1) {
+            ledOn = on;
+        }
+    }
+
+    /**
+     * @brief impair drops and corrupts bytes as on a bad line
+     * @return number of bytes left in buffer
+     */
+    int impair(char *buffer, int length) {
+        if(conditions.lossRate <= 0 && conditions.corruptionRate <= 0) {
+            return length;
+        }
+
+        std::uniform_real_distribution<double> chance(0, 1);
+        std::uniform_int_distribution<int> bit(0, 7);
+        int kept = 0;
+        for(int i = 0; i < length; i++) {
+            if(chance(random) < conditions.lossRate) {
+                bytesLost++;
+                continue;
+            }
+            char byte = buffer[i];
+            if(chance(random) < conditions.corruptionRate) {
+                byte ^= 1 << bit(random);
+                bytesCorrupted++;
+            }
+            buffer[kept++] = byte;
+        }
+        return kept;
+    }
+
+    int pendingBytes() {
+        int bytes = 0;
+        if(ioctl(fd, FIONREAD, &bytes) == -1) {
+            return 0;
+        }
+        return bytes;
+    }
+
+    void refill() {
+        uint32_t now = micros();
+        double bytes = (now - lastRefill) * bytesPerMicro;
+        lastRefill = now;
+        // an idle line does not save up time
+        double maxBudget = 1 + LINE_SLACK * bytesPerMicro;
+        rxBudget = std::min(rxBudget + bytes, maxBudget);
+        txBudget = std::min(txBudget + bytes, maxBudget);
+    }
+
+    senseboard::Firmware firmware;
+    int fd;
+    std::thread thread;
+
+    LinkConditions conditions;
+    std::mt19937 random;
+    double bytesPerMicro;
+    double rxBudget; //!< bytes the line delivered but the board did not read yet
+    double txBudget; //!< bytes the line can send right now
+    std::deque<char> txLine; //!< UART transmit buffer
+    uint32_t lastRefill;
+
+    std::atomic<bool> stopRequested;
+    std::atomic<bool> isRunning;
+
+    std::atomic<int16_t> servoAngle[2];
+    std::atomic<uint16_t> motorPulse;
+    std::atomic<bool> ledOn;
+    std::atomic<bool> failsafe;
+    std::atomic<uint32_t> writes;
+
+    std::atomic<uint32_t> framesReceived;
+    std::atomic<uint32_t> framesSent;
+    std::atomic<uint32_t> framesDropped;
+    std::atomic<uint32_t> bytesLost;
+    std::atomic<uint32_t> bytesCorrupted;
+};
+
+SimulatedBoard::SimulatedBoard() {
+}
+
+SimulatedBoard::~SimulatedBoard() {
+    stop();
+}
+
+bool SimulatedBoard::start(int fd, const LinkConditions &conditions) {
+    if(impl && impl->isRunning) {
+        return false;
+    }
+
+    // a fresh firmware behaves like a board after reset
+    impl.reset(new Impl(conditions));
+    impl->fd = fd;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    impl->isRunning = true;
+    impl->thread = std::thread(&Impl::run, impl.get());
+    return true;
+}
+
+void SimulatedBoard::stop() {
+    if(impl && impl->isRunning) {
+        impl->stopRequested = true;
+        impl->thread.join();
+        impl->isRunning = false;
+    }
+}
+
+bool SimulatedBoard::running() const {
+    return impl && impl->isRunning;
+}
+
+int16_t SimulatedBoard::servo(uint8_t id) const {
+    return impl && (id == 1 || id == 2) ? impl->servoAngle[id - 1].load() : 0;
+}
+
+uint16_t SimulatedBoard::motor() const {
+    return impl ? impl->motorPulse.load() : 1500;
+}
+
+bool SimulatedBoard::led() const {
+    return impl && impl->ledOn;
+}
+
+bool SimulatedBoard::failsafeActive() const {
+    return impl && impl->failsafe;
+}
+
+uint32_t SimulatedBoard::actuatorWrites() const {
+    return impl ? impl->writes.load() : 0;
+}
+
+SimulatedBoardStats SimulatedBoard::stats() const {
+    SimulatedBoardStats stats = SimulatedBoardStats();
+    if(impl) {
+        stats.framesReceived = impl->framesReceived;
+        stats.framesSent = impl->framesSent;
+        stats.framesDropped = impl->framesDropped;
+        stats.bytesLost = impl->bytesLost;
+        stats.bytesCorrupted = impl->bytesCorrupted;
+    }
+    return stats;
+}
+
+}  // namespace sense_link
@@ -0,0 +1,264 @@
+/**
+ * Tests of the clock synchronization, the sample ring and the sample
+ * history the SerialHub records from a simulated board.
+ *
+ * Usage: sense_link_host_test
+ *
+ * Prints every failed check and exits with 1 if there was one.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include "sense_link_host/clock_sync.h"
+#include "sense_link_host/sample_ring.h"
+#include "sense_link_host/serial_hub.h"
+#include "sense_link_host/simulated_board.h"
+
+using namespace sense_link;
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if(! (condition)) { \
+            std::fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while(0)
+
+#define CHECK_NEAR(value, expected, tolerance) \
+    do { \
+        double actual = static_cast<double>(value); \
+        if(std::fabs(actual - static_cast<double>(expected)) > (tolerance)) { \
+            std::fprintf(stderr, "%s:%d: %s is %f, expected %f\n", __FILE__, __LINE__, \
+                         #value, actual, static_cast<double>(expected)); \
+            failures++; \
+        } \
+    } while(0)
+
+/**
+ * @brief Board clock running at an offset and drift to the host clock
+ */
+struct BoardClock {
+    int64_t offset; //!< board time at host time 0 [us]
+    double drift; //!< [ppm]
+
+    uint64_t at(int64_t hostTime) const {
+        return static_cast<uint64_t>(offset + hostTime + std::llround(hostTime * drift * 1e-6));
+    }
+};
+
+/**
+ * One request and reply, the board reads its clock after toBoard of the
+ * round trip, the reply takes the rest.
+ */
+bool exchange(ClockSync &sync, const BoardClock &clock, int64_t sendTime, int64_t toBoard, int64_t roundTrip) {
+    Message reply = sync.request(sendTime);
+    reply.time.micros = clock.at(sendTime + toBoard);
+    return sync.reply(reply, sendTime + roundTrip);
+}
+
+void testClockOffset() {
+    ClockSync sync;
+    CHECK(! sync.synchronized());
+
+    BoardClock clock = {5000000, 0};
+    CHECK(exchange(sync, clock, 1000000, 200, 400));
+    CHECK(sync.synchronized());
+    CHECK_NEAR(sync.offset(1000200), 5000000, 1);
+    CHECK_NEAR(sync.roundTrip(), 400, 0);
+    CHECK_NEAR(sync.toHost(clock.at(2000000)), 2000000, 1);
+    CHECK_NEAR(sync.toBoard(2000000), clock.at(2000000), 1);
+    // no drift from exchanges shorter than the drift span
+    CHECK_NEAR(sync.drift(), 0, 0);
+}
+
+void testClockReplies() {
+    ClockSync sync;
+    BoardClock clock = {1000, 0};
+
+    Message unrequested;
+    std::memset(&unrequested, 0, sizeof(unrequested));
+    unrequested.message = MessageType::TIME;
+    unrequested.id = TIME_SYNC_ID;
+    CHECK(! sync.reply(unrequested, 100));
+
+    // only the reply to the last request counts
+    Message first = sync.request(1000);
+    Message second = sync.request(2000);
+    first.time.micros = clock.at(1100);
+    CHECK(! sync.reply(first, 1200));
+    second.time.micros = clock.at(2100);
+    CHECK(sync.reply(second, 2200));
+    CHECK(! sync.reply(second, 2300));
+}
+
+void testClockDrift() {
+    ClockSync sync;
+    BoardClock clock = {-300000, 120};
+
+    // one exchange every 100 ms, every 4th delayed by 5 ms on the way back
+    for(int i = 0; i < ClockSync::WINDOW; i++) {
+        int64_t sendTime = 10000000 + i * 100000;
+        int64_t roundTrip = i % 4 == 3 ? 5300 : 300;
+        CHECK(exchange(sync, clock, sendTime, 150, roundTrip));
+    }
+    CHECK_NEAR(sync.drift(), 120, 1);
+    CHECK_NEAR(sync.roundTrip(), 300, 0);
+
+    // converting works before, inside and after the window of exchanges
+    for(int64_t hostTime : {9000000ll, 11500000ll, 14000000ll}) {
+        CHECK_NEAR(sync.offset(hostTime), static_cast<int64_t>(clock.at(hostTime)) - hostTime, 2);
+        CHECK_NEAR(sync.toHost(clock.at(hostTime)), hostTime, 2);
+    }
+}
+
+Message gyro(int32_t x, int32_t y) {
+    Message message;
+    std::memset(&message, 0, sizeof(message));
+    message.message = MessageType::SENSOR_DATA;
+    message.sensor = SensorType::GYROSCOPE;
+    message.id = 1;
+    message.sensorData.Gyroscope.x = x;
+    message.sensorData.Gyroscope.y = y;
+    return message;
+}
+
+void testRingInterpolation() {
+    SampleRing ring(16);
+    Message sample;
+    int64_t time;
+    CHECK(! ring.latest(&sample, &time));
+    CHECK(! ring.at(0, &sample));
+
+    ring.push(gyro(0, 100), 1000);
+    ring.push(gyro(100, -100), 2000);
+    ring.push(gyro(-50, 0), 3000);
+
+    CHECK(ring.at(1500, &sample));
+    CHECK_NEAR(sample.sensorData.Gyroscope.x, 50, 0);
+    CHECK_NEAR(sample.sensorData.Gyroscope.y, 0, 0);
+    CHECK(ring.at(2750, &sample));
+    CHECK_NEAR(sample.sensorData.Gyroscope.x, -13, 0);
+    CHECK_NEAR(sample.sensorData.Gyroscope.y, -25, 0);
+
+    // exact hits, also the newest sample
+    CHECK(ring.at(1000, &sample));
+    CHECK_NEAR(sample.sensorData.Gyroscope.x, 0, 0);
+    CHECK(ring.at(3000, &sample));
+    CHECK_NEAR(sample.sensorData.Gyroscope.x, -50, 0);
+
+    CHECK(! ring.at(999, &sample));
+    CHECK(! ring.at(3001, &sample));
+
+    // an older timestamp is stored with the newest one
+    ring.push(gyro(10, 10), 2500);
+    CHECK(ring.latest(&sample, &time));
+    CHECK_NEAR(time, 3000, 0);
+    CHECK_NEAR(sample.sensorData.Gyroscope.x, 10, 0);
+}
+
+void testRingWraparound() {
+    SampleRing ring(5);
+    CHECK(ring.capacity() == 8);
+
+    for(int i = 0; i < 20; i++) {
+        ring.push(gyro(i * 10, -i * 10), i * 100);
+    }
+    CHECK(ring.size() == 20);
+
+    // the slot of the oldest sample is the next one written, so capacity - 1
+    // samples (1300 to 1900) can be looked up
+    Message sample;
+    CHECK(! ring.at(1299, &sample));
+    CHECK(ring.at(1300, &sample));
+    CHECK_NEAR(sample.sensorData.Gyroscope.x, 130, 0);
+    CHECK(! ring.at(1950, &sample));
+    CHECK(ring.at(1850, &sample));
+    CHECK_NEAR(sample.sensorData.Gyroscope.x, 185, 0);
+    CHECK_NEAR(sample.sensorData.Gyroscope.y, -185, 0);
+
+    int64_t time;
+    CHECK(ring.latest(&sample, &time));
+    CHECK_NEAR(time, 1900, 0);
+    CHECK_NEAR(sample.sensorData.Gyroscope.x, 190, 0);
+
+    // the interpolation works across the end of the buffer
+    for(int i = 20; i < 27; i++) {
+        ring.push(gyro(i * 10, 0), i * 100);
+    }
+    CHECK(ring.at(2350, &sample));
+    CHECK_NEAR(sample.sensorData.Gyroscope.x, 235, 0);
+}
+
+void testHubHistory() {
+    int fds[2];
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    SimulatedBoard board;
+    board.start(fds[0], LinkConditions());
+
+    HubOptions hubOptions;
+    hubOptions.syncInterval = 100000;
+    SerialHub hub(hubOptions);
+    BoardOptions options;
+    options.name = "car";
+    int index = hub.attachBoard(options, fds[1]);
+    const SampleRing &servo = hub.keepHistory(index, SensorType::SERVO, 1, 64);
+    CHECK(hub.history(index, SensorType::SERVO, 1) == &servo);
+    CHECK(hub.history(index, SensorType::SERVO, 2) == nullptr);
+
+    std::string error;
+    CHECK(hub.start(&error));
+    Message message;
+    std::memset(&message, 0, sizeof(message));
+    message.message = MessageType::ACTUATOR;
+    message.actuator = ActuatorType::SERVO;
+    message.id = 1;
+    message.actuatorData.Servo.angle = 42;
+    hub.send(index, message);
+    message.message = MessageType::SENSOR_ENABLE;
+    message.sensor = SensorType::SERVO;
+    hub.send(index, message);
+
+    // the firmware streams at 50 Hz
+    Message sample;
+    int64_t time = 0;
+    for(int i = 0; i < 100 && servo.size() < 5; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK(servo.size() >= 5);
+    CHECK(servo.latest(&sample, &time));
+    CHECK_NEAR(sample.sensorData.Servo.angle, 42, 0);
+    CHECK(servo.at(time, &sample));
+    CHECK(std::llabs(time - hostMicros()) < 1000000);
+
+    hub.stop();
+    board.stop();
+    close(fds[0]);
+}
+
+}  // namespace
+
+int main() {
+    testClockOffset();
+    testClockReplies();
+    testClockDrift();
+    testRingInterpolation();
+    testRingWraparound();
+    testHubHistory();
+
+    if(failures > 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
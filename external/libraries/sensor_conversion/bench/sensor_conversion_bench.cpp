@@ -0,0 +1,186 @@
+/**
+ * Converts batches of raw Senseboard samples with the conversions of
+ * configs/sensor plus a lookup and a polynomial sensor, once per value
+ * through a virtual converter found by name as the importer does per
+ * sample, once with ConversionPlan. Checks both against
+ * Conversion::apply().
+ *
+ * Usage: sensor_conversion_bench [--configs DIR] [--batch N] [--rounds N]
+ *
+ * --configs  directory of the sensor .lconf files, default configs/sensor
+ * --batch    samples per batch, default 256
+ * --rounds   batches converted, default 20000
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sensor_conversion/conversion_plan.h"
+
+using namespace sensor_conversion;
+
+namespace {
+
+struct Sensor {
+    const char *name;
+    int components;
+};
+
+/**
+ * @brief The sensors of car.xml, the IMU ones with three axes
+ */
+const Sensor SENSORS[] = {
+    {"acc", 3}, {"encoder", 1}, {"gyro", 3}, {"ir_front", 1}, {"ir_r_front", 1},
+    {"ir_r_rear", 1}, {"ir_rear", 1}, {"mode", 1}, {"rc_poti", 1}, {"servo_front", 1},
+    {"servo_rear", 1}, {"ultrasonic", 1}, {"velocity", 1}
+};
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Per value conversion as in the importer
+ */
+class Converter {
+public:
+    virtual ~Converter() {}
+    virtual float convert(int32_t raw) const = 0;
+};
+
+class ConfiguredConverter : public Converter {
+public:
+    explicit ConfiguredConverter(const Conversion &conversion) : conversion(conversion) {
+    }
+
+    float convert(int32_t raw) const override {
+        return conversion.apply(static_cast<float>(raw));
+    }
+
+private:
+    Conversion conversion;
+};
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    std::string directory = "configs/sensor";
+    size_t batch = 256;
+    int rounds = 20000;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if(arg == "--configs") {
+            directory = argv[i + 1];
+        } else if(arg == "--batch") {
+            batch = std::atoi(argv[i + 1]);
+        } else if(arg == "--rounds") {
+            rounds = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    ConversionPlan plan;
+    std::map<std::string, std::unique_ptr<Converter>> converters;
+    std::vector<std::string> columnNames;
+    auto addSensor = [&](const std::string &name, const Conversion &conversion, int components) {
+        plan.add(name, conversion, components);
+        converters[name].reset(new ConfiguredConverter(conversion));
+        for(int i = 0; i < components; i++) {
+            columnNames.push_back(name);
+        }
+    };
+
+    for(const Sensor &sensor : SENSORS) {
+        ConfigMap config;
+        Conversion conversion;
+        std::string error;
+        if(! loadLconf(directory + "/" + sensor.name + ".lconf", &config, &error)
+                || ! parseConversion(config, &conversion, &error)) {
+            std::fprintf(stderr, "%s: %s\n", sensor.name, error.c_str());
+            return 1;
+        }
+        addSensor(sensor.name, conversion, sensor.components);
+    }
+
+    // an IR distance curve and a temperature compensated gyro drift
+    ConfigMap extra;
+    parseLconf("_conversion_mode = lookup\nraw = 80, 200, 400, 700, 1000\n"
+               "value = 0.8, 0.4, 0.2, 0.12, 0.1\n", &extra);
+    Conversion irCurve;
+    std::string error;
+    if(! parseConversion(extra, &irCurve, &error)) {
+        std::fprintf(stderr, "lookup: %s\n", error.c_str());
+        return 1;
+    }
+    addSensor("ir_curve", irCurve, 1);
+    extra.clear();
+    parseLconf("_conversion_mode = polynomial\ncoefficients = 0.5, 0.01, -0.0002, 0.000001\n", &extra);
+    Conversion drift;
+    if(! parseConversion(extra, &drift, &error)) {
+        std::fprintf(stderr, "polynomial: %s\n", error.c_str());
+        return 1;
+    }
+    addSensor("gyro_drift", drift, 1);
+    plan.compile();
+
+    const size_t stride = plan.stride();
+    const size_t channels = plan.channels();
+    std::vector<int32_t> raw(batch * stride, 0);
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int32_t> values(-2000, 2000);
+    for(size_t s = 0; s < batch; s++) {
+        for(size_t c = 0; c < channels; c++) {
+            raw[s * stride + c] = values(random);
+        }
+    }
+    std::vector<float> perValue(batch * stride, 0);
+    std::vector<float> planned(batch * stride, 0);
+
+    int64_t start = nowNanos();
+    for(int r = 0; r < rounds; r++) {
+        for(size_t s = 0; s < batch; s++) {
+            for(size_t c = 0; c < channels; c++) {
+                perValue[s * stride + c] = converters.find(columnNames[c])->second->convert(
+                            raw[s * stride + c]);
+            }
+        }
+    }
+    int64_t perValueTime = nowNanos() - start;
+
+    start = nowNanos();
+    for(int r = 0; r < rounds; r++) {
+        plan.convert(raw.data(), batch, planned.data());
+    }
+    int64_t planTime = nowNanos() - start;
+
+    int mismatches = 0;
+    for(size_t s = 0; s < batch; s++) {
+        for(size_t c = 0; c < channels; c++) {
+            float expected = perValue[s * stride + c];
+            float actual = planned[s * stride + c];
+            if(std::fabs(expected - actual) > 1e-4f * std::max(1.0f, std::fabs(expected))) {
+                if(mismatches++ < 5) {
+                    std::printf("mismatch %s raw %d: %g vs %g\n", columnNames[c].c_str(),
+                                raw[s * stride + c], expected, actual);
+                }
+            }
+        }
+    }
+
+    double samples = static_cast<double>(batch) * rounds;
+    std::printf("%zu channels, stride %zu, batches of %zu samples\n", channels, stride, batch);
+    std::printf("per value: %7.1f ns/sample\n", perValueTime / samples);
+    std::printf("plan:      %7.1f ns/sample  %5.1fx\n", planTime / samples,
+                static_cast<double>(perValueTime) / planTime);
+    std::printf("%d mismatches\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
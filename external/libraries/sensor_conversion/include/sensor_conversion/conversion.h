@@ -0,0 +1,59 @@
+#ifndef SENSOR_CONVERSION_CONVERSION_H
+#define SENSOR_CONVERSION_CONVERSION_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace sensor_conversion {
+
+enum class Mode {
+    LINEAR, DUAL_LINEAR, POLYNOMIAL, LOOKUP
+};
+
+/**
+ * @brief Conversion of a raw sensor value as configured in its .lconf
+ */
+struct Conversion {
+    Conversion() : mode(Mode::LINEAR), factor(1), offset(0), negativeFactor(1),
+        negativeOffset(0) {
+    }
+
+    Mode mode;
+    float factor; //!< LINEAR, DUAL_LINEAR for raw values >= 0
+    float offset;
+    float negativeFactor; //!< DUAL_LINEAR for raw values < 0
+    float negativeOffset;
+    std::vector<float> coefficients; //!< POLYNOMIAL, c0 + c1 x + c2 x^2 ...
+    std::vector<float> raw; //!< LOOKUP, ascending, linear in between, clamped outside
+    std::vector<float> value; //!< LOOKUP, one per raw
+
+    /**
+     * @brief apply converts one value, the reference for ConversionPlan
+     */
+    float apply(float x) const;
+};
+
+typedef std::map<std::string, std::string> ConfigMap;
+
+/**
+ * @brief parseLconf reads the key = value lines of an .lconf, # starts a
+ * comment
+ */
+void parseLconf(const std::string &text, ConfigMap *config);
+bool loadLconf(const std::string &path, ConfigMap *config, std::string *error);
+
+/**
+ * @brief parseConversion reads _conversion_mode and its parameters:
+ * - linear: factor, offset
+ * - dual_linear: positive_factor, positive_offset, negative_factor,
+ *   negative_offset
+ * - polynomial: coefficients, comma separated from the constant term
+ * - lookup: raw and value, comma separated points
+ * @return false with error set if the mode is unknown or a parameter invalid
+ */
+bool parseConversion(const ConfigMap &config, Conversion *conversion, std::string *error);
+
+}  // namespace sensor_conversion
+
+#endif // SENSOR_CONVERSION_CONVERSION_H
@@ -0,0 +1,111 @@
+#ifndef SENSOR_CONVERSION_CONVERSION_PLAN_H
+#define SENSOR_CONVERSION_CONVERSION_PLAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sensor_conversion/conversion.h"
+
+namespace sensor_conversion {
+
+/**
+ * @brief All sensor conversions of a board compiled into one batch kernel
+ *
+ * A sample is a row of stride() raw values, one per channel plus padding.
+ * convert() turns a batch of rows into floats of the same layout, the
+ * contiguous SENSOR_DATA of the batch. Per row, one vector pass applies
+ * factor and offset to all channels (identity for the others), then the
+ * few non-linear channels are corrected by one kernel per mode with its
+ * parameters in arrays. There is no per-value dispatch or config lookup.
+ */
+class ConversionPlan {
+public:
+    ConversionPlan();
+
+    /**
+     * @brief add appends a sensor, call compile() afterwards
+     * @param components consecutive channels sharing the conversion,
+     * e.g. 3 for the axes of the gyro
+     * @return channel of the first component
+     */
+    int add(const std::string &name, const Conversion &conversion, int components = 1);
+
+    /**
+     * @brief compile builds the kernel parameters of all added sensors
+     */
+    void compile();
+
+    size_t channels() const {
+        return conversions.size();
+    }
+
+    /**
+     * @brief stride values per row, channels() rounded up to the vector width
+     */
+    size_t stride() const {
+        return rowStride;
+    }
+
+    /**
+     * @return first channel of the sensor, -1 if unknown
+     */
+    int channel(const std::string &name) const;
+
+    /**
+     * @brief convert converts a batch of samples
+     * @param raw samples rows of stride() raw values, padding is ignored
+     * @param out samples rows of stride() converted values, may not alias raw
+     */
+    void convert(const int32_t *raw, size_t samples, float *out) const;
+
+    /**
+     * @brief convert converts one value of a channel with the same kernels
+     */
+    float convert(int channel, int32_t raw) const;
+
+private:
+    struct DualLinear {
+        std::vector<uint32_t> columns;
+        std::vector<float> positiveFactor, positiveOffset, negativeFactor, negativeOffset;
+    };
+
+    struct Polynomial {
+        std::vector<uint32_t> columns;
+        size_t terms; //!< coefficients per column, higher ones padded with 0
+        std::vector<float> coefficients; //!< [term][column], highest term first
+    };
+
+    struct Lookup {
+        std::vector<uint32_t> columns;
+        std::vector<uint32_t> first; //!< first segment of each column, one more at the end
+        std::vector<float> start; //!< raw value where each segment starts
+        std::vector<float> slope, intercept; //!< value = slope * raw + intercept
+    };
+
+    /**
+     * @brief correct applies the kernel of a group of non-linear columns to
+     * one row, specialized per group
+     */
+    template<typename Group>
+    static void correct(const Group &group, float *row);
+
+    struct Sensor {
+        std::string name;
+        int channel;
+    };
+
+    std::vector<Sensor> sensors;
+    std::vector<Conversion> conversions; //!< per channel
+    size_t rowStride;
+
+    std::vector<float> factor, offset; //!< per column of the linear pass
+    DualLinear dualLinear;
+    Polynomial polynomial;
+    Lookup lookup;
+};
+
+}  // namespace sensor_conversion
+
+#endif // SENSOR_CONVERSION_CONVERSION_PLAN_H
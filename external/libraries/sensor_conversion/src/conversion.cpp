@@ -0,0 +1,170 @@
+#include "sensor_conversion/conversion.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace sensor_conversion {
+
+namespace {
+
+std::string trim(const std::string &text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if(begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+bool toFloat(const std::string &text, float *value) {
+    std::string trimmed = trim(text);
+    char *end;
+    *value = std::strtof(trimmed.c_str(), &end);
+    return ! trimmed.empty() && *end == '\0';
+}
+
+bool getFloat(const ConfigMap &config, const std::string &key, float fallback, float *value,
+              std::string *error) {
+    auto it = config.find(key);
+    if(it == config.end()) {
+        *value = fallback;
+        return true;
+    }
+    if(! toFloat(it->second, value)) {
+        *error = key + " is not a number: " + it->second;
+        return false;
+    }
+    return true;
+}
+
+bool getList(const ConfigMap &config, const std::string &key, std::vector<float> *values,
+             std::string *error) {
+    values->clear();
+    auto it = config.find(key);
+    if(it == config.end()) {
+        *error = key + " missing";
+        return false;
+    }
+    std::stringstream stream(it->second);
+    std::string item;
+    while(std::getline(stream, item, ',')) {
+        float value;
+        if(! toFloat(item, &value)) {
+            *error = key + " is not a list of numbers: " + it->second;
+            return false;
+        }
+        values->push_back(value);
+    }
+    if(values->empty()) {
+        *error = key + " is empty";
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+float Conversion::apply(float x) const {
+    switch(mode) {
+    case Mode::LINEAR:
+        return x * factor + offset;
+    case Mode::DUAL_LINEAR:
+        return x >= 0 ? x * factor + offset : x * negativeFactor + negativeOffset;
+    case Mode::POLYNOMIAL: {
+        float result = 0;
+        for(size_t i = coefficients.size(); i > 0; i--) {
+            result = result * x + coefficients[i - 1];
+        }
+        return result;
+    }
+    case Mode::LOOKUP:
+        if(x <= raw.front()) {
+            return value.front();
+        }
+        for(size_t i = 1; i < raw.size(); i++) {
+            if(x < raw[i]) {
+                float slope = (value[i] - value[i - 1]) / (raw[i] - raw[i - 1]);
+                return value[i - 1] + (x - raw[i - 1]) * slope;
+            }
+        }
+        return value.back();
+    }
+    return x;
+}
+
+void parseLconf(const std::string &text, ConfigMap *config) {
+    std::stringstream stream(text);
+    std::string line;
+    while(std::getline(stream, line)) {
+        size_t comment = line.find('#');
+        if(comment != std::string::npos) {
+            line.erase(comment);
+        }
+        size_t equals = line.find('=');
+        if(equals == std::string::npos) {
+            continue;
+        }
+        std::string key = trim(line.substr(0, equals));
+        if(! key.empty()) {
+            (*config)[key] = trim(line.substr(equals + 1));
+        }
+    }
+}
+
+bool loadLconf(const std::string &path, ConfigMap *config, std::string *error) {
+    std::ifstream file(path.c_str());
+    if(! file) {
+        *error = "Could not open " + path;
+        return false;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    parseLconf(text.str(), config);
+    return true;
+}
+
+bool parseConversion(const ConfigMap &config, Conversion *conversion, std::string *error) {
+    auto it = config.find("_conversion_mode");
+    std::string mode = it == config.end() ? "linear" : it->second;
+    *conversion = Conversion();
+
+    if(mode == "linear") {
+        conversion->mode = Mode::LINEAR;
+        return getFloat(config, "factor", 1, &conversion->factor, error)
+                && getFloat(config, "offset", 0, &conversion->offset, error);
+    }
+    if(mode == "dual_linear") {
+        conversion->mode = Mode::DUAL_LINEAR;
+        return getFloat(config, "positive_factor", 1, &conversion->factor, error)
+                && getFloat(config, "positive_offset", 0, &conversion->offset, error)
+                && getFloat(config, "negative_factor", 1, &conversion->negativeFactor, error)
+                && getFloat(config, "negative_offset", 0, &conversion->negativeOffset, error);
+    }
+    if(mode == "polynomial") {
+        conversion->mode = Mode::POLYNOMIAL;
+        return getList(config, "coefficients", &conversion->coefficients, error);
+    }
+    if(mode == "lookup") {
+        conversion->mode = Mode::LOOKUP;
+        if(! getList(config, "raw", &conversion->raw, error)
+                || ! getList(config, "value", &conversion->value, error)) {
+            return false;
+        }
+        if(conversion->raw.size() != conversion->value.size()) {
+            *error = "raw and value differ in length";
+            return false;
+        }
+        for(size_t i = 1; i < conversion->raw.size(); i++) {
+            if(conversion->raw[i] <= conversion->raw[i - 1]) {
+                *error = "raw is not ascending";
+                return false;
+            }
+        }
+        return true;
+    }
+    *error = "unknown _conversion_mode " + mode;
+    return false;
+}
+
+}  // namespace sensor_conversion
@@ -0,0 +1,190 @@
+#include "sensor_conversion/conversion_plan.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace sensor_conversion {
+
+namespace {
+
+/**
+ * @brief Values per vector of the linear pass, SSE2 or NEON
+ */
+const size_t WIDTH = 4;
+
+#if defined(__GNUC__)
+typedef float Floats __attribute__((vector_size(16)));
+typedef int32_t Ints __attribute__((vector_size(16)));
+#endif
+
+}  // namespace
+
+ConversionPlan::ConversionPlan() : rowStride(WIDTH) {
+    polynomial.terms = 0;
+}
+
+int ConversionPlan::add(const std::string &name, const Conversion &conversion, int components) {
+    int channel = static_cast<int>(conversions.size());
+    sensors.push_back(Sensor{name, channel});
+    for(int i = 0; i < components; i++) {
+        conversions.push_back(conversion);
+    }
+    return channel;
+}
+
+int ConversionPlan::channel(const std::string &name) const {
+    for(const Sensor &sensor : sensors) {
+        if(sensor.name == name) {
+            return sensor.channel;
+        }
+    }
+    return -1;
+}
+
+void ConversionPlan::compile() {
+    rowStride = std::max(WIDTH, (conversions.size() + WIDTH - 1) / WIDTH * WIDTH);
+    factor.assign(rowStride, 0);
+    offset.assign(rowStride, 0);
+    dualLinear = DualLinear();
+    polynomial = Polynomial();
+    polynomial.terms = 0;
+    lookup = Lookup();
+
+    for(size_t c = 0; c < conversions.size(); c++) {
+        const Conversion &conversion = conversions[c];
+        uint32_t column = static_cast<uint32_t>(c);
+        // non-linear columns leave the linear pass unchanged
+        factor[c] = conversion.mode == Mode::LINEAR ? conversion.factor : 1;
+        offset[c] = conversion.mode == Mode::LINEAR ? conversion.offset : 0;
+
+        switch(conversion.mode) {
+        case Mode::LINEAR:
+            break;
+        case Mode::DUAL_LINEAR:
+            dualLinear.columns.push_back(column);
+            dualLinear.positiveFactor.push_back(conversion.factor);
+            dualLinear.positiveOffset.push_back(conversion.offset);
+            dualLinear.negativeFactor.push_back(conversion.negativeFactor);
+            dualLinear.negativeOffset.push_back(conversion.negativeOffset);
+            break;
+        case Mode::POLYNOMIAL:
+            polynomial.columns.push_back(column);
+            polynomial.terms = std::max(polynomial.terms, conversion.coefficients.size());
+            break;
+        case Mode::LOOKUP: {
+            lookup.columns.push_back(column);
+            lookup.first.push_back(static_cast<uint32_t>(lookup.start.size()));
+            const std::vector<float> &raw = conversion.raw;
+            const std::vector<float> &value = conversion.value;
+            // constant below the first and above the last point
+            lookup.start.push_back(-std::numeric_limits<float>::infinity());
+            lookup.slope.push_back(0);
+            lookup.intercept.push_back(value.front());
+            for(size_t i = 0; i + 1 < raw.size(); i++) {
+                float slope = (value[i + 1] - value[i]) / (raw[i + 1] - raw[i]);
+                lookup.start.push_back(raw[i]);
+                lookup.slope.push_back(slope);
+                lookup.intercept.push_back(value[i] - slope * raw[i]);
+            }
+            lookup.start.push_back(raw.back());
+            lookup.slope.push_back(0);
+            lookup.intercept.push_back(value.back());
+            break;
+        }
+        }
+    }
+    lookup.first.push_back(static_cast<uint32_t>(lookup.start.size()));
+
+    size_t columns = polynomial.columns.size();
+    polynomial.coefficients.assign(polynomial.terms * columns, 0);
+    for(size_t k = 0; k < columns; k++) {
+        const std::vector<float> &c = conversions[polynomial.columns[k]].coefficients;
+        for(size_t i = 0; i < c.size(); i++) {
+            polynomial.coefficients[(polynomial.terms - 1 - i) * columns + k] = c[i];
+        }
+    }
+}
+
+template<>
+void ConversionPlan::correct(const DualLinear &group, float *row) {
+    for(size_t k = 0; k < group.columns.size(); k++) {
+        float x = row[group.columns[k]];
+        float positive = x * group.positiveFactor[k] + group.positiveOffset[k];
+        float negative = x * group.negativeFactor[k] + group.negativeOffset[k];
+        row[group.columns[k]] = x >= 0 ? positive : negative;
+    }
+}
+
+template<>
+void ConversionPlan::correct(const Polynomial &group, float *row) {
+    size_t columns = group.columns.size();
+    for(size_t k = 0; k < columns; k++) {
+        float x = row[group.columns[k]];
+        // Horner, the padded higher terms are 0
+        float result = group.coefficients[k];
+        for(size_t t = 1; t < group.terms; t++) {
+            result = result * x + group.coefficients[t * columns + k];
+        }
+        row[group.columns[k]] = result;
+    }
+}
+
+template<>
+void ConversionPlan::correct(const Lookup &group, float *row) {
+    for(size_t k = 0; k < group.columns.size(); k++) {
+        float x = row[group.columns[k]];
+        // tables are short, counting the passed segment starts has no
+        // unpredictable branch
+        uint32_t segment = group.first[k];
+        for(uint32_t i = group.first[k] + 1; i < group.first[k + 1]; i++) {
+            segment += x >= group.start[i];
+        }
+        row[group.columns[k]] = group.slope[segment] * x + group.intercept[segment];
+    }
+}
+
+void ConversionPlan::convert(const int32_t *raw, size_t samples, float *out) const {
+    const size_t stride = rowStride;
+    for(size_t s = 0; s < samples; s++) {
+        const int32_t *in = raw + s * stride;
+        float *row = out + s * stride;
+
+        // factor and offset of all channels, one vector at a time
+        for(size_t c = 0; c < stride; c += WIDTH) {
+#if defined(__GNUC__)
+            Ints values;
+            Floats f, o;
+            std::memcpy(&values, in + c, sizeof(values));
+            std::memcpy(&f, &factor[c], sizeof(f));
+            std::memcpy(&o, &offset[c], sizeof(o));
+            Floats result = __builtin_convertvector(values, Floats) * f + o;
+            std::memcpy(row + c, &result, sizeof(result));
+#else
+            for(size_t i = c; i < c + WIDTH; i++) {
+                row[i] = in[i] * factor[i] + offset[i];
+            }
+#endif
+        }
+
+        if(! dualLinear.columns.empty()) {
+            correct(dualLinear, row);
+        }
+        if(! polynomial.columns.empty()) {
+            correct(polynomial, row);
+        }
+        if(! lookup.columns.empty()) {
+            correct(lookup, row);
+        }
+    }
+}
+
+float ConversionPlan::convert(int channel, int32_t raw) const {
+    std::vector<int32_t> in(rowStride, 0);
+    std::vector<float> out(rowStride);
+    in[channel] = raw;
+    convert(in.data(), 1, out.data());
+    return out[channel];
+}
+
+}  // namespace sensor_conversion
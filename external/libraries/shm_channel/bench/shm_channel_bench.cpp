@@ -0,0 +1,269 @@
+/**
+ * Ping-pong between two processes through shm_channel and through TCP on
+ * localhost, the transport of socket_data. Both ends read every byte of the
+ * message like a deserializer would.
+ *
+ * Usage: shm_channel_bench [--count N] [--size BYTES]
+ *
+ * --count   round trips per measurement, default 2000
+ * --size    message size, default: 16 KiB (IMAGE of car.xml) and 257 KiB
+ *           (752x350 CAMERA_IMAGE)
+ */
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "shm_channel/channel.h"
+
+using namespace shm_channel;
+
+namespace {
+
+const int TIMEOUT_MILLIS = 1000;
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double cpuMicros(int who) {
+    rusage usage;
+    getrusage(who, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6
+            + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+uint32_t checksum(const uint8_t *data, size_t size) {
+    uint32_t sum = 0;
+    for(size_t i = 0; i < size; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+struct Result {
+    double p50; //!< one way latency [us]
+    double p99;
+    double cpu; //!< CPU time of both processes per message [us]
+};
+
+void print(const char *name, size_t size, const Result &result) {
+    std::printf("%-4s %7zu bytes  one way p50 %7.1f  p99 %7.1f us  cpu per message %6.1f us\n",
+                name, size, result.p50, result.p99, result.cpu);
+}
+
+Result evaluate(std::vector<int64_t> &roundTrips, double cpu) {
+    std::sort(roundTrips.begin(), roundTrips.end());
+    Result result;
+    result.p50 = roundTrips[roundTrips.size() / 2] / 2000.0;
+    result.p99 = roundTrips[std::min(roundTrips.size() - 1, roundTrips.size() * 99 / 100)] / 2000.0;
+    result.cpu = cpu / (2.0 * roundTrips.size());
+    return result;
+}
+
+/**
+ * @brief shm: ping on one channel, pong on another
+ */
+bool pingPongShm(int count, size_t size, Result *result) {
+    std::string error;
+    const std::string ping = "shm_channel_bench_ping";
+    const std::string pong = "shm_channel_bench_pong";
+    // both segments exist before the fork, the child inherits the mappings
+    Writer writer;
+    Writer reply;
+    Reader in;
+    Reader childIn;
+    if(! writer.open(ping, size, 4, &error) || ! reply.open(pong, size, 4, &error)
+            || ! in.open(pong, &error) || ! childIn.open(ping, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return false;
+    }
+
+    double cpuBefore = cpuMicros(RUSAGE_SELF) + cpuMicros(RUSAGE_CHILDREN);
+    pid_t child = fork();
+    if(child == 0) {
+        for(int i = 0; i < count; i++) {
+            const uint8_t *data;
+            uint32_t length;
+            while(! childIn.acquire(&data, &length)) {
+                if(! childIn.wait(TIMEOUT_MILLIS)) {
+                    _exit(2);
+                }
+            }
+            uint32_t sum = checksum(data, length);
+            childIn.release();
+            uint8_t *slot = reply.begin();
+            std::memcpy(slot, &sum, sizeof(sum));
+            reply.commit(size);
+        }
+        _exit(0);
+    }
+
+    std::vector<int64_t> roundTrips;
+    bool ok = true;
+    for(int i = 0; i < count && ok; i++) {
+        int64_t start = nowNanos();
+        uint8_t *slot = writer.begin();
+        std::memset(slot, i, size);
+        writer.commit(size);
+
+        const uint8_t *data;
+        uint32_t length;
+        while(ok && ! in.acquire(&data, &length)) {
+            ok = in.wait(TIMEOUT_MILLIS);
+        }
+        if(ok) {
+            checksum(data, length);
+            in.release();
+            roundTrips.push_back(nowNanos() - start);
+        }
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if(ok) {
+        *result = evaluate(roundTrips, cpuMicros(RUSAGE_SELF) + cpuMicros(RUSAGE_CHILDREN) - cpuBefore);
+    }
+    return ok;
+}
+
+bool sendAll(int fd, const uint8_t *data, size_t size) {
+    while(size > 0) {
+        ssize_t sent = send(fd, data, size, 0);
+        if(sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+bool receiveAll(int fd, uint8_t *data, size_t size) {
+    while(size > 0) {
+        ssize_t received = recv(fd, data, size, 0);
+        if(received <= 0) {
+            return false;
+        }
+        data += received;
+        size -= received;
+    }
+    return true;
+}
+
+/**
+ * @brief TCP: length prefixed messages over one localhost connection
+ */
+bool pingPongTcp(int count, size_t size, Result *result) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if(bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || listen(listener, 1) != 0
+            || getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        std::perror("listen");
+        return false;
+    }
+
+    double cpuBefore = cpuMicros(RUSAGE_SELF) + cpuMicros(RUSAGE_CHILDREN);
+    pid_t child = fork();
+    if(child == 0) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            _exit(1);
+        }
+        std::vector<uint8_t> buffer(size);
+        for(int i = 0; i < count; i++) {
+            uint32_t bytes;
+            if(! receiveAll(fd, reinterpret_cast<uint8_t*>(&bytes), sizeof(bytes))
+                    || ! receiveAll(fd, buffer.data(), bytes)) {
+                _exit(2);
+            }
+            uint32_t sum = checksum(buffer.data(), bytes);
+            std::memcpy(buffer.data(), &sum, sizeof(sum));
+            if(! sendAll(fd, reinterpret_cast<uint8_t*>(&bytes), sizeof(bytes))
+                    || ! sendAll(fd, buffer.data(), bytes)) {
+                _exit(3);
+            }
+        }
+        _exit(0);
+    }
+
+    int fd = accept(listener, nullptr, nullptr);
+    close(listener);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    std::vector<uint8_t> buffer(size);
+    std::vector<int64_t> roundTrips;
+    bool ok = fd >= 0;
+    for(int i = 0; i < count && ok; i++) {
+        int64_t start = nowNanos();
+        std::memset(buffer.data(), i, size);
+        uint32_t bytes = size;
+        ok = sendAll(fd, reinterpret_cast<uint8_t*>(&bytes), sizeof(bytes))
+                && sendAll(fd, buffer.data(), size)
+                && receiveAll(fd, reinterpret_cast<uint8_t*>(&bytes), sizeof(bytes))
+                && receiveAll(fd, buffer.data(), bytes);
+        if(ok) {
+            checksum(buffer.data(), bytes);
+            roundTrips.push_back(nowNanos() - start);
+        }
+    }
+    close(fd);
+    int status = 0;
+    waitpid(child, &status, 0);
+    ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if(ok) {
+        *result = evaluate(roundTrips, cpuMicros(RUSAGE_SELF) + cpuMicros(RUSAGE_CHILDREN) - cpuBefore);
+    }
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    int count = 2000;
+    std::vector<size_t> sizes = {188 * 87, 752 * 350};
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if(arg == "--count") {
+            count = std::atoi(argv[i + 1]);
+        } else if(arg == "--size") {
+            sizes = {static_cast<size_t>(std::atol(argv[i + 1]))};
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    for(size_t size : sizes) {
+        Result result;
+        if(! pingPongShm(count, size, &result)) {
+            std::fprintf(stderr, "shm ping-pong failed\n");
+            return 1;
+        }
+        print("shm", size, result);
+        if(! pingPongTcp(count, size, &result)) {
+            std::fprintf(stderr, "tcp ping-pong failed\n");
+            return 1;
+        }
+        print("tcp", size, result);
+    }
+    return 0;
+}
@@ -0,0 +1,145 @@
+#ifndef SHM_CHANNEL_CHANNEL_H
+#define SHM_CHANNEL_CHANNEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace shm_channel {
+
+struct Header;
+struct Slot;
+
+/**
+ * @brief Writing end of a channel: creates the shared memory segment
+ * /dev/shm/<name> with a ring of fixed size slots
+ *
+ * A message is written in place: begin() hands out a free slot, commit()
+ * publishes it as the newest message and wakes waiting readers. The writer
+ * never waits for readers. It reuses the oldest slot no reader holds, so a
+ * slow reader misses messages but never sees a torn one.
+ */
+class Writer {
+public:
+    Writer();
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    /**
+     * @brief open creates the segment, replacing a stale one of a previous
+     * writer; readers of the old one reopen
+     * @param slots at least 3: the newest message, one being written and one
+     * per reader holding a message, at most 255
+     */
+    bool open(const std::string &name, uint32_t slotSize, uint32_t slots, std::string *error);
+
+    /**
+     * @brief close marks the segment closed and removes it
+     */
+    void close();
+
+    bool isOpen() const {
+        return header != nullptr;
+    }
+
+    /**
+     * @brief begin takes a free slot to write the next message into
+     * @return nullptr if every slot is held by a reader
+     */
+    uint8_t* begin();
+
+    /**
+     * @brief capacity bytes a message may have
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief commit publishes the slot of begin() with length bytes
+     */
+    void commit(uint32_t length);
+
+    /**
+     * @brief abort returns the slot of begin() without publishing
+     */
+    void abort();
+
+    uint64_t published() const {
+        return sequence;
+    }
+
+private:
+    Slot* slot(uint32_t index) const;
+
+    std::string path;
+    Header *header;
+    size_t size;
+    uint64_t sequence; //!< of the last published message
+    int current; //!< slot between begin() and commit(), -1 for none
+    uint64_t currentSequence; //!< value the current slot had before begin()
+    uint32_t next; //!< where begin() starts looking for a free slot
+};
+
+/**
+ * @brief Reading end of a channel, any number per channel
+ *
+ * Readers get the newest message, like a data channel holds only the newest
+ * value. The message stays in shared memory and is not copied; the writer
+ * leaves the slot alone until release().
+ */
+class Reader {
+public:
+    Reader();
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    /**
+     * @brief open maps the segment of a writer
+     * @return false if no writer created it yet
+     */
+    bool open(const std::string &name, std::string *error);
+    void close();
+
+    /**
+     * @brief isOpen false after close() and once the writer closed the segment
+     */
+    bool isOpen();
+
+    /**
+     * @brief wait blocks until there is a message newer than the last
+     * acquired one, without polling
+     * @return false on timeout or if the writer closed the segment
+     */
+    bool wait(int timeoutMillis);
+
+    /**
+     * @brief acquire holds the newest message until release()
+     * @return false if there is none newer than the last acquired one
+     */
+    bool acquire(const uint8_t **data, uint32_t *length);
+    void release();
+
+    /**
+     * @brief missed messages overwritten by newer ones before they were
+     * acquired
+     */
+    uint64_t missed() const {
+        return missedCount;
+    }
+
+private:
+    bool newer() const;
+
+    Header *header;
+    size_t size;
+    uint64_t lastSequence;
+    int held; //!< slot between acquire() and release(), -1 for none
+    uint64_t missedCount;
+};
+
+}  // namespace shm_channel
+
+#endif // SHM_CHANNEL_CHANNEL_H
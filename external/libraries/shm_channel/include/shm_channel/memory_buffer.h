@@ -0,0 +1,41 @@
+#ifndef SHM_CHANNEL_MEMORY_BUFFER_H
+#define SHM_CHANNEL_MEMORY_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <streambuf>
+
+namespace shm_channel {
+
+/**
+ * @brief std::streambuf over a fixed piece of memory, lets the channel
+ * serialization of LMS read and write slots in place
+ *
+ * Writing past the end fails the stream instead of allocating.
+ */
+class MemoryBuffer : public std::streambuf {
+public:
+    MemoryBuffer(uint8_t *data, size_t size) {
+        char *begin = reinterpret_cast<char*>(data);
+        setp(begin, begin + size);
+        setg(begin, begin, begin + size);
+    }
+
+    MemoryBuffer(const uint8_t *data, size_t size) {
+        // the get area is only read
+        char *begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+        setp(begin, begin);
+        setg(begin, begin, begin + size);
+    }
+
+    /**
+     * @brief written bytes put into the buffer
+     */
+    size_t written() const {
+        return static_cast<size_t>(pptr() - pbase());
+    }
+};
+
+}  // namespace shm_channel
+
+#endif // SHM_CHANNEL_MEMORY_BUFFER_H
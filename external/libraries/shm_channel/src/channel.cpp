@@ -0,0 +1,372 @@
+#include "shm_channel/channel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace shm_channel {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "the atomics are shared between processes, they must not use locks");
+
+namespace {
+
+const char MAGIC[4] = {'L', 'S', 'H', 'M'};
+const uint32_t VERSION = 1;
+const size_t ALIGNMENT = 64;
+const uint32_t MAX_SLOTS = 255;
+
+/**
+ * @brief Slot sequence while the writer fills it, published sequences start at 1
+ */
+const uint64_t WRITING = 0;
+
+size_t align(size_t value) {
+    return (value + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+long futex(std::atomic<uint32_t> *word, int operation, uint32_t value, const timespec *timeout) {
+    // not FUTEX_PRIVATE_FLAG, the word is shared with other processes
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), operation, value, timeout, nullptr, 0);
+}
+
+}  // namespace
+
+struct Header {
+    char magic[4]; //!< set last, a reader may map the segment while it is initialized
+    uint32_t version;
+    uint32_t slotSize;
+    uint32_t slotCount;
+    std::atomic<uint32_t> closed;
+    std::atomic<uint32_t> wakeups; //!< futex word, incremented per message
+    std::atomic<uint32_t> waiters; //!< readers in wait(), commit() skips the syscall if none
+    std::atomic<uint64_t> latest; //!< sequence << 8 | slot of the newest message, 0 for none
+};
+
+struct Slot {
+    std::atomic<uint64_t> sequence; //!< of the message in the slot, WRITING while written
+    std::atomic<uint32_t> readers; //!< readers holding the slot
+    uint32_t length;
+};
+
+namespace {
+
+size_t slotStride(uint32_t slotSize) {
+    return align(sizeof(Slot)) + align(slotSize);
+}
+
+size_t segmentSize(uint32_t slotSize, uint32_t slots) {
+    return align(sizeof(Header)) + slotStride(slotSize) * slots;
+}
+
+Slot* slotAt(Header *header, uint32_t index) {
+    uint8_t *base = reinterpret_cast<uint8_t*>(header) + align(sizeof(Header));
+    return reinterpret_cast<Slot*>(base + slotStride(header->slotSize) * index);
+}
+
+uint8_t* slotData(Slot *slot) {
+    return reinterpret_cast<uint8_t*>(slot) + align(sizeof(Slot));
+}
+
+std::string segmentPath(const std::string &name) {
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+std::string systemError(const std::string &what) {
+    return what + ": " + std::strerror(errno);
+}
+
+/**
+ * @brief markClosed tells the readers of an existing segment to reopen
+ */
+void markClosed(const std::string &path) {
+    int fd = shm_open(path.c_str(), O_RDWR, 0);
+    if(fd < 0) {
+        return;
+    }
+    struct stat info;
+    if(fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(Header)) {
+        void *memory = mmap(nullptr, sizeof(Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(memory != MAP_FAILED) {
+            Header *header = static_cast<Header*>(memory);
+            header->closed = 1;
+            futex(&header->wakeups, FUTEX_WAKE, INT_MAX, nullptr);
+            munmap(memory, sizeof(Header));
+        }
+    }
+    ::close(fd);
+}
+
+}  // namespace
+
+Writer::Writer() : header(nullptr), size(0), sequence(0), current(-1), currentSequence(0), next(0) {
+}
+
+Writer::~Writer() {
+    close();
+}
+
+bool Writer::open(const std::string &name, uint32_t slotSize, uint32_t slots, std::string *error) {
+    close();
+    if(slots < 3 || slots > MAX_SLOTS || slotSize == 0) {
+        *error = "slots must be 3 to 255, slotSize above 0";
+        return false;
+    }
+
+    path = segmentPath(name);
+    markClosed(path);
+    shm_unlink(path.c_str());
+
+    int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd < 0) {
+        *error = systemError("shm_open " + path);
+        return false;
+    }
+    size_t bytes = segmentSize(slotSize, slots);
+    if(ftruncate(fd, bytes) != 0) {
+        *error = systemError("ftruncate " + path);
+        ::close(fd);
+        shm_unlink(path.c_str());
+        return false;
+    }
+    void *memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if(memory == MAP_FAILED) {
+        *error = systemError("mmap " + path);
+        shm_unlink(path.c_str());
+        return false;
+    }
+
+    // ftruncate zeroed the segment: no messages, all slots free
+    header = static_cast<Header*>(memory);
+    size = bytes;
+    header->version = VERSION;
+    header->slotSize = slotSize;
+    header->slotCount = slots;
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+
+    sequence = 0;
+    current = -1;
+    next = 0;
+    return true;
+}
+
+void Writer::close() {
+    if(header == nullptr) {
+        return;
+    }
+    abort();
+    header->closed = 1;
+    futex(&header->wakeups, FUTEX_WAKE, INT_MAX, nullptr);
+    munmap(header, size);
+    shm_unlink(path.c_str());
+    header = nullptr;
+}
+
+Slot* Writer::slot(uint32_t index) const {
+    return slotAt(header, index);
+}
+
+uint8_t* Writer::begin() {
+    if(header == nullptr) {
+        return nullptr;
+    }
+    abort();
+
+    uint32_t latestSlot = static_cast<uint32_t>(header->latest.load() & 0xFF);
+    for(uint32_t i = 0; i < header->slotCount; i++) {
+        uint32_t index = (next + i) % header->slotCount;
+        if(sequence != 0 && index == latestSlot) {
+            continue;
+        }
+        Slot *candidate = slot(index);
+        // mark first, then look for readers; a reader increments first, then
+        // checks the mark, so one of both sees the other
+        uint64_t previous = candidate->sequence.exchange(WRITING);
+        if(candidate->readers.load() != 0) {
+            candidate->sequence.store(previous);
+            continue;
+        }
+        current = static_cast<int>(index);
+        currentSequence = previous;
+        next = (index + 1) % header->slotCount;
+        return slotData(candidate);
+    }
+    return nullptr;
+}
+
+size_t Writer::capacity() const {
+    return header != nullptr ? header->slotSize : 0;
+}
+
+void Writer::commit(uint32_t length) {
+    if(current < 0) {
+        return;
+    }
+    Slot *written = slot(current);
+    written->length = length;
+    sequence++;
+    written->sequence.store(sequence, std::memory_order_release);
+    header->latest.store(sequence << 8 | static_cast<uint64_t>(current));
+    current = -1;
+
+    header->wakeups.fetch_add(1);
+    if(header->waiters.load() != 0) {
+        futex(&header->wakeups, FUTEX_WAKE, INT_MAX, nullptr);
+    }
+}
+
+void Writer::abort() {
+    if(current < 0) {
+        return;
+    }
+    // no reader can hold an old message of the slot while it is WRITING
+    slot(current)->sequence.store(currentSequence);
+    current = -1;
+}
+
+Reader::Reader() : header(nullptr), size(0), lastSequence(0), held(-1), missedCount(0) {
+}
+
+Reader::~Reader() {
+    close();
+}
+
+bool Reader::open(const std::string &name, std::string *error) {
+    close();
+    std::string path = segmentPath(name);
+    int fd = shm_open(path.c_str(), O_RDWR, 0);
+    if(fd < 0) {
+        *error = systemError("shm_open " + path);
+        return false;
+    }
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+        *error = "segment " + path + " is not initialized yet";
+        ::close(fd);
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(info.st_size);
+    void *memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(memory == MAP_FAILED) {
+        *error = systemError("mmap " + path);
+        return false;
+    }
+
+    Header *mapped = static_cast<Header*>(memory);
+    bool valid = std::memcmp(mapped->magic, MAGIC, sizeof(MAGIC)) == 0;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(! valid || mapped->version != VERSION
+            || mapped->slotCount == 0 || mapped->slotCount > MAX_SLOTS
+            || segmentSize(mapped->slotSize, mapped->slotCount) > bytes) {
+        *error = "segment " + path + " is not initialized or of another version";
+        munmap(memory, bytes);
+        return false;
+    }
+
+    header = mapped;
+    size = bytes;
+    lastSequence = 0;
+    held = -1;
+    return true;
+}
+
+void Reader::close() {
+    if(header == nullptr) {
+        return;
+    }
+    release();
+    munmap(header, size);
+    header = nullptr;
+}
+
+bool Reader::isOpen() {
+    if(header != nullptr && header->closed.load() != 0) {
+        close();
+    }
+    return header != nullptr;
+}
+
+bool Reader::newer() const {
+    return (header->latest.load() >> 8) != lastSequence;
+}
+
+bool Reader::wait(int timeoutMillis) {
+    if(! isOpen()) {
+        return false;
+    }
+    if(newer()) {
+        return true;
+    }
+
+    timespec timeout;
+    timeout.tv_sec = timeoutMillis / 1000;
+    timeout.tv_nsec = (timeoutMillis % 1000) * 1000000L;
+    // registered as waiter before the last check, commit() either sees the
+    // waiter or this sees the message
+    header->waiters.fetch_add(1);
+    uint32_t wakeups = header->wakeups.load();
+    if(! newer() && header->closed.load() == 0) {
+        futex(&header->wakeups, FUTEX_WAIT, wakeups, &timeout);
+    }
+    header->waiters.fetch_sub(1);
+    return isOpen() && newer();
+}
+
+bool Reader::acquire(const uint8_t **data, uint32_t *length) {
+    if(! isOpen()) {
+        return false;
+    }
+    release();
+
+    for(;;) {
+        uint64_t latest = header->latest.load();
+        uint64_t sequence = latest >> 8;
+        if(sequence == 0 || sequence == lastSequence) {
+            return false;
+        }
+        uint32_t index = static_cast<uint32_t>(latest & 0xFF);
+        if(index >= header->slotCount) {
+            return false;
+        }
+
+        Slot *slot = slotAt(header, index);
+        slot->readers.fetch_add(1);
+        if(slot->sequence.load() != sequence) {
+            // the writer took the slot for a newer message meanwhile
+            slot->readers.fetch_sub(1);
+            continue;
+        }
+
+        if(lastSequence != 0 && sequence > lastSequence + 1) {
+            missedCount += sequence - lastSequence - 1;
+        }
+        lastSequence = sequence;
+        held = static_cast<int>(index);
+        *data = slotData(slot);
+        *length = std::min(slot->length, header->slotSize);
+        return true;
+    }
+}
+
+void Reader::release() {
+    if(held < 0) {
+        return;
+    }
+    slotAt(header, held)->readers.fetch_sub(1);
+    held = -1;
+}
+
+}  // namespace shm_channel
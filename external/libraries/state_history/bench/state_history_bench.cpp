@@ -0,0 +1,132 @@
+/**
+ * Allocations and time per cycle of keeping the recent control states of
+ * two sources: states with a name string in a std::deque trimmed to the
+ * history length, against a CarHistory with interned source names. Then
+ * the cost of looking up a state by time and by source in both.
+ *
+ * Usage: state_history_bench [--cycles N] [--history N]
+ *
+ * --cycles   cycles per variant, default 1000000
+ * --history  states kept, default 256
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+
+#include "state_history/allocations.h"
+#include "state_history/state_history.h"
+
+using namespace state_history;
+
+namespace {
+
+/**
+ * @brief Like sensor_utils::Car::State
+ */
+struct NamedState {
+    std::string name;
+    int64_t timestamp;
+    float steering_front;
+    float steering_rear;
+    float targetSpeed;
+};
+
+// names of the modules putting states in pc_gamepad.xml
+const char *KEYBOARD = "keyboard";
+const char *GAMEPAD = "gamepad_car_controller";
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void print(const char *name, int64_t nanos, uint64_t allocations, int cycles) {
+    std::printf("%-26s %7.1f ns  %5.2f allocations per cycle\n", name,
+                static_cast<double>(nanos) / cycles, static_cast<double>(allocations) / cycles);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    int cycles = 1000000;
+    size_t history = 256;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if(arg == "--cycles") {
+            cycles = std::atoi(argv[i + 1]);
+        } else if(arg == "--history") {
+            history = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if(! counting()) {
+        std::printf("allocation counter not active (release build?)\n");
+    }
+
+    // a fresh state with its name per cycle, the oldest dropped
+    std::deque<NamedState> named;
+    AllocationScope namedAllocations;
+    int64_t start = nowNanos();
+    for(int i = 0; i < cycles; i++) {
+        NamedState state;
+        state.name = i % 2 == 0 ? KEYBOARD : GAMEPAD;
+        state.timestamp = i * int64_t(5000);
+        state.steering_front = i * 0.001f;
+        state.steering_rear = -state.steering_front;
+        state.targetSpeed = 1;
+        named.push_back(state);
+        if(named.size() > history) {
+            named.pop_front();
+        }
+    }
+    print("std::string name, deque", nowNanos() - start, namedAllocations.count(), cycles);
+
+    SourceId keyboard = intern(KEYBOARD);
+    SourceId gamepad = intern(GAMEPAD);
+    CarHistory ring(history);
+    AllocationScope ringAllocations;
+    start = nowNanos();
+    for(int i = 0; i < cycles; i++) {
+        CarState &state = ring.push(i * int64_t(5000), i % 2 == 0 ? keyboard : gamepad);
+        state.steeringFront = i * 0.001f;
+        state.steeringRear = -state.steeringFront;
+        state.targetSpeed = 1;
+    }
+    print("interned source, ring", nowNanos() - start, ringAllocations.count(), cycles);
+
+    // newest state of a source and the state at a time in the history
+    const int LOOKUPS = 100000;
+    int64_t newest = (cycles - 1) * int64_t(5000);
+    double sum = 0;
+    start = nowNanos();
+    for(int i = 0; i < LOOKUPS; i++) {
+        for(auto it = named.rbegin(); it != named.rend(); ++it) {
+            if(it->name == KEYBOARD) {
+                sum += it->steering_front;
+                break;
+            }
+        }
+        int64_t time = newest - static_cast<int64_t>(i % history) * 5000;
+        for(auto it = named.rbegin(); it != named.rend(); ++it) {
+            if(it->timestamp <= time) {
+                sum += it->steering_front;
+                break;
+            }
+        }
+    }
+    int64_t namedLookup = nowNanos() - start;
+    start = nowNanos();
+    for(int i = 0; i < LOOKUPS; i++) {
+        sum -= ring.latest(keyboard)->steeringFront;
+        sum -= ring.at(newest - static_cast<int64_t>(i % history) * 5000)->steeringFront;
+    }
+    int64_t ringLookup = nowNanos() - start;
+    std::printf("lookup by source and time: deque %.1f ns, ring %.1f ns%s\n",
+                static_cast<double>(namedLookup) / LOOKUPS, static_cast<double>(ringLookup) / LOOKUPS,
+                sum == 0 ? "" : " (results differ!)");
+    return sum == 0 ? 0 : 1;
+}
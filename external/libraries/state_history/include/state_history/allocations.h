@@ -0,0 +1,41 @@
+#ifndef STATE_HISTORY_ALLOCATIONS_H
+#define STATE_HISTORY_ALLOCATIONS_H
+
+#include <cstdint>
+
+namespace state_history {
+
+/**
+ * @brief allocations counts operator new calls of the calling thread
+ *
+ * Counted by liballocation_counter.so, started with
+ * LD_PRELOAD=liballocation_counter.so, or linked into the executable.
+ * @return 0 without the counter or in release builds (NDEBUG)
+ */
+uint64_t allocations();
+
+/**
+ * @brief counting false if allocations() always returns 0
+ */
+bool counting();
+
+/**
+ * @brief Allocations of the calling thread since construction, e.g. of
+ * one cycle
+ */
+class AllocationScope {
+public:
+    AllocationScope() : begin(allocations()) {
+    }
+
+    uint64_t count() const {
+        return allocations() - begin;
+    }
+
+private:
+    uint64_t begin;
+};
+
+}  // namespace state_history
+
+#endif // STATE_HISTORY_ALLOCATIONS_H
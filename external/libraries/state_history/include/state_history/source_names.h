@@ -0,0 +1,35 @@
+#ifndef STATE_HISTORY_SOURCE_NAMES_H
+#define STATE_HISTORY_SOURCE_NAMES_H
+
+#include <cstdint>
+#include <string>
+
+namespace state_history {
+
+/**
+ * @brief Interned name of the module or device a state comes from
+ */
+typedef uint16_t SourceId;
+
+/**
+ * @brief MAX_SOURCES names can be interned per process
+ */
+const SourceId MAX_SOURCES = 256;
+
+/**
+ * @brief intern returns the id of a name, the same for every call with
+ * that name in the process. Allocates the first time a name is seen, call
+ * it in initialize(), not per cycle.
+ * @return MAX_SOURCES if the table is full
+ */
+SourceId intern(const std::string &name);
+
+/**
+ * @brief sourceName of an interned id, valid until the process ends
+ * @return "" for an unknown id
+ */
+const char* sourceName(SourceId id);
+
+}  // namespace state_history
+
+#endif // STATE_HISTORY_SOURCE_NAMES_H
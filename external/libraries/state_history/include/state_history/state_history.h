@@ -0,0 +1,138 @@
+#ifndef STATE_HISTORY_STATE_HISTORY_H
+#define STATE_HISTORY_STATE_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "state_history/source_names.h"
+
+namespace state_history {
+
+/**
+ * @brief Control state of a car or the camera tower, the fields of
+ * sensor_utils::Car::State without the name string
+ */
+struct CarState {
+    int64_t timestamp; //!< [us]
+    SourceId source;
+    float steeringFront; //!< [rad]
+    float steeringRear; //!< [rad]
+    float targetSpeed; //!< [m/s]
+};
+
+/**
+ * @brief Fixed number of the newest states, allocated once
+ *
+ * push() hands out the oldest slot to fill in place, so the steady state
+ * neither allocates nor copies. Queries return pointers into the ring,
+ * valid until capacity() more states were pushed. Like a data channel it
+ * is used by one thread at a time.
+ *
+ * State needs the members timestamp (int64_t) and source (SourceId).
+ * Timestamps must not decrease, an older one is raised to the newest.
+ */
+template<typename State>
+class StateHistory {
+public:
+    explicit StateHistory(size_t capacity = 256)
+        : slots(capacity == 0 ? 1 : capacity), count(0), newestBySource(MAX_SOURCES, 0) {
+    }
+
+    /**
+     * @brief push returns the slot of a new state with timestamp and source
+     * set, the other fields still hold the state it replaces
+     */
+    State& push(int64_t timestamp, SourceId source) {
+        if(count > 0 && timestamp < newest().timestamp) {
+            timestamp = newest().timestamp;
+        }
+        State &state = slots[count % slots.size()];
+        state.timestamp = timestamp;
+        state.source = source;
+        count++;
+        if(source < MAX_SOURCES) {
+            newestBySource[source] = count;
+        }
+        return state;
+    }
+
+    size_t size() const {
+        return count < slots.size() ? static_cast<size_t>(count) : slots.size();
+    }
+
+    size_t capacity() const {
+        return slots.size();
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    /**
+     * @brief pushed number of states pushed since construction
+     */
+    uint64_t pushed() const {
+        return count;
+    }
+
+    /**
+     * @brief age 0 is the newest state, size() - 1 the oldest
+     */
+    const State& operator[](size_t age) const {
+        return slots[(count - 1 - age) % slots.size()];
+    }
+
+    const State& newest() const {
+        return (*this)[0];
+    }
+
+    /**
+     * @return nullptr if empty
+     */
+    const State* latest() const {
+        return count == 0 ? nullptr : &newest();
+    }
+
+    /**
+     * @brief latest state of one source in O(1)
+     * @return nullptr if the source pushed nothing that is still kept
+     */
+    const State* latest(SourceId source) const {
+        if(source >= MAX_SOURCES || newestBySource[source] == 0
+                || count - newestBySource[source] >= slots.size()) {
+            return nullptr;
+        }
+        return &slots[(newestBySource[source] - 1) % slots.size()];
+    }
+
+    /**
+     * @brief at finds the newest state at or before time in O(log n)
+     * @return nullptr if all kept states are newer
+     */
+    const State* at(int64_t time) const {
+        // ages are ordered by descending timestamps
+        size_t low = 0;
+        size_t high = size();
+        while(low < high) {
+            size_t middle = (low + high) / 2;
+            if((*this)[middle].timestamp <= time) {
+                high = middle;
+            } else {
+                low = middle + 1;
+            }
+        }
+        return low < size() ? &(*this)[low] : nullptr;
+    }
+
+private:
+    std::vector<State> slots;
+    uint64_t count;
+    std::vector<uint64_t> newestBySource; //!< count after its newest push, 0 for none
+};
+
+typedef StateHistory<CarState> CarHistory;
+
+}  // namespace state_history
+
+#endif // STATE_HISTORY_STATE_HISTORY_H
@@ -0,0 +1,58 @@
+// Replaces the global operator new to count allocations per thread, see
+// state_history/allocations.h. Only meant for debugging sessions.
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local uint64_t threadCount = 0;
+
+void* allocate(std::size_t size) {
+    threadCount++;
+    void *memory = std::malloc(size == 0 ? 1 : size);
+    if(memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+}  // namespace
+
+extern "C" uint64_t allocation_counter_thread_count() {
+    return threadCount;
+}
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    threadCount++;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    threadCount++;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
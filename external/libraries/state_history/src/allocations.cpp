@@ -0,0 +1,24 @@
+#include "state_history/allocations.h"
+
+// defined by liballocation_counter.so if it is loaded
+extern "C" uint64_t allocation_counter_thread_count() __attribute__((weak));
+
+namespace state_history {
+
+uint64_t allocations() {
+#ifdef NDEBUG
+    return 0;
+#else
+    return allocation_counter_thread_count != nullptr ? allocation_counter_thread_count() : 0;
+#endif
+}
+
+bool counting() {
+#ifdef NDEBUG
+    return false;
+#else
+    return allocation_counter_thread_count != nullptr;
+#endif
+}
+
+}  // namespace state_history
@@ -0,0 +1,43 @@
+#include "state_history/source_names.h"
+
+#include <deque>
+#include <mutex>
+
+namespace state_history {
+
+namespace {
+
+std::mutex namesMutex;
+
+/**
+ * @brief Interned names by id, a deque keeps the strings in place
+ */
+std::deque<std::string>& names() {
+    static std::deque<std::string> table;
+    return table;
+}
+
+}  // namespace
+
+SourceId intern(const std::string &name) {
+    std::lock_guard<std::mutex> lock(namesMutex);
+    std::deque<std::string> &table = names();
+    for(size_t i = 0; i < table.size(); i++) {
+        if(table[i] == name) {
+            return static_cast<SourceId>(i);
+        }
+    }
+    if(table.size() >= MAX_SOURCES) {
+        return MAX_SOURCES;
+    }
+    table.push_back(name);
+    return static_cast<SourceId>(table.size() - 1);
+}
+
+const char* sourceName(SourceId id) {
+    std::lock_guard<std::mutex> lock(namesMutex);
+    const std::deque<std::string> &table = names();
+    return id < table.size() ? table[id].c_str() : "";
+}
+
+}  // namespace state_history
@@ -8,15 +8,37 @@
 #include "sense_link/datatypes.h"
 #include "sense_link/actuators.h"
 #include "sensor_utils/car.h"
+#include "cycle_trace/trace.h"
+#include "input_events/input_events.h"
+#include "state_history/allocations.h"
+#include "state_history/state_history.h"
 
 class TowerController : public lms::Module {
 public:
     bool initialize();
     bool deinitialize();
     bool cycle();
+    void configsChanged();
 private:
+    /**
+     * @brief Servo limits and speed, loaded by configsChanged()
+     */
+    struct Parameters {
+        float minServoHor;
+        float maxServoHor;
+        float minServoVer;
+        float maxServoVer;
+        float v;
+    };
+    Parameters params;
+
     lms::WriteDataChannel<sensor_utils::Car> cameraTowerControlls;
+    lms::WriteDataChannel<state_history::CarHistory> history;
+    lms::ReadDataChannel<input_events::InputEvents> inputEvents;
     lms::extra::PrecisionTime lastCycle;
+    cycle_trace::ScopeId traceScope;
+    sensor_utils::Car::State state; //!< named once, refilled each cycle
+    state_history::SourceId source;
     float servoHorizontal;
     float servoVertical;
     int verticalState;
@@ -4,10 +4,17 @@
 #include <cstdint>
 bool TowerController::initialize() {
     cameraTowerControlls = writeChannel<sensor_utils::Car>("TOWER");
+    history = writeChannel<state_history::CarHistory>("TOWER_HISTORY");
+    inputEvents = readChannel<input_events::InputEvents>("INPUT_EVENTS");
+    configsChanged();
     servoHorizontal = 0;
     servoVertical = 0;
     verticalState = 0;
+    state.name = "keyboard";
+    state.targetSpeed = 0;
+    source = state_history::intern(state.name);
     lastCycle = lms::extra::PrecisionTime::now();
+    traceScope = cycle_trace::scope(getName());
     return true;
 }
 
@@ -15,46 +22,64 @@ bool TowerController::deinitialize() {
     return true;
 }
 
-bool TowerController::cycle() {
-    sensor_utils::Car::State state;
+void TowerController::configsChanged() {
+    Parameters loaded;
+    loaded.minServoHor = config().get<float>("minServoHor");
+    loaded.maxServoHor = config().get<float>("maxServoHor");
+    loaded.minServoVer = config().get<float>("minServoVer");
+    loaded.maxServoVer = config().get<float>("maxServoVer");
+    loaded.v = config().get<float>("v");
+    params = loaded;
+}
 
-    float minServoHor = config().get<float>("minServoHor");
-    float maxServoHor = config().get<float>("maxServoHor");
-    float minServoVer = config().get<float>("minServoVer");
-    float maxServoVer = config().get<float>("maxServoVer");
+bool TowerController::cycle() {
+    cycle_trace::Scope trace(traceScope);
+    state_history::AllocationScope allocations;
 
-    for(const std::string &msg : messaging()->receive("car")) {
-        if(msg == "left") {
+    for(const input_events::InputEvent &event : *inputEvents) {
+        switch(event.action) {
+        case input_events::Action::LEFT:
+        case input_events::Action::BREAK_DOWN:
             verticalState = -1;
-        } else if(msg == "right") {
-            verticalState = 1;
-        } else if(msg == "acc_down") {
+            break;
+        case input_events::Action::RIGHT:
+        case input_events::Action::ACC_DOWN:
             verticalState = 1;
-        } else if(msg == "acc_up") {
+            break;
+        case input_events::Action::ACC_UP:
+        case input_events::Action::BREAK_UP:
             verticalState = 0;
-        } else if(msg == "break_down") {
-            verticalState = -1;
-        } else if(msg == "break_up") {
-            verticalState = 0;
-        } else if(msg == "right_up" || msg == "left_up") {
+            break;
+        case input_events::Action::LEFT_UP:
+        case input_events::Action::RIGHT_UP:
             servoHorizontal = 0;
+            break;
+        default:
+            break;
         }
     }
 
     float t = lms::extra::PrecisionTime::since(lastCycle).toFloat();
-    servoVertical = servoVertical + verticalState * config().get<float>("v") * t;
-    servoHorizontal = servoHorizontal + verticalState * config().get<float>("v") * t;
+    servoVertical = servoVertical + verticalState * params.v * t;
+    servoHorizontal = servoHorizontal + verticalState * params.v * t;
 
-    servoVertical = std::max(float(minServoVer), std::min(servoVertical, float(maxServoVer)));
-    servoHorizontal = std::max(float(minServoHor), std::min(servoVertical, float(maxServoHor)));
+    servoVertical = std::max(params.minServoVer, std::min(servoVertical, params.maxServoVer));
+    servoHorizontal = std::max(params.minServoHor, std::min(servoVertical, params.maxServoHor));
 
-    state.name = "keyboard";
     state.steering_front = servoHorizontal;
     state.steering_rear = servoVertical;
     cameraTowerControlls->putState(state);
 
+    state_history::CarState &recent = history->push(lms::extra::PrecisionTime::now().micros(), source);
+    recent.steeringFront = state.steering_front;
+    recent.steeringRear = state.steering_rear;
+    recent.targetSpeed = state.targetSpeed;
+
     logger.debug() << servoVertical << " " << servoHorizontal;
 
     lastCycle = lms::extra::PrecisionTime::now();
+    if(allocations.count() > 0) {
+        logger.debug("allocations") << allocations.count() << " in cycle";
+    }
     return true;
 }
@@ -8,15 +8,25 @@
 #include "sense_link/datatypes.h"
 #include "sense_link/actuators.h"
 #include "sensor_utils/car.h"
+#include "cycle_trace/trace.h"
+#include "sense_link_host/actuator_filter.h"
 
 class TowerToSenseLink : public lms::Module {
 public:
     bool initialize();
     bool deinitialize();
     bool cycle();
+    void configsChanged();
 private:
+    void logStatistics();
+
     lms::WriteDataChannel<sense_link::Actuators> actuators;
     lms::ReadDataChannel<sensor_utils::Car> cameraTowerControlls;
+    cycle_trace::ScopeId traceScope;
+
+    sense_link::ActuatorFilter filter; //!< only changes and keepalives are sent
+    int64_t statisticsInterval; //!< [us]
+    int64_t lastStatistics; //!< [us]
 };
 
 #endif // TO_ARDUIONO_H
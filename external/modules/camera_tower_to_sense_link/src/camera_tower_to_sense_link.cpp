@@ -2,27 +2,68 @@
 #include "lms/math/vertex.h"
 #include <cmath>
 #include <cstdint>
+#include "sense_link_host/clock_sync.h"
 bool TowerToSenseLink::initialize() {
     actuators = writeChannel<sense_link::Actuators>("ACTUATORS");
     cameraTowerControlls = readChannel<sensor_utils::Car>("TOWER");
+    traceScope = cycle_trace::scope(getName());
+    configsChanged();
+    lastStatistics = sense_link::hostMicros();
 
     return true;
 }
 
+void TowerToSenseLink::configsChanged() {
+    sense_link::ActuatorFilterOptions options;
+    options.deadband[static_cast<int>(sense_link::ActuatorType::SERVO)] =
+            config().get<double>("servoDeadband", 0);
+    options.deadband[static_cast<int>(sense_link::ActuatorType::LED)] =
+            config().get<double>("ledDeadband", 0);
+    options.keepalive = config().get<int64_t>("keepalive", 200) * 1000;
+    filter.setOptions(options);
+    statisticsInterval = config().get<int64_t>("statisticsInterval", 10) * 1000000;
+}
+
 bool TowerToSenseLink::deinitialize() {
+    logStatistics();
     return true;
 }
 
 bool TowerToSenseLink::cycle() {
+    cycle_trace::Scope trace(traceScope);
     actuators->clear();
+    int64_t now = sense_link::hostMicros();
+
     sense_link::Servo s0;
     s0.angle = cameraTowerControlls->steeringFront();
     sense_link::Servo s1;
     s1.angle = cameraTowerControlls->steeringRear();
-    actuators->set(sense_link::ActuatorType::SERVO,1,s0);
-    actuators->set(sense_link::ActuatorType::SERVO,2,s1);
+    if(filter.update(sense_link::ActuatorType::SERVO, 1, s0.angle, now)) {
+        actuators->set(sense_link::ActuatorType::SERVO,1,s0);
+    }
+    if(filter.update(sense_link::ActuatorType::SERVO, 2, s1.angle, now)) {
+        actuators->set(sense_link::ActuatorType::SERVO,2,s1);
+    }
     sense_link::ActuatorData led;
     led.Led.value = 255;
-    actuators->set(sense_link::ActuatorType::LED,1,led);
+    if(filter.update(sense_link::ActuatorType::LED, 1, led.Led.value, now)) {
+        actuators->set(sense_link::ActuatorType::LED,1,led);
+    }
+
+    if(statisticsInterval > 0 && now - lastStatistics >= statisticsInterval) {
+        logStatistics();
+        lastStatistics = now;
+    }
     return true;
 }
+
+void TowerToSenseLink::logStatistics() {
+    static const char *TYPES[] = {"servo", "motor", "led"};
+    for(const sense_link::ActuatorFilter::Entry &entry : filter.entries()) {
+        logger.debug("statistics") << TYPES[static_cast<int>(entry.type)] << " "
+                                   << static_cast<int>(entry.id) << ": sent "
+                                   << entry.counters.sent << " (keepalive "
+                                   << entry.counters.keepalives << "), suppressed "
+                                   << entry.counters.suppressed;
+    }
+}
@@ -5,6 +5,11 @@
 #include "comm/senseboard.h"
 #include "lms/extra/time.h"
 #include "sensor_utils/car.h"
+#include "cycle_trace/trace.h"
+#include "image_codec/rate_controller.h"
+#include "sense_link_host/actuator_filter.h"
+#include "sense_link_host/board_channels.h"
+#include "state_history/allocations.h"
 
 class CarToSenseboard2015 : public lms::Module {
 
@@ -12,12 +17,23 @@ public:
     bool initialize() override;
     bool deinitialize() override;
     bool cycle() override;
+    void configsChanged() override;
 
 private:
+    void logStatistics();
+
     bool lastRcState;
+    sense_link::ActuatorFilter filter; //!< steering servos and motor, see cycle()
+    double motorScale; //!< MOTOR speed per m/s
+    int64_t statisticsInterval; //!< [us]
+    int64_t lastStatistics; //!< [us]
+    uint64_t allocations; //!< in cycle() since the last statistics, debug builds only
+    cycle_trace::ScopeId traceScope;
     lms::WriteDataChannel<Comm::SensorBoard::ControlData> controlData;
     lms::WriteDataChannel<Comm::SensorBoard::SensorData> sensorData;
+    lms::WriteDataChannel<sense_link::BoardActuators> actuators; //!< changes only, for sense_link_hub
     lms::ReadDataChannel<sensor_utils::Car> car;
+    lms::ReadDataChannel<image_codec::LinkReport> link; //!< newest frame the PC had when it sent CAR
 };
 
 #endif /* CAR_TRACKER */
@@ -3,33 +3,99 @@
 #include <algorithm>
 #include "lms/datamanager.h"
 #include "lms/messaging.h"
+#include "sense_link_host/clock_sync.h"
 bool CarToSenseboard2015::initialize() {
     controlData = datamanager()->writeChannel<Comm::SensorBoard::ControlData>(this,"CONTROL_DATA");
     sensorData = datamanager()->writeChannel<Comm::SensorBoard::SensorData>(this,"SENSOR_DATA");
+    actuators = datamanager()->writeChannel<sense_link::BoardActuators>(this,"CAR_ACTUATORS");
     car = datamanager()->readChannel<sensor_utils::Car>(this,"CAR");
+    link = datamanager()->readChannel<image_codec::LinkReport>(this,"IMAGE_LINK");
     lastRcState = false;
+    traceScope = cycle_trace::scope(getName());
+    configsChanged();
+    lastStatistics = sense_link::hostMicros();
+    allocations = 0;
     return true;
 }
 
+void CarToSenseboard2015::configsChanged() {
+    sense_link::ActuatorFilterOptions options;
+    options.deadband[static_cast<int>(sense_link::ActuatorType::SERVO)] =
+            config().get<double>("steeringDeadband", 0);
+    options.deadband[static_cast<int>(sense_link::ActuatorType::MOTOR)] =
+            config().get<double>("velocityDeadband", 0);
+    options.keepalive = config().get<int64_t>("keepalive", 200) * 1000;
+    filter.setOptions(options);
+    motorScale = sense_link::MAXIMUM_MOTOR_VALUE / config().get<double>("maxSpeed", 5);
+    statisticsInterval = config().get<int64_t>("statisticsInterval", 10) * 1000000;
+}
 
 bool CarToSenseboard2015::deinitialize() {
+    logStatistics();
     return true;
 }
 
 bool CarToSenseboard2015::cycle() {
+    cycle_trace::Scope trace(traceScope);
+    state_history::AllocationScope cycleAllocations;
+
+    int64_t now = sense_link::hostMicros();
+    // importer_senseboard2015 sends all of CONTROL_DATA every cycle, it gets
+    // the exact values
     controlData->vel_mode = Comm::SensorBoard::ControlData::MODE_VELOCITY;
     controlData->control.velocity.velocity = car->targetSpeed();
-
     controlData->steering_front = car->steeringFront();
     controlData->steering_rear = -car->steeringRear();
 
-    logger.debug("cylce")<<"sf: "<<controlData->steering_front << " sr: "<<controlData->steering_rear << " tv: "<<controlData->control.velocity.velocity;
+    // only changes beyond the deadband and keepalives go into CAR_ACTUATORS,
+    // sense_link_hub sends them as one frame
+    actuators->clear();
+    sense_link::ActuatorData data;
+    if(filter.update(sense_link::ActuatorType::MOTOR, 1, car->targetSpeed(), now)) {
+        data.Motor.speed = static_cast<int16_t>(std::max<double>(sense_link::MINIMUM_MOTOR_VALUE,
+                std::min<double>(sense_link::MAXIMUM_MOTOR_VALUE, std::round(car->targetSpeed() * motorScale))));
+        actuators->set(sense_link::ActuatorType::MOTOR, 1, data);
+    }
+    if(filter.update(sense_link::ActuatorType::SERVO, 1, car->steeringFront(), now)) {
+        data.Servo.angle = static_cast<int16_t>(std::round(car->steeringFront() * 180 / M_PI));
+        actuators->set(sense_link::ActuatorType::SERVO, 1, data);
+    }
+    if(filter.update(sense_link::ActuatorType::SERVO, 2, -car->steeringRear(), now)) {
+        data.Servo.angle = static_cast<int16_t>(std::round(-car->steeringRear() * 180 / M_PI));
+        actuators->set(sense_link::ActuatorType::SERVO, 2, data);
+    }
+    // IMAGE_LINK arrives with CAR from the PC: the CAR state was made with
+    // this frame on the screen, frame_to_actuator ends here once per frame
+    if(link->frames > 0) {
+        cycle_trace::frameActuated(link->lastSequence);
+    }
+
     if(sensorData->rc_on != lastRcState){
         lastRcState = sensorData->rc_on;
         //TODO broadcast msg
         messaging()->send("RC_STATE_CHANGED",std::to_string(lastRcState));
-        logger.error("cycle")<<"RC_STATE_CHANGED: "<<std::to_string(lastRcState);
+        logger.info("cycle")<<"RC_STATE_CHANGED: "<<std::to_string(lastRcState);
+    }
+
+    allocations += cycleAllocations.count();
+    if(statisticsInterval > 0 && now - lastStatistics >= statisticsInterval) {
+        logStatistics();
+        lastStatistics = now;
     }
 
     return true;
 }
+
+void CarToSenseboard2015::logStatistics() {
+    for(const sense_link::ActuatorFilter::Entry &entry : filter.entries()) {
+        logger.debug("statistics") << (entry.type == sense_link::ActuatorType::MOTOR ? "velocity" :
+                                       entry.id == 1 ? "steering front" : "steering rear")
+                                   << ": sent " << entry.counters.sent << " (keepalive "
+                                   << entry.counters.keepalives << "), suppressed "
+                                   << entry.counters.suppressed;
+    }
+    if(state_history::counting()) {
+        logger.debug("statistics") << "allocations in cycle: " << allocations;
+        allocations = 0;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef CHANNEL_RECORDER_H
+#define CHANNEL_RECORDER_H
+
+#include <string>
+#include <vector>
+
+#include <lms/datamanager.h>
+#include <lms/module.h>
+#include <channel_log/stream_buffers.h>
+#include <channel_log/writer.h>
+
+/**
+ * @brief LMS module channel_recorder
+ *
+ * Serializes data channels every cycle into a channel log. The disk is
+ * written by a background thread, the cycle only copies into memory.
+ **/
+class ChannelRecorder : public lms::Module {
+public:
+    bool initialize() override;
+    bool deinitialize() override;
+    bool cycle() override;
+private:
+    struct Channel {
+        std::string name;
+        uint16_t id;
+    };
+
+    channel_log::Writer writer;
+    std::vector<Channel> channels;
+    channel_log::VectorBuffer buffer; //!< reused, no allocation per cycle
+    std::string path;
+
+    uint64_t lastDropped;
+    bool failureLogged;
+};
+
+#endif // CHANNEL_RECORDER_H
@@ -0,0 +1,75 @@
+#include "channel_recorder.h"
+
+#include <ctime>
+#include <ostream>
+
+#include <cycle_trace/trace.h>
+
+bool ChannelRecorder::initialize() {
+    // strftime pattern, every run gets its own file
+    std::string pattern = config().get<std::string>("path", "drive-%Y%m%d-%H%M%S.clog");
+    char name[512];
+    std::time_t now = std::time(nullptr);
+    if(std::strftime(name, sizeof(name), pattern.c_str(), std::localtime(&now)) == 0) {
+        logger.error("init") << "Invalid path " << pattern;
+        return false;
+    }
+    path = name;
+
+    channel_log::WriterOptions options;
+    options.chunkSize = config().get<uint32_t>("chunkSize", 4194304);
+    options.buffers = config().get<uint32_t>("buffers", 8);
+    std::string error;
+    if(! writer.open(path, options, &error)) {
+        logger.error("init") << "Could not record: " << error;
+        return false;
+    }
+
+    channels.clear();
+    for(const std::string &channel : config().getArray<std::string>("dataChannels")) {
+        channels.push_back(Channel{channel, writer.channel(channel)});
+    }
+    lastDropped = 0;
+    failureLogged = false;
+    logger.info("init") << "Recording " << channels.size() << " channels to " << path;
+    return true;
+}
+
+bool ChannelRecorder::deinitialize() {
+    uint64_t records = writer.records();
+    uint64_t dropped = writer.dropped();
+    if(! writer.close()) {
+        logger.error("deinit") << "Could not write " << path << " completely";
+        return false;
+    }
+    logger.info("deinit") << "Recorded " << records << " records to " << path << ", "
+                          << dropped << " dropped";
+    return true;
+}
+
+bool ChannelRecorder::cycle() {
+    // one timestamp for all channels, the replayer restores them together
+    int64_t timestamp = cycle_trace::now() / 1000;
+
+    for(const Channel &channel : channels) {
+        buffer.clear();
+        std::ostream stream(&buffer);
+        if(! datamanager()->serializeChannel(this, channel.name, stream)) {
+            logger.error("cycle") << "Could not serialize " << channel.name;
+            continue;
+        }
+        writer.append(channel.id, timestamp, buffer.data().data(),
+                      static_cast<uint32_t>(buffer.data().size()));
+    }
+
+    if(writer.dropped() != lastDropped) {
+        logger.warn("cycle") << writer.dropped() - lastDropped
+                             << " records dropped, the disk is too slow or chunkSize too small";
+        lastDropped = writer.dropped();
+    }
+    if(writer.failed() && ! failureLogged) {
+        logger.error("cycle") << "Writing " << path << " failed, disk full?";
+        failureLogged = true;
+    }
+    return true;
+}
@@ -0,0 +1,3 @@
+#include "channel_recorder.h"
+
+LMS_MODULE_INTERFACE(ChannelRecorder)
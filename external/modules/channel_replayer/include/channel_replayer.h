@@ -0,0 +1,63 @@
+#ifndef CHANNEL_REPLAYER_H
+#define CHANNEL_REPLAYER_H
+
+#include <string>
+#include <vector>
+
+#include <lms/datamanager.h>
+#include <lms/imaging/image.h>
+#include <lms/module.h>
+#include <channel_log/reader.h>
+#include <comm/senseboard.h>
+#include <sense_link/actuators.h>
+#include <sensor_utils/car.h>
+
+/**
+ * @brief LMS module channel_replayer
+ *
+ * Writes the channels of a channel_recorder log back into the framework,
+ * one recorded cycle per cycle, in real time, as fast as possible or on
+ * command.
+ **/
+class ChannelReplayer : public lms::Module {
+public:
+    bool initialize() override;
+    bool deinitialize() override;
+    bool cycle() override;
+private:
+    enum class Mode {
+        REALTIME, FAST, STEP
+    };
+
+    /**
+     * @brief replay writes the records of the next recorded cycle
+     * @return false at the end of the log
+     */
+    bool replay();
+
+    /**
+     * @brief declareWrite declares the write of a replayed channel with its
+     * type, the channels of car_record.xml are known
+     * @return false if the type of the channel is not known
+     */
+    bool declareWrite(const std::string &channel);
+    void restart();
+    void logResult();
+
+    channel_log::Reader reader;
+    std::vector<bool> selected; //!< per channel of the log
+    Mode mode;
+    double speed;
+    bool loop;
+    int64_t budget; //!< [us] for the cycle_trace summary
+
+    int64_t logStart; //!< [us] log time at wallStart
+    int64_t wallStart; //!< [us] cycle_trace::now() / 1000
+    bool finished;
+
+    uint64_t cycles;
+    uint64_t bytes;
+    int64_t replayStart; //!< [ns]
+};
+
+#endif // CHANNEL_REPLAYER_H
@@ -0,0 +1,187 @@
+#include "channel_replayer.h"
+
+#include <chrono>
+#include <istream>
+#include <thread>
+
+#include <channel_log/stream_buffers.h>
+#include <cycle_trace/trace.h>
+
+bool ChannelReplayer::initialize() {
+    std::string path = config().get<std::string>("path", "");
+    std::string error;
+    if(! reader.open(path, &error)) {
+        logger.error("init") << "Could not replay: " << error;
+        return false;
+    }
+    if(! reader.indexed()) {
+        logger.warn("init") << path << " was not closed, replaying up to its last complete chunk";
+    }
+
+    // all channels of the log unless restricted
+    std::vector<std::string> channels = config().getArray<std::string>("dataChannels");
+    selected.assign(reader.channels().size(), channels.empty());
+    for(const std::string &channel : channels) {
+        int id = reader.channel(channel);
+        if(id < 0) {
+            logger.warn("init") << "Channel " << channel << " is not in " << path;
+            continue;
+        }
+        selected[id] = true;
+    }
+    for(size_t id = 0; id < selected.size(); id++) {
+        if(selected[id] && ! declareWrite(reader.channels()[id])) {
+            logger.warn("init") << "Channel " << reader.channels()[id] << " has no known type, not replayed";
+            selected[id] = false;
+        }
+    }
+
+    std::string modeName = config().get<std::string>("mode", "realtime");
+    if(modeName == "fast") {
+        mode = Mode::FAST;
+    } else if(modeName == "step") {
+        mode = Mode::STEP;
+    } else {
+        if(modeName != "realtime") {
+            logger.warn("init") << "Unknown mode " << modeName << ", using realtime";
+        }
+        mode = Mode::REALTIME;
+    }
+    speed = config().get<double>("speed", 1);
+    if(speed <= 0) {
+        speed = 1;
+    }
+    loop = config().get<bool>("loop", false);
+    budget = config().get<int64_t>("budget", 10000);
+
+    logger.info("init") << "Replaying " << path << ", " << (reader.end() - reader.begin()) / 1e6
+                        << " s in " << reader.chunkCount() << " chunks";
+    restart();
+    return true;
+}
+
+bool ChannelReplayer::deinitialize() {
+    if(! finished) {
+        logResult();
+    }
+    reader.close();
+    return true;
+}
+
+bool ChannelReplayer::declareWrite(const std::string &channel) {
+    if(channel == "CAR" || channel == "TOWER") {
+        writeChannel<sensor_utils::Car>(channel);
+    } else if(channel == "ACTUATORS") {
+        writeChannel<sense_link::Actuators>(channel);
+    } else if(channel == "CONTROL_DATA") {
+        writeChannel<Comm::SensorBoard::ControlData>(channel);
+    } else if(channel == "SENSOR_DATA") {
+        writeChannel<Comm::SensorBoard::SensorData>(channel);
+    } else if(channel == "IMAGE") {
+        writeChannel<lms::imaging::Image>(channel);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void ChannelReplayer::restart() {
+    reader.rewind();
+    double start = config().get<double>("start", 0);
+    if(start > 0) {
+        reader.seek(reader.begin() + static_cast<int64_t>(start * 1e6));
+    }
+    channel_log::Record record;
+    logStart = reader.peek(&record) ? record.timestamp : reader.begin();
+    wallStart = cycle_trace::now() / 1000;
+    finished = false;
+    cycles = 0;
+    bytes = 0;
+    replayStart = cycle_trace::now();
+}
+
+bool ChannelReplayer::cycle() {
+    if(finished) {
+        return true;
+    }
+
+    if(mode == Mode::STEP) {
+        int steps = 0;
+        for(const std::string &msg : messaging()->receive("REPLAY_STEP")) {
+            (void)msg;
+            steps++;
+        }
+        if(steps == 0) {
+            return true;
+        }
+        // only the last step writes the channels the other modules see
+        for(int i = 0; i < steps && ! finished; i++) {
+            finished = ! replay();
+        }
+    } else {
+        if(mode == Mode::REALTIME) {
+            channel_log::Record record;
+            if(reader.peek(&record)) {
+                int64_t due = wallStart + static_cast<int64_t>((record.timestamp - logStart) / speed);
+                int64_t wait = due - cycle_trace::now() / 1000;
+                if(wait > 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(wait));
+                }
+            }
+        }
+        finished = ! replay();
+    }
+
+    if(finished) {
+        logResult();
+        if(loop) {
+            logger.info("cycle") << "Restarting the replay";
+            restart();
+        }
+    }
+    return true;
+}
+
+bool ChannelReplayer::replay() {
+    channel_log::Record record;
+    if(! reader.next(&record)) {
+        return false;
+    }
+
+    // all records with the timestamp of the first belong to one recorded cycle
+    int64_t timestamp = record.timestamp;
+    do {
+        if(record.channel < selected.size() && selected[record.channel]) {
+            channel_log::MemoryBuffer buffer(record.data, record.size);
+            std::istream stream(&buffer);
+            const std::string &name = reader.channels()[record.channel];
+            if(! datamanager()->deserializeChannel(this, name, stream)) {
+                logger.error("replay") << "Could not deserialize " << name;
+            }
+            bytes += record.size;
+        }
+        channel_log::Record following;
+        if(! reader.peek(&following) || following.timestamp != timestamp) {
+            break;
+        }
+        reader.next(&record);
+    } while(true);
+
+    cycles++;
+    return true;
+}
+
+void ChannelReplayer::logResult() {
+    double seconds = (cycle_trace::now() - replayStart) / 1e9;
+    if(seconds <= 0) {
+        return;
+    }
+    logger.info("result") << "Replayed " << cycles << " cycles in " << seconds << " s: "
+                          << cycles / seconds << " cycles/s, " << bytes / seconds / 1e6 << " MB/s";
+
+    // throughput the modules would reach on their own, from their traced scopes
+    for(const cycle_trace::ScopeSummary &s : cycle_trace::summary(budget)) {
+        logger.info("result") << s.name << ": n=" << s.count << " mean=" << s.mean << "us p99="
+                              << s.p99 << "us -> " << (s.mean > 0 ? 1e6 / s.mean : 0) << "/s";
+    }
+}
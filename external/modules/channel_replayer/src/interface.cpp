@@ -0,0 +1,3 @@
+#include "channel_replayer.h"
+
+LMS_MODULE_INTERFACE(ChannelReplayer)
@@ -0,0 +1,35 @@
+#ifndef CYCLE_TRACE_DUMP_H
+#define CYCLE_TRACE_DUMP_H
+
+#include <string>
+
+#include <lms/module.h>
+#include <cycle_trace/trace.h>
+
+/**
+ * @brief LMS module cycle_trace_dump
+ *
+ * Measures the period of the framework cycle and writes what the modules
+ * recorded with cycle_trace: a summary to the log every few seconds, the
+ * trace to files on request.
+ **/
+class CycleTraceDump : public lms::Module {
+public:
+    bool initialize() override;
+    bool deinitialize() override;
+    bool cycle() override;
+private:
+    void logSummary();
+    void dump();
+
+    cycle_trace::ScopeId periodScope;
+    int64_t lastCycle;
+    int64_t lastSummary;
+
+    std::string path;
+    int64_t budget;
+    int64_t summaryInterval;
+    bool chromeTrace;
+};
+
+#endif // CYCLE_TRACE_DUMP_H
@@ -0,0 +1,87 @@
+#include "cycle_trace_dump.h"
+
+#include <atomic>
+#include <csignal>
+
+#include <cycle_trace/trace_file.h>
+
+namespace {
+
+std::atomic<bool> dumpRequested(false);
+
+void onSignal(int) {
+    dumpRequested = true;
+}
+
+}  // namespace
+
+bool CycleTraceDump::initialize() {
+    path = config().get<std::string>("path", "cycle_trace");
+    budget = config().get<int64_t>("budget", 10000);
+    summaryInterval = config().get<int64_t>("summaryInterval", 10) * 1000000000;
+    chromeTrace = config().get<bool>("chromeTrace", true);
+
+    periodScope = cycle_trace::scope("framework_period");
+    lastCycle = 0;
+    lastSummary = cycle_trace::now();
+
+    // kill -USR1 <pid> dumps the trace of a running framework
+    std::signal(SIGUSR1, onSignal);
+    return true;
+}
+
+bool CycleTraceDump::deinitialize() {
+    std::signal(SIGUSR1, SIG_DFL);
+    if(config().get<bool>("dumpOnExit", false)) {
+        dump();
+    }
+    return true;
+}
+
+bool CycleTraceDump::cycle() {
+    int64_t now = cycle_trace::now();
+    if(lastCycle != 0) {
+        // period instead of duration, the jitter of the whole framework cycle
+        cycle_trace::histogram(periodScope).record((now - lastCycle) / 1000);
+    }
+    lastCycle = now;
+
+    bool dumpNow = dumpRequested.exchange(false);
+    for(const std::string &msg : messaging()->receive("TRACE_DUMP")) {
+        (void)msg;
+        dumpNow = true;
+    }
+    if(dumpNow) {
+        dump();
+    }
+
+    if(summaryInterval > 0 && now - lastSummary > summaryInterval) {
+        lastSummary = now;
+        logSummary();
+    }
+    return true;
+}
+
+void CycleTraceDump::logSummary() {
+    for(const cycle_trace::ScopeSummary &s : cycle_trace::summary(budget)) {
+        logger.info("summary") << s.name << ": n=" << s.count << " mean=" << s.mean
+                               << "us p50=" << s.p50 << "us p99=" << s.p99 << "us max=" << s.max
+                               << "us over budget=" << s.overBudget;
+    }
+}
+
+void CycleTraceDump::dump() {
+    cycle_trace::Trace trace = cycle_trace::snapshot();
+
+    std::string binary = path + ".ctrace";
+    if(! cycle_trace::writeBinary(trace, binary)) {
+        logger.error("dump") << "Could not write " << binary;
+        return;
+    }
+    if(chromeTrace && ! cycle_trace::writeChromeTrace(trace, path + ".json")) {
+        logger.error("dump") << "Could not write " << path << ".json";
+        return;
+    }
+    logger.info("dump") << "Trace written to " << binary;
+    logSummary();
+}
@@ -0,0 +1,3 @@
+#include "cycle_trace_dump.h"
+
+LMS_MODULE_INTERFACE(CycleTraceDump)
@@ -0,0 +1,53 @@
+#ifndef ENGINE_SOUND_PLAYER_H
+#define ENGINE_SOUND_PLAYER_H
+
+#include <memory>
+#include <vector>
+
+#include <SFML/Audio/SoundStream.hpp>
+
+#include <lms/datamanager.h>
+#include <lms/module.h>
+#include <sensor_utils/car.h>
+#include <audio_mixer/engine_sound.h>
+#include <audio_mixer/mixer.h>
+
+/**
+ * @brief LMS module engine_sound_player
+ *
+ * Engine sound of the car from the RPM clips, crossfaded and pitch-shifted
+ * with the speed. Replaces sfml_sound_player and sound_controller: the clips
+ * are decoded once in initialize(), the cycle only queues gain and pitch
+ * targets, mixing runs on the audio thread.
+ **/
+class EngineSoundPlayer : public lms::Module {
+public:
+    bool initialize() override;
+    bool deinitialize() override;
+    bool cycle() override;
+    void configsChanged() override;
+private:
+    /**
+     * @brief Pulls blocks from the mixer on the streaming thread of SFML
+     */
+    class Stream : public sf::SoundStream {
+    public:
+        Stream(audio_mixer::Mixer &mixer, size_t frames);
+    protected:
+        bool onGetData(Chunk &data) override;
+        void onSeek(sf::Time) override;
+    private:
+        audio_mixer::Mixer &mixer;
+        std::vector<sf::Int16> buffer; //!< one block, preallocated
+        bool prioritySet;
+    };
+
+    lms::ReadDataChannel<sensor_utils::Car> car;
+
+    std::unique_ptr<audio_mixer::Mixer> mixer;
+    std::unique_ptr<audio_mixer::EngineSound> engine;
+    std::unique_ptr<Stream> stream;
+    float maxSpeed;
+};
+
+#endif // ENGINE_SOUND_PLAYER_H
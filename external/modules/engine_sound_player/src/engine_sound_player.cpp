@@ -0,0 +1,91 @@
+#include "engine_sound_player.h"
+
+#include <cmath>
+#include <pthread.h>
+#include <sched.h>
+
+EngineSoundPlayer::Stream::Stream(audio_mixer::Mixer &mixer, size_t frames)
+    : mixer(mixer), buffer(frames * 2), prioritySet(false) {
+    initialize(2, mixer.sampleRate());
+}
+
+bool EngineSoundPlayer::Stream::onGetData(Chunk &data) {
+    if(! prioritySet) {
+        // the streaming thread of SFML is the audio thread, keep it ahead of
+        // rendering and input; needs CAP_SYS_NICE or rtprio, else stays normal
+        sched_param param;
+        param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+        pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        prioritySet = true;
+    }
+    mixer.render(buffer.data(), buffer.size() / 2);
+    data.samples = buffer.data();
+    data.sampleCount = buffer.size();
+    return true;
+}
+
+void EngineSoundPlayer::Stream::onSeek(sf::Time) {
+}
+
+bool EngineSoundPlayer::initialize() {
+    car = readChannel<sensor_utils::Car>("CAR");
+
+    int sampleRate = config().get<int>("sampleRate", 44100);
+    size_t blockFrames = config().get<size_t>("blockFrames", 512);
+    std::vector<std::string> sounds = config().getArray<std::string>("sounds");
+    mixer.reset(new audio_mixer::Mixer(sampleRate, static_cast<unsigned int>(sounds.size()),
+                                       blockFrames));
+
+    std::vector<int> clips;
+    for(const std::string &sound : sounds) {
+        audio_mixer::Clip clip;
+        std::string error;
+        if(! audio_mixer::loadWav(sound, sampleRate, &clip, &error)) {
+            logger.error("init") << error;
+            return false;
+        }
+        logger.debug("init") << "Loaded " << sound << ", " << clip.frames() << " frames";
+        clips.push_back(mixer->addClip(std::move(clip)));
+    }
+
+    audio_mixer::EngineOptions options;
+    options.thresholds = config().getArray<float>("percent");
+    if(options.thresholds.size() != clips.size()) {
+        logger.error("init") << "percent needs one threshold per sound";
+        return false;
+    }
+    options.crossfade = config().get<float>("crossfade", 0.1);
+    options.minPitch = config().get<float>("minPitch", 0.85);
+    options.maxPitch = config().get<float>("maxPitch", 1.15);
+    options.ramp = config().get<float>("ramp", 0.05);
+    options.volume = config().get<float>("volume", 1);
+    engine.reset(new audio_mixer::EngineSound(*mixer, clips, options));
+    configsChanged();
+
+    engine->start();
+    stream.reset(new Stream(*mixer, blockFrames));
+    stream->play();
+    return true;
+}
+
+void EngineSoundPlayer::configsChanged() {
+    maxSpeed = config().get<float>("maxSpeed", 1);
+    if(maxSpeed <= 0) {
+        maxSpeed = 1;
+    }
+}
+
+bool EngineSoundPlayer::deinitialize() {
+    if(stream) {
+        stream->stop();
+    }
+    stream.reset();
+    engine.reset();
+    mixer.reset();
+    return true;
+}
+
+bool EngineSoundPlayer::cycle() {
+    engine->update(std::fabs(car->targetSpeed()) / maxSpeed);
+    return true;
+}
@@ -0,0 +1,3 @@
+#include "engine_sound_player.h"
+
+LMS_MODULE_INTERFACE(EngineSoundPlayer)
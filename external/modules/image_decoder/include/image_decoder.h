@@ -0,0 +1,48 @@
+#ifndef IMAGE_DECODER_H
+#define IMAGE_DECODER_H
+
+#include <lms/datamanager.h>
+#include <lms/imaging/image.h>
+#include <lms/module.h>
+#include <cycle_trace/trace.h>
+#include <image_codec/codec.h>
+#include <image_codec/rate_controller.h>
+#include <image_stage/damage.h>
+
+/**
+ * @brief LMS module image_decoder
+ *
+ * Decodes what image_encoder sent and reports back what arrived, so the
+ * encoder can adapt to the link. Only the tiles that changed are written
+ * to IMAGE and listed in IMAGE_DAMAGE, so renderers can skip unchanged
+ * frames and upload the changed regions only.
+ **/
+class ImageDecoder : public lms::Module {
+public:
+    bool initialize() override;
+    bool deinitialize() override;
+    bool cycle() override;
+private:
+    void logStatistics(int64_t now);
+
+    lms::ReadDataChannel<image_codec::EncodedFrame> encoded;
+    lms::WriteDataChannel<lms::imaging::Image> image;
+    lms::WriteDataChannel<image_stage::Damage> damage;
+    lms::WriteDataChannel<image_codec::LinkReport> link;
+
+    image_codec::Decoder decoder;
+    cycle_trace::ScopeId traceScope;
+    uint32_t lastSequence;
+    int64_t statisticsInterval; //!< [us]
+
+    // since the last statistics
+    int64_t lastStatistics;
+    int frames;
+    int skipped;
+    int unchanged; //!< decoded, but identical to the previous image
+    int lost;
+    uint64_t bytes;
+    int64_t decodeMicros;
+};
+
+#endif // IMAGE_DECODER_H
@@ -0,0 +1,113 @@
+#include "image_decoder.h"
+
+#include <cstring>
+
+namespace {
+
+/**
+ * @brief Format of the same pixel size, all copyChanged() needs to know
+ */
+image_stage::PixelFormat pixelFormat(int bytesPerPixel) {
+    switch(bytesPerPixel) {
+    case 2:
+        return image_stage::PixelFormat::YUYV;
+    case 3:
+        return image_stage::PixelFormat::BGR;
+    case 4:
+        return image_stage::PixelFormat::BGRA;
+    default:
+        return image_stage::PixelFormat::GREY;
+    }
+}
+
+}  // namespace
+
+bool ImageDecoder::initialize() {
+    encoded = readChannel<image_codec::EncodedFrame>("IMAGE_ENCODED");
+    image = writeChannel<lms::imaging::Image>("IMAGE");
+    damage = writeChannel<image_stage::Damage>("IMAGE_DAMAGE");
+    link = writeChannel<image_codec::LinkReport>("IMAGE_LINK");
+    traceScope = cycle_trace::scope("image_decode");
+
+    statisticsInterval = config().get<int64_t>("statisticsInterval", 5) * 1000000;
+    lastSequence = 0;
+    lastStatistics = cycle_trace::now() / 1000;
+    frames = 0;
+    skipped = 0;
+    unchanged = 0;
+    lost = 0;
+    bytes = 0;
+    decodeMicros = 0;
+    return true;
+}
+
+bool ImageDecoder::deinitialize() {
+    return true;
+}
+
+bool ImageDecoder::cycle() {
+    cycle_trace::Scope trace(traceScope);
+    int64_t now = cycle_trace::now() / 1000;
+
+    // socket_data delivers the channel again if nothing new arrived
+    if(encoded->sequence != lastSequence && encoded->width > 0) {
+        if(encoded->sequence > lastSequence + 1 && lastSequence != 0) {
+            lost += encoded->sequence - lastSequence - 1;
+        }
+        lastSequence = encoded->sequence;
+
+        int64_t start = cycle_trace::now();
+        if(! decoder.decode(*encoded)) {
+            logger.warn("cycle") << "Dropped malformed frame " << encoded->sequence;
+        } else if(! encoded->skipped()) {
+            decodeMicros += (cycle_trace::now() - start) / 1000;
+            lms::imaging::Format format = static_cast<lms::imaging::Format>(encoded->format);
+            int stride = decoder.width() * decoder.bytesPerPixel();
+            if(image->width() != decoder.width() || image->height() != decoder.height()
+                    || image->format() != format) {
+                image->resize(decoder.width(), decoder.height(), format);
+                std::memcpy(image->data(), decoder.data(), static_cast<size_t>(stride) * decoder.height());
+                damage->begin();
+                damage->addAll(decoder.width(), decoder.height());
+            } else {
+                // rows outside top..bottom are the previous image anyway
+                image_stage::ImageView decoded(decoder.data(), decoder.width(), decoder.height(), stride,
+                                               pixelFormat(decoder.bytesPerPixel()));
+                if(! image_stage::copyChanged(decoded, image->data(), stride, encoded->top,
+                                              encoded->bottom, &*damage)) {
+                    unchanged++;
+                }
+            }
+        } else {
+            skipped++;
+        }
+
+        frames++;
+        bytes += encoded->size();
+        link->lastSequence = encoded->sequence;
+        link->frames++;
+        link->bytes += encoded->size();
+    }
+    link->timestamp = now;
+
+    if(now - lastStatistics >= statisticsInterval) {
+        logStatistics(now);
+    }
+    return true;
+}
+
+void ImageDecoder::logStatistics(int64_t now) {
+    int decoded = frames - skipped;
+    logger.info("statistics") << frames << " frames, " << skipped << " skipped, " << unchanged
+                              << " unchanged, " << lost
+                              << " lost, " << (frames > 0 ? bytes / frames : 0)
+                              << " bytes/frame, decode " << (decoded > 0 ? decodeMicros / decoded : 0)
+                              << "us";
+    lastStatistics = now;
+    frames = 0;
+    skipped = 0;
+    unchanged = 0;
+    lost = 0;
+    bytes = 0;
+    decodeMicros = 0;
+}
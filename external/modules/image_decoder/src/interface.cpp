@@ -0,0 +1,3 @@
+#include "image_decoder.h"
+
+LMS_MODULE_INTERFACE(ImageDecoder)
@@ -0,0 +1,56 @@
+#ifndef IMAGE_ENCODER_H
+#define IMAGE_ENCODER_H
+
+#include <memory>
+#include <string>
+
+#include <lms/datamanager.h>
+#include <lms/imaging/image.h>
+#include <lms/module.h>
+#include <cycle_trace/trace.h>
+#include <image_codec/codec.h>
+#include <image_codec/rate_controller.h>
+
+/**
+ * @brief LMS module image_encoder
+ *
+ * Compresses the streamed image before socket_data sends it. In adaptive
+ * mode the quality follows the reports image_decoder sends back.
+ **/
+class ImageEncoder : public lms::Module {
+public:
+    bool initialize() override;
+    bool deinitialize() override;
+    bool cycle() override;
+    void configsChanged() override;
+private:
+    enum class Mode {
+        ADAPTIVE, LOSSLESS, LOSSY
+    };
+
+    void logStatistics(int64_t now);
+
+    lms::ReadDataChannel<lms::imaging::Image> image;
+    lms::ReadDataChannel<image_codec::LinkReport> link;
+    lms::WriteDataChannel<image_codec::EncodedFrame> encoded;
+
+    image_codec::Encoder encoder;
+    std::unique_ptr<image_codec::RateController> controller;
+    cycle_trace::ScopeId traceScope;
+
+    struct Parameters {
+        Mode mode;
+        int shift;
+        double roiTop; //!< part of the height above the ROI
+        int64_t statisticsInterval; //!< [us]
+    } params;
+
+    // since the last statistics
+    int64_t lastStatistics;
+    int frames;
+    int skipped;
+    uint64_t bytes;
+    int64_t encodeMicros;
+};
+
+#endif // IMAGE_ENCODER_H
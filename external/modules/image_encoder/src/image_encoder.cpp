@@ -0,0 +1,106 @@
+#include "image_encoder.h"
+
+bool ImageEncoder::initialize() {
+    image = readChannel<lms::imaging::Image>("IMAGE");
+    link = readChannel<image_codec::LinkReport>("IMAGE_LINK");
+    encoded = writeChannel<image_codec::EncodedFrame>("IMAGE_ENCODED");
+    traceScope = cycle_trace::scope("image_encode");
+
+    configsChanged();
+    lastStatistics = cycle_trace::now() / 1000;
+    frames = 0;
+    skipped = 0;
+    bytes = 0;
+    encodeMicros = 0;
+    return true;
+}
+
+void ImageEncoder::configsChanged() {
+    std::string mode = config().get<std::string>("mode", "adaptive");
+    if(mode == "lossless") {
+        params.mode = Mode::LOSSLESS;
+    } else if(mode == "lossy") {
+        params.mode = Mode::LOSSY;
+    } else {
+        if(mode != "adaptive") {
+            logger.warn("config") << "Unknown mode " << mode << ", using adaptive";
+        }
+        params.mode = Mode::ADAPTIVE;
+    }
+    params.shift = config().get<int>("shift", 3);
+    params.roiTop = config().get<double>("roiTop", 0.33);
+    params.statisticsInterval = config().get<int64_t>("statisticsInterval", 5) * 1000000;
+
+    image_codec::RateOptions options;
+    options.maxBytesPerSecond = config().get<double>("maxBytesPerSecond", 0);
+    options.maxInFlight = config().get<int>("maxInFlight", 4);
+    options.holdFrames = config().get<int>("holdFrames", 10);
+    options.probeFrames = config().get<int>("probeFrames", 100);
+    options.staleMicros = config().get<int64_t>("staleMillis", 1000) * 1000;
+    controller.reset(new image_codec::RateController(options));
+}
+
+bool ImageEncoder::deinitialize() {
+    return true;
+}
+
+bool ImageEncoder::cycle() {
+    cycle_trace::Scope trace(traceScope);
+    int64_t now = cycle_trace::now() / 1000;
+    // the image enters the operator loop here, frame_to_actuator ends when
+    // car_to_senseboard2015 gets its sequence back in IMAGE_LINK
+    cycle_trace::frameCaptured(encoder.nextSequence());
+
+    image_codec::EncodeParams encodeParams;
+    switch(params.mode) {
+    case Mode::LOSSLESS:
+        break;
+    case Mode::LOSSY:
+        encodeParams.shift = params.shift;
+        break;
+    case Mode::ADAPTIVE:
+        controller->report(*link, now);
+        encodeParams = controller->params(encoder.nextSequence(),
+                                          static_cast<int>(image->height() * params.roiTop),
+                                          image->height(), now);
+        break;
+    }
+
+    int64_t start = cycle_trace::now();
+    int bytesPerPixel = lms::imaging::bpp(image->format());
+    if(! encoder.encode(image->data(), image->width(), image->height(),
+                        image->width() * bytesPerPixel, bytesPerPixel, encodeParams, &*encoded,
+                        static_cast<uint8_t>(image->format()))) {
+        logger.error("cycle") << "Cannot encode " << image->width() << "x" << image->height()
+                              << " image with " << bytesPerPixel << " bytes per pixel";
+        return true;
+    }
+    controller->sent(encoded->sequence, encoded->size(), now);
+
+    frames++;
+    bytes += encoded->size();
+    if(encoded->skipped()) {
+        skipped++;
+    } else {
+        encodeMicros += (cycle_trace::now() - start) / 1000;
+    }
+    if(now - lastStatistics >= params.statisticsInterval) {
+        logStatistics(now);
+    }
+    return true;
+}
+
+void ImageEncoder::logStatistics(int64_t now) {
+    int sent = frames - skipped;
+    logger.info("statistics") << frames << " frames, " << skipped << " skipped, "
+                              << (frames > 0 ? bytes / frames : 0) << " bytes/frame, encode "
+                              << (sent > 0 ? encodeMicros / sent : 0) << "us, level "
+                              << controller->level() << ", in flight " << controller->inFlight()
+                              << ", link " << static_cast<int>(controller->throughput() / 1000)
+                              << "kB/s";
+    lastStatistics = now;
+    frames = 0;
+    skipped = 0;
+    bytes = 0;
+    encodeMicros = 0;
+}
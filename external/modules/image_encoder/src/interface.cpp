@@ -0,0 +1,3 @@
+#include "image_encoder.h"
+
+LMS_MODULE_INTERFACE(ImageEncoder)
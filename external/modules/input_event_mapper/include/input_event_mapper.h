@@ -0,0 +1,34 @@
+#ifndef INPUT_EVENT_MAPPER_H
+#define INPUT_EVENT_MAPPER_H
+
+#include <string>
+#include <vector>
+
+#include <lms/datamanager.h>
+#include <lms/module.h>
+#include <input_events/input_events.h>
+
+/**
+ * @brief LMS module input_event_mapper
+ *
+ * Turns the string commands of ogre_input into typed input events, once per
+ * message instead of once per consumer.
+ **/
+class InputEventMapper : public lms::Module {
+public:
+    bool initialize() override;
+    bool deinitialize() override;
+    bool cycle() override;
+private:
+    /**
+     * @brief aliasKeys maps the contents of one section of the ogre_input
+     * key config (key.down or key.up) to the actions they name
+     */
+    void aliasKeys(const std::vector<std::string> &keys, const std::string &section);
+
+    lms::WriteDataChannel<input_events::InputEvents> events;
+    input_events::ActionTable table;
+    std::string command;
+};
+
+#endif // INPUT_EVENT_MAPPER_H
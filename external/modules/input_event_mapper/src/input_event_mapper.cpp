@@ -0,0 +1,50 @@
+#include "input_event_mapper.h"
+
+bool InputEventMapper::initialize() {
+    events = writeChannel<input_events::InputEvents>("INPUT_EVENTS");
+    command = config().get<std::string>("command", "car");
+    std::vector<std::string> keys = config().getArray<std::string>("keys");
+    aliasKeys(keys, "key.down.");
+    aliasKeys(keys, "key.up.");
+    return true;
+}
+
+bool InputEventMapper::deinitialize() {
+    return true;
+}
+
+void InputEventMapper::aliasKeys(const std::vector<std::string> &keys, const std::string &section) {
+    for(const std::string &key : keys) {
+        std::string prefix = section + key + ".";
+        std::string content = config().get<std::string>(prefix + "content", "");
+        if(content.empty() || config().get<std::string>(prefix + "command", "") != command) {
+            continue;
+        }
+        std::string name = config().get<std::string>(prefix + "action", content);
+        input_events::Action action = table.find(name);
+        if(action == input_events::Action::NONE) {
+            logger.warn("initialize") << prefix << "action " << name << " is no action";
+            continue;
+        }
+        table.alias(content, action);
+    }
+}
+
+bool InputEventMapper::cycle() {
+    events->clear();
+
+    for(const std::string &msg : messaging()->receive(command)) {
+        input_events::InputEvent event;
+        event.action = table.find(msg.data(), msg.size());
+        event.source = input_events::SOURCE_KEYBOARD;
+        event.value = 0;
+        if(event.action == input_events::Action::NONE) {
+            logger.debug("cycle") << "Unknown input " << msg;
+            continue;
+        }
+        if(! events->push(event)) {
+            logger.warn("cycle") << "Too many input events, dropped " << msg;
+        }
+    }
+    return true;
+}
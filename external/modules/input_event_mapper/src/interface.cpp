@@ -0,0 +1,3 @@
+#include "input_event_mapper.h"
+
+LMS_MODULE_INTERFACE(InputEventMapper)
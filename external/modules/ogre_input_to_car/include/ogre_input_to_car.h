@@ -4,6 +4,10 @@
 #include <lms/datamanager.h>
 #include <lms/module.h>
 #include <sensor_utils/car.h>
+#include <cycle_trace/trace.h>
+#include <input_events/input_events.h>
+#include <state_history/allocations.h>
+#include <state_history/state_history.h>
 
 /**
  * @brief LMS module ogre_input_to_car
@@ -13,10 +17,28 @@ public:
     bool initialize() override;
     bool deinitialize() override;
     bool cycle() override;
+    void configsChanged() override;
 private:
+    /**
+     * @brief Config values, read once instead of per cycle
+     */
+    struct Parameters {
+        float steeringAngle;
+        float acc;
+        float minSpeed;
+        float maxSpeed;
+    };
+    Parameters params;
+
     lms::extra::PrecisionTime lastCycle;
+    cycle_trace::ScopeId traceScope;
 
     lms::WriteDataChannel<sensor_utils::Car> car;
+    lms::WriteDataChannel<state_history::CarHistory> history;
+    lms::ReadDataChannel<input_events::InputEvents> inputEvents;
+
+    sensor_utils::Car::State state; //!< named once, refilled each cycle
+    state_history::SourceId source;
 
     float steering;
     float speed;
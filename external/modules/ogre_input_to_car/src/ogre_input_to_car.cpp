@@ -2,11 +2,18 @@
 
 bool OgreInputToCar::initialize() {
     car = writeChannel<sensor_utils::Car>("CAR");
+    history = writeChannel<state_history::CarHistory>("CAR_HISTORY");
+    inputEvents = readChannel<input_events::InputEvents>("INPUT_EVENTS");
+    configsChanged();
 
     steering = 0;
     speed = 0;
     accelerationState = 0;
+    // the name is the only part of the state that allocates
+    state.name = "keyboard";
+    source = state_history::intern(state.name);
     lastCycle = lms::extra::PrecisionTime::now();
+    traceScope = cycle_trace::scope(getName());
 
     return true;
 }
@@ -15,50 +22,72 @@ bool OgreInputToCar::deinitialize() {
     return true;
 }
 
-bool OgreInputToCar::cycle() {
-    sensor_utils::Car::State state;
+void OgreInputToCar::configsChanged() {
+    Parameters loaded;
+    loaded.steeringAngle = config().get<float>("steeringAngle", M_PI/8);
+    loaded.acc = config().get<float>("acc");
+    loaded.minSpeed = config().get<float>("minSpeed");
+    loaded.maxSpeed = config().get<float>("maxSpeed");
+    // a reload never leaves a mix of old and new values
+    params = loaded;
+}
 
-    float steeringAngle = config().get<float>("steeringAngle", M_PI/8);
+bool OgreInputToCar::cycle() {
+    cycle_trace::Scope trace(traceScope);
+    state_history::AllocationScope allocations;
 
-    for(const std::string &msg : messaging()->receive("car")) {
-        if(msg == "left") {
-            steering = steeringAngle;
-        } else if(msg == "right") {
-            steering = - steeringAngle;
-        } else if(msg == "acc_down") {
+    for(const input_events::InputEvent &event : *inputEvents) {
+        switch(event.action) {
+        case input_events::Action::LEFT:
+            steering = params.steeringAngle;
+            break;
+        case input_events::Action::RIGHT:
+            steering = - params.steeringAngle;
+            break;
+        case input_events::Action::ACC_DOWN:
             accelerationState = 1;
-        } else if(msg == "acc_up") {
-            accelerationState = 0;
-        } else if(msg == "break_down") {
+            break;
+        case input_events::Action::BREAK_DOWN:
             accelerationState = -1;
-        } else if(msg == "break_up") {
+            break;
+        case input_events::Action::ACC_UP:
+        case input_events::Action::BREAK_UP:
             accelerationState = 0;
-        } else if(msg == "right_up" || msg == "left_up") {
+            break;
+        case input_events::Action::LEFT_UP:
+        case input_events::Action::RIGHT_UP:
             steering = 0;
+            break;
+        default:
+            break;
         }
     }
 
     float t = lms::extra::PrecisionTime::since(lastCycle).toFloat();
     if(accelerationState != 0) {
-        speed = speed + accelerationState * config().get<float>("acc") * t;
+        speed = speed + accelerationState * params.acc * t;
     } else {
         speed = 0;
     }
 
-    float minSpeed = config().get<float>("minSpeed");
-    float maxSpeed = config().get<float>("maxSpeed");
+    speed = std::max(params.minSpeed, std::min(speed, params.maxSpeed));
 
-    speed = std::max(float(minSpeed), std::min(speed, float(maxSpeed)));
-
-    state.name = "keyboard";
     state.steering_front = steering;
     state.steering_rear = - steering;
     state.targetSpeed = speed;
     car->putState(state);
 
+    state_history::CarState &recent = history->push(lms::extra::PrecisionTime::now().micros(), source);
+    recent.steeringFront = state.steering_front;
+    recent.steeringRear = state.steering_rear;
+    recent.targetSpeed = state.targetSpeed;
+
     logger.debug() << speed << " " << steering;
 
     lastCycle = lms::extra::PrecisionTime::now();
 
+    if(allocations.count() > 0) {
+        logger.debug("allocations") << allocations.count() << " in cycle";
+    }
     return true;
 }
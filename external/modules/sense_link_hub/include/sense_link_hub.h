@@ -0,0 +1,44 @@
+#ifndef SENSE_LINK_HUB_H
+#define SENSE_LINK_HUB_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <lms/datamanager.h>
+#include <lms/module.h>
+#include <cycle_trace/trace.h>
+#include <sense_link_host/board_channels.h>
+#include <sense_link_host/serial_hub.h>
+
+/**
+ * @brief LMS module sense_link_hub
+ *
+ * Serves all Senseboards of the vehicle from one sense_link::SerialHub:
+ * one I/O thread reads every device and writes the batched actuator
+ * values, the cycle routes the messages into a sensor and an actuator
+ * channel per board.
+ **/
+class SenseLinkHub : public lms::Module {
+public:
+    bool initialize() override;
+    bool deinitialize() override;
+    bool cycle() override;
+private:
+    struct Board {
+        std::string name;
+        lms::WriteDataChannel<sense_link::BoardSensors> sensors;
+        lms::ReadDataChannel<sense_link::BoardActuators> actuators;
+    };
+
+    void logStatistics();
+
+    std::unique_ptr<sense_link::SerialHub> hub;
+    std::vector<Board> boards; //!< by hub board index
+    std::vector<sense_link::Sample> samples; //!< reused each cycle
+    cycle_trace::ScopeId traceScope;
+    int64_t statisticsInterval; //!< [us]
+    int64_t lastStatistics; //!< [us]
+};
+
+#endif // SENSE_LINK_HUB_H
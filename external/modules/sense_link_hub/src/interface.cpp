@@ -0,0 +1,3 @@
+#include "sense_link_hub.h"
+
+LMS_MODULE_INTERFACE(SenseLinkHub)
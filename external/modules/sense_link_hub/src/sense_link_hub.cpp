@@ -0,0 +1,145 @@
+#include "sense_link_hub.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+std::string channelPrefix(const std::string &board) {
+    std::string prefix = board;
+    std::transform(prefix.begin(), prefix.end(), prefix.begin(), [](unsigned char c) {
+        return static_cast<char>(std::toupper(c));
+    });
+    return prefix;
+}
+
+/**
+ * @return SensorType::__END__ for an unknown name
+ */
+sense_link::SensorType sensorType(const std::string &name) {
+    static const char *NAMES[] = {"unknown", "proximity", "gyroscope", "accelerometer", "magnetometer",
+                                  "orientation", "servo", "motor", "led", "mouse", "sbus"};
+    static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == static_cast<size_t>(sense_link::SensorType::__END__),
+                  "NAMES must contain one entry per SensorType");
+    for(size_t i = 0; i < sizeof(NAMES) / sizeof(NAMES[0]); i++) {
+        if(name == NAMES[i]) {
+            return static_cast<sense_link::SensorType>(i);
+        }
+    }
+    return sense_link::SensorType::__END__;
+}
+
+}  // namespace
+
+bool SenseLinkHub::initialize() {
+    std::vector<std::string> names = config().getArray<std::string>("boards");
+    std::vector<std::string> devices = config().getArray<std::string>("devices");
+    if(names.empty() || names.size() != devices.size()) {
+        logger.error("init") << "boards and devices need one entry per board";
+        return false;
+    }
+
+    sense_link::HubOptions hubOptions;
+    hubOptions.syncInterval = config().get<int64_t>("syncInterval", 1000) * 1000;
+    hubOptions.reconnectInterval = config().get<int64_t>("reconnectInterval", 1000) * 1000;
+    hub.reset(new sense_link::SerialHub(hubOptions));
+
+    std::string checksum = config().get<std::string>("checksum", "crc8");
+    if(checksum != "crc8" && checksum != "crc32c") {
+        logger.error("init") << "Unknown checksum " << checksum;
+        return false;
+    }
+    for(size_t i = 0; i < names.size(); i++) {
+        sense_link::BoardOptions options;
+        options.name = names[i];
+        options.device = devices[i];
+        options.baudRate = config().get<int>("baudRate", 115200);
+        options.checksum = checksum == "crc32c" ? sense_link::ChecksumMode::CRC32C
+                                                : sense_link::ChecksumMode::CRC8;
+        options.batch = config().get<bool>("batch", true);
+        hub->addBoard(options);
+
+        std::string prefix = channelPrefix(names[i]);
+        Board board;
+        board.name = names[i];
+        board.sensors = writeChannel<sense_link::BoardSensors>(prefix + "_SENSORS");
+        board.actuators = readChannel<sense_link::BoardActuators>(prefix + "_ACTUATORS");
+        boards.push_back(board);
+    }
+
+    // board:sensor:id, e.g. car:gyroscope:1
+    unsigned int historySize = config().get<unsigned int>("historySize", 1024);
+    for(const std::string &entry : config().getArray<std::string>("history")) {
+        size_t first = entry.find(':');
+        size_t second = entry.find(':', first + 1);
+        int index = first == std::string::npos ? -1 : hub->board(entry.substr(0, first));
+        sense_link::SensorType type = second == std::string::npos ? sense_link::SensorType::__END__
+                : sensorType(entry.substr(first + 1, second - first - 1));
+        if(index == -1 || type == sense_link::SensorType::__END__) {
+            logger.error("init") << "Invalid history entry " << entry;
+            return false;
+        }
+        uint8_t id = static_cast<uint8_t>(std::atoi(entry.c_str() + second + 1));
+        boards[index].sensors->addHistory(type, id, &hub->keepHistory(index, type, id, historySize));
+    }
+
+    std::string error;
+    if(! hub->start(&error)) {
+        logger.error("init") << error;
+        return false;
+    }
+    for(size_t i = 0; i < boards.size(); i++) {
+        if(! hub->stats(i).connected) {
+            // retried by the I/O thread, the other boards run meanwhile
+            logger.warn("init") << "Could not open " << devices[i] << " of " << names[i];
+        }
+    }
+
+    traceScope = cycle_trace::scope(getName());
+    statisticsInterval = config().get<int64_t>("statisticsInterval", 10) * 1000000;
+    lastStatistics = sense_link::hostMicros();
+    return true;
+}
+
+bool SenseLinkHub::deinitialize() {
+    logStatistics();
+    hub->stop();
+    return true;
+}
+
+bool SenseLinkHub::cycle() {
+    cycle_trace::Scope trace(traceScope);
+    for(size_t i = 0; i < boards.size(); i++) {
+        Board &board = boards[i];
+        board.sensors->clear();
+        hub->receive(i, &samples);
+        for(const sense_link::Sample &sample : samples) {
+            board.sensors->add(sample);
+        }
+
+        const std::vector<sense_link::Message> &messages = board.actuators->messages();
+        if(! messages.empty()) {
+            hub->send(i, messages.data(), messages.size());
+        }
+    }
+
+    int64_t now = sense_link::hostMicros();
+    if(statisticsInterval > 0 && now - lastStatistics >= statisticsInterval) {
+        logStatistics();
+        lastStatistics = now;
+    }
+    return true;
+}
+
+void SenseLinkHub::logStatistics() {
+    for(size_t i = 0; i < boards.size(); i++) {
+        sense_link::BoardStats stats = hub->stats(i);
+        logger.debug("statistics") << boards[i].name << (stats.connected ? "" : " (disconnected)")
+                                   << ": received " << stats.received << ", dropped " << stats.dropped
+                                   << ", sent " << stats.sent << " in " << stats.frames
+                                   << " frames, write errors " << stats.writeErrors
+                                   << ", reconnects " << stats.reconnects;
+    }
+    logger.debug("statistics") << "I/O thread wakeups " << hub->wakeups();
+}
@@ -0,0 +1,38 @@
+#ifndef SHM_CHANNEL_RECEIVER_H
+#define SHM_CHANNEL_RECEIVER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <lms/datamanager.h>
+#include <lms/module.h>
+#include <shm_channel/channel.h>
+
+/**
+ * @brief LMS module shm_channel_receiver
+ *
+ * Deserializes the newest value of data channels a shm_channel_sender of
+ * another framework on the same machine wrote, in place of
+ * socket_data_receiver.
+ **/
+class ShmChannelReceiver : public lms::Module {
+public:
+    bool initialize() override;
+    bool deinitialize() override;
+    bool cycle() override;
+private:
+    struct Channel {
+        std::string name;
+        shm_channel::Reader reader;
+        uint64_t missed;
+    };
+
+    bool open(Channel &channel);
+
+    std::vector<std::unique_ptr<Channel>> channels;
+    std::string prefix;
+    int timeout;
+};
+
+#endif // SHM_CHANNEL_RECEIVER_H
@@ -0,0 +1,3 @@
+#include "shm_channel_receiver.h"
+
+LMS_MODULE_INTERFACE(ShmChannelReceiver)
@@ -0,0 +1,68 @@
+#include "shm_channel_receiver.h"
+
+#include <istream>
+
+#include <shm_channel/memory_buffer.h>
+
+bool ShmChannelReceiver::initialize() {
+    prefix = config().get<std::string>("prefix", "lms_");
+    timeout = config().get<int>("timeout", 0);
+
+    for(const std::string &name : config().getArray<std::string>("dataChannels")) {
+        std::unique_ptr<Channel> channel(new Channel);
+        channel->name = name;
+        channel->missed = 0;
+        // the sender may start later, cycle() opens the channel then
+        open(*channel);
+        channels.push_back(std::move(channel));
+    }
+    return true;
+}
+
+bool ShmChannelReceiver::deinitialize() {
+    channels.clear();
+    return true;
+}
+
+bool ShmChannelReceiver::open(Channel &channel) {
+    std::string error;
+    if(! channel.reader.open(prefix + channel.name, &error)) {
+        logger.debug("open") << "Channel " << channel.name << " not available: " << error;
+        return false;
+    }
+    logger.info("open") << "Receiving " << channel.name;
+    channel.missed = 0;
+    return true;
+}
+
+bool ShmChannelReceiver::cycle() {
+    for(size_t i = 0; i < channels.size(); i++) {
+        Channel &channel = *channels[i];
+        if(! channel.reader.isOpen() && ! open(channel)) {
+            continue;
+        }
+        // wait for the first channel only, the cycle follows its sender
+        if(i == 0 && timeout > 0) {
+            channel.reader.wait(timeout);
+        }
+
+        const uint8_t *data;
+        uint32_t length;
+        if(! channel.reader.acquire(&data, &length)) {
+            continue;
+        }
+        shm_channel::MemoryBuffer buffer(data, length);
+        std::istream stream(&buffer);
+        if(! datamanager()->deserializeChannel(this, channel.name, stream)) {
+            logger.error("cycle") << "Could not deserialize " << channel.name;
+        }
+        channel.reader.release();
+
+        if(channel.reader.missed() != channel.missed) {
+            logger.debug("cycle") << channel.name << ": " << channel.reader.missed() - channel.missed
+                                  << " messages superseded before this cycle";
+            channel.missed = channel.reader.missed();
+        }
+    }
+    return true;
+}
@@ -0,0 +1,32 @@
+#ifndef SHM_CHANNEL_SENDER_H
+#define SHM_CHANNEL_SENDER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <lms/datamanager.h>
+#include <lms/module.h>
+#include <shm_channel/channel.h>
+
+/**
+ * @brief LMS module shm_channel_sender
+ *
+ * Serializes data channels into shared memory for a shm_channel_receiver in
+ * another framework on the same machine, in place of socket_data_sender.
+ **/
+class ShmChannelSender : public lms::Module {
+public:
+    bool initialize() override;
+    bool deinitialize() override;
+    bool cycle() override;
+private:
+    struct Channel {
+        std::string name;
+        shm_channel::Writer writer;
+    };
+
+    std::vector<std::unique_ptr<Channel>> channels;
+};
+
+#endif // SHM_CHANNEL_SENDER_H
@@ -0,0 +1,3 @@
+#include "shm_channel_sender.h"
+
+LMS_MODULE_INTERFACE(ShmChannelSender)
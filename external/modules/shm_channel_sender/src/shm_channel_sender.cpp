@@ -0,0 +1,50 @@
+#include "shm_channel_sender.h"
+
+#include <ostream>
+
+#include <shm_channel/memory_buffer.h>
+
+bool ShmChannelSender::initialize() {
+    std::string prefix = config().get<std::string>("prefix", "lms_");
+    uint32_t slotSize = config().get<uint32_t>("slotSize", 1048576);
+    uint32_t slots = config().get<uint32_t>("slots", 4);
+
+    for(const std::string &name : config().getArray<std::string>("dataChannels")) {
+        std::unique_ptr<Channel> channel(new Channel);
+        channel->name = name;
+        std::string error;
+        if(! channel->writer.open(prefix + name, slotSize, slots, &error)) {
+            logger.error("init") << "Could not create channel " << name << ": " << error;
+            return false;
+        }
+        channels.push_back(std::move(channel));
+    }
+    return true;
+}
+
+bool ShmChannelSender::deinitialize() {
+    channels.clear();
+    return true;
+}
+
+bool ShmChannelSender::cycle() {
+    for(std::unique_ptr<Channel> &channel : channels) {
+        uint8_t *slot = channel->writer.begin();
+        if(slot == nullptr) {
+            logger.warn("cycle") << "All slots of " << channel->name << " are held by readers";
+            continue;
+        }
+
+        // serialized straight into the slot, no copy in between
+        shm_channel::MemoryBuffer buffer(slot, channel->writer.capacity());
+        std::ostream stream(&buffer);
+        if(! datamanager()->serializeChannel(this, channel->name, stream) || ! stream) {
+            logger.error("cycle") << "Could not serialize " << channel->name
+                                  << ", larger than slotSize?";
+            channel->writer.abort();
+            continue;
+        }
+        channel->writer.commit(static_cast<uint32_t>(buffer.written()));
+    }
+    return true;
+}
@@ -0,0 +1,259 @@
+#include "checksum.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define SENSE_LINK_CRC32C_SSE42
+#endif
+
+#if !defined(__AVR__)
+// Lookup tables of several KB, too large for the boards
+#define SENSE_LINK_CRC_SLICING
+#endif
+
+namespace sense_link {
+
+/**
+  * CRC-8 lookup table
+  */
+static const uint8_t table[] =
+{0x00, 0x5e, 0xbc, 0xe2, 0x61, 0x3f, 0xdd, 0x83,
+0xc2, 0x9c, 0x7e, 0x20, 0xa3, 0xfd, 0x1f, 0x41,
+0x9d, 0xc3, 0x21, 0x7f, 0xfc, 0xa2, 0x40, 0x1e,
+0x5f, 0x01, 0xe3, 0xbd, 0x3e, 0x60, 0x82, 0xdc,
+0x23, 0x7d, 0x9f, 0xc1, 0x42, 0x1c, 0xfe, 0xa0,
+0xe1, 0xbf, 0x5d, 0x03, 0x80, 0xde, 0x3c, 0x62,
+0xbe, 0xe0, 0x02, 0x5c, 0xdf, 0x81, 0x63, 0x3d,
+0x7c, 0x22, 0xc0, 0x9e, 0x1d, 0x43, 0xa1, 0xff,
+0x46, 0x18, 0xfa, 0xa4, 0x27, 0x79, 0x9b, 0xc5,
+0x84, 0xda, 0x38, 0x66, 0xe5, 0xbb, 0x59, 0x07,
+0xdb, 0x85, 0x67, 0x39, 0xba, 0xe4, 0x06, 0x58,
+0x19, 0x47, 0xa5, 0xfb, 0x78, 0x26, 0xc4, 0x9a,
+0x65, 0x3b, 0xd9, 0x87, 0x04, 0x5a, 0xb8, 0xe6,
+0xa7, 0xf9, 0x1b, 0x45, 0xc6, 0x98, 0x7a, 0x24,
+0xf8, 0xa6, 0x44, 0x1a, 0x99, 0xc7, 0x25, 0x7b,
+0x3a, 0x64, 0x86, 0xd8, 0x5b, 0x05, 0xe7, 0xb9,
+0x8c, 0xd2, 0x30, 0x6e, 0xed, 0xb3, 0x51, 0x0f,
+0x4e, 0x10, 0xf2, 0xac, 0x2f, 0x71, 0x93, 0xcd,
+0x11, 0x4f, 0xad, 0xf3, 0x70, 0x2e, 0xcc, 0x92,
+0xd3, 0x8d, 0x6f, 0x31, 0xb2, 0xec, 0x0e, 0x50,
+0xaf, 0xf1, 0x13, 0x4d, 0xce, 0x90, 0x72, 0x2c,
+0x6d, 0x33, 0xd1, 0x8f, 0x0c, 0x52, 0xb0, 0xee,
+0x32, 0x6c, 0x8e, 0xd0, 0x53, 0x0d, 0xef, 0xb1,
+0xf0, 0xae, 0x4c, 0x12, 0x91, 0xcf, 0x2d, 0x73,
+0xca, 0x94, 0x76, 0x28, 0xab, 0xf5, 0x17, 0x49,
+0x08, 0x56, 0xb4, 0xea, 0x69, 0x37, 0xd5, 0x8b,
+0x57, 0x09, 0xeb, 0xb5, 0x36, 0x68, 0x8a, 0xd4,
+0x95, 0xcb, 0x29, 0x77, 0xf4, 0xaa, 0x48, 0x16,
+0xe9, 0xb7, 0x55, 0x0b, 0x88, 0xd6, 0x34, 0x6a,
+0x2b, 0x75, 0x97, 0xc9, 0x4a, 0x14, 0xf6, 0xa8,
+0x74, 0x2a, 0xc8, 0x96, 0x15, 0x4b, 0xa9, 0xf7,
+0xb6, 0xe8, 0x0a, 0x54, 0xd7, 0x89, 0x6b, 0x35,
+};
+
+/**
+  * CRC-32C polynomial (reversed representation)
+  */
+static const uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+#ifdef SENSE_LINK_CRC_SLICING
+
+namespace {
+
+/**
+ * @brief Tables for slice-by-4 CRC-8: slices[k][x] is the CRC-8 state after
+ * processing the byte x followed by k zero bytes.
+ */
+struct Crc8Slices {
+    uint8_t slices[4][256];
+
+    Crc8Slices() {
+        for(int i = 0; i < 256; i++) {
+            slices[0][i] = table[i];
+        }
+        for(int k = 1; k < 4; k++) {
+            for(int i = 0; i < 256; i++) {
+                slices[k][i] = table[slices[k - 1][i]];
+            }
+        }
+    }
+};
+
+/**
+ * @brief Tables for slice-by-8 CRC-32C
+ */
+struct Crc32cSlices {
+    uint32_t slices[8][256];
+
+    Crc32cSlices() {
+        for(uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for(int bit = 0; bit < 8; bit++) {
+                crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+            }
+            slices[0][i] = crc;
+        }
+        for(int k = 1; k < 8; k++) {
+            for(int i = 0; i < 256; i++) {
+                slices[k][i] = (slices[k - 1][i] >> 8) ^ slices[0][slices[k - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+const Crc8Slices& crc8Slices() {
+    static const Crc8Slices tables;
+    return tables;
+}
+
+const Crc32cSlices& crc32cSlices() {
+    static const Crc32cSlices tables;
+    return tables;
+}
+
+inline uint32_t readLittleEndian32(const uint8_t *data) {
+    return (uint32_t) data[0] | ((uint32_t) data[1] << 8)
+            | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+uint32_t crc32cSoftware(uint32_t crc, const uint8_t *data, unsigned int len) {
+    const Crc32cSlices &t = crc32cSlices();
+    for(; len >= 8; len -= 8, data += 8) {
+        uint32_t low = crc ^ readLittleEndian32(data);
+        uint32_t high = readLittleEndian32(data + 4);
+        crc = t.slices[7][low & 0xFF] ^ t.slices[6][(low >> 8) & 0xFF]
+                ^ t.slices[5][(low >> 16) & 0xFF] ^ t.slices[4][low >> 24]
+                ^ t.slices[3][high & 0xFF] ^ t.slices[2][(high >> 8) & 0xFF]
+                ^ t.slices[1][(high >> 16) & 0xFF] ^ t.slices[0][high >> 24];
+    }
+    for(; len; len--, data++) {
+        crc = (crc >> 8) ^ t.slices[0][(crc ^ *data) & 0xFF];
+    }
+    return crc;
+}
+
+#ifdef SENSE_LINK_CRC32C_SSE42
+__attribute__((target("sse4.2")))
+uint32_t crc32cHardware(uint32_t crc, const uint8_t *data, unsigned int len) {
+    uint64_t crc64 = crc;
+    for(; len >= 8; len -= 8, data += 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = (uint32_t) crc64;
+    for(; len; len--, data++) {
+        crc = _mm_crc32_u8(crc, *data);
+    }
+    return crc;
+}
+
+bool hasCrc32Instruction() {
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+}
+#endif
+
+}  // namespace
+
+#else
+
+namespace {
+
+/**
+ * @brief CRC-32C of a single nibble, 64 bytes instead of a 1 KB table
+ */
+uint32_t crc32cNibble(uint8_t nibble) {
+    uint32_t crc = nibble;
+    for(int bit = 0; bit < 4; bit++) {
+        crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+    }
+    return crc;
+}
+
+uint32_t crc32cSoftware(uint32_t crc, const uint8_t *data, unsigned int len) {
+    static uint32_t nibbles[16];
+    static bool initialized = false;
+    if(! initialized) {
+        for(uint8_t i = 0; i < 16; i++) {
+            nibbles[i] = crc32cNibble(i);
+        }
+        initialized = true;
+    }
+
+    for(; len; len--, data++) {
+        crc = (crc >> 4) ^ nibbles[(crc ^ *data) & 0x0F];
+        crc = (crc >> 4) ^ nibbles[(crc ^ (*data >> 4)) & 0x0F];
+    }
+    return crc;
+}
+
+}  // namespace
+
+#endif
+
+/**
+  Return CRC-8 of the data (cyclic redundancy check) - message validity
+ * @brief crc8
+ * @param vptr begin of data
+ * @param len length of data
+ * @return CRC-8 value
+ */
+uint8_t crc8(const char *vptr, unsigned int len) {
+    const uint8_t *data = (const uint8_t*)vptr;
+    uint8_t crc = 0xde;
+#ifdef SENSE_LINK_CRC_SLICING
+    // four independent lookups per step instead of one dependent lookup per byte
+    const Crc8Slices &t = crc8Slices();
+    for (; len >= 4; len -= 4, data += 4) {
+        crc = t.slices[3][crc ^ data[0]] ^ t.slices[2][data[1]]
+                ^ t.slices[1][data[2]] ^ t.slices[0][data[3]];
+    }
+#endif
+    for (; len; len--, data++) {
+        crc = table[crc ^ *data];
+    }
+
+    return crc;
+}
+
+/**
+  Return CRC-32C of the data, uses the SSE4.2 crc32 instruction if available
+ * @brief crc32c
+ * @param vptr begin of data
+ * @param len length of data
+ * @return CRC-32C value
+ */
+uint32_t crc32c(const char *vptr, unsigned int len) {
+    const uint8_t *data = (const uint8_t*)vptr;
+#ifdef SENSE_LINK_CRC32C_SSE42
+    if(hasCrc32Instruction()) {
+        return ~crc32cHardware(0xFFFFFFFF, data, len);
+    }
+#endif
+    return ~crc32cSoftware(0xFFFFFFFF, data, len);
+}
+
+uint8_t writeChecksum(ChecksumMode mode, char *data, unsigned int len) {
+    if(mode == ChecksumMode::CRC32C) {
+        uint32_t crc = crc32c(data, len);
+        memcpy(data + len, &crc, sizeof(crc));
+        return sizeof(crc);
+    }
+
+    data[len] = crc8(data, len);
+    return 1;
+}
+
+bool verifyChecksum(ChecksumMode mode, const char *data, unsigned int len) {
+    if(mode == ChecksumMode::CRC32C) {
+        uint32_t sent;
+        memcpy(&sent, data + len, sizeof(sent));
+        return crc32c(data, len) == sent;
+    }
+
+    return crc8(data, len) == static_cast<uint8_t>(data[len]);
+}
+
+}  // namespace sense_link
@@ -0,0 +1,51 @@
+#ifndef SENSE_LINK_CHECKSUM_H
+#define SENSE_LINK_CHECKSUM_H
+
+#include <stdint.h>
+
+namespace sense_link {
+
+/**
+ * @brief Checksum appended to every message
+ *
+ * Every link starts with CRC8. A wider checksum is negotiated with a
+ * MessageType::CHECKSUM_MODE message, boards that do not know the message
+ * keep using CRC8.
+ */
+enum class ChecksumMode : uint8_t {
+    CRC8 = 0, //!< 1 byte CRC-8 (Dallas/Maxim)
+    CRC32C = 1, //!< 4 byte CRC-32C (Castagnoli)
+    __END__ // ChecksumMode counter, must be LAST
+};
+
+/**
+ * @brief checksumSize returns the number of checksum bytes of a mode
+ */
+inline uint8_t checksumSize(ChecksumMode mode) {
+    return mode == ChecksumMode::CRC32C ? 4 : 1;
+}
+
+uint8_t crc8(const char *vptr, unsigned int len);
+uint32_t crc32c(const char *vptr, unsigned int len);
+
+/**
+ * @brief writeChecksum computes the checksum of data and appends it
+ * @param mode checksum mode
+ * @param data begin of data
+ * @param len length of data
+ * @return number of checksum bytes written after data
+ */
+uint8_t writeChecksum(ChecksumMode mode, char *data, unsigned int len);
+
+/**
+ * @brief verifyChecksum compares the checksum of data with the one appended
+ * @param mode checksum mode
+ * @param data begin of data
+ * @param len length of data (without checksum)
+ * @return true if the checksums match
+ */
+bool verifyChecksum(ChecksumMode mode, const char *data, unsigned int len);
+
+}  // namespace sense_link
+
+#endif /* SENSE_LINK_CHECKSUM_H */
@@ -0,0 +1,269 @@
+#include "compact.h"
+
+#include <string.h>
+
+namespace sense_link {
+
+namespace {
+
+/**
+ * @brief Longest varint of a 32 bit value (7 bits per byte)
+ */
+const uint8_t MAX_VARINT_SIZE = 5;
+
+/**
+ * @brief loadField reads a payload field of 1, 2 or 4 bytes
+ */
+inline uint32_t loadField(const char* field, uint8_t width) {
+    switch(width) {
+    case 1:
+        return static_cast<uint8_t>(*field);
+    case 2: {
+        uint16_t value;
+        memcpy(&value, field, sizeof(value));
+        return value;
+    }
+    default: {
+        uint32_t value;
+        memcpy(&value, field, sizeof(value));
+        return value;
+    }
+    }
+}
+
+/**
+ * @brief storeField writes a payload field of 1, 2 or 4 bytes, the value is
+ * truncated to the field width
+ */
+inline void storeField(char* field, uint8_t width, uint32_t value) {
+    switch(width) {
+    case 1:
+        *field = static_cast<char>(value);
+        break;
+    case 2: {
+        uint16_t truncated = static_cast<uint16_t>(value);
+        memcpy(field, &truncated, sizeof(truncated));
+        break;
+    }
+    default:
+        memcpy(field, &value, sizeof(value));
+        break;
+    }
+}
+
+/**
+ * @brief signExtend interprets a field value as two's complement number of
+ * the field width, so a delta of -1 in a 16 bit field stays small
+ */
+inline int32_t signExtend(uint32_t value, uint8_t width) {
+    switch(width) {
+    case 1:
+        return static_cast<int8_t>(value);
+    case 2:
+        return static_cast<int16_t>(value);
+    default:
+        return static_cast<int32_t>(value);
+    }
+}
+
+inline uint32_t zigZag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+inline int32_t unZigZag(uint32_t value) {
+    return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+/**
+ * @brief slotFor looks up the slot of a stream
+ * @param slots slots to search
+ * @param message message of the stream
+ * @param create take a free slot if the stream has none yet
+ * @return slot of the stream, 0 if it has none
+ */
+CompactSlot* slotFor(CompactSlot* slots, const Message* message, bool create) {
+    CompactSlot* free = 0;
+    for(uint8_t i = 0; i < COMPACT_SLOTS; i++) {
+        CompactSlot* slot = &slots[i];
+        if(! slot->used) {
+            if(free == 0) {
+                free = slot;
+            }
+        } else if(slot->last.sensor == message->sensor && slot->last.id == message->id) {
+            return slot;
+        }
+    }
+
+    if(create && free != 0) {
+        free->used = true;
+        free->valid = false;
+        free->sinceKeyframe = 0;
+        return free;
+    }
+    return 0;
+}
+
+}  // namespace
+
+uint8_t writeDeltaPayload(const PayloadLayout* layout, const Message* message, char* buffer) {
+    const char* base = reinterpret_cast<const char*>(message);
+    char* start = buffer;
+
+    for(uint8_t i = 0; i < layout->count; i++) {
+        const FieldLayout& field = layout->fields[i];
+        uint32_t value = zigZag(signExtend(loadField(base + field.offset, field.width), field.width));
+        while(value >= 0x80) {
+            *buffer++ = static_cast<char>(value | 0x80);
+            value >>= 7;
+        }
+        *buffer++ = static_cast<char>(value);
+    }
+
+    return buffer - start;
+}
+
+uint8_t deltaPayloadLength(const PayloadLayout* layout, const Message* message) {
+    const char* base = reinterpret_cast<const char*>(message);
+    uint8_t length = 0;
+
+    for(uint8_t i = 0; i < layout->count; i++) {
+        const FieldLayout& field = layout->fields[i];
+        uint32_t value = zigZag(signExtend(loadField(base + field.offset, field.width), field.width));
+        for(length++; value >= 0x80; value >>= 7) {
+            length++;
+        }
+    }
+
+    return length;
+}
+
+uint8_t readDeltaPayload(const PayloadLayout* layout, Message* message, const char* buffer) {
+    char* base = reinterpret_cast<char*>(message);
+    const char* start = buffer;
+
+    for(uint8_t i = 0; i < layout->count; i++) {
+        const FieldLayout& field = layout->fields[i];
+        uint32_t value = 0;
+        uint8_t shift = 0;
+        uint8_t byte;
+        do {
+            byte = *buffer++;
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            shift += 7;
+        } while(byte & 0x80);
+        storeField(base + field.offset, field.width, static_cast<uint32_t>(unZigZag(value)));
+    }
+
+    return buffer - start;
+}
+
+int deltaPayloadSize(const PayloadLayout* layout, const char* buffer, unsigned int available) {
+    unsigned int size = 0;
+
+    for(uint8_t i = 0; i < layout->count; i++) {
+        uint8_t length = 0;
+        do {
+            if(size >= available || length == MAX_VARINT_SIZE) {
+                return -1;
+            }
+            length++;
+        } while(buffer[size++] & 0x80);
+    }
+
+    return size;
+}
+
+CompactEncoder::CompactEncoder(uint8_t keyframeInterval)
+    : keyframeInterval(keyframeInterval) {
+    memset(slots, 0, sizeof(slots));
+}
+
+void CompactEncoder::encode(const Message& sample, Message* out) {
+    *out = sample;
+    out->message = MessageType::SENSOR_DATA;
+
+    CompactSlot* slot = slotFor(slots, &sample, true);
+    if(slot == 0) {
+        // no slot left, the stream is sent uncompressed
+        return;
+    }
+
+    if(slot->valid && sample.sequence == static_cast<uint8_t>(slot->last.sequence + 1)
+            && slot->sinceKeyframe + 1 < keyframeInterval) {
+        const PayloadLayout* layout = payloadLayout(MessageType::SENSOR_DATA,
+                                                    static_cast<uint8_t>(sample.sensor));
+        const char* current = reinterpret_cast<const char*>(&sample);
+        const char* previous = reinterpret_cast<const char*>(&slot->last);
+        char* delta = reinterpret_cast<char*>(out);
+        for(uint8_t i = 0; i < layout->count; i++) {
+            const FieldLayout& field = layout->fields[i];
+            storeField(delta + field.offset, field.width,
+                       loadField(current + field.offset, field.width)
+                       - loadField(previous + field.offset, field.width));
+        }
+        out->message = MessageType::SENSOR_DATA_DELTA;
+        slot->sinceKeyframe++;
+    } else {
+        slot->sinceKeyframe = 0;
+    }
+
+    slot->last = sample;
+    slot->valid = true;
+}
+
+void CompactEncoder::forceKeyframes() {
+    for(uint8_t i = 0; i < COMPACT_SLOTS; i++) {
+        slots[i].valid = false;
+    }
+}
+
+CompactDecoder::CompactDecoder() {
+    memset(slots, 0, sizeof(slots));
+    memset(&statistics, 0, sizeof(statistics));
+}
+
+bool CompactDecoder::decode(Message* message) {
+    if(message->message == MessageType::SENSOR_DATA) {
+        statistics.keyframes++;
+        CompactSlot* slot = slotFor(slots, message, true);
+        if(slot != 0) {
+            slot->last = *message;
+            slot->valid = true;
+        }
+        return true;
+    }
+
+    if(message->message != MessageType::SENSOR_DATA_DELTA) {
+        return true;
+    }
+
+    CompactSlot* slot = slotFor(slots, message, false);
+    if(slot == 0 || ! slot->valid
+            || message->sequence != static_cast<uint8_t>(slot->last.sequence + 1)) {
+        // a sample is missing, wait for the next keyframe
+        if(slot != 0 && slot->valid) {
+            slot->valid = false;
+            statistics.gaps++;
+        }
+        statistics.dropped++;
+        return false;
+    }
+
+    const PayloadLayout* layout = payloadLayout(MessageType::SENSOR_DATA,
+                                                static_cast<uint8_t>(message->sensor));
+    const char* previous = reinterpret_cast<const char*>(&slot->last);
+    char* current = reinterpret_cast<char*>(message);
+    for(uint8_t i = 0; i < layout->count; i++) {
+        const FieldLayout& field = layout->fields[i];
+        storeField(current + field.offset, field.width,
+                   loadField(previous + field.offset, field.width)
+                   + loadField(current + field.offset, field.width));
+    }
+    message->message = MessageType::SENSOR_DATA;
+
+    slot->last = *message;
+    statistics.deltas++;
+    return true;
+}
+
+}  // namespace sense_link
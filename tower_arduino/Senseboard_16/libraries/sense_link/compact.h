@@ -0,0 +1,158 @@
+#ifndef SENSE_LINK_COMPACT_H
+#define SENSE_LINK_COMPACT_H
+
+#include <stdint.h>
+
+#include "message.h"
+
+namespace sense_link {
+
+/**
+ * @brief Number of (SensorType, id) streams tracked by CompactEncoder and
+ * CompactDecoder
+ */
+const uint8_t COMPACT_SLOTS = 8;
+
+/**
+ * @brief Default number of samples per stream between two keyframes
+ */
+const uint8_t COMPACT_KEYFRAME_INTERVAL = 50;
+
+/**
+ * Compact sensor encoding
+ *
+ * A stream of samples of one (SensorType, id) is sent as a SENSOR_DATA
+ * keyframe followed by SENSOR_DATA_DELTA messages. A delta message carries
+ * the difference to the previous sample of the stream for every payload field,
+ * zig-zag encoded as a varint, so small changes take one byte per field.
+ *
+ * The sequence number is given by the sender, e.g. the sequence of the
+ * BATCH the samples are streamed in. A delta is applied only if it directly
+ * follows the previous sample, otherwise the stream is dropped until the
+ * next keyframe.
+ *
+ * SENSOR_DATA_DELTA messages are sent as single frames or as BATCH entries.
+ * Only messages of the encoded stream may be given to CompactDecoder: a
+ * SENSOR_DATA reply to SENSOR_GET is not part of it.
+ */
+
+/**
+ * @brief writeDeltaPayload encodes the fields of a SENSOR_DATA_DELTA message
+ * as zig-zag varints
+ * @param layout payload layout of the sensor
+ * @param message message holding the field deltas
+ * @param buffer write target
+ * @return number of bytes written
+ */
+uint8_t writeDeltaPayload(const PayloadLayout* layout, const Message* message, char* buffer);
+
+/**
+ * @brief deltaPayloadLength computes the size writeDeltaPayload will write
+ * @param layout payload layout of the sensor
+ * @param message message holding the field deltas
+ * @return size of the payload (bytes)
+ */
+uint8_t deltaPayloadLength(const PayloadLayout* layout, const Message* message);
+
+/**
+ * @brief readDeltaPayload decodes the zig-zag varint fields of a
+ * SENSOR_DATA_DELTA message, the payload must have been checked by
+ * deltaPayloadSize
+ * @param layout payload layout of the sensor
+ * @param message message receiving the field deltas
+ * @param buffer reading source
+ * @return number of bytes read
+ */
+uint8_t readDeltaPayload(const PayloadLayout* layout, Message* message, const char* buffer);
+
+/**
+ * @brief deltaPayloadSize walks the varints of a SENSOR_DATA_DELTA payload
+ * @param layout payload layout of the sensor
+ * @param buffer begin of the payload
+ * @param available number of bytes available
+ * @return size of the payload (bytes), -1 if it is truncated or malformed
+ */
+int deltaPayloadSize(const PayloadLayout* layout, const char* buffer, unsigned int available);
+
+/**
+ * @brief State of one (SensorType, id) stream
+ */
+struct CompactSlot {
+    bool used;
+    bool valid; //!< decoder: last is the current value of the stream
+    uint8_t sinceKeyframe; //!< encoder: samples sent since the last keyframe
+    Message last; //!< last sample of the stream (absolute values)
+};
+
+/**
+ * @brief The CompactEncoder class
+ *
+ * Turns SENSOR_DATA samples into keyframes and SENSOR_DATA_DELTA messages.
+ * Streams beyond COMPACT_SLOTS are always sent as keyframes.
+ */
+class CompactEncoder {
+public:
+    explicit CompactEncoder(uint8_t keyframeInterval = COMPACT_KEYFRAME_INTERVAL);
+
+    /**
+     * @brief encode chooses the message to send for a sample. A delta is
+     * only sent if the sequence directly follows the previous sample of the
+     * stream, so a sensor skipped in a batch gets a keyframe next time.
+     * @param sample SENSOR_DATA message with absolute values and the sequence
+     * number it is sent with
+     * @param out SENSOR_DATA keyframe or SENSOR_DATA_DELTA message (result)
+     */
+    void encode(const Message& sample, Message* out);
+
+    /**
+     * @brief forceKeyframes sends the next sample of every stream as keyframe,
+     * e.g. after the host reconnected
+     */
+    void forceKeyframes();
+
+private:
+    CompactSlot slots[COMPACT_SLOTS];
+    uint8_t keyframeInterval;
+};
+
+/**
+ * @brief The CompactStats struct
+ */
+struct CompactStats {
+    uint32_t keyframes; //!< SENSOR_DATA messages received
+    uint32_t deltas; //!< SENSOR_DATA_DELTA messages applied
+    uint32_t gaps; //!< Streams interrupted by a missing sample
+    uint32_t dropped; //!< SENSOR_DATA_DELTA messages that could not be applied
+};
+
+/**
+ * @brief The CompactDecoder class
+ *
+ * Rebuilds absolute SENSOR_DATA samples from keyframes and SENSOR_DATA_DELTA
+ * messages.
+ */
+class CompactDecoder {
+public:
+    CompactDecoder();
+
+    /**
+     * @brief decode applies a received sensor message to its stream
+     * @param message SENSOR_DATA or SENSOR_DATA_DELTA message, turned into a
+     * SENSOR_DATA message with absolute values
+     * @return false if the message is a delta that cannot be applied because
+     * a sample of its stream is missing
+     */
+    bool decode(Message* message);
+
+    const CompactStats& stats() const {
+        return statistics;
+    }
+
+private:
+    CompactSlot slots[COMPACT_SLOTS];
+    CompactStats statistics;
+};
+
+}  // namespace sense_link
+
+#endif /* SENSE_LINK_COMPACT_H */
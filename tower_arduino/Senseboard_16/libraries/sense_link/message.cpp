@@ -1,442 +1,557 @@
 #include "message.h"
+#include "compact.h"
+
+#include <stddef.h>
+#include <string.h>
 
 namespace sense_link {
 
 /**
- * @brief writeInt16 writes 2 bytes in the buffer.
- * @param number int16_t|uint32_t number which is written into the buffer
- * @param buffer write target
+ * @brief Declares the layout of a single member of Message on the wire.
+ *
+ * The wire format stores every field in native byte order, so a field is
+ * fully described by its offset inside Message and its width in bytes.
+ */
+#define SENSE_LINK_FIELD(member) \
+    { offsetof(Message, member), sizeof(((const Message*)0)->member) }
+
+/**
+ * @brief Declares a PayloadLayout from a FieldLayout array.
  */
-template<typename T>
-void writeInt16(T number, char* buffer){
-#if __cplusplus >= 201103L // C++11 support
-    static_assert(sizeof(T) == 2, "writeInt16 type must be of size 2");
-#endif
-#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-    *buffer++ = (number >> 8) & 0xFF;
-    *buffer++ = (number) & 0xFF;
-#elif __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-    *( reinterpret_cast<T*>(buffer) ) = number;
-#else
-    #error unknown byte order
-#endif
+#define SENSE_LINK_LAYOUT(fields) \
+    { fields, sizeof(fields) / sizeof(fields[0]), \
+      payloadWidth(fields, sizeof(fields) / sizeof(fields[0])), \
+      fields[0].offset, \
+      isContiguous(fields, sizeof(fields) / sizeof(fields[0])) }
+
+/**
+ * @brief payloadWidth sums up the widths of the given fields at compile time
+ * @param fields first field
+ * @param count number of fields
+ * @return size of the payload in bytes
+ */
+constexpr uint8_t payloadWidth(const FieldLayout* fields, uint8_t count) {
+    return count == 0 ? 0 : fields[0].width + payloadWidth(fields + 1, count - 1);
 }
 
 /**
- * @brief writeInt32 writes 4 bytes in the buffer.
- * @param number int32_t|uint32_t number which is written into the buffer
- * @param buffer write target
+ * @brief isContiguous checks at compile time whether the fields follow each
+ * other in memory without padding, i.e. the payload is a plain copy of Message
+ * @param fields first field
+ * @param count number of fields
+ * @return true if every field starts where the previous one ends
  */
-template<typename T>
-void writeInt32(T number, char* buffer){
-#if __cplusplus >= 201103L // C++11 support
-    static_assert(sizeof(T) == 4, "writeInt32 type must be of size 4");
-#endif
-#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-    *buffer++ = (number >> 24) & 0xFF;
-    *buffer++ = (number >> 16) & 0xFF;
-    *buffer++ = (number >> 8) & 0xFF;
-    *buffer++ = (number) & 0xFF;
-#elif __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-    *( reinterpret_cast<T*>(buffer) ) = number;
-#else
-    #error unknown byte order
-#endif
+constexpr bool isContiguous(const FieldLayout* fields, uint8_t count) {
+    return count < 2 || (fields[0].offset + fields[0].width == fields[1].offset
+                         && isContiguous(fields + 1, count - 1));
 }
 
+constexpr FieldLayout errorFields[] = {
+    SENSE_LINK_FIELD(error.code)
+};
+
+constexpr FieldLayout timeFields[] = {
+    SENSE_LINK_FIELD(time.micros)
+};
+
+constexpr FieldLayout checksumFields[] = {
+    SENSE_LINK_FIELD(checksum.mode)
+};
+
+constexpr FieldLayout servoFields[] = {
+    SENSE_LINK_FIELD(sensorData.Servo.angle)
+};
+
+constexpr FieldLayout motorFields[] = {
+    SENSE_LINK_FIELD(sensorData.Motor.speed)
+};
+
+constexpr FieldLayout ledFields[] = {
+    SENSE_LINK_FIELD(sensorData.Led.value)
+};
+
+constexpr FieldLayout proximityFields[] = {
+    SENSE_LINK_FIELD(sensorData.Proximity.distance)
+};
+
+constexpr FieldLayout gyroscopeFields[] = {
+    SENSE_LINK_FIELD(sensorData.Gyroscope.x),
+    SENSE_LINK_FIELD(sensorData.Gyroscope.y),
+    SENSE_LINK_FIELD(sensorData.Gyroscope.z)
+};
+
+constexpr FieldLayout accelerometerFields[] = {
+    SENSE_LINK_FIELD(sensorData.Accelerometer.x),
+    SENSE_LINK_FIELD(sensorData.Accelerometer.y),
+    SENSE_LINK_FIELD(sensorData.Accelerometer.z)
+};
+
+constexpr FieldLayout magnetometerFields[] = {
+    SENSE_LINK_FIELD(sensorData.Magnetometer.x),
+    SENSE_LINK_FIELD(sensorData.Magnetometer.y),
+    SENSE_LINK_FIELD(sensorData.Magnetometer.z)
+};
+
+constexpr FieldLayout orientationFields[] = {
+    SENSE_LINK_FIELD(sensorData.Orientation.x),
+    SENSE_LINK_FIELD(sensorData.Orientation.y),
+    SENSE_LINK_FIELD(sensorData.Orientation.z)
+};
+
+constexpr FieldLayout mouseFields[] = {
+    SENSE_LINK_FIELD(sensorData.Mouse.x),
+    SENSE_LINK_FIELD(sensorData.Mouse.y),
+    SENSE_LINK_FIELD(sensorData.Mouse.duration),
+    SENSE_LINK_FIELD(sensorData.Mouse.surfaceQuality)
+};
+
+constexpr FieldLayout sbusFields[] = {
+    SENSE_LINK_FIELD(sensorData.SBus.channels[0]),
+    SENSE_LINK_FIELD(sensorData.SBus.channels[1]),
+    SENSE_LINK_FIELD(sensorData.SBus.channels[2]),
+    SENSE_LINK_FIELD(sensorData.SBus.channels[3]),
+    SENSE_LINK_FIELD(sensorData.SBus.channels[4]),
+    SENSE_LINK_FIELD(sensorData.SBus.channels[5]),
+    SENSE_LINK_FIELD(sensorData.SBus.channels[6]),
+    SENSE_LINK_FIELD(sensorData.SBus.channels[7]),
+    SENSE_LINK_FIELD(sensorData.SBus.flags)
+};
+
 /**
- * @brief writeInt64 writes 8 bytes in the buffer.
- * @param number int64_t|uint64_t number which is written into the buffer
- * @param buffer write target
+ * Payload without any fields (headers only)
  */
-template<typename T>
-void writeInt64(T number, char* buffer){
-#if __cplusplus >= 201103L // C++11 support
-    static_assert(sizeof(T) == 8, "writeInt64 type must be of size 8");
-#endif
-#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-    *buffer++ = (number >> 56) & 0xFF;
-    *buffer++ = (number >> 48) & 0xFF;
-    *buffer++ = (number >> 40) & 0xFF;
-    *buffer++ = (number >> 32) & 0xFF;
-    *buffer++ = (number >> 24) & 0xFF;
-    *buffer++ = (number >> 16) & 0xFF;
-    *buffer++ = (number >> 8) & 0xFF;
-    *buffer++ = (number) & 0xFF;
-#elif __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-    *( reinterpret_cast<T*>(buffer) ) = number;
-#else
-    #error unknown byte order
-#endif
+constexpr PayloadLayout emptyLayout = { 0, 0, 0, 0, true };
+
+constexpr PayloadLayout errorLayout = SENSE_LINK_LAYOUT(errorFields);
+constexpr PayloadLayout timeLayout = SENSE_LINK_LAYOUT(timeFields);
+constexpr PayloadLayout checksumLayout = SENSE_LINK_LAYOUT(checksumFields);
+
+/**
+ * SENSOR_DATA layouts, indexed by SensorType
+ */
+constexpr PayloadLayout sensorLayouts[] = {
+    emptyLayout,                                // UNKNOWN
+    SENSE_LINK_LAYOUT(proximityFields),         // PROXIMITY
+    SENSE_LINK_LAYOUT(gyroscopeFields),         // GYROSCOPE
+    SENSE_LINK_LAYOUT(accelerometerFields),     // ACCELEROMETER
+    SENSE_LINK_LAYOUT(magnetometerFields),      // MAGNETOMETER
+    SENSE_LINK_LAYOUT(orientationFields),       // ORIENTATION
+    SENSE_LINK_LAYOUT(servoFields),             // SERVO
+    SENSE_LINK_LAYOUT(motorFields),             // MOTOR
+    SENSE_LINK_LAYOUT(ledFields),               // LED
+    SENSE_LINK_LAYOUT(mouseFields),             // MOUSE
+    SENSE_LINK_LAYOUT(sbusFields)               // SBUS
+};
+
+static_assert(sizeof(sensorLayouts) / sizeof(sensorLayouts[0])
+              == static_cast<uint8_t>(SensorType::__END__),
+              "sensorLayouts must contain one entry per SensorType");
+
+/**
+ * ACTUATOR layouts, indexed by ActuatorType
+ */
+constexpr PayloadLayout actuatorLayouts[] = {
+    SENSE_LINK_LAYOUT(servoFields),             // SERVO
+    SENSE_LINK_LAYOUT(motorFields),             // MOTOR
+    SENSE_LINK_LAYOUT(ledFields)                // LED
+};
+
+static_assert(sizeof(actuatorLayouts) / sizeof(actuatorLayouts[0])
+              == static_cast<uint8_t>(ActuatorType::__END__),
+              "actuatorLayouts must contain one entry per ActuatorType");
+
+/**
+ * @brief payloadLayout looks up the payload layout of a message
+ * @param type MessageType of the message
+ * @param subtype SensorType or ActuatorType byte of the message
+ * @return layout of the payload, emptyLayout for unknown types
+ */
+const PayloadLayout* payloadLayout(MessageType type, uint8_t subtype) {
+    switch(type) {
+    case MessageType::ERROR:
+        return &errorLayout;
+    case MessageType::TIME:
+        return &timeLayout;
+    case MessageType::CHECKSUM_MODE:
+        return &checksumLayout;
+    case MessageType::ACTUATOR:
+        return subtype < static_cast<uint8_t>(ActuatorType::__END__)
+                ? &actuatorLayouts[subtype] : &emptyLayout;
+    case MessageType::SENSOR_DATA:
+    case MessageType::SENSOR_DATA_DELTA:
+        return subtype < static_cast<uint8_t>(SensorType::__END__)
+                ? &sensorLayouts[subtype] : &emptyLayout;
+    default:
+        return &emptyLayout;
+    }
 }
 
 /**
- * @brief readInt16 reades 2 bytes from the buffer.
- * @param number int16_t|uint16_t number which will be read
- * @param buffer reading source
+ * @brief messageLength computes the encoded size of a message from its header
+ * @param type MessageType of the message
+ * @param subtype SensorType or ActuatorType byte of the message
+ * @param mode checksum mode of the link
+ * @return size of the encoded message including checksum (bytes),
+ * -1 if the message type is unknown, BATCH or SENSOR_DATA_DELTA (size not
+ * given by the header)
  */
-template<typename T>
-void readInt16(T* number, const void* voidBuf) {
-#if __cplusplus >= 201103L // C++11 support
-    static_assert(sizeof(T) == 2, "readInt16 type must be of size 2");
-#endif
-    const uint8_t *buffer = (const uint8_t*) voidBuf;
-#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-    *number = (((uint16_t) buffer[0]) << 8) | ((uint16_t )buffer[1]);
-#elif __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-    *number = *( reinterpret_cast<const T*>(buffer) );
-#else
-    #error unknown byte order
-#endif
+int messageLength(MessageType type, uint8_t subtype, ChecksumMode mode) {
+    if(static_cast<uint8_t>(type) >= static_cast<uint8_t>(MessageType::__END__)
+            || type == MessageType::BATCH || type == MessageType::SENSOR_DATA_DELTA) {
+        return -1;
+    }
+    return MESSAGE_HEADER_SIZE + payloadLayout(type, subtype)->size + checksumSize(mode);
 }
 
 /**
- * @brief readInt32 reades 4 bytes from the buffer.
- * @param number int32_t|uint32_t number which will be read
- * @param buffer reading source
+ * @brief copyBlock copies a payload in 4 byte words. Payloads are at most a
+ * few words long, a library memcpy call with a variable size is slower here.
+ * @param dst write target
+ * @param src reading source
+ * @param size number of bytes
  */
-template<typename T>
-void readInt32(T* number, const void* voidBuf) {
-#if __cplusplus >= 201103L // C++11 support
-    static_assert(sizeof(T) == 4, "readInt32 type must be of size 4");
-#endif
-    const uint8_t *buffer = (const uint8_t*) voidBuf;
-#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-    *number = ((uint32_t) buffer[0] << 24) | ((uint32_t) buffer[1] << 16)
-            | ((uint32_t) buffer[2] << 8) | (uint32_t) buffer[3];
-#elif __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-    *number = *( reinterpret_cast<const T*>(buffer) );
-#else
-    #error unknown byte order
-#endif
+inline void copyBlock(char* dst, const char* src, uint8_t size) {
+    for(; size >= 4; size -= 4, dst += 4, src += 4) {
+        memcpy(dst, src, 4);
+    }
+    for(; size > 0; size--) {
+        *dst++ = *src++;
+    }
 }
 
 /**
- * @brief readInt64 reades 8 bytes from the buffer.
- * @param number int64_t|uint64_t number which will be read
- * @param buffer reading source
+ * @brief writePayload copies the payload fields of a message to the buffer
+ * @param layout payload layout of the message
+ * @param message source
+ * @param buffer write target
  */
-template<typename T>
-void readInt64(T* number, const void* voidBuf) {
-#if __cplusplus >= 201103L // C++11 support
-    static_assert(sizeof(T) == 8, "readInt64 type must be of size 8");
-#endif
-    const uint8_t *buffer = (const uint8_t*) voidBuf;
-#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-    *number = ((uint64_t) buffer[0] << 56) | ((uint64_t) buffer[1] << 48)
-            | ((uint64_t) buffer[2] << 40) | ((uint64_t) buffer[3] << 32)
-            | ((uint64_t) buffer[4] << 24) | ((uint64_t) buffer[5] << 16)
-            | ((uint64_t) buffer[6] << 8) | (uint64_t) buffer[7];
-#elif __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-    *number = *( reinterpret_cast<const T*>(buffer) );
-#else
-    #error unknown byte order
-#endif
+inline void writePayload(const PayloadLayout* layout, const Message* message, char* buffer) {
+    const char* base = reinterpret_cast<const char*>(message);
+    if(layout->contiguous) {
+        copyBlock(buffer, base + layout->offset, layout->size);
+        return;
+    }
+    for(uint8_t i = 0; i < layout->count; i++) {
+        memcpy(buffer, base + layout->fields[i].offset, layout->fields[i].width);
+        buffer += layout->fields[i].width;
+    }
 }
 
+/**
+ * @brief readPayload copies the payload fields from the buffer to a message
+ * @param layout payload layout of the message
+ * @param message target
+ * @param buffer reading source
+ */
+inline void readPayload(const PayloadLayout* layout, Message* message, const char* buffer) {
+    char* base = reinterpret_cast<char*>(message);
+    if(layout->contiguous) {
+        copyBlock(base + layout->offset, buffer, layout->size);
+        return;
+    }
+    for(uint8_t i = 0; i < layout->count; i++) {
+        memcpy(base + layout->fields[i].offset, buffer, layout->fields[i].width);
+        buffer += layout->fields[i].width;
+    }
+}
 
 /**
  * @brief encode encodes a Message to a byte buffer
  * @param message Message to encode (send)
  * @param buffer encoded Message in bytes
+ * @param mode checksum mode of the link
  * @return size of message (bytes)
  */
-int encodeMessage (const Message* message, char* buffer) {
+int encodeMessage (const Message* message, char* buffer, ChecksumMode mode) {
     //copy start adress of the message
     //to count bytes written
-    const char* start = buffer;
+    char* start = buffer;
 
-    //writing first byte
+    // Header: message type, sensor/actuator type, id, sequence number
+    // (sensor and actuator share the same byte)
     *buffer++ = static_cast<char>(message->message);
-
-    //writing second byte
-    if(message->message == MessageType::ACTUATOR){
-        *buffer++ = static_cast<char> (message->actuator);
-    }else{
-        *buffer++ = static_cast<char> (message->sensor);
-    }
-
-    // Sensor/Actor id
+    *buffer++ = static_cast<char>(message->sensor);
     *buffer++ = message->id;
-
-    // Sequence number
     *buffer++ = message->sequence;
 
-    //writing rest bytes
-    if(message->message == MessageType::ERROR){
-        *buffer++ = static_cast<char>(message->error.code);
-    }else if(message->message == MessageType::TIME){
-        writeInt64(message->time.micros, buffer);
-        buffer += 8;
-    }else if(message->message == MessageType::ACTUATOR){
-        switch (message->actuator) {
-            case ActuatorType::LED:
-                *buffer++ = message->sensorData.Led.value;
-                break;
-            case ActuatorType::SERVO:
-                writeInt16(message->sensorData.Servo.angle, buffer);
-                buffer+= 2;
-                break;
-            case ActuatorType::MOTOR:
-                writeInt16(message->sensorData.Motor.speed, buffer);
-                buffer+= 2;
-        }
-    }else if(message->message == MessageType::SENSOR_DATA){
-        switch (message->sensor) {
-            case SensorType::PROXIMITY:
-                writeInt16(message->sensorData.Proximity.distance, buffer);
-                buffer += 2;
-                break;
-            case SensorType::GYROSCOPE:
-                writeInt32(message->sensorData.Gyroscope.x, buffer);
-                buffer += 4;
-                writeInt32(message->sensorData.Gyroscope.y, buffer);
-                buffer += 4;
-                writeInt32(message->sensorData.Gyroscope.z, buffer);
-                buffer += 4;
-                break;
-            case SensorType::ACCELEROMETER:
-                writeInt32(message->sensorData.Accelerometer.x, buffer);
-                buffer += 4;
-                writeInt32(message->sensorData.Accelerometer.y, buffer);
-                buffer += 4;
-                writeInt32(message->sensorData.Accelerometer.z, buffer);
-                buffer += 4;
-                break;
-            case SensorType::MAGNETOMETER:
-                writeInt32(message->sensorData.Magnetometer.x, buffer);
-                buffer+= 4;
-                writeInt32(message->sensorData.Magnetometer.y, buffer);
-                buffer+= 4;
-                writeInt32(message->sensorData.Magnetometer.z, buffer);
-                buffer+= 4;
-                break;
-            case SensorType::ORIENTATION:
-                writeInt32(message->sensorData.Orientation.x, buffer);
-                buffer+= 4;
-                writeInt32(message->sensorData.Orientation.y, buffer);
-                buffer+= 4;
-                writeInt32(message->sensorData.Orientation.z, buffer);
-                buffer+= 4;
-                break;
-            case SensorType::SERVO:
-                writeInt16(message->sensorData.Servo.angle, buffer);
-                buffer+= 2;
-                break;
-            case SensorType::MOTOR:
-                writeInt16(message->sensorData.Motor.speed, buffer);
-                buffer+= 2;
-                break;
-            case SensorType::UNKNOWN:
-            case SensorType::__END__:
-                break;
-            case SensorType::LED:
-                *buffer++ = message->sensorData.Led.value;
-                break;
-            case SensorType::MOUSE:
-                writeInt32(message->sensorData.Mouse.x, buffer);
-                buffer += 4;
-                writeInt32(message->sensorData.Mouse.y, buffer);
-                buffer += 4;
-                writeInt32(message->sensorData.Mouse.duration, buffer);
-                buffer += 4;
-                *buffer++ = message->sensorData.Mouse.surfaceQuality;
-                break;
-            case SensorType::SBUS:
-                for(uint8_t i = 0; i < 8; i++)
-                {
-                    writeInt16(message->sensorData.SBus.channels[i], buffer);
-                    buffer += 2;
-                }
-                *buffer++ = message->sensorData.SBus.flags;
-                break;
-        } // end switch
-    } // end SENSOR_DATA
+    const PayloadLayout* layout = payloadLayout(message->message,
+                                                static_cast<uint8_t>(message->sensor));
+    if(message->message == MessageType::SENSOR_DATA_DELTA) {
+        buffer += writeDeltaPayload(layout, message, buffer);
+    } else {
+        writePayload(layout, message, buffer);
+        buffer += layout->size;
+    }
 
     //returns actual adress - start adress = bytes written
     unsigned int messageLength = buffer - start;
 
     // compute checksum
-    *buffer = crc8(start, messageLength);
-
-    return messageLength + 1; // +1 is for crc checksum
+    return messageLength + writeChecksum(mode, start, messageLength);
 }
 
 /**
- * @brief decode decodes a Message from a byte buffer
+ * @brief decode decodes a Message from a byte buffer. The payload of a
+ * SENSOR_DATA_DELTA message must have been checked with deltaPayloadSize.
  * @param message decoded message (result)
  * @param buffer reading source
- * @return size of message (bytes)
+ * @param mode checksum mode of the link
+ * @return size of message (bytes), -1 if the checksum does not match
  */
-int decodeMessage (Message* message, const char* buffer) {
+int decodeMessage (Message* message, const char* buffer, ChecksumMode mode) {
     const char* start = buffer;
 
-    message->message = (MessageType) *buffer++;
+    message->message = static_cast<MessageType>(*buffer++);
+    message->sensor = static_cast<SensorType>(*buffer++);
+    message->id = *buffer++;
+    message->sequence = *buffer++;
 
-    if(message->message == MessageType::ACTUATOR){
-        message->actuator = (ActuatorType) *buffer++;
-    }else{
-        message->sensor = (SensorType) *buffer++;
+    const PayloadLayout* layout = payloadLayout(message->message,
+                                                static_cast<uint8_t>(message->sensor));
+    if(message->message == MessageType::SENSOR_DATA_DELTA) {
+        buffer += readDeltaPayload(layout, message, buffer);
+    } else {
+        readPayload(layout, message, buffer);
+        buffer += layout->size;
     }
 
-    message->id = *buffer++;
-    message->sequence = *buffer++;
+    unsigned int messageLength = buffer - start;
+
+    if(! verifyChecksum(mode, start, messageLength)) {
+        return -1;
+    } else {
+        return messageLength + checksumSize(mode);
+    }
+}
+
+/**
+ * @brief encodeMessages encodes several messages into one contiguous buffer.
+ * Every message is prefixed by its length byte, exactly like a single frame
+ * written to the serial link.
+ * @param messages first message to encode
+ * @param count number of messages
+ * @param buffer encoded frames in bytes
+ * @param bufferSize size of buffer in bytes
+ * @param mode checksum mode of the link
+ * @return number of bytes written, -1 if the buffer is too small or a message
+ * has no fixed size (BATCH, SENSOR_DATA_DELTA)
+ */
+int encodeMessages (const Message* messages, unsigned int count, char* buffer, unsigned int bufferSize,
+                    ChecksumMode mode) {
+    const char* start = buffer;
+    const char* end = buffer + bufferSize;
 
-    if(message->message == MessageType::ERROR){
-        message->error.code = static_cast<ErrorCode>(*buffer++);
-    }else if(message->message == MessageType::TIME){
-        readInt64( &(message->time.micros), buffer);
-        buffer += 8;
-    }else if(message->message == MessageType::ACTUATOR){
-        switch (message->actuator) {
-            case ActuatorType::LED:
-                message->sensorData.Led.value = *buffer++;
-                break;
-            case ActuatorType::SERVO:
-                readInt16(&(message->sensorData.Servo.angle), buffer);
-                buffer+= 2;
-                break;
-            case ActuatorType::MOTOR:
-                readInt16(&(message->sensorData.Motor.speed), buffer);
-                buffer+= 2;
-                break;
+    for(unsigned int i = 0; i < count; i++) {
+        int length = messageLength(messages[i].message,
+                                   static_cast<uint8_t>(messages[i].sensor), mode);
+        if(length == -1 || end - buffer < 1 + length) {
+            return -1;
         }
-    }else if(message->message == MessageType::SENSOR_DATA){
-        switch (message->sensor){
-        case SensorType::PROXIMITY:
-            readInt16( &(message->sensorData.Proximity.distance), buffer);
-            buffer += 2;
-            break;
-        case SensorType::GYROSCOPE:
-            readInt32(&(message->sensorData.Gyroscope.x), buffer);
-            buffer += 4;
-            readInt32(&(message->sensorData.Gyroscope.y), buffer);
-            buffer += 4;
-            readInt32(&(message->sensorData.Gyroscope.z), buffer);
-            buffer += 4;
-            break;
-        case SensorType::ACCELEROMETER:
-            readInt32(&(message->sensorData.Accelerometer.x), buffer);
-            buffer += 4;
-            readInt32(&(message->sensorData.Accelerometer.y), buffer);
-            buffer += 4;
-            readInt32(&(message->sensorData.Accelerometer.z), buffer);
-            buffer += 4;
-            break;
-        case SensorType::MAGNETOMETER:
-            readInt32(&(message->sensorData.Magnetometer.x), buffer);
-            buffer+= 4;
-            readInt32(&(message->sensorData.Magnetometer.y), buffer);
-            buffer+= 4;
-            readInt32(&(message->sensorData.Magnetometer.z), buffer);
-            buffer+= 4;
-            break;
-        case SensorType::ORIENTATION:
-            readInt32(&(message->sensorData.Orientation.x), buffer);
-            buffer+= 4;
-            readInt32(&(message->sensorData.Orientation.y), buffer);
-            buffer+= 4;
-            readInt32(&(message->sensorData.Orientation.z), buffer);
-            buffer+= 4;
-            break;
-        case SensorType::SERVO:
-            readInt16(&(message->sensorData.Servo.angle), buffer);
-            buffer+= 2;
-            break;
-        case SensorType::MOTOR:
-            readInt16(&(message->sensorData.Motor.speed), buffer);
-            buffer+= 2;
-            break;
-        case SensorType::UNKNOWN:
-        case SensorType::__END__:
-            break;
-        case SensorType::LED:
-            message->sensorData.Led.value = *buffer++;
-            break;
-        case SensorType::MOUSE:
-            readInt32(&(message->sensorData.Mouse.x), buffer);
-            buffer += 4;
-            readInt32(&(message->sensorData.Mouse.y), buffer);
-            buffer += 4;
-            readInt32(&(message->sensorData.Mouse.duration), buffer);
-            buffer += 4;
-            message->sensorData.Mouse.surfaceQuality = *buffer++;
-            break;
-        case SensorType::SBUS:
-            for(uint8_t i = 0; i < 8; i++)
-            {
-                readInt16(&(message->sensorData.SBus.channels[i]), buffer);
-                buffer += 2;
-            }
-            message->sensorData.SBus.flags = *buffer++;
+        int messageLength = encodeMessage(&messages[i], buffer + 1, mode);
+        buffer[0] = messageLength;
+        buffer += messageLength + 1;
+    }
+
+    return buffer - start;
+}
+
+/**
+ * @brief decodeMessages decodes length-prefixed frames from one contiguous
+ * buffer as written by encodeMessages. Decoding stops at the first incomplete
+ * frame.
+ * @param messages decoded messages (result)
+ * @param count maximum number of messages to decode
+ * @param buffer reading source
+ * @param length number of bytes in buffer
+ * @param mode checksum mode of the link
+ * @return number of messages decoded, -1 on a corrupt frame
+ */
+int decodeMessages (Message* messages, unsigned int count, const char* buffer, unsigned int length,
+                    ChecksumMode mode) {
+    const char* end = buffer + length;
+    unsigned int decoded = 0;
+
+    while(decoded < count && end - buffer >= 1 + MESSAGE_HEADER_SIZE + checksumSize(mode)) {
+        uint8_t frameLength = buffer[0];
+        if(end - buffer < 1 + frameLength) {
             break;
         }
+
+        if(frameLength != messageLength(static_cast<MessageType>(buffer[1]),
+                                        static_cast<uint8_t>(buffer[2]), mode)
+                || decodeMessage(&messages[decoded], buffer + 1, mode) == -1) {
+            return -1;
+        }
+
+        buffer += 1 + frameLength;
+        decoded++;
+    }
+
+    return decoded;
+}
+
+/**
+ * @brief encodeBatch encodes several messages into one BATCH message
+ * @param messages first message to encode
+ * @param count number of messages, 1 - 255
+ * @param sequence sequence number of the batch
+ * @param buffer encoded BATCH message in bytes (without length prefix)
+ * @param bufferSize size of buffer in bytes
+ * @param mode checksum mode of the link
+ * @return size of the BATCH message (bytes), -1 if it does not fit into
+ * buffer or into a single frame
+ */
+int encodeBatch (const Message* messages, unsigned int count, uint8_t sequence, char* buffer,
+                 unsigned int bufferSize, ChecksumMode mode) {
+    if(count == 0 || count > 255) {
+        return -1;
+    }
+
+    unsigned int length = MESSAGE_HEADER_SIZE + checksumSize(mode);
+    for(unsigned int i = 0; i < count; i++) {
+        const Message* message = &messages[i];
+        if(message->message == MessageType::BATCH) {
+            return -1;
+        }
+        const PayloadLayout* layout = payloadLayout(message->message,
+                                                    static_cast<uint8_t>(message->sensor));
+        length += BATCH_ENTRY_HEADER_SIZE + (message->message == MessageType::SENSOR_DATA_DELTA
+                                             ? deltaPayloadLength(layout, message) : layout->size);
+    }
+    // the frame length must fit into the length byte
+    if(length > bufferSize || length > 255) {
+        return -1;
+    }
+
+    char* start = buffer;
+    *buffer++ = static_cast<char>(MessageType::BATCH);
+    *buffer++ = count;
+    *buffer++ = 0;
+    *buffer++ = sequence;
+
+    for(unsigned int i = 0; i < count; i++) {
+        const Message* message = &messages[i];
+        *buffer++ = static_cast<char>(message->message);
+        *buffer++ = static_cast<char>(message->sensor);
+        *buffer++ = message->id;
+
+        const PayloadLayout* layout = payloadLayout(message->message,
+                                                    static_cast<uint8_t>(message->sensor));
+        if(message->message == MessageType::SENSOR_DATA_DELTA) {
+            buffer += writeDeltaPayload(layout, message, buffer);
+        } else {
+            writePayload(layout, message, buffer);
+            buffer += layout->size;
+        }
     }
 
     unsigned int messageLength = buffer - start;
+    return messageLength + writeChecksum(mode, start, messageLength);
+}
 
-    uint8_t computedChecksum = crc8(start, messageLength);
-    uint8_t sentChecksum = *buffer;
+/**
+ * @brief checkBatch validates the entries and the checksum of a BATCH message
+ * @param buffer BATCH message (without length prefix)
+ * @param length size of the BATCH message including checksum (bytes)
+ * @param mode checksum mode of the link
+ * @return number of entries, -1 if the message is malformed or corrupt
+ */
+int checkBatch (const char* buffer, unsigned int length, ChecksumMode mode) {
+    if(length < static_cast<unsigned int>(MESSAGE_HEADER_SIZE + checksumSize(mode))
+            || static_cast<MessageType>(buffer[0]) != MessageType::BATCH) {
+        return -1;
+    }
 
-    if(computedChecksum != sentChecksum) {
+    uint8_t count = buffer[1];
+    if(count == 0) {
+        return -1;
+    }
+
+    const char* entry = buffer + MESSAGE_HEADER_SIZE;
+    const char* end = buffer + length - checksumSize(mode);
+    for(uint8_t i = 0; i < count; i++) {
+        if(end - entry < BATCH_ENTRY_HEADER_SIZE) {
+            return -1;
+        }
+
+        MessageType type = static_cast<MessageType>(entry[0]);
+        if(static_cast<uint8_t>(type) >= static_cast<uint8_t>(MessageType::__END__)
+                || type == MessageType::BATCH) {
+            return -1;
+        }
+
+        const PayloadLayout* layout = payloadLayout(type, static_cast<uint8_t>(entry[1]));
+        if(type == MessageType::SENSOR_DATA_DELTA) {
+            // the size follows from the varints
+            if(static_cast<uint8_t>(entry[1]) >= static_cast<uint8_t>(SensorType::__END__)) {
+                return -1;
+            }
+            int size = deltaPayloadSize(layout, entry + BATCH_ENTRY_HEADER_SIZE,
+                                        end - entry - BATCH_ENTRY_HEADER_SIZE);
+            if(size == -1) {
+                return -1;
+            }
+            entry += BATCH_ENTRY_HEADER_SIZE + size;
+        } else {
+            entry += BATCH_ENTRY_HEADER_SIZE + layout->size;
+        }
+    }
+
+    if(entry != end || ! verifyChecksum(mode, buffer, end - buffer)) {
         return -1;
-    } else {
-        return messageLength + 1; // +1 for checksum
     }
+
+    return count;
 }
+
 /**
-  * CRC-8 lookup table
-  */
-static const uint8_t table[] =
-{0x00, 0x5e, 0xbc, 0xe2, 0x61, 0x3f, 0xdd, 0x83,
-0xc2, 0x9c, 0x7e, 0x20, 0xa3, 0xfd, 0x1f, 0x41,
-0x9d, 0xc3, 0x21, 0x7f, 0xfc, 0xa2, 0x40, 0x1e,
-0x5f, 0x01, 0xe3, 0xbd, 0x3e, 0x60, 0x82, 0xdc,
-0x23, 0x7d, 0x9f, 0xc1, 0x42, 0x1c, 0xfe, 0xa0,
-0xe1, 0xbf, 0x5d, 0x03, 0x80, 0xde, 0x3c, 0x62,
-0xbe, 0xe0, 0x02, 0x5c, 0xdf, 0x81, 0x63, 0x3d,
-0x7c, 0x22, 0xc0, 0x9e, 0x1d, 0x43, 0xa1, 0xff,
-0x46, 0x18, 0xfa, 0xa4, 0x27, 0x79, 0x9b, 0xc5,
-0x84, 0xda, 0x38, 0x66, 0xe5, 0xbb, 0x59, 0x07,
-0xdb, 0x85, 0x67, 0x39, 0xba, 0xe4, 0x06, 0x58,
-0x19, 0x47, 0xa5, 0xfb, 0x78, 0x26, 0xc4, 0x9a,
-0x65, 0x3b, 0xd9, 0x87, 0x04, 0x5a, 0xb8, 0xe6,
-0xa7, 0xf9, 0x1b, 0x45, 0xc6, 0x98, 0x7a, 0x24,
-0xf8, 0xa6, 0x44, 0x1a, 0x99, 0xc7, 0x25, 0x7b,
-0x3a, 0x64, 0x86, 0xd8, 0x5b, 0x05, 0xe7, 0xb9,
-0x8c, 0xd2, 0x30, 0x6e, 0xed, 0xb3, 0x51, 0x0f,
-0x4e, 0x10, 0xf2, 0xac, 0x2f, 0x71, 0x93, 0xcd,
-0x11, 0x4f, 0xad, 0xf3, 0x70, 0x2e, 0xcc, 0x92,
-0xd3, 0x8d, 0x6f, 0x31, 0xb2, 0xec, 0x0e, 0x50,
-0xaf, 0xf1, 0x13, 0x4d, 0xce, 0x90, 0x72, 0x2c,
-0x6d, 0x33, 0xd1, 0x8f, 0x0c, 0x52, 0xb0, 0xee,
-0x32, 0x6c, 0x8e, 0xd0, 0x53, 0x0d, 0xef, 0xb1,
-0xf0, 0xae, 0x4c, 0x12, 0x91, 0xcf, 0x2d, 0x73,
-0xca, 0x94, 0x76, 0x28, 0xab, 0xf5, 0x17, 0x49,
-0x08, 0x56, 0xb4, 0xea, 0x69, 0x37, 0xd5, 0x8b,
-0x57, 0x09, 0xeb, 0xb5, 0x36, 0x68, 0x8a, 0xd4,
-0x95, 0xcb, 0x29, 0x77, 0xf4, 0xaa, 0x48, 0x16,
-0xe9, 0xb7, 0x55, 0x0b, 0x88, 0xd6, 0x34, 0x6a,
-0x2b, 0x75, 0x97, 0xc9, 0x4a, 0x14, 0xf6, 0xa8,
-0x74, 0x2a, 0xc8, 0x96, 0x15, 0x4b, 0xa9, 0xf7,
-0xb6, 0xe8, 0x0a, 0x54, 0xd7, 0x89, 0x6b, 0x35,
-};
+ * @brief decodeBatchEntry decodes a single entry of a BATCH message that was
+ * validated by checkBatch
+ * @param message decoded message (result)
+ * @param entry first byte of the entry
+ * @param sequence sequence number of the batch
+ * @return size of the entry (bytes)
+ */
+int decodeBatchEntry (Message* message, const char* entry, uint8_t sequence) {
+    message->message = static_cast<MessageType>(entry[0]);
+    message->sensor = static_cast<SensorType>(entry[1]);
+    message->id = entry[2];
+    message->sequence = sequence;
+
+    const PayloadLayout* layout = payloadLayout(message->message,
+                                                static_cast<uint8_t>(message->sensor));
+    if(message->message == MessageType::SENSOR_DATA_DELTA) {
+        return BATCH_ENTRY_HEADER_SIZE + readDeltaPayload(layout, message, entry + BATCH_ENTRY_HEADER_SIZE);
+    }
+    readPayload(layout, message, entry + BATCH_ENTRY_HEADER_SIZE);
+
+    return BATCH_ENTRY_HEADER_SIZE + layout->size;
+}
+
 /**
-  Return CRC-8 of the data (cyclic redundancy check) - message validity
- * @brief crc8
- * @param vptr begin of data
- * @param len length of data
- * @return CRC-8 value
+ * @brief decodeBatch decodes all entries of a BATCH message
+ * @param messages decoded messages (result)
+ * @param count maximum number of messages to decode
+ * @param buffer BATCH message (without length prefix)
+ * @param length size of the BATCH message including checksum (bytes)
+ * @param mode checksum mode of the link
+ * @return number of messages decoded, -1 if the message is malformed or corrupt
  */
-uint8_t crc8(const char *vptr, unsigned int len) {
-    const uint8_t *data = (uint8_t*)vptr;
-    uint8_t crc = 0xde;
-    int j;
-    for (j = len; j; j--, data++) {
-        crc = table[crc ^ *data];
+int decodeBatch (Message* messages, unsigned int count, const char* buffer, unsigned int length,
+                 ChecksumMode mode) {
+    int entries = checkBatch(buffer, length, mode);
+    if(entries == -1) {
+        return -1;
+    }
+
+    uint8_t sequence = buffer[3];
+    const char* entry = buffer + MESSAGE_HEADER_SIZE;
+    unsigned int decoded = 0;
+    for(; decoded < count && decoded < static_cast<unsigned int>(entries); decoded++) {
+        entry += decodeBatchEntry(&messages[decoded], entry, sequence);
     }
 
-    return crc;
+    return decoded;
 }
 
 }  // namespace sense_link
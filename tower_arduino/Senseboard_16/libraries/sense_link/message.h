@@ -4,6 +4,8 @@
 
 #include <stdint.h>
 
+#include "checksum.h"
+
 namespace sense_link {
 
 enum class SensorType : uint8_t {
@@ -24,7 +26,8 @@ enum class SensorType : uint8_t {
 enum class ActuatorType : uint8_t {
     SERVO = 0,
     MOTOR = 1,
-    LED = 2
+    LED = 2,
+    __END__ // ActuatorType counter, must be LAST
 };
 
 enum class MessageType : uint8_t {
@@ -35,7 +38,11 @@ enum class MessageType : uint8_t {
     SENSOR_GET = 4,
     TIME = 5,
     ACTUATOR = 6,
-    ACTUATOR_ACK = 7
+    ACTUATOR_ACK = 7,
+    CHECKSUM_MODE = 8,
+    BATCH = 9,
+    SENSOR_DATA_DELTA = 10,
+    __END__ // MessageType counter, must be LAST
 };
 
 enum class ErrorCode : uint8_t {
@@ -196,13 +203,55 @@ typedef struct {
     ErrorCode code; //!< Error code
 } Error;
 
+/**
+ * @brief The Checksum struct
+ *
+ * Sent by the host to request a checksum mode. A board that supports the mode
+ * answers with the same message (still using the old mode) and switches to the
+ * new mode for every following message.
+ */
+typedef struct {
+    ChecksumMode mode; //!< Requested/accepted checksum mode
+} Checksum;
+
 /**
  * @brief The Time struct
+ *
+ * The id of a TIME message tells its purpose:
+ * - TIME_SYNC_ID: clock synchronization. The host sends its own clock, the
+ *   board answers with the same sequence number and the board clock.
+ * - TIME_STAMP_ID: sent by the board, the following SENSOR_DATA and
+ *   SENSOR_DATA_DELTA messages were sampled at this board time. Usually the
+ *   first entry of a BATCH.
  */
 typedef struct {
     uint64_t micros; //!< 8 byte microseconds timestamp
 } Time;
 
+const uint8_t TIME_SYNC_ID = 0;
+const uint8_t TIME_STAMP_ID = 1;
+
+/**
+ * @brief The BATCH frame
+ *
+ * Carries several messages under one header and one checksum.
+ *
+ * Header
+ * - 1 byte MessageType::BATCH
+ * - 1 byte number of entries (at least 1)
+ * - 1 byte unused (0)
+ * - 1 byte Sequence number, applies to all entries
+ *
+ * Entries, each
+ * - 1 byte MessageType (any but BATCH)
+ * - 1 byte SensorType or ActuatorType
+ * - 1 byte Sensor ID
+ * - Payload as in a single message, varints for SENSOR_DATA_DELTA
+ *
+ * Checksum over header and all entries
+ */
+const uint8_t BATCH_ENTRY_HEADER_SIZE = 3;
+
 /**
  * @brief The Message struct
  *
@@ -214,7 +263,11 @@ typedef struct {
  * Payload, one of
  * - Error struct
  * - Time struct
+ * - Checksum struct
  * - SensorData struct (depending on SensorType)
+ *
+ * SENSOR_DATA_DELTA messages carry the SensorData fields as zig-zag varint
+ * deltas to the previous sample, see compact.h
  */
 struct Message {
     MessageType message;
@@ -227,16 +280,59 @@ struct Message {
     union {
         Error error;
         Time time;
+        Checksum checksum;
         SensorData sensorData;
         ActuatorData actuatorData;
     };
 
 };
 
-int encodeMessage (const Message*, char*);
-int decodeMessage (Message*, const char*);
+/**
+ * @brief Size of the message header in bytes (type, sensor/actuator, id, sequence)
+ */
+const uint8_t MESSAGE_HEADER_SIZE = 4;
+
+/**
+ * @brief The FieldLayout struct
+ *
+ * Position of a single payload field inside Message and its width on the wire.
+ */
+struct FieldLayout {
+    uint8_t offset; //!< Offset of the field inside Message [bytes]
+    uint8_t width; //!< Width of the field [bytes]
+};
+
+/**
+ * @brief The PayloadLayout struct
+ *
+ * Fields of a message payload in wire order. One layout exists for every
+ * MessageType/SensorType/ActuatorType combination that carries a payload.
+ */
+struct PayloadLayout {
+    const FieldLayout* fields; //!< First field
+    uint8_t count; //!< Number of fields
+    uint8_t size; //!< Sum of all field widths [bytes]
+    uint8_t offset; //!< Offset of the first field inside Message [bytes]
+    bool contiguous; //!< Fields are adjacent in Message, payload is a single copy
+};
+
+const PayloadLayout* payloadLayout(MessageType type, uint8_t subtype);
+int messageLength(MessageType type, uint8_t subtype, ChecksumMode mode = ChecksumMode::CRC8);
+
+int encodeMessage (const Message*, char*, ChecksumMode mode = ChecksumMode::CRC8);
+int decodeMessage (Message*, const char*, ChecksumMode mode = ChecksumMode::CRC8);
+
+int encodeMessages (const Message* messages, unsigned int count, char* buffer, unsigned int bufferSize,
+                    ChecksumMode mode = ChecksumMode::CRC8);
+int decodeMessages (Message* messages, unsigned int count, const char* buffer, unsigned int length,
+                    ChecksumMode mode = ChecksumMode::CRC8);
 
-uint8_t crc8(const char *vptr, unsigned int len);
+int encodeBatch (const Message* messages, unsigned int count, uint8_t sequence, char* buffer,
+                 unsigned int bufferSize, ChecksumMode mode = ChecksumMode::CRC8);
+int checkBatch (const char* buffer, unsigned int length, ChecksumMode mode = ChecksumMode::CRC8);
+int decodeBatchEntry (Message* message, const char* entry, uint8_t sequence);
+int decodeBatch (Message* messages, unsigned int count, const char* buffer, unsigned int length,
+                 ChecksumMode mode = ChecksumMode::CRC8);
 
 }  // namespace sense_link
 
@@ -0,0 +1,197 @@
+#include "parser.h"
+#include "compact.h"
+
+#include <string.h>
+
+namespace sense_link {
+
+FrameParser::FrameParser() : checksumMode(ChecksumMode::CRC8) {
+    reset();
+}
+
+void FrameParser::reset() {
+    fill = 0;
+    batchRemaining = 0;
+    fromBatch = false;
+    resyncBytes = 0;
+    memset(&statistics, 0, sizeof(statistics));
+}
+
+/**
+ * @brief next decodes the next message from the given bytes. Complete frames
+ * are decoded in place, only the tail of a split frame is copied.
+ */
+bool FrameParser::next(const char*& data, unsigned int& length, Message* message) {
+    unsigned int needed;
+
+    while(true) {
+        if(batchRemaining > 0) {
+            // entries of a validated BATCH frame are decoded where the frame lies,
+            // the frame is consumed with its last entry
+            const char* frame = fill == 0 ? data : buffer;
+            batchOffset += decodeBatchEntry(message, frame + batchOffset, batchSequence);
+            fromBatch = true;
+            if(--batchRemaining == 0) {
+                consume(data, length, batchSize);
+                frameDecoded();
+            }
+            return true;
+        }
+
+        // parse directly from the input if nothing is staged
+        bool staged = fill > 0;
+        if(! staged && length == 0) {
+            return false;
+        }
+
+        switch(checkFrame(staged ? buffer : data, staged ? fill : length, message, &needed)) {
+        case FrameState::VALID:
+            if(batchRemaining > 0) {
+                batchSize = needed;
+                break;
+            }
+            consume(data, length, needed);
+            frameDecoded();
+            fromBatch = false;
+            return true;
+        case FrameState::INVALID:
+            consume(data, length, 1);
+            dropByte();
+            break;
+        case FrameState::INCOMPLETE:
+            if(! staged) {
+                // frame continues in the next chunk, needed <= MAX_FRAME_SIZE
+                memcpy(buffer, data, length);
+                fill = length;
+                data += length;
+                length = 0;
+                return false;
+            }
+            if(length == 0) {
+                return false;
+            }
+
+            needed -= fill;
+            if(needed > length) {
+                needed = length;
+            }
+            memcpy(buffer + fill, data, needed);
+            fill += needed;
+            data += needed;
+            length -= needed;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief consume removes bytes from the front of the staged buffer or,
+ * if nothing is staged, from the input
+ */
+void FrameParser::consume(const char*& data, unsigned int& length, unsigned int count) {
+    if(fill == 0) {
+        data += count;
+        length -= count;
+    } else {
+        fill -= count;
+        memmove(buffer, buffer + count, fill);
+    }
+}
+
+/**
+ * @brief checkFrame validates and decodes the frame at the start of the given bytes
+ * @param frame first byte of the frame (length byte)
+ * @param available number of bytes available
+ * @param message decoded message (result)
+ * @param needed INCOMPLETE: number of bytes needed to continue checking,
+ * VALID: size of the frame
+ * @return state of the frame, a valid BATCH frame sets up the batch state
+ * instead of decoding a message
+ */
+FrameParser::FrameState FrameParser::checkFrame(const char* frame, unsigned int available,
+                                                Message* message, unsigned int* needed) {
+    uint8_t frameLength = frame[0];
+    if(frameLength < MESSAGE_HEADER_SIZE + checksumSize(checksumMode)) {
+        return FrameState::INVALID;
+    }
+
+    // length byte, message type and sensor/actuator type
+    if(available < 3) {
+        *needed = 3;
+        return FrameState::INCOMPLETE;
+    }
+
+    if(static_cast<MessageType>(frame[1]) == MessageType::BATCH) {
+        if(available < 1u + frameLength) {
+            *needed = 1 + frameLength;
+            return FrameState::INCOMPLETE;
+        }
+
+        int entries = checkBatch(frame + 1, frameLength, checksumMode);
+        if(entries == -1) {
+            statistics.framesRejected++;
+            return FrameState::INVALID;
+        }
+
+        batchRemaining = entries;
+        batchOffset = 1 + MESSAGE_HEADER_SIZE;
+        batchSequence = frame[4];
+        *needed = 1 + frameLength;
+        return FrameState::VALID;
+    }
+
+    if(static_cast<MessageType>(frame[1]) == MessageType::SENSOR_DATA_DELTA) {
+        // the size follows from the varints, check it before decoding
+        if(static_cast<uint8_t>(frame[2]) >= static_cast<uint8_t>(SensorType::__END__)) {
+            return FrameState::INVALID;
+        }
+        if(available < 1u + frameLength) {
+            *needed = 1 + frameLength;
+            return FrameState::INCOMPLETE;
+        }
+
+        unsigned int payloadSize = frameLength - MESSAGE_HEADER_SIZE - checksumSize(checksumMode);
+        if(deltaPayloadSize(payloadLayout(MessageType::SENSOR_DATA_DELTA, static_cast<uint8_t>(frame[2])),
+                            frame + 1 + MESSAGE_HEADER_SIZE, payloadSize)
+                != static_cast<int>(payloadSize)) {
+            return FrameState::INVALID;
+        }
+    } else if(frameLength != messageLength(static_cast<MessageType>(frame[1]),
+                                           static_cast<uint8_t>(frame[2]), checksumMode)) {
+        return FrameState::INVALID;
+    }
+
+    if(available < 1u + frameLength) {
+        *needed = 1 + frameLength;
+        return FrameState::INCOMPLETE;
+    }
+
+    if(decodeMessage(message, frame + 1, checksumMode) == -1) {
+        statistics.framesRejected++;
+        return FrameState::INVALID;
+    }
+
+    *needed = 1 + frameLength;
+    return FrameState::VALID;
+}
+
+void FrameParser::dropByte() {
+    statistics.bytesDropped++;
+    if(resyncBytes < 0xFFFF) {
+        resyncBytes++;
+    }
+}
+
+void FrameParser::frameDecoded() {
+    statistics.framesDecoded++;
+    if(resyncBytes > 0) {
+        statistics.resyncs++;
+        statistics.lastResyncBytes = resyncBytes;
+        if(resyncBytes > statistics.maxResyncBytes) {
+            statistics.maxResyncBytes = resyncBytes;
+        }
+        resyncBytes = 0;
+    }
+}
+
+}  // namespace sense_link
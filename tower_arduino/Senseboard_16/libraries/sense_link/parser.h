@@ -0,0 +1,137 @@
+#ifndef SENSE_LINK_PARSER_H
+#define SENSE_LINK_PARSER_H
+
+#include <stdint.h>
+
+#include "message.h"
+
+namespace sense_link {
+
+/**
+ * @brief Largest frame on the link: 1 length byte + up to 255 message bytes
+ */
+const uint16_t MAX_FRAME_SIZE = 256;
+
+/**
+ * @brief The ParserStats struct
+ *
+ * Link quality counters of a FrameParser. Resync latency is measured in bytes
+ * (one byte takes ~87 us at 115200 baud).
+ */
+struct ParserStats {
+    uint32_t framesDecoded; //!< Frames that passed length and checksum checks
+    uint32_t framesRejected; //!< Frames with a checksum mismatch
+    uint32_t bytesDropped; //!< Bytes skipped while searching for the next frame
+    uint32_t resyncs; //!< Number of times the parser found a frame after dropping bytes
+    uint16_t lastResyncBytes; //!< Bytes dropped before the last resync
+    uint16_t maxResyncBytes; //!< Most bytes ever dropped before a resync
+};
+
+/**
+ * @brief The FrameParser class
+ *
+ * Incremental parser for length-prefixed sense_link frames. It is fed chunks
+ * of arbitrary size and decodes complete frames directly from the chunk.
+ * Only a frame that is split between two chunks is staged in the parser's
+ * own buffer.
+ *
+ * A length byte is accepted only if it matches the size implied by the
+ * message header and the checksum matches. Otherwise the parser drops one
+ * byte and scans forward for the next valid frame.
+ *
+ * The entries of a BATCH frame are returned one per call, each with the
+ * sequence number of the batch. The frame stays in data until its last entry
+ * was returned, so keep calling next() with the same data until it returns
+ * false.
+ *
+ * Usage:
+ * @code
+ * const char* data = chunk;
+ * unsigned int length = chunkLength;
+ * Message message;
+ * while(parser.next(data, length, &message)) {
+ *     handle(message);
+ * }
+ * // all bytes of chunk are consumed now
+ * @endcode
+ */
+class FrameParser {
+public:
+    FrameParser();
+
+    /**
+     * @brief next decodes the next message from the given bytes
+     * @param data bytes to parse, advanced past the consumed bytes
+     * @param length number of bytes in data, decreased by the consumed bytes
+     * @param message decoded message (result), only valid if true is returned
+     * @return true if a message was decoded, false if all bytes were consumed
+     * without completing a frame
+     */
+    bool next(const char*& data, unsigned int& length, Message* message);
+
+    /**
+     * @brief reset discards a partially received frame and all counters,
+     * the checksum mode is kept
+     */
+    void reset();
+
+    /**
+     * @brief setChecksumMode switches the checksum mode for all following
+     * frames, e.g. after a CHECKSUM_MODE message was exchanged
+     */
+    void setChecksumMode(ChecksumMode mode) {
+        checksumMode = mode;
+    }
+
+    ChecksumMode getChecksumMode() const {
+        return checksumMode;
+    }
+
+    const ParserStats& stats() const {
+        return statistics;
+    }
+
+    /**
+     * @brief batchEntry tells if the message returned last by next() is an
+     * entry of a BATCH frame
+     */
+    bool batchEntry() const {
+        return fromBatch;
+    }
+
+    /**
+     * @brief lastBatchEntry tells if the message returned last by next() is
+     * the last entry of its BATCH frame
+     */
+    bool lastBatchEntry() const {
+        return fromBatch && batchRemaining == 0;
+    }
+
+private:
+    enum class FrameState : uint8_t {
+        INCOMPLETE,
+        INVALID,
+        VALID
+    };
+
+    FrameState checkFrame(const char* frame, unsigned int available,
+                          Message* message, unsigned int* needed);
+    void consume(const char*& data, unsigned int& length, unsigned int count);
+    void dropByte();
+    void frameDecoded();
+
+    char buffer[MAX_FRAME_SIZE]; //!< staged bytes of a split frame
+    uint16_t fill;
+    uint16_t resyncBytes; //!< bytes dropped since the last valid frame
+    ChecksumMode checksumMode;
+    uint8_t batchRemaining; //!< entries of the current BATCH frame not returned yet
+    uint8_t batchSequence;
+    uint16_t batchOffset; //!< offset of the next entry inside the frame
+    uint16_t batchSize; //!< size of the current BATCH frame including length byte
+    bool fromBatch; //!< message returned last is a BATCH entry
+    ParserStats statistics;
+};
+
+}  // namespace sense_link
+
+#endif /* SENSE_LINK_PARSER_H */
@@ -0,0 +1,309 @@
+#include "firmware.h"
+
+#include <string.h>
+
+using namespace sense_link;
+
+namespace senseboard {
+
+namespace {
+
+// bits of Firmware::streamMask
+const uint8_t STREAM_FRONT_SERVO = 1 << 0;
+const uint8_t STREAM_REAR_SERVO = 1 << 1;
+const uint8_t STREAM_MOTOR = 1 << 2;
+
+// most samples sent in one stamped BATCH frame
+const uint8_t MAX_STREAM_SAMPLES = 3;
+
+// frame buffers on the stack, a payload is never larger than Message
+const uint8_t MESSAGE_FRAME_SIZE = 1 + sizeof(Message) + 4;
+const uint8_t BATCH_FRAME_SIZE = 1 + MESSAGE_HEADER_SIZE
+        + (MAX_STREAM_SAMPLES + 1) * (BATCH_ENTRY_HEADER_SIZE + sizeof(Message)) + 4;
+
+}  // namespace
+
+Firmware::Firmware(Hardware& hardware) : hardware(hardware),
+    checksumMode(ChecksumMode::CRC8), rxData(rxChunk), rxLength(0),
+    motorSpeed(0), lastActuator(0), failsafe(false), streamMask(0), streamSequence(0),
+    lastMicros(0), microsWraps(0) {
+    servoAngle[0] = 0;
+    servoAngle[1] = 0;
+    memset(&statistics, 0, sizeof(statistics));
+}
+
+void Firmware::begin() {
+    uint32_t now = hardware.micros();
+    lastActuator = now;
+
+    scheduler.add(&Firmware::serialTask, this, 0, now);
+    scheduler.add(&Firmware::actuatorTask, this, SERVO_REFRESH_PERIOD, now);
+    scheduler.add(&Firmware::streamTask, this, STREAM_PERIOD, now);
+}
+
+void Firmware::loop() {
+    uint32_t now = hardware.micros();
+    boardMicros(now); // keep track of micros() wraps
+    scheduler.run(now);
+}
+
+uint16_t Firmware::motorMicroseconds(int16_t speed) {
+    int microseconds = 1500 - ((int32_t)speed * 500) / 10000;
+    // out of range values stop the motor
+    if(microseconds > 2000 || microseconds < 1000) {
+        microseconds = 1500;
+    }
+    return microseconds;
+}
+
+/**
+ * Parses all received frames and hands queued frames to the transmitter.
+ * Only bytes the serial port already holds are read, so this never waits.
+ */
+void Firmware::serialTask(void* self, uint32_t now) {
+    Firmware& firmware = *static_cast<Firmware*>(self);
+
+    Message message;
+    while(true) {
+        if(firmware.parser.next(firmware.rxData, firmware.rxLength, &message)) {
+            firmware.statistics.framesReceived++;
+            firmware.handle(message, now);
+            continue;
+        }
+
+        int available = firmware.hardware.available();
+        if(available <= 0) {
+            break;
+        }
+        if(available > RX_CHUNK_SIZE) {
+            available = RX_CHUNK_SIZE;
+        }
+        firmware.rxLength = firmware.hardware.read(firmware.rxChunk, available);
+        firmware.rxData = firmware.rxChunk;
+    }
+
+    const char* data;
+    uint16_t length;
+    while((length = firmware.tx.peek(data)) > 0) {
+        int space = firmware.hardware.availableForWrite();
+        if(space <= 0) {
+            break;
+        }
+        if(length > space) {
+            length = space;
+        }
+        int written = firmware.hardware.write(data, length);
+        if(written <= 0) {
+            break;
+        }
+        firmware.tx.pop(written);
+    }
+}
+
+/**
+ * Writes the commanded actuator values at a fixed cadence. Without ACTUATOR
+ * frames the motor falls back to neutral, the servos keep their position.
+ */
+void Firmware::actuatorTask(void* self, uint32_t now) {
+    Firmware& firmware = *static_cast<Firmware*>(self);
+
+    if(! firmware.failsafe && now - firmware.lastActuator > FAILSAFE_TIMEOUT) {
+        firmware.failsafe = true;
+        firmware.motorSpeed = 0;
+        firmware.statistics.failsafes++;
+    }
+
+    firmware.hardware.writeServo(1, firmware.servoAngle[0]);
+    firmware.hardware.writeServo(2, firmware.servoAngle[1]);
+    firmware.hardware.writeMotor(motorMicroseconds(firmware.motorSpeed));
+}
+
+void Firmware::streamTask(void* self, uint32_t now) {
+    Firmware& firmware = *static_cast<Firmware*>(self);
+    if(firmware.streamMask == 0) {
+        return;
+    }
+
+    Message samples[MAX_STREAM_SAMPLES];
+    uint8_t count = 0;
+    if(firmware.streamMask & STREAM_FRONT_SERVO) {
+        firmware.sample(SensorType::SERVO, 1, &samples[count++]);
+    }
+    if(firmware.streamMask & STREAM_REAR_SERVO) {
+        firmware.sample(SensorType::SERVO, 2, &samples[count++]);
+    }
+    if(firmware.streamMask & STREAM_MOTOR) {
+        firmware.sample(SensorType::MOTOR, 1, &samples[count++]);
+    }
+
+    // the samples are sent with the sequence of their BATCH, a batch that
+    // is dropped breaks the deltas, so the next one carries keyframes
+    Message encoded[MAX_STREAM_SAMPLES];
+    for(uint8_t i = 0; i < count; i++) {
+        samples[i].sequence = firmware.streamSequence;
+        firmware.encoder.encode(samples[i], &encoded[i]);
+    }
+    if(! firmware.sendSamples(firmware.boardMicros(now), encoded, count)) {
+        firmware.encoder.forceKeyframes();
+    }
+}
+
+void Firmware::handle(Message& m, uint32_t now) {
+    if(m.message == MessageType::ACTUATOR) {
+        lastActuator = now;
+        failsafe = false;
+
+        if(m.actuator == ActuatorType::LED) {
+            if(m.id == 1) {
+                // LEDs have no cadence, switch at once
+                hardware.writeLed(1, m.actuatorData.Led.value == ON);
+            }
+        } else if(m.actuator == ActuatorType::MOTOR) {
+            if(m.id == 1) {
+                motorSpeed = m.actuatorData.Motor.speed;
+            }
+        } else if(m.actuator == ActuatorType::SERVO) {
+            // front servo ID 1, rear servo ID 2
+            if(m.id == 1 || m.id == 2) {
+                servoAngle[m.id - 1] = m.actuatorData.Servo.angle;
+            }
+        }
+    } else if(m.message == MessageType::CHECKSUM_MODE
+              && m.checksum.mode < ChecksumMode::__END__) {
+        // switch the receiver at once, the host waits for the acknowledge
+        parser.setChecksumMode(m.checksum.mode);
+        // acknowledge using the old mode, then switch the sender
+        send(m);
+        checksumMode = m.checksum.mode;
+        // frames in flight may be lost while the host switches
+        encoder.forceKeyframes();
+    } else if(m.message == MessageType::TIME && m.id == TIME_SYNC_ID) {
+        // answer with the board clock, the sequence number identifies the request
+        m.time.micros = boardMicros(now);
+        send(m);
+    } else if(m.message == MessageType::SENSOR_ENABLE || m.message == MessageType::SENSOR_DISABLE) {
+        uint8_t bit = streamBit(m.sensor, m.id);
+        if(bit == 0) {
+            m.error.code = m.message == MessageType::SENSOR_ENABLE
+                    ? ErrorCode::SENSOR_ENABLE_FAILED : ErrorCode::SENSOR_DISABLE_FAILED;
+            m.message = MessageType::ERROR;
+        } else if(m.message == MessageType::SENSOR_ENABLE) {
+            streamMask |= bit;
+            // a (re)connected host has no state to apply deltas to
+            encoder.forceKeyframes();
+        } else {
+            streamMask &= ~bit;
+        }
+        // acknowledge with the same message
+        send(m);
+    } else if(m.message == MessageType::SENSOR_GET) {
+        if(! sample(m.sensor, m.id, &m)) {
+            m.message = MessageType::ERROR;
+            m.error.code = ErrorCode::SENSOR_DATA_FAILED;
+        }
+        send(m);
+    } else {
+        Message out;
+        out.message = MessageType::ERROR;
+        out.sensor = SensorType::UNKNOWN;
+        out.id = 0;
+        out.sequence = m.sequence;
+        out.error.code = ErrorCode::INVALID_SENSOR_TYPE;
+        send(out);
+    }
+}
+
+/**
+ * Queues a message as a single frame, the frame is dropped if the TX buffer
+ * is full rather than stalling the loop.
+ */
+bool Firmware::send(const Message& message) {
+    char buffer[MESSAGE_FRAME_SIZE];
+    buffer[0] = encodeMessage(&message, buffer + 1, checksumMode);
+
+    if(! tx.push(buffer, 1 + static_cast<uint8_t>(buffer[0]))) {
+        statistics.framesDropped++;
+        return false;
+    }
+    statistics.framesSent++;
+    return true;
+}
+
+/**
+ * Queues samples taken at the same time as one BATCH frame. The first entry
+ * is a TIME_STAMP_ID message, so the host can map the samples to its own
+ * clock.
+ */
+bool Firmware::sendSamples(uint64_t sampleMicros, const Message* samples, uint8_t count) {
+    Message messages[MAX_STREAM_SAMPLES + 1];
+    if(count > MAX_STREAM_SAMPLES) {
+        return false;
+    }
+
+    messages[0].message = MessageType::TIME;
+    messages[0].sensor = SensorType::UNKNOWN;
+    messages[0].id = TIME_STAMP_ID;
+    messages[0].time.micros = sampleMicros;
+    for(uint8_t i = 0; i < count; i++) {
+        messages[i + 1] = samples[i];
+    }
+
+    char buffer[BATCH_FRAME_SIZE];
+    int batchLength = encodeBatch(messages, count + 1, streamSequence++, buffer + 1,
+                                  sizeof(buffer) - 1, checksumMode);
+    if(batchLength == -1) {
+        return false;
+    }
+    buffer[0] = batchLength;
+
+    if(! tx.push(buffer, batchLength + 1)) {
+        statistics.framesDropped++;
+        return false;
+    }
+    statistics.framesSent++;
+    return true;
+}
+
+/**
+ * Fills in the current value of a sensor as SENSOR_DATA message.
+ */
+bool Firmware::sample(SensorType sensor, uint8_t id, Message* message) {
+    message->message = MessageType::SENSOR_DATA;
+    message->sensor = sensor;
+    message->id = id;
+
+    if(sensor == SensorType::SERVO && (id == 1 || id == 2)) {
+        message->sensorData.Servo.angle = servoAngle[id - 1];
+        return true;
+    } else if(sensor == SensorType::MOTOR && id == 1) {
+        message->sensorData.Motor.speed = motorSpeed;
+        return true;
+    }
+    return false;
+}
+
+uint8_t Firmware::streamBit(SensorType sensor, uint8_t id) const {
+    if(sensor == SensorType::SERVO && id == 1) {
+        return STREAM_FRONT_SERVO;
+    } else if(sensor == SensorType::SERVO && id == 2) {
+        return STREAM_REAR_SERVO;
+    } else if(sensor == SensorType::MOTOR && id == 1) {
+        return STREAM_MOTOR;
+    }
+    return 0;
+}
+
+/**
+ * Board clock in microseconds. micros() wraps after ~71 minutes, the wraps
+ * are counted so the clock keeps increasing. loop() calls it at least once
+ * per wrap.
+ */
+uint64_t Firmware::boardMicros(uint32_t now) {
+    if(now < lastMicros) {
+        microsWraps++;
+    }
+    lastMicros = now;
+    return ((uint64_t)microsWraps << 32) | now;
+}
+
+}  // namespace senseboard
@@ -0,0 +1,119 @@
+#ifndef SENSEBOARD_FIRMWARE_H
+#define SENSEBOARD_FIRMWARE_H
+
+#include <stdint.h>
+
+#include <compact.h>
+#include <message.h>
+#include <parser.h>
+
+#include "hardware.h"
+#include "ring_buffer.h"
+#include "scheduler.h"
+
+namespace senseboard {
+
+const uint32_t SERVO_REFRESH_PERIOD = 10000; //!< 100 Hz [us]
+const uint32_t FAILSAFE_TIMEOUT = 250000; //!< motor neutral without actuator frames [us]
+const uint32_t STREAM_PERIOD = 20000; //!< sensor streaming at 50 Hz [us]
+
+const uint16_t TX_BUFFER_SIZE = 256;
+const uint8_t RX_CHUNK_SIZE = 32;
+
+/**
+ * @brief The FirmwareStats struct
+ */
+struct FirmwareStats {
+    uint32_t framesReceived;
+    uint32_t framesSent;
+    uint32_t framesDropped; //!< Frames not sent because the TX buffer was full
+    uint32_t failsafes; //!< Times the failsafe set the motor to neutral
+};
+
+/**
+ * @brief Senseboard firmware
+ *
+ * Runs three tasks on a cooperative Scheduler, none of them blocks:
+ * - serial: parses received bytes as they arrive and hands queued frames to
+ *   the transmitter as far as it accepts them
+ * - actuators (100 Hz): writes the last commanded servo angles and motor
+ *   speed, sets the motor to neutral if no ACTUATOR frame arrived within
+ *   FAILSAFE_TIMEOUT
+ * - stream (50 Hz): sends the sensors enabled with SENSOR_ENABLE as one
+ *   stamped BATCH frame, compact encoded: a keyframe every
+ *   COMPACT_KEYFRAME_INTERVAL samples and SENSOR_DATA_DELTA in between
+ *
+ * Sensors: SERVO 1/2 (angle) and MOTOR 1 (speed) report the commanded values.
+ */
+class Firmware {
+public:
+    explicit Firmware(Hardware& hardware);
+
+    /**
+     * @brief begin registers the tasks, call once from setup()
+     */
+    void begin();
+
+    /**
+     * @brief loop runs all due tasks, call from loop() as often as possible
+     */
+    void loop();
+
+    bool failsafeActive() const {
+        return failsafe;
+    }
+
+    const FirmwareStats& stats() const {
+        return statistics;
+    }
+
+    const Scheduler& tasks() const {
+        return scheduler;
+    }
+
+    /**
+     * @brief motorMicroseconds maps a motor speed of -10000 (full brake) to
+     * 10000 (full throttle) to a PWM pulse of 2000 to 1000 us
+     */
+    static uint16_t motorMicroseconds(int16_t speed);
+
+private:
+    static void serialTask(void* self, uint32_t now);
+    static void actuatorTask(void* self, uint32_t now);
+    static void streamTask(void* self, uint32_t now);
+
+    void handle(sense_link::Message& message, uint32_t now);
+    bool send(const sense_link::Message& message);
+    bool sendSamples(uint64_t sampleMicros, const sense_link::Message* samples, uint8_t count);
+    bool sample(sense_link::SensorType sensor, uint8_t id, sense_link::Message* message);
+    uint8_t streamBit(sense_link::SensorType sensor, uint8_t id) const;
+    uint64_t boardMicros(uint32_t now);
+
+    Hardware& hardware;
+    Scheduler scheduler;
+
+    sense_link::FrameParser parser;
+    sense_link::ChecksumMode checksumMode; //!< negotiated by the host
+    char rxChunk[RX_CHUNK_SIZE]; //!< bytes taken from the serial receiver
+    const char* rxData; //!< first byte of rxChunk not parsed yet
+    unsigned int rxLength; //!< number of bytes in rxChunk not parsed yet
+    RingBuffer<TX_BUFFER_SIZE> tx;
+
+    int16_t servoAngle[2]; //!< front and rear servo [deg]
+    int16_t motorSpeed;
+    uint32_t lastActuator; //!< time of the last ACTUATOR frame [us]
+    bool failsafe;
+
+    uint8_t streamMask; //!< sensors enabled for streaming, see streamBit()
+    uint8_t streamSequence;
+    sense_link::CompactEncoder encoder; //!< of the streamed samples
+
+    uint32_t lastMicros; //!< board clock, micros() extended to 64 bit
+    uint32_t microsWraps;
+
+    FirmwareStats statistics;
+};
+
+}  // namespace senseboard
+
+#endif /* SENSEBOARD_FIRMWARE_H */
@@ -0,0 +1,64 @@
+#ifndef SENSEBOARD_HARDWARE_H
+#define SENSEBOARD_HARDWARE_H
+
+#include <stdint.h>
+
+namespace senseboard {
+
+/**
+ * @brief Interface between the firmware and the board
+ *
+ * Implemented by the sketch on the Arduino and by the host simulation, so both
+ * run the same Firmware and Scheduler. None of the functions may block.
+ */
+class Hardware {
+public:
+    /**
+     * @brief micros free running microseconds clock, wraps at 2^32
+     */
+    virtual uint32_t micros() = 0;
+
+    /**
+     * @brief available number of received bytes that can be read
+     */
+    virtual int available() = 0;
+
+    /**
+     * @brief read reads up to length received bytes
+     * @return number of bytes read
+     */
+    virtual int read(char* buffer, int length) = 0;
+
+    /**
+     * @brief availableForWrite number of bytes write() accepts without blocking
+     */
+    virtual int availableForWrite() = 0;
+
+    /**
+     * @brief write hands bytes to the serial transmitter
+     * @return number of bytes accepted
+     */
+    virtual int write(const char* buffer, int length) = 0;
+
+    /**
+     * @brief writeServo sets a servo deflection
+     * @param id 1: front servo, 2: rear servo
+     * @param angle deflection angle [deg]
+     */
+    virtual void writeServo(uint8_t id, int16_t angle) = 0;
+
+    /**
+     * @brief writeMotor sets the PWM pulse of the motor controller
+     * @param microseconds 1000 - 2000, 1500 is neutral
+     */
+    virtual void writeMotor(uint16_t microseconds) = 0;
+
+    virtual void writeLed(uint8_t id, bool on) = 0;
+
+protected:
+    ~Hardware() {}
+};
+
+}  // namespace senseboard
+
+#endif /* SENSEBOARD_HARDWARE_H */
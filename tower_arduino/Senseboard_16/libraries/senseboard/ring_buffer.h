@@ -0,0 +1,76 @@
+#ifndef SENSEBOARD_RING_BUFFER_H
+#define SENSEBOARD_RING_BUFFER_H
+
+#include <stdint.h>
+#include <string.h>
+
+namespace senseboard {
+
+/**
+ * @brief Byte FIFO with a fixed size
+ *
+ * Whole frames are pushed at once or not at all, so the receiver never sees a
+ * truncated frame. The free-running indices wrap at 2^16, SIZE must be a power
+ * of two.
+ */
+template<uint16_t SIZE>
+class RingBuffer {
+    static_assert(SIZE > 0 && (SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+public:
+    RingBuffer() : head(0), tail(0) {
+    }
+
+    uint16_t used() const {
+        return head - tail;
+    }
+
+    uint16_t free() const {
+        return SIZE - used();
+    }
+
+    /**
+     * @brief push appends all bytes or none
+     * @return false if there is not enough space
+     */
+    bool push(const char* data, uint16_t length) {
+        if(length > free()) {
+            return false;
+        }
+
+        uint16_t start = head & (SIZE - 1);
+        uint16_t first = SIZE - start < length ? SIZE - start : length;
+        memcpy(buffer + start, data, first);
+        memcpy(buffer, data + first, length - first);
+        head += length;
+        return true;
+    }
+
+    /**
+     * @brief peek returns the oldest bytes that lie contiguous in memory
+     * @param data first byte (result)
+     * @return number of bytes at data
+     */
+    uint16_t peek(const char*& data) const {
+        uint16_t start = tail & (SIZE - 1);
+        data = buffer + start;
+        uint16_t length = used();
+        return SIZE - start < length ? SIZE - start : length;
+    }
+
+    /**
+     * @brief pop removes the oldest bytes, e.g. after they were sent
+     */
+    void pop(uint16_t length) {
+        tail += length;
+    }
+
+private:
+    char buffer[SIZE];
+    uint16_t head; //!< total bytes pushed
+    uint16_t tail; //!< total bytes popped
+};
+
+}  // namespace senseboard
+
+#endif /* SENSEBOARD_RING_BUFFER_H */
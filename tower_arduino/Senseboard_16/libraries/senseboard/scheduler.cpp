@@ -0,0 +1,48 @@
+#include "scheduler.h"
+
+namespace senseboard {
+
+Scheduler::Scheduler() : count(0), skipped(0), lateness(0) {
+}
+
+bool Scheduler::add(TaskFunction function, void* context, uint32_t period, uint32_t now) {
+    if(count == MAX_TASKS) {
+        return false;
+    }
+
+    Task& task = tasks[count++];
+    task.function = function;
+    task.context = context;
+    task.period = period;
+    task.due = now;
+    return true;
+}
+
+void Scheduler::run(uint32_t now) {
+    for(uint8_t i = 0; i < count; i++) {
+        Task& task = tasks[i];
+        if(task.period == 0) {
+            task.function(task.context, now);
+            continue;
+        }
+
+        // the difference stays correct when micros() wraps
+        uint32_t late = now - task.due;
+        if(static_cast<int32_t>(late) < 0) {
+            continue;
+        }
+
+        if(late > lateness) {
+            lateness = late;
+        }
+        task.due += task.period;
+        if(late >= task.period) {
+            skipped += late / task.period;
+            task.due = now + task.period;
+        }
+
+        task.function(task.context, now);
+    }
+}
+
+}  // namespace senseboard
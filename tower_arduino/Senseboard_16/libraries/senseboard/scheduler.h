@@ -0,0 +1,77 @@
+#ifndef SENSEBOARD_SCHEDULER_H
+#define SENSEBOARD_SCHEDULER_H
+
+#include <stdint.h>
+
+namespace senseboard {
+
+/**
+ * @brief Cooperative scheduler for periodic tasks
+ *
+ * Every task runs to completion, so a task must never wait for I/O. Periodic
+ * tasks keep a fixed cadence: the next run is due one period after the last
+ * due time, not after the time the task actually ran. A task that fell behind
+ * by more than a period skips the missed runs and counts an overrun.
+ */
+class Scheduler {
+public:
+    /**
+     * @brief Task entry point
+     * @param context pointer given to add()
+     * @param now current time [us]
+     */
+    typedef void (*TaskFunction)(void* context, uint32_t now);
+
+    static const uint8_t MAX_TASKS = 8;
+
+    Scheduler();
+
+    /**
+     * @brief add registers a task, it first runs on the next call to run()
+     * @param function task entry point
+     * @param context passed to function
+     * @param period time between two runs [us], 0 runs the task on every call
+     * to run()
+     * @param now current time [us]
+     * @return false if MAX_TASKS are registered already
+     */
+    bool add(TaskFunction function, void* context, uint32_t period, uint32_t now);
+
+    /**
+     * @brief run runs every task that is due, in the order they were added
+     * @param now current time [us]
+     */
+    void run(uint32_t now);
+
+    /**
+     * @brief overruns number of runs skipped because a task fell behind
+     */
+    uint32_t overruns() const {
+        return skipped;
+    }
+
+    /**
+     * @brief maxLateness longest delay between the due time and the start of
+     * a periodic task [us]
+     */
+    uint32_t maxLateness() const {
+        return lateness;
+    }
+
+private:
+    struct Task {
+        TaskFunction function;
+        void* context;
+        uint32_t period;
+        uint32_t due;
+    };
+
+    Task tasks[MAX_TASKS];
+    uint8_t count;
+    uint32_t skipped;
+    uint32_t lateness;
+};
+
+}  // namespace senseboard
+
+#endif /* SENSEBOARD_SCHEDULER_H */